@@ -216,8 +216,44 @@ struct BroadwayOutput {
   guint32 serial;
   gboolean proto_v7_plus;
   gboolean binary;
+  /* Data not yet written, for nonblocking outputs */
+  GByteArray *pending;
 };
 
+static void
+broadway_output_write (BroadwayOutput *output,
+		       const void *buf, gsize count)
+{
+  if (output->pending)
+    g_byte_array_append (output->pending, buf, count);
+  else
+    g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+}
+
+static void
+broadway_output_write_pending (BroadwayOutput *output)
+{
+  GError *error = NULL;
+  gssize res;
+
+  while (output->pending->len > 0)
+    {
+      res = g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM (output->out),
+							output->pending->data,
+							output->pending->len,
+							NULL, &error);
+      if (res < 0)
+	{
+	  if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+	    output->error = TRUE;
+	  g_error_free (error);
+	  return;
+	}
+
+      g_byte_array_remove_range (output->pending, 0, res);
+    }
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
 			  gboolean fin, BroadwayWSOpCode code,
@@ -247,30 +283,37 @@ broadway_output_send_cmd (BroadwayOutput *output,
     }
   // FIXME: if we are paranoid we should 'mask' the data
   // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+  broadway_output_write (output, header, p);
+  broadway_output_write (output, buf, count);
 }
 
 static void
 broadway_output_send_cmd_pre_v7 (BroadwayOutput *output,
 				 const void *buf, gsize count)
 {
-  g_output_stream_write_all (output->out, "\0", 1, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, "\xff", 1, NULL, NULL, NULL);
+  broadway_output_write (output, "\0", 1);
+  broadway_output_write (output, buf, count);
+  broadway_output_write (output, "\xff", 1);
 }
 
 void broadway_output_pong (BroadwayOutput *output)
 {
   if (output->proto_v7_plus)
     broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
+
+  if (output->pending)
+    broadway_output_write_pending (output);
 }
 
 int
 broadway_output_flush (BroadwayOutput *output)
 {
   if (output->buf->len == 0)
-    return TRUE;
+    {
+      if (output->pending)
+	broadway_output_write_pending (output);
+      return !output->error;
+    }
 
   if (!output->proto_v7_plus)
     broadway_output_send_cmd_pre_v7 (output, output->buf->str, output->buf->len);
@@ -283,10 +326,43 @@ broadway_output_flush (BroadwayOutput *output)
 
   g_string_set_size (output->buf, 0);
 
+  if (output->pending)
+    broadway_output_write_pending (output);
+
   return !output->error;
 
 }
 
+int
+broadway_output_has_error (BroadwayOutput *output)
+{
+  return output->error;
+}
+
+/* Makes flushes queue whatever the stream can't take right away,
+ * instead of waiting for it. The stream must be pollable. */
+void
+broadway_output_set_nonblocking (BroadwayOutput *output)
+{
+  g_return_if_fail (G_IS_POLLABLE_OUTPUT_STREAM (output->out));
+
+  if (output->pending == NULL)
+    output->pending = g_byte_array_new ();
+}
+
+/* Whether a nonblocking output still has data that the stream
+ * didn't take, i.e. whether the other end is behind. */
+gboolean
+broadway_output_is_blocked (BroadwayOutput *output)
+{
+  if (output->pending == NULL)
+    return FALSE;
+
+  broadway_output_write_pending (output);
+
+  return output->pending->len > 0;
+}
+
 BroadwayOutput *
 broadway_output_new (GOutputStream *out, guint32 serial,
 		     gboolean proto_v7_plus, gboolean binary)
@@ -308,6 +384,8 @@ void
 broadway_output_free (BroadwayOutput *output)
 {
   g_object_unref (output->out);
+  if (output->pending)
+    g_byte_array_free (output->pending, TRUE);
   free (output);
 }
 
@@ -851,6 +929,161 @@ broadway_output_put_rgba (BroadwayOutput *output,  int id, int x, int y,
   free (rects);
 }
 
+/* Buffers are sent as the changes to the pixels the client already
+ * has, or as all pixels if old_data is NULL, as a list of runs:
+ *   0x00 - 0x7f: skip n + 1 unchanged pixels
+ *   0x80 - 0xbf: n - 0x7f pixels follow, as RGB bytes
+ *   0xc0 - 0xff: n - 0xbf times the RGB pixel that follows
+ * This is much cheaper to produce than a png, and most updates
+ * only change a few pixels of the area they are sent for.
+ * The client doesn't care about rows, but runs end with each row
+ * here, so the rows can be walked without computing positions.
+ */
+#define MAX_SKIP_RUN 128
+#define MAX_PIXEL_RUN 64
+
+#define PIXEL(_line, _x) ((_line)[_x] & 0xffffff)
+
+static void
+append_pixel (GString *buf, guint32 pixel)
+{
+  g_string_append_c (buf, (pixel >> 16) & 0xff);
+  g_string_append_c (buf, (pixel >> 8) & 0xff);
+  g_string_append_c (buf, (pixel >> 0) & 0xff);
+}
+
+static void
+encode_row (GString *buf, int w,
+	    guint32 *line, guint32 *old_line)
+{
+  int i, j;
+
+  i = 0;
+  while (i < w)
+    {
+      guint32 pixel = PIXEL (line, i);
+
+      if (old_line != NULL &&
+	  pixel == PIXEL (old_line, i))
+	{
+	  for (j = i + 1; j < w && j - i < MAX_SKIP_RUN; j++)
+	    {
+	      if (PIXEL (line, j) != PIXEL (old_line, j))
+		break;
+	    }
+	  g_string_append_c (buf, j - i - 1);
+	  i = j;
+	  continue;
+	}
+
+      for (j = i + 1; j < w && j - i < MAX_PIXEL_RUN; j++)
+	{
+	  if (PIXEL (line, j) != pixel)
+	    break;
+	}
+      if (j - i >= 3)
+	{
+	  g_string_append_c (buf, 0xbf + j - i);
+	  append_pixel (buf, pixel);
+	  i = j;
+	  continue;
+	}
+
+      /* Literal pixels, up to the next unchanged pixel or run */
+      for (j = i + 1; j < w && j - i < MAX_PIXEL_RUN; j++)
+	{
+	  guint32 p = PIXEL (line, j);
+
+	  if (old_line != NULL &&
+	      p == PIXEL (old_line, j))
+	    break;
+	  if (j + 2 < w &&
+	      p == PIXEL (line, j + 1) &&
+	      p == PIXEL (line, j + 2))
+	    break;
+	}
+      g_string_append_c (buf, 0x7f + j - i);
+      for (; i < j; i++)
+	append_pixel (buf, PIXEL (line, i));
+    }
+}
+
+static void
+encode_buffer (GString *buf, int w, int h,
+	       int byte_stride, void *data,
+	       int old_byte_stride, void *old_data)
+{
+  guint8 *line, *old_line;
+  int y;
+
+  line = data;
+  old_line = old_data;
+  for (y = 0; y < h; y++)
+    {
+      encode_row (buf, w, (guint32 *)line, (guint32 *)old_line);
+
+      line += byte_stride;
+      if (old_line != NULL)
+	old_line += old_byte_stride;
+    }
+}
+
+void
+broadway_output_put_buffer (BroadwayOutput *output,  int id, int x, int y,
+			    int w, int h, int byte_stride, void *data,
+			    int old_byte_stride, void *old_data)
+{
+  gsize size_start, image_start, len;
+
+  if (!output->binary && old_data == NULL)
+    {
+      broadway_output_put_rgb (output, id, x, y, w, h, byte_stride, data);
+      return;
+    }
+
+  if (!output->binary)
+    {
+      guint32 *diff;
+      int xx, yy;
+
+      /* The text protocol can only carry pngs */
+      diff = g_new (guint32, w * h);
+      for (yy = 0; yy < h; yy++)
+	{
+	  guint32 *line = (guint32 *)((guint8 *)data + yy * byte_stride);
+	  guint32 *old_line = (guint32 *)((guint8 *)old_data + yy * old_byte_stride);
+
+	  for (xx = 0; xx < w; xx++)
+	    {
+	      if ((line[xx] & 0xffffff) == (old_line[xx] & 0xffffff))
+		diff[yy * w + xx] = 0;
+	      else
+		diff[yy * w + xx] = line[xx] | 0xff000000;
+	    }
+	}
+
+      broadway_output_put_rgba (output, id, x, y, w, h, w * 4, diff);
+      g_free (diff);
+      return;
+    }
+
+  write_header (output, BROADWAY_OP_PUT_BUFFER);
+  append_uint16 (output, id);
+  append_uint16 (output, x);
+  append_uint16 (output, y);
+  append_uint16 (output, w);
+  append_uint16 (output, h);
+
+  size_start = output->buf->len;
+  append_uint32 (output, 0);
+
+  image_start = output->buf->len;
+  encode_buffer (output->buf, w, h, byte_stride, data, old_byte_stride, old_data);
+  len = output->buf->len - image_start;
+
+  overwrite_uint32 (output, size_start, len);
+}
+
 void
 broadway_output_surface_flush (BroadwayOutput *output,
 			       int             id)
@@ -23,6 +23,8 @@ BroadwayOutput *broadway_output_new             (GOutputStream  *out,
 void            broadway_output_free            (BroadwayOutput *output);
 int             broadway_output_flush           (BroadwayOutput *output);
 int             broadway_output_has_error       (BroadwayOutput *output);
+void            broadway_output_set_nonblocking (BroadwayOutput *output);
+gboolean        broadway_output_is_blocked      (BroadwayOutput *output);
 void            broadway_output_set_next_serial (BroadwayOutput *output,
 						 guint32         serial);
 guint32         broadway_output_get_next_serial (BroadwayOutput *output);
@@ -69,6 +71,16 @@ void            broadway_output_put_rgba        (BroadwayOutput *output,
 						 int             h,
 						 int             byte_stride,
 						 void           *data);
+void            broadway_output_put_buffer      (BroadwayOutput *output,
+						 int             id,
+						 int             x,
+						 int             y,
+						 int             w,
+						 int             h,
+						 int             byte_stride,
+						 void           *data,
+						 int             old_byte_stride,
+						 void           *old_data);
 void            broadway_output_surface_flush   (BroadwayOutput *output,
 						 int             id);
 void            broadway_output_copy_rectangles (BroadwayOutput *output,
@@ -50,6 +50,8 @@ struct _BroadwayServer {
   BroadwayInput *input;
   GList *input_messages;
   guint process_input_idle;
+  /* Inputs that only watch the session, see viewer_sync() */
+  GList *viewers;
 
   GHashTable *id_ht;
   GList *toplevels;
@@ -99,8 +101,26 @@ struct BroadwayInput {
   gboolean proto_v7_plus;
   gboolean binary;
   gboolean active;
+
+  /* Viewers own their output, ignore their input and get the
+   * latest state whenever they can take it */
+  gboolean is_viewer;
+  GHashTable *viewer_windows;
+  gint64 last_sync_time;
+  guint sync_source;
 };
 
+/* What a viewer was last sent of a window */
+typedef struct {
+  gint32 x;
+  gint32 y;
+  gint32 width;
+  gint32 height;
+  gboolean visible;
+  gint32 transient_for;
+  guint64 *tile_hashes;
+} BroadwayViewerWindow;
+
 struct BroadwayWindow {
   gint32 id;
   gint32 x;
@@ -113,6 +133,9 @@ struct BroadwayWindow {
   gint32 transient_for;
 
   cairo_surface_t *last_surface;
+  /* Hashes of the tiles and rows of last_surface, or NULL */
+  guint64 *tile_hashes;
+  guint64 *row_hashes;
 
   char *cached_surface_name;
   cairo_surface_t *cached_surface;
@@ -184,6 +207,8 @@ broadway_server_class_init (BroadwayServerClass * class)
 }
 
 static void start (BroadwayInput *input);
+static void viewer_sync (BroadwayInput *input);
+static gboolean viewer_sync_cb (BroadwayInput *input);
 
 static void
 http_request_free (HttpRequest *request)
@@ -197,12 +222,29 @@ http_request_free (HttpRequest *request)
 static void
 broadway_input_free (BroadwayInput *input)
 {
+  if (input->is_viewer)
+    {
+      input->server->viewers = g_list_remove (input->server->viewers, input);
+      if (input->sync_source)
+	g_source_remove (input->sync_source);
+      if (input->viewer_windows)
+	g_hash_table_destroy (input->viewer_windows);
+      broadway_output_free (input->output);
+    }
+
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
   g_source_destroy (input->source);
   g_free (input);
 }
 
+static void
+viewer_window_free (BroadwayViewerWindow *viewer_window)
+{
+  g_free (viewer_window->tile_hashes);
+  g_free (viewer_window);
+}
+
 static void
 update_event_state (BroadwayServer *server,
 		    BroadwayInputMsg *message)
@@ -425,6 +467,9 @@ parse_input_message (BroadwayInput *input, const char *message)
       return;
     }
 
+  if (input->is_viewer)
+    return;
+
   memset (&msg, 0, sizeof (msg));
 
   p = (char *)message;
@@ -799,6 +844,8 @@ broadway_server_get_screen_size (BroadwayServer   *server,
 void
 broadway_server_flush (BroadwayServer *server)
 {
+  GList *l, *next;
+
   if (server->output &&
       !broadway_output_flush (server->output))
     {
@@ -806,6 +853,12 @@ broadway_server_flush (BroadwayServer *server)
       broadway_output_free (server->output);
       server->output = NULL;
     }
+
+  for (l = server->viewers; l != NULL; l = next)
+    {
+      next = l->next;
+      viewer_sync (l->data);
+    }
 }
 
 void
@@ -1002,7 +1055,7 @@ generate_handshake_response_wsietf_v7 (const gchar *key)
 }
 
 static void
-start_input (HttpRequest *request, gboolean binary)
+start_input (HttpRequest *request, gboolean binary, gboolean is_viewer)
 {
   char **lines;
   char *p;
@@ -1178,6 +1231,7 @@ start_input (HttpRequest *request, gboolean binary)
   input->connection = g_object_ref (request->connection);
   input->proto_v7_plus = proto_v7_plus;
   input->binary = binary;
+  input->is_viewer = is_viewer;
 
   data_buffer = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (request->data), &data_buffer_size);
   input->buffer = g_byte_array_sized_new (data_buffer_size);
@@ -1218,6 +1272,20 @@ start (BroadwayInput *input)
 
   server = BROADWAY_SERVER (input->server);
 
+  if (input->is_viewer)
+    {
+      /* Viewers never hold up the session, see viewer_sync() */
+      input->viewer_windows = g_hash_table_new_full (NULL, NULL, NULL,
+						     (GDestroyNotify) viewer_window_free);
+      broadway_output_set_nonblocking (input->output);
+      broadway_output_auth_ok (input->output);
+      server->viewers = g_list_prepend (server->viewers, input);
+      /* Not synced right away, since that frees the input if the
+       * viewer is already gone */
+      input->sync_source = g_idle_add ((GSourceFunc)viewer_sync_cb, input);
+      return;
+    }
+
   if (server->output)
     {
       broadway_output_disconnected (server->output);
@@ -1316,9 +1384,9 @@ got_request (HttpRequest *request)
   else if (strcmp (escaped, "/broadway.js") == 0)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
-    start_input (request, FALSE);
+    start_input (request, FALSE, query && strcmp (query + 1, "view") == 0);
   else if (strcmp (escaped, "/socket-bin") == 0)
-    start_input (request, TRUE);
+    start_input (request, TRUE, query && strcmp (query + 1, "view") == 0);
   else
     send_error (request, 404, "File not found");
 
@@ -1506,6 +1574,8 @@ broadway_server_destroy_window (BroadwayServer *server,
 	g_free (window->cached_surface_name);
       if (window->cached_surface != NULL)
 	cairo_surface_destroy (window->cached_surface);
+      g_free (window->tile_hashes);
+      g_free (window->row_hashes);
 
       g_free (window);
     }
@@ -1611,6 +1681,43 @@ _cairo_region (cairo_t         *cr,
 }
 
 
+/* Updates are compared with what the client has in tiles, so that
+ * unchanged parts of a window are never encoded. */
+#define TILE_SIZE 64
+#define N_TILES(size) (((size) + TILE_SIZE - 1) / TILE_SIZE)
+/* The smallest band of rows that is worth sending as a copy */
+#define MIN_SCROLL_ROWS 16
+
+#define HASH_INIT G_GUINT64_CONSTANT (0xcbf29ce484222325)
+#define HASH_STEP(hash, value) (((hash) ^ (value)) * G_GUINT64_CONSTANT (0x100000001b3))
+
+/* Forgets the hashes of the parts of last_surface that changed
+ * without a matching update, or all of them for a NULL area */
+static void
+invalidate_hashes (BroadwayWindow              *window,
+		   const cairo_rectangle_int_t *area)
+{
+  int n_tiles_x, tx, ty, y;
+
+  if (area == NULL || window->tile_hashes == NULL)
+    {
+      g_free (window->tile_hashes);
+      g_free (window->row_hashes);
+      window->tile_hashes = NULL;
+      window->row_hashes = NULL;
+      return;
+    }
+
+  /* Zero matches no real hash */
+  n_tiles_x = N_TILES (window->width);
+  for (ty = MAX (area->y, 0) / TILE_SIZE; ty < N_TILES (MIN (area->y + area->height, window->height)); ty++)
+    for (tx = MAX (area->x, 0) / TILE_SIZE; tx < N_TILES (MIN (area->x + area->width, window->width)); tx++)
+      window->tile_hashes[ty * n_tiles_x + tx] = 0;
+
+  for (y = MAX (area->y, 0); y < MIN (area->y + area->height, window->height); y++)
+    window->row_hashes[y] = 0;
+}
+
 static void
 copy_region (cairo_surface_t *surface,
 	     cairo_region_t *area,
@@ -1662,6 +1769,8 @@ broadway_server_window_translate (BroadwayServer *server,
       int i, n_rects;
 
       copy_region (window->last_surface, area, dx, dy);
+      cairo_region_get_extents (area, &rect);
+      invalidate_hashes (window, &rect);
       n_rects = cairo_region_num_rectangles (area);
       rects = g_new (BroadwayRect, n_rects);
       for (i = 0; i < n_rects; i++)
@@ -1683,41 +1792,184 @@ broadway_server_window_translate (BroadwayServer *server,
 }
 
 static void
-diff_surfaces (cairo_surface_t *surface,
-	       cairo_surface_t *old_surface)
+hash_surface (cairo_surface_t *surface,
+	      guint64         *tile_hashes,
+	      guint64         *row_hashes)
 {
-  guint8 *data, *old_data;
-  guint32 *line, *old_line;
-  int w, h, stride, old_stride;
-  int x, y;
+  guint8 *data;
+  guint32 *line;
+  guint64 hash, *tile_row;
+  int w, h, stride, n_tiles_x, n_tiles_y;
+  int x, y, tx, x2;
 
   data = cairo_image_surface_get_data (surface);
-  old_data = cairo_image_surface_get_data (old_surface);
-
   w = cairo_image_surface_get_width (surface);
   h = cairo_image_surface_get_height (surface);
-
   stride = cairo_image_surface_get_stride (surface);
-  old_stride = cairo_image_surface_get_stride (old_surface);
+
+  n_tiles_x = N_TILES (w);
+  n_tiles_y = N_TILES (h);
+  for (x = 0; x < n_tiles_x * n_tiles_y; x++)
+    tile_hashes[x] = HASH_INIT;
 
   for (y = 0; y < h; y++)
     {
-      line = (guint32 *)data;
-      old_line = (guint32 *)old_data;
+      line = (guint32 *)(data + y * stride);
+      tile_row = tile_hashes + (y / TILE_SIZE) * n_tiles_x;
+      row_hashes[y] = HASH_INIT;
 
-      for (x = 0; x < w; x++)
+      for (tx = 0; tx < n_tiles_x; tx++)
 	{
-	  if ((*line & 0xffffff) == (*old_line & 0xffffff))
-	    *old_line = 0;
-	  else
-	    *old_line = *line | 0xff000000;
-	  line ++;
-	  old_line ++;
+	  hash = HASH_INIT;
+	  x2 = MIN ((tx + 1) * TILE_SIZE, w);
+	  for (x = tx * TILE_SIZE; x < x2; x++)
+	    hash = HASH_STEP (hash, line[x] & 0xffffff);
+
+	  tile_row[tx] = HASH_STEP (tile_row[tx], hash);
+	  row_hashes[y] = HASH_STEP (row_hashes[y], hash);
 	}
+    }
+}
+
+static gboolean
+lines_equal (guint32 *line,
+	     guint32 *other,
+	     int      width)
+{
+  int x;
 
-      data += stride;
-      old_data += old_stride;
+  for (x = 0; x < width; x++)
+    {
+      if ((line[x] ^ other[x]) & 0xffffff)
+	return FALSE;
     }
+
+  return TRUE;
+}
+
+static int
+find_scroll_offset (const guint64 *row_hashes,
+		    const guint64 *old_row_hashes,
+		    int            height)
+{
+  GHashTable *old_rows;
+  guint *votes;
+  int y, old_y, dy, best_dy, n_changed;
+  gpointer value;
+
+  n_changed = 0;
+  for (y = 0; y < height; y++)
+    {
+      if (row_hashes[y] != old_row_hashes[y])
+	n_changed++;
+    }
+  if (n_changed < MIN_SCROLL_ROWS)
+    return 0;
+
+  /* Rows that appear more than once, like empty lines, say nothing
+   * about where the contents went */
+  old_rows = g_hash_table_new (g_int64_hash, g_int64_equal);
+  for (y = 0; y < height; y++)
+    {
+      if (g_hash_table_lookup_extended (old_rows, &old_row_hashes[y], NULL, NULL))
+	g_hash_table_insert (old_rows, (gpointer) &old_row_hashes[y], GINT_TO_POINTER (-1));
+      else
+	g_hash_table_insert (old_rows, (gpointer) &old_row_hashes[y], GINT_TO_POINTER (y));
+    }
+
+  votes = g_new0 (guint, 2 * height);
+  for (y = 0; y < height; y++)
+    {
+      if (row_hashes[y] == old_row_hashes[y] ||
+	  !g_hash_table_lookup_extended (old_rows, &row_hashes[y], NULL, &value))
+	continue;
+
+      old_y = GPOINTER_TO_INT (value);
+      if (old_y >= 0)
+	votes[y - old_y + height]++;
+    }
+
+  best_dy = 0;
+  for (dy = 1 - height; dy < height; dy++)
+    {
+      if (votes[dy + height] > votes[best_dy + height])
+	best_dy = dy;
+    }
+  if (votes[best_dy + height] < MIN_SCROLL_ROWS)
+    best_dy = 0;
+
+  g_free (votes);
+  g_hash_table_destroy (old_rows);
+
+  return best_dy;
+}
+
+/* Finds contents that moved up or down since the last update, and
+ * lets the client copy them instead of getting them sent again. */
+static void
+send_scroll (BroadwayServer  *server,
+	     BroadwayWindow  *window,
+	     cairo_surface_t *surface,
+	     const guint64   *row_hashes)
+{
+  cairo_region_t *area;
+  cairo_rectangle_int_t rect;
+  BroadwayRect *rects;
+  guint8 *data, *old_data;
+  int stride, old_stride;
+  int dy, y, y1, y2, i, n_rects;
+
+  dy = find_scroll_offset (row_hashes, window->row_hashes, window->height);
+  if (dy == 0)
+    return;
+
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  old_data = cairo_image_surface_get_data (window->last_surface);
+  old_stride = cairo_image_surface_get_stride (window->last_surface);
+
+  area = cairo_region_create ();
+  y1 = MAX (0, dy);
+  y2 = MIN (window->height, window->height + dy);
+  for (y = y1; y < y2; y = rect.y + rect.height + 1)
+    {
+      rect.x = 0;
+      rect.y = y;
+      rect.width = window->width;
+      rect.height = 0;
+      while (y + rect.height < y2 &&
+	     row_hashes[y + rect.height] == window->row_hashes[y + rect.height - dy] &&
+	     lines_equal ((guint32 *)(data + (y + rect.height) * stride),
+			  (guint32 *)(old_data + (y + rect.height - dy) * old_stride),
+			  window->width))
+	rect.height++;
+
+      if (rect.height >= MIN_SCROLL_ROWS)
+	cairo_region_union_rectangle (area, &rect);
+    }
+
+  n_rects = cairo_region_num_rectangles (area);
+  if (n_rects > 0)
+    {
+      copy_region (window->last_surface, area, 0, dy);
+
+      rects = g_new (BroadwayRect, n_rects);
+      for (i = 0; i < n_rects; i++)
+	{
+	  cairo_region_get_rectangle (area, i, &rect);
+	  rects[i].x = rect.x;
+	  rects[i].y = rect.y;
+	  rects[i].width = rect.width;
+	  rects[i].height = rect.height;
+	  invalidate_hashes (window, &rect);
+	}
+      broadway_output_copy_rectangles (server->output,
+				       window->id,
+				       rects, n_rects, 0, dy);
+      g_free (rects);
+    }
+
+  cairo_region_destroy (area);
 }
 
 void
@@ -1727,6 +1979,7 @@ broadway_server_window_update (BroadwayServer *server,
 {
   cairo_t *cr;
   BroadwayWindow *window;
+  guint64 *tile_hashes, *row_hashes;
 
   if (surface == NULL)
     return;
@@ -1746,17 +1999,47 @@ broadway_server_window_update (BroadwayServer *server,
   g_assert (window->height == cairo_image_surface_get_height (window->last_surface));
   g_assert (window->height == cairo_image_surface_get_height (surface));
 
+  tile_hashes = NULL;
+  row_hashes = NULL;
+  if (server->output != NULL || server->viewers != NULL)
+    {
+      tile_hashes = g_new (guint64, N_TILES (window->width) * N_TILES (window->height));
+      row_hashes = g_new (guint64, window->height);
+      hash_surface (surface, tile_hashes, row_hashes);
+    }
+
   if (server->output != NULL)
     {
       if (window->last_synced)
 	{
-	  diff_surfaces (surface,
-			 window->last_surface);
-	  broadway_output_put_rgba (server->output, window->id, 0, 0,
-				    cairo_image_surface_get_width (window->last_surface),
-				    cairo_image_surface_get_height (window->last_surface),
-				    cairo_image_surface_get_stride (window->last_surface),
-				    cairo_image_surface_get_data (window->last_surface));
+	  guint8 *data, *old_data;
+	  int stride, old_stride;
+	  int x, y, i;
+
+	  if (window->row_hashes != NULL)
+	    send_scroll (server, window, surface, row_hashes);
+
+	  data = cairo_image_surface_get_data (surface);
+	  stride = cairo_image_surface_get_stride (surface);
+	  old_data = cairo_image_surface_get_data (window->last_surface);
+	  old_stride = cairo_image_surface_get_stride (window->last_surface);
+
+	  /* Only send the tiles that changed */
+	  for (y = 0, i = 0; y < window->height; y += TILE_SIZE)
+	    {
+	      for (x = 0; x < window->width; x += TILE_SIZE, i++)
+		{
+		  if (window->tile_hashes != NULL &&
+		      window->tile_hashes[i] == tile_hashes[i])
+		    continue;
+
+		  broadway_output_put_buffer (server->output, window->id, x, y,
+					      MIN (TILE_SIZE, window->width - x),
+					      MIN (TILE_SIZE, window->height - y),
+					      stride, data + y * stride + x * 4,
+					      old_stride, old_data + y * old_stride + x * 4);
+		}
+	    }
 	}
       else
 	{
@@ -1771,6 +2054,11 @@ broadway_server_window_update (BroadwayServer *server,
       broadway_output_surface_flush (server->output, window->id);
     }
 
+  g_free (window->tile_hashes);
+  g_free (window->row_hashes);
+  window->tile_hashes = tile_hashes;
+  window->row_hashes = row_hashes;
+
   cr = cairo_create (window->last_surface);
   cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
   cairo_set_source_surface (cr, surface, 0, 0);
@@ -1778,6 +2066,210 @@ broadway_server_window_update (BroadwayServer *server,
   cairo_destroy (cr);
 }
 
+/* Viewers get at most this many frames per second */
+#define VIEWER_FRAME_RATE 30
+
+static gboolean
+viewer_sync_cb (BroadwayInput *input)
+{
+  input->sync_source = 0;
+  viewer_sync (input);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+viewer_writable_cb (GObject       *stream,
+		    BroadwayInput *input)
+{
+  return viewer_sync_cb (input);
+}
+
+static void
+viewer_sync_window_contents (BroadwayInput        *input,
+			     BroadwayWindow       *window,
+			     BroadwayViewerWindow *viewer_window)
+{
+  guint8 *data;
+  int stride, n_tiles, x, y, i;
+
+  if (window->tile_hashes == NULL)
+    {
+      window->tile_hashes = g_new (guint64, N_TILES (window->width) * N_TILES (window->height));
+      window->row_hashes = g_new (guint64, window->height);
+      hash_surface (window->last_surface, window->tile_hashes, window->row_hashes);
+    }
+
+  data = cairo_image_surface_get_data (window->last_surface);
+  stride = cairo_image_surface_get_stride (window->last_surface);
+
+  /* The viewer has no copy of the old contents to diff against, so
+   * changed tiles are sent whole. Zero hashes mean unknown. */
+  for (y = 0, i = 0; y < window->height; y += TILE_SIZE)
+    {
+      for (x = 0; x < window->width; x += TILE_SIZE, i++)
+	{
+	  if (viewer_window->tile_hashes != NULL &&
+	      viewer_window->tile_hashes[i] == window->tile_hashes[i] &&
+	      window->tile_hashes[i] != 0)
+	    continue;
+
+	  broadway_output_put_buffer (input->output, window->id, x, y,
+				      MIN (TILE_SIZE, window->width - x),
+				      MIN (TILE_SIZE, window->height - y),
+				      stride, data + y * stride + x * 4,
+				      0, NULL);
+	}
+    }
+
+  n_tiles = N_TILES (window->width) * N_TILES (window->height);
+  g_free (viewer_window->tile_hashes);
+  viewer_window->tile_hashes = g_memdup (window->tile_hashes, n_tiles * sizeof (guint64));
+
+  broadway_output_surface_flush (input->output, window->id);
+}
+
+/* Brings a viewer up to date with the current state of all windows.
+ * Rather than getting every update, viewers are synced when they
+ * have taken everything sent to them before, and not more often than
+ * VIEWER_FRAME_RATE, so a slow viewer skips frames instead of making
+ * the session wait for it. */
+static void
+viewer_sync (BroadwayInput *input)
+{
+  BroadwayServer *server = input->server;
+  BroadwayViewerWindow *viewer_window;
+  GHashTableIter iter;
+  gpointer key, value;
+  gboolean blocked;
+  gint64 now;
+  GList *l;
+
+  if (input->sync_source != 0)
+    return;
+
+  /* Writing what is pending may find out the viewer is gone */
+  blocked = broadway_output_is_blocked (input->output);
+  if (broadway_output_has_error (input->output))
+    {
+      broadway_input_free (input);
+      return;
+    }
+
+  if (blocked)
+    {
+      GOutputStream *out;
+      GSource *source;
+
+      out = g_io_stream_get_output_stream (G_IO_STREAM (input->connection));
+      source = g_pollable_output_stream_create_source (G_POLLABLE_OUTPUT_STREAM (out), NULL);
+      g_source_set_callback (source, (GSourceFunc)viewer_writable_cb, input, NULL);
+      input->sync_source = g_source_attach (source, NULL);
+      g_source_unref (source);
+      return;
+    }
+
+  now = g_get_monotonic_time ();
+  if (now - input->last_sync_time < G_USEC_PER_SEC / VIEWER_FRAME_RATE)
+    {
+      input->sync_source =
+	g_timeout_add ((G_USEC_PER_SEC / VIEWER_FRAME_RATE - (now - input->last_sync_time)) / 1000 + 1,
+		       (GSourceFunc)viewer_sync_cb, input);
+      return;
+    }
+  input->last_sync_time = now;
+
+  g_hash_table_iter_init (&iter, input->viewer_windows);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      if (g_hash_table_lookup (server->id_ht, key) == NULL)
+	{
+	  broadway_output_destroy_surface (input->output, GPOINTER_TO_INT (key));
+	  g_hash_table_iter_remove (&iter);
+	}
+    }
+
+  /* First create all windows, like broadway_server_resync_windows() */
+  for (l = server->toplevels; l != NULL; l = l->next)
+    {
+      BroadwayWindow *window = l->data;
+
+      if (window->id == 0)
+	continue; /* Skip root */
+
+      viewer_window = g_hash_table_lookup (input->viewer_windows,
+					   GINT_TO_POINTER (window->id));
+      if (viewer_window == NULL)
+	{
+	  viewer_window = g_new0 (BroadwayViewerWindow, 1);
+	  viewer_window->transient_for = -1;
+	  g_hash_table_insert (input->viewer_windows,
+			       GINT_TO_POINTER (window->id), viewer_window);
+	  broadway_output_new_surface (input->output,
+				       window->id,
+				       window->x,
+				       window->y,
+				       window->width,
+				       window->height,
+				       window->is_temp);
+	}
+      else
+	{
+	  gboolean with_move, with_resize;
+
+	  with_move = viewer_window->x != window->x || viewer_window->y != window->y;
+	  with_resize = viewer_window->width != window->width || viewer_window->height != window->height;
+	  broadway_output_move_resize_surface (input->output,
+					       window->id,
+					       with_move, window->x, window->y,
+					       with_resize, window->width, window->height);
+	  if (with_resize)
+	    {
+	      g_free (viewer_window->tile_hashes);
+	      viewer_window->tile_hashes = NULL;
+	    }
+	}
+
+      viewer_window->x = window->x;
+      viewer_window->y = window->y;
+      viewer_window->width = window->width;
+      viewer_window->height = window->height;
+    }
+
+  /* Then do everything that may reference other windows */
+  for (l = server->toplevels; l != NULL; l = l->next)
+    {
+      BroadwayWindow *window = l->data;
+
+      if (window->id == 0)
+	continue; /* Skip root */
+
+      viewer_window = g_hash_table_lookup (input->viewer_windows,
+					   GINT_TO_POINTER (window->id));
+
+      if (viewer_window->transient_for != window->transient_for)
+	{
+	  broadway_output_set_transient_for (input->output, window->id, window->transient_for);
+	  viewer_window->transient_for = window->transient_for;
+	}
+
+      if (viewer_window->visible != window->visible)
+	{
+	  if (window->visible)
+	    broadway_output_show_surface (input->output, window->id);
+	  else
+	    broadway_output_hide_surface (input->output, window->id);
+	  viewer_window->visible = window->visible;
+	}
+
+      if (window->visible && window->last_surface != NULL)
+	viewer_sync_window_contents (input, window, viewer_window);
+    }
+
+  if (!broadway_output_flush (input->output))
+    broadway_input_free (input);
+}
+
 gboolean
 broadway_server_window_move_resize (BroadwayServer *server,
 				    gint id,
@@ -1801,6 +2293,9 @@ broadway_server_window_move_resize (BroadwayServer *server,
   window->width = width;
   window->height = height;
 
+  if (with_resize)
+    invalidate_hashes (window, NULL);
+
   if (with_resize && window->last_surface != NULL)
     {
       cairo_surface_t *old;
@@ -168,6 +168,7 @@ var surfaces = {};
 var stackingOrder = [];
 var outstandingCommands = new Array();
 var inputSocket = null;
+var viewOnly = false;
 
 var GDK_CROSSING_NORMAL = 0;
 var GDK_CROSSING_GRAB = 1;
@@ -206,10 +207,45 @@ function getButtonMask (button) {
     return 0;
 }
 
+function putBuffer(context, cmd)
+{
+    var imageData = context.getImageData(cmd.x, cmd.y, cmd.w, cmd.h);
+    var pixels = imageData.data;
+    var data = cmd.data;
+    var end = cmd.w * cmd.h * 4;
+    var i = 0, o = 0, n, r, g, b;
+
+    while (i < data.length && o < end) {
+	var op = data[i++];
+	if (op < 0x80) { // skip unchanged pixels
+	    o += (op + 1) * 4;
+	} else if (op < 0xc0) { // literal pixels
+	    for (n = op - 0x7f; n > 0; n--) {
+		pixels[o++] = data[i++];
+		pixels[o++] = data[i++];
+		pixels[o++] = data[i++];
+		pixels[o++] = 255;
+	    }
+	} else { // repeated pixel
+	    r = data[i++];
+	    g = data[i++];
+	    b = data[i++];
+	    for (n = op - 0xbf; n > 0; n--) {
+		pixels[o++] = r;
+		pixels[o++] = g;
+		pixels[o++] = b;
+		pixels[o++] = 255;
+	    }
+	}
+    }
+
+    context.putImageData(imageData, cmd.x, cmd.y);
+}
+
 function flushSurface(surface)
 {
     var commands = surface.drawQueue;
-    surface.queue = [];
+    surface.drawQueue = [];
     var context = surface.canvas.getContext("2d");
     context.globalCompositeOperation = "source-over";
     var i = 0;
@@ -221,6 +257,10 @@ function flushSurface(surface)
 	    context.drawImage(cmd.img, cmd.x, cmd.y);
 	    break;
 
+	case 'B': // put buffer
+	    putBuffer(context, cmd);
+	    break;
+
 	case 'b': // copy rects
 	    context.save();
 	    context.beginPath();
@@ -598,6 +638,18 @@ function handleCommands(cmd)
 	    cmd.free_image_url (url);
 	    break;
 
+	case 'B': // Put changed pixels
+	    q = new Object();
+	    q.op = 'B';
+	    q.id = cmd.get_16();
+	    q.x = cmd.get_16();
+	    q.y = cmd.get_16();
+	    q.w = cmd.get_16();
+	    q.h = cmd.get_16();
+	    q.data = cmd.get_data();
+	    surfaces[q.id].drawQueue.push(q);
+	    break;
+
 	case 'b': // Copy rects
 	    q = new Object();
 	    q.op = 'b';
@@ -742,6 +794,12 @@ BinCommands.prototype.get_image_url = function() {
     this.pos = this.pos + size;
     return url;
 };
+BinCommands.prototype.get_data = function() {
+    var size = this.get_32();
+    var data = new Uint8Array (this.arraybuffer, this.pos, size);
+    this.pos = this.pos + size;
+    return data;
+};
 BinCommands.prototype.free_image_url = function(url) {
     URL.revokeObjectURL(url);
 };
@@ -768,7 +826,7 @@ function getSurfaceId(ev) {
 
 function sendInput(cmd, args)
 {
-    if (inputSocket != null) {
+    if (inputSocket != null && !viewOnly) {
 	inputSocket.send(cmd + ([lastSerial, lastTimeStamp].concat(args)).join(","));
     }
 }
@@ -2673,17 +2731,20 @@ function connect()
     var query_string = url.split("?");
     if (query_string.length > 1) {
 	var params = query_string[1].split("&");
+	// Watch the session without taking it over
+	viewOnly = params.indexOf("view") >= 0;
     }
 
-    var loc = window.location.toString().replace("http:", "ws:").replace("https:", "wss:");
+    var loc = window.location.toString().split("?")[0].replace("http:", "ws:").replace("https:", "wss:");
     loc = loc.substr(0, loc.lastIndexOf('/')) + "/socket";
 
+    var query = viewOnly ? "?view" : "";
     var supports_binary = newWS (loc + "-test").binaryType == "blob";
     if (supports_binary) {
-	ws = newWS (loc + "-bin");
+	ws = newWS (loc + "-bin" + query);
 	ws.binaryType = "arraybuffer";
     } else {
-	ws = newWS (loc);
+	ws = newWS (loc + query);
     }
 
     ws.onopen = function() {
@@ -127,6 +127,12 @@ static GMutex gdk_threads_mutex;
 static GCallback gdk_threads_lock = NULL;
 static GCallback gdk_threads_unlock = NULL;
 
+static const GDebugKey gdk_paint_stats_keys[] = {
+  {"record",        GDK_PAINT_STATS_RECORD},
+  {"print",         GDK_PAINT_STATS_PRINT},
+  {"heatmap",       GDK_PAINT_STATS_HEATMAP}
+};
+
 #ifdef G_ENABLE_DEBUG
 static const GDebugKey gdk_debug_keys[] = {
   {"events",        GDK_DEBUG_EVENTS},
@@ -239,6 +245,7 @@ void
 gdk_pre_parse_libgtk_only (void)
 {
   const char *rendering_mode;
+  const char *paint_stats;
 
   gdk_initialized = TRUE;
 
@@ -276,6 +283,13 @@ gdk_pre_parse_libgtk_only (void)
       else if (g_str_equal (rendering_mode, "recording"))
         _gdk_rendering_mode = GDK_RENDERING_MODE_RECORDING;
     }
+
+  /* Not tied to G_ENABLE_DEBUG, it is meant for profiling release builds */
+  paint_stats = g_getenv ("GDK_PAINT_STATS");
+  if (paint_stats)
+    _gdk_paint_stats_flags = g_parse_debug_string (paint_stats,
+                                                   (GDebugKey *) gdk_paint_stats_keys,
+                                                   G_N_ELEMENTS (gdk_paint_stats_keys));
 }
 
   
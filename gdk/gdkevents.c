@@ -262,6 +262,49 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+/* Enough for a second of a 1000 Hz tablet. Histories can grow to
+ * twice that before the oldest events are dropped, so that appending
+ * a motion doesn't move the whole history every time; only the most
+ * recent MAX_MOTION_HISTORY events are visible. */
+#define MAX_MOTION_HISTORY 1024
+
+static guint
+motion_history_first (GPtrArray *history)
+{
+  return history->len > MAX_MOTION_HISTORY ? history->len - MAX_MOTION_HISTORY : 0;
+}
+
+/* Moves the history of @event to the end of @history, which
+ * becomes the history of @event if it is %NULL */
+static GPtrArray *
+gdk_event_take_motion_history (GPtrArray       *history,
+                               GdkEventPrivate *event)
+{
+  GPtrArray *taken;
+  guint first, i;
+
+  taken = event->motion_history;
+  event->motion_history = NULL;
+
+  if (taken == NULL)
+    return history;
+
+  if (history == NULL)
+    return taken;
+
+  first = motion_history_first (taken);
+  for (i = first; i < taken->len; i++)
+    g_ptr_array_add (history, g_ptr_array_index (taken, i));
+
+  /* only free the events that were dropped already */
+  g_ptr_array_set_free_func (taken, NULL);
+  g_ptr_array_remove_range (taken, first, taken->len - first);
+  g_ptr_array_set_free_func (taken, (GDestroyNotify) gdk_event_free);
+  g_ptr_array_unref (taken);
+
+  return history;
+}
+
 void
 _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
 {
@@ -269,9 +312,12 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   GList *pending_motions = NULL;
   GdkWindow *pending_motion_window = NULL;
   GdkDevice *pending_motion_device = NULL;
+  GdkEventPrivate *last_motion;
+  GPtrArray *history;
 
   /* If the last N events in the event queue are motion notify
-   * events for the same window, drop all but the last */
+   * events for the same window, only the last one is delivered;
+   * the others become its motion history */
 
   tmp_list = display->queued_tail;
 
@@ -300,12 +346,34 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
       tmp_list = tmp_list->prev;
     }
 
-  while (pending_motions && pending_motions->next != NULL)
+  if (pending_motions && pending_motions->next != NULL)
     {
-      GList *next = pending_motions->next;
-      display->queued_events = g_list_delete_link (display->queued_events,
-                                                   pending_motions);
-      pending_motions = next;
+      last_motion = display->queued_tail->data;
+
+      /* Usually only the newest motion was added since the last
+       * time, so this appends to the history of the one before */
+      history = NULL;
+      while (pending_motions->next != NULL)
+        {
+          GList *next = pending_motions->next;
+          GdkEventPrivate *event = pending_motions->data;
+
+          history = gdk_event_take_motion_history (history, event);
+          if (history == NULL)
+            history = g_ptr_array_new_with_free_func ((GDestroyNotify) gdk_event_free);
+          g_ptr_array_add (history, event);
+
+          display->queued_events = g_list_delete_link (display->queued_events,
+                                                       pending_motions);
+          pending_motions = next;
+        }
+
+      history = gdk_event_take_motion_history (history, last_motion);
+
+      if (history->len > 2 * MAX_MOTION_HISTORY)
+        g_ptr_array_remove_range (history, 0, history->len - MAX_MOTION_HISTORY);
+
+      last_motion->motion_history = history;
     }
 
   if (pending_motions &&
@@ -622,6 +690,20 @@ gdk_event_copy (const GdkEvent *event)
       new_private->screen = private->screen;
       new_private->device = private->device;
       new_private->source_device = private->source_device;
+
+      if (private->motion_history)
+        {
+          guint i;
+
+          i = motion_history_first (private->motion_history);
+          new_private->motion_history =
+            g_ptr_array_new_full (private->motion_history->len - i,
+                                  (GDestroyNotify) gdk_event_free);
+
+          for (; i < private->motion_history->len; i++)
+            g_ptr_array_add (new_private->motion_history,
+                             gdk_event_copy (g_ptr_array_index (private->motion_history, i)));
+        }
     }
 
   switch (event->any.type)
@@ -768,6 +850,8 @@ gdk_event_free (GdkEvent *event)
       
     case GDK_MOTION_NOTIFY:
       g_free (event->motion.axes);
+      if (((GdkEventPrivate *) event)->motion_history)
+        g_ptr_array_unref (((GdkEventPrivate *) event)->motion_history);
       break;
       
     case GDK_SETTING:
@@ -1345,6 +1429,48 @@ gdk_event_get_scroll_deltas (const GdkEvent *event,
   return fetched;
 }
 
+/**
+ * gdk_event_get_motion_history:
+ * @event: a #GdkEvent
+ *
+ * Retrieves the motion events that were coalesced into @event.
+ *
+ * When motion events for the same window and device pile up in the
+ * event queue faster than they are handled, only the last one is
+ * delivered. The others are kept with it, so that applications
+ * that need every sample, like drawing programs, can get them
+ * without giving up on motion compression.
+ *
+ * Returns: (transfer container) (element-type GdkEvent): the coalesced
+ *   motion events, oldest first, or %NULL. The events are owned by
+ *   @event; free the list with g_list_free().
+ *
+ * Since: 3.10
+ **/
+GList *
+gdk_event_get_motion_history (const GdkEvent *event)
+{
+  GdkEventPrivate *private;
+  GList *history;
+  guint i;
+
+  g_return_val_if_fail (event != NULL, NULL);
+
+  if (event->type != GDK_MOTION_NOTIFY ||
+      !gdk_event_is_allocated (event))
+    return NULL;
+
+  private = (GdkEventPrivate *) event;
+  if (private->motion_history == NULL)
+    return NULL;
+
+  history = NULL;
+  for (i = private->motion_history->len; i > motion_history_first (private->motion_history); i--)
+    history = g_list_prepend (history, g_ptr_array_index (private->motion_history, i - 1));
+
+  return history;
+}
+
 /**
  * gdk_event_get_axis:
  * @event: a #GdkEvent
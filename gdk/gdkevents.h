@@ -1249,6 +1249,8 @@ GDK_AVAILABLE_IN_ALL
 gboolean  gdk_event_get_axis            (const GdkEvent  *event,
                                          GdkAxisUse       axis_use,
                                          gdouble         *value);
+GDK_AVAILABLE_IN_3_10
+GList *   gdk_event_get_motion_history  (const GdkEvent  *event);
 GDK_AVAILABLE_IN_ALL
 void       gdk_event_set_device         (GdkEvent        *event,
                                          GdkDevice       *device);
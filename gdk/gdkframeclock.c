@@ -520,6 +520,10 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
     g_print (" predicted=%-4.1f", (timings->predicted_presentation_time - timings->frame_time) / 1000.);
   if (timings->refresh_interval != 0)
     g_print (" refresh_interval=%-4.1f", timings->refresh_interval / 1000.);
+  if (timings->n_paints != 0)
+    g_print (" paints=%u invalidated=%" G_GINT64_FORMAT " painted=%" G_GINT64_FORMAT " paint_time=%-4.1f",
+             timings->n_paints, timings->invalidated_area, timings->painted_area,
+             timings->paint_time / 1000.);
   g_print ("\n");
 }
 #endif /* G_ENABLE_DEBUG */
@@ -77,6 +77,12 @@ struct _GdkFrameTimings
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
 
+  /* Only filled in when GDK_PAINT_STATS is set */
+  gint64 invalidated_area;
+  gint64 painted_area;
+  gint64 paint_time;
+  guint n_paints;
+
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
   gint64 paint_start_time;
@@ -217,3 +217,93 @@ gdk_frame_timings_get_refresh_interval (GdkFrameTimings *timings)
 
   return timings->refresh_interval;
 }
+
+/**
+ * gdk_frame_timings_get_invalidated_area:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets the number of pixels that were invalidated in the windows
+ * drawn in this frame, counting every invalidation separately.
+ *
+ * This is only recorded when the GDK_PAINT_STATS environment
+ * variable is set.
+ *
+ * Returns: the invalidated area, in pixels, or 0 if paint
+ *  statistics are not being recorded.
+ * Since: 3.10
+ */
+gint64
+gdk_frame_timings_get_invalidated_area (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->invalidated_area;
+}
+
+/**
+ * gdk_frame_timings_get_painted_area:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets the number of pixels that were handed to expose handlers
+ * in this frame. A pixel that is exposed in several windows is
+ * counted once per window, so comparing this to the size of the
+ * toplevel gives an estimate of the overdraw.
+ *
+ * This is only recorded when the GDK_PAINT_STATS environment
+ * variable is set.
+ *
+ * Returns: the painted area, in pixels, or 0 if paint
+ *  statistics are not being recorded.
+ * Since: 3.10
+ */
+gint64
+gdk_frame_timings_get_painted_area (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->painted_area;
+}
+
+/**
+ * gdk_frame_timings_get_n_paints:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets the number of times gdk_window_begin_paint_region() was
+ * called while drawing this frame.
+ *
+ * This is only recorded when the GDK_PAINT_STATS environment
+ * variable is set.
+ *
+ * Returns: the number of paints, or 0 if paint statistics
+ *  are not being recorded.
+ * Since: 3.10
+ */
+guint
+gdk_frame_timings_get_n_paints (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->n_paints;
+}
+
+/**
+ * gdk_frame_timings_get_paint_time:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets the time that was spent in expose handlers while
+ * drawing this frame.
+ *
+ * This is only recorded when the GDK_PAINT_STATS environment
+ * variable is set.
+ *
+ * Returns: the paint time, in microseconds, or 0 if paint
+ *  statistics are not being recorded.
+ * Since: 3.10
+ */
+gint64
+gdk_frame_timings_get_paint_time (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->paint_time;
+}
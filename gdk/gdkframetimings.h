@@ -51,6 +51,15 @@ gint64           gdk_frame_timings_get_refresh_interval  (GdkFrameTimings *timin
 GDK_AVAILABLE_IN_3_8
 gint64           gdk_frame_timings_get_predicted_presentation_time (GdkFrameTimings *timings);
 
+GDK_AVAILABLE_IN_3_10
+gint64           gdk_frame_timings_get_invalidated_area  (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_3_10
+gint64           gdk_frame_timings_get_painted_area      (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_3_10
+guint            gdk_frame_timings_get_n_paints          (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_3_10
+gint64           gdk_frame_timings_get_paint_time        (GdkFrameTimings *timings);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_TIMINGS_H__ */
@@ -93,11 +93,18 @@ typedef enum {
   GDK_RENDERING_MODE_RECORDING
 } GdkRenderingMode;
 
+typedef enum {
+  GDK_PAINT_STATS_RECORD  = 1 << 0,
+  GDK_PAINT_STATS_PRINT   = 1 << 1,
+  GDK_PAINT_STATS_HEATMAP = 1 << 2
+} GdkPaintStatsFlags;
+
 extern GList            *_gdk_default_filters;
 extern GdkWindow        *_gdk_parent_root;
 
 extern guint _gdk_debug_flags;
 extern GdkRenderingMode    _gdk_rendering_mode;
+extern guint               _gdk_paint_stats_flags;
 
 #ifdef G_ENABLE_DEBUG
 
@@ -167,9 +174,26 @@ struct _GdkEventPrivate
   gpointer   windowing_data;
   GdkDevice *device;
   GdkDevice *source_device;
+
+  /* motion events that were coalesced into this one, oldest first */
+  GPtrArray *motion_history;
 };
 
 typedef struct _GdkWindowPaint GdkWindowPaint;
+typedef struct _GdkWindowPaintStats GdkWindowPaintStats;
+
+/* Accumulated between two frames of the window's frame clock */
+struct _GdkWindowPaintStats
+{
+  gint64 invalidated_area;
+  gint64 painted_area;
+  gint64 paint_time;
+  guint n_paints;
+
+  /* Only on impl windows, in impl window coordinates. One
+   * region per expose, so overlapping regions are overdraw. */
+  GPtrArray *exposed_regions;
+};
 
 struct _GdkWindow
 {
@@ -269,6 +293,8 @@ struct _GdkWindow
 
   GdkFrameClock *frame_clock; /* NULL to use from parent or default */
   GdkWindowInvalidateHandlerFunc invalidate_handler;
+
+  GdkWindowPaintStats *paint_stats; /* NULL unless GDK_PAINT_STATS is set */
 };
 
 #define GDK_WINDOW_TYPE(d) ((((GdkWindow *)(d)))->window_type)
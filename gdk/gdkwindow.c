@@ -195,6 +195,8 @@ static cairo_surface_t *gdk_window_ref_impl_surface (GdkWindow *window);
 
 static void gdk_window_set_frame_clock (GdkWindow      *window,
                                         GdkFrameClock  *clock);
+static GdkWindowPaintStats *gdk_window_get_paint_stats (GdkWindow *window);
+static void gdk_window_paint_stats_free (GdkWindowPaintStats *stats);
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
@@ -516,6 +518,9 @@ gdk_window_finalize (GObject *object)
   if (window->devices_inside)
     g_list_free (window->devices_inside);
 
+  if (window->paint_stats)
+    gdk_window_paint_stats_free (window->paint_stats);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -2772,6 +2777,9 @@ gdk_window_begin_paint_region (GdkWindow       *window,
   if (impl_class->begin_paint_region)
     needs_surface = impl_class->begin_paint_region (window, region);
 
+  if (G_UNLIKELY (_gdk_paint_stats_flags))
+    gdk_window_get_paint_stats (window)->n_paints++;
+
   paint = g_new0 (GdkWindowPaint, 1);
   paint->region = cairo_region_copy (region);
 
@@ -3203,6 +3211,152 @@ gdk_cairo_create (GdkWindow *window)
 static GSList *update_windows = NULL;
 static gboolean debug_updates = FALSE;
 
+/* Paint statistics, enabled with GDK_PAINT_STATS
+ */
+static GdkWindowPaintStats *
+gdk_window_get_paint_stats (GdkWindow *window)
+{
+  if (G_LIKELY (_gdk_paint_stats_flags == 0))
+    return NULL;
+
+  if (window->paint_stats == NULL)
+    window->paint_stats = g_slice_new0 (GdkWindowPaintStats);
+
+  return window->paint_stats;
+}
+
+static void
+gdk_window_paint_stats_free (GdkWindowPaintStats *stats)
+{
+  if (stats->exposed_regions)
+    g_ptr_array_unref (stats->exposed_regions);
+
+  g_slice_free (GdkWindowPaintStats, stats);
+}
+
+static gint64
+region_area (const cairo_region_t *region)
+{
+  cairo_rectangle_int_t r;
+  gint64 area = 0;
+  int i, n;
+
+  n = cairo_region_num_rectangles (region);
+  for (i = 0; i < n; i++)
+    {
+      cairo_region_get_rectangle (region, i, &r);
+      area += (gint64) r.width * r.height;
+    }
+
+  return area;
+}
+
+static void
+gdk_window_record_expose (GdkWindow            *window,
+                          const cairo_region_t *region,
+                          gint64                paint_time)
+{
+  GdkWindowPaintStats *stats, *impl_stats;
+  cairo_region_t *exposed;
+
+  stats = gdk_window_get_paint_stats (window);
+  stats->painted_area += region_area (region);
+  stats->paint_time += paint_time;
+
+  if (_gdk_paint_stats_flags & GDK_PAINT_STATS_HEATMAP)
+    {
+      impl_stats = gdk_window_get_paint_stats (window->impl_window);
+      if (impl_stats->exposed_regions == NULL)
+        impl_stats->exposed_regions = g_ptr_array_new_with_free_func ((GDestroyNotify) cairo_region_destroy);
+
+      exposed = cairo_region_copy (region);
+      cairo_region_translate (exposed, window->abs_x, window->abs_y);
+      g_ptr_array_add (impl_stats->exposed_regions, exposed);
+    }
+}
+
+/* Paints every exposed region of this update translucently on top
+ * of the result, so areas that got drawn more than once show up
+ * in a more saturated red. The overlay is composited straight onto
+ * the impl surface: a paint of its own would clear the exposed area
+ * to the background and copy that over the contents. */
+static void
+gdk_window_draw_heatmap (GdkWindow *window)
+{
+  GdkWindowPaintStats *stats = window->paint_stats;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint i;
+
+  if (stats == NULL ||
+      stats->exposed_regions == NULL ||
+      stats->exposed_regions->len == 0)
+    return;
+
+  surface = gdk_window_ref_impl_surface (window);
+  cr = cairo_create (surface);
+
+  gdk_cairo_region (cr, window->clip_region);
+  cairo_clip (cr);
+  cairo_set_source_rgba (cr, 1, 0, 0, 0.2);
+
+  for (i = 0; i < stats->exposed_regions->len; i++)
+    {
+      gdk_cairo_region (cr, g_ptr_array_index (stats->exposed_regions, i));
+      cairo_fill (cr);
+    }
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+  cairo_surface_destroy (surface);
+
+  g_ptr_array_set_size (stats->exposed_regions, 0);
+}
+
+/* Adds the statistics of @window and its descendants on the same
+ * frame clock to @timings, and starts counting anew. */
+static void
+gdk_window_flush_paint_stats (GdkWindow       *window,
+                              GdkFrameTimings *timings,
+                              gint64           frame_counter)
+{
+  GdkWindowPaintStats *stats = window->paint_stats;
+  GList *l;
+
+  if (stats != NULL)
+    {
+      if (timings != NULL)
+        {
+          timings->invalidated_area += stats->invalidated_area;
+          timings->painted_area += stats->painted_area;
+          timings->paint_time += stats->paint_time;
+          timings->n_paints += stats->n_paints;
+        }
+
+      if ((_gdk_paint_stats_flags & GDK_PAINT_STATS_PRINT) &&
+          (stats->invalidated_area != 0 || stats->painted_area != 0))
+        g_print ("%5" G_GINT64_FORMAT ": window %p (%dx%d%s): paints=%u invalidated=%" G_GINT64_FORMAT
+                 " painted=%" G_GINT64_FORMAT " paint_time=%.1f\n",
+                 frame_counter, window, window->width, window->height,
+                 gdk_window_has_impl (window) ? ", native" : "",
+                 stats->n_paints, stats->invalidated_area, stats->painted_area,
+                 stats->paint_time / 1000.);
+
+      stats->invalidated_area = 0;
+      stats->painted_area = 0;
+      stats->paint_time = 0;
+      stats->n_paints = 0;
+    }
+
+  for (l = window->children; l != NULL; l = l->next)
+    {
+      GdkWindow *child = l->data;
+
+      if (child->frame_clock == NULL)
+        gdk_window_flush_paint_stats (child, timings, frame_counter);
+    }
+}
+
 static inline gboolean
 gdk_window_is_ancestor (GdkWindow *window,
 			GdkWindow *ancestor)
@@ -3371,6 +3525,7 @@ _gdk_window_process_updates_recurse_helper (GdkWindow *window,
       window->event_mask & GDK_EXPOSURE_MASK)
     {
       GdkEvent event;
+      gint64 start_time = 0;
 
       event.expose.type = GDK_EXPOSE;
       event.expose.window = g_object_ref (window);
@@ -3379,8 +3534,15 @@ _gdk_window_process_updates_recurse_helper (GdkWindow *window,
       event.expose.region = clipped_expose_region;
       cairo_region_get_extents (clipped_expose_region, &event.expose.area);
 
+      if (G_UNLIKELY (_gdk_paint_stats_flags))
+        start_time = g_get_monotonic_time ();
+
       _gdk_event_emit (&event);
 
+      if (G_UNLIKELY (_gdk_paint_stats_flags) && !window->destroyed)
+        gdk_window_record_expose (window, clipped_expose_region,
+                                  g_get_monotonic_time () - start_time);
+
       g_object_unref (window);
     }
 
@@ -3489,6 +3651,9 @@ gdk_window_process_updates_internal (GdkWindow *window)
 	  save_region = impl_class->queue_antiexpose (window, update_area);
           impl_class->process_updates_recurse (window, expose_region);
 	  cairo_region_destroy (expose_region);
+
+          if (_gdk_paint_stats_flags & GDK_PAINT_STATS_HEATMAP)
+            gdk_window_draw_heatmap (window);
 	}
       if (!save_region)
 	cairo_region_destroy (update_area);
@@ -3883,6 +4048,7 @@ gdk_window_invalidate_maybe_recurse_full (GdkWindow            *window,
 {
   cairo_region_t *visible_region;
   cairo_rectangle_int_t r;
+  GdkWindow *invalidated;
 
   g_return_if_fail (GDK_IS_WINDOW (window));
 
@@ -3905,6 +4071,8 @@ gdk_window_invalidate_maybe_recurse_full (GdkWindow            *window,
   if (debug_updates)
     draw_ugly_color (window, visible_region);
 
+  invalidated = window;
+
   while (window != NULL && 
 	 !cairo_region_is_empty (visible_region))
     {
@@ -3917,6 +4085,9 @@ gdk_window_invalidate_maybe_recurse_full (GdkWindow            *window,
 
       if (gdk_window_has_impl (window))
 	{
+          if (G_UNLIKELY (_gdk_paint_stats_flags))
+            gdk_window_get_paint_stats (invalidated)->invalidated_area += region_area (visible_region);
+
 	  impl_window_add_update_area (window, visible_region);
 	  break;
 	}
@@ -10667,6 +10838,17 @@ gdk_window_paint_on_clock (GdkFrameClock *clock,
   /* Update window and any children on the same clock.
    */
   gdk_window_process_updates_with_mode (window, PROCESS_UPDATES_WITH_SAME_CLOCK_CHILDREN);
+
+  if (G_UNLIKELY (_gdk_paint_stats_flags))
+    {
+      GdkFrameTimings *timings = NULL;
+
+      if (_gdk_paint_stats_flags & GDK_PAINT_STATS_RECORD)
+        timings = gdk_frame_clock_get_current_timings (clock);
+
+      gdk_window_flush_paint_stats (window, timings,
+                                    gdk_frame_clock_get_frame_counter (clock));
+    }
 }
 
 static void
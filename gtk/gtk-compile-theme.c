@@ -0,0 +1,156 @@
+/* GTK - The GIMP Toolkit
+ *
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+
+#include <locale.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <gtk.h>
+
+static gchar **args = NULL;
+static gboolean quiet = FALSE;
+
+static GOptionEntry entries[] = {
+  { "quiet", 'q', 0, G_OPTION_ARG_NONE, &quiet, N_("Don't print parsing errors"), NULL },
+  { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &args, NULL, N_("FILE…") },
+  { NULL }
+};
+
+static void
+parsing_error_cb (GtkCssProvider *provider,
+                  GtkCssSection  *section,
+                  const GError   *error,
+                  gpointer        unused)
+{
+  GFile *file;
+  char *path;
+
+  if (quiet)
+    return;
+
+  file = gtk_css_section_get_file (section);
+  path = file ? g_file_get_parse_name (file) : g_strdup ("<data>");
+
+  g_printerr ("%s:%u:%u: %s\n",
+              path,
+              gtk_css_section_get_start_line (section) + 1,
+              gtk_css_section_get_start_position (section),
+              error->message);
+
+  g_free (path);
+}
+
+static gboolean
+compile_theme (const char *filename)
+{
+  GtkCssProvider *provider;
+  GError *error = NULL;
+  char *cache_file;
+  gboolean result;
+
+  provider = gtk_css_provider_new ();
+  g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error_cb), NULL);
+
+  /* Errors don't stop loading, so the cache has the same contents
+   * GTK+ would get from loading the CSS. */
+  gtk_css_provider_load_from_path (provider, filename, NULL);
+
+  cache_file = g_strconcat (filename, ".cache", NULL);
+  result = gtk_css_provider_save_cache (provider, cache_file, &error);
+  if (!result)
+    {
+      /* Translators: the first %s is the program name, the second one
+       * is the name of the cache file that could not be written and the
+       * third one is the error message.
+       */
+      g_printerr (_("%s: failed to write %s: %s\n"),
+                  g_get_prgname (), cache_file, error->message);
+      g_error_free (error);
+    }
+
+  g_free (cache_file);
+  g_object_unref (provider);
+
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  gboolean success;
+  guint i;
+
+  setlocale (LC_ALL, "");
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, GTK_LOCALEDIR);
+  textdomain (GETTEXT_PACKAGE);
+#ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+#endif
+#endif
+
+  /* Translators: this is shown after "Usage: gtk-compile-theme [OPTION…]".
+   * FILE is a CSS file and must be translated the same way as in the
+   * other gtk-compile-theme messages.
+   */
+  context = g_option_context_new (_("FILE… — compile CSS themes for faster loading."));
+  /* Translators: this is shown after the usage line and before the list
+   * of options. FILE is the same placeholder as in the usage line.
+   */
+  g_option_context_set_summary (context,
+                                _("Writes FILE.cache for every CSS FILE. GTK+ loads it\n"
+                                  "instead of FILE as long as none of the loaded files changed."));
+  g_option_context_add_main_entries (context, entries, GETTEXT_PACKAGE);
+  g_option_context_parse (context, &argc, &argv, &error);
+  g_option_context_free (context);
+
+  if (error != NULL)
+    {
+      g_printerr (_("Error parsing commandline options: %s\n"), error->message);
+      g_printerr ("\n");
+      g_printerr (_("Try \"%s --help\" for more information."),
+                  g_get_prgname ());
+      g_printerr ("\n");
+      g_error_free (error);
+      return 1;
+    }
+
+  if (args == NULL)
+    {
+      /* Translators: the %s is the program name. This is shown when
+       * gtk-compile-theme is run without any CSS file to compile.
+       */
+      g_printerr (_("%s: missing file name"), g_get_prgname ());
+      g_printerr ("\n");
+      g_printerr (_("Try \"%s --help\" for more information."),
+                  g_get_prgname ());
+      g_printerr ("\n");
+      return 1;
+    }
+
+  success = TRUE;
+  for (i = 0; args[i]; i++)
+    success &= compile_theme (args[i]);
+
+  return success ? 0 : 1;
+}
@@ -1099,6 +1099,8 @@ gtk_box_get_size (GtkWidget      *widget,
 
   nvis_children = 0;
 
+  _gtk_widget_prefetch_child_sizes (widget, orientation);
+
   for (children = private->children; children; children = children->next)
     {
       GtkBoxChild *child = children->data;
@@ -492,8 +492,11 @@ gtk_builder_get_parameters (GtkBuilder  *builder,
       PropertyInfo *prop = (PropertyInfo*)l->data;
       GParameter parameter = { NULL };
 
-      pspec = g_object_class_find_property (G_OBJECT_CLASS (oclass),
-                                            prop->name);
+      if (prop->pspec)
+        pspec = prop->pspec;
+      else
+        pspec = g_object_class_find_property (G_OBJECT_CLASS (oclass),
+                                              prop->name);
       if (!pspec)
         {
           g_warning ("Unknown property: %s.%s",
@@ -532,6 +535,11 @@ gtk_builder_get_parameters (GtkBuilder  *builder,
               continue;
             }
         }
+      else if (prop->value)
+        {
+          g_value_init (&parameter.value, G_VALUE_TYPE (prop->value));
+          g_value_copy (prop->value, &parameter.value);
+        }
       else if (!gtk_builder_value_from_string (builder, pspec,
 					       prop->data, &parameter.value, &error))
         {
@@ -629,7 +637,10 @@ _gtk_builder_construct (GtkBuilder *builder,
   GParamFlags param_filter_flags;
 
   g_assert (info->class_name != NULL);
-  object_type = gtk_builder_get_type_from_name (builder, info->class_name);
+  if (info->type != G_TYPE_INVALID)
+    object_type = info->type;
+  else
+    object_type = gtk_builder_get_type_from_name (builder, info->class_name);
   if (object_type == G_TYPE_INVALID)
     {
       g_set_error (error,
@@ -797,7 +808,10 @@ _gtk_builder_apply_properties (GtkBuilder *builder,
 
   g_assert (info->object != NULL);
   g_assert (info->class_name != NULL);
-  object_type = gtk_builder_get_type_from_name (builder, info->class_name);
+  if (info->type != G_TYPE_INVALID)
+    object_type = info->type;
+  else
+    object_type = gtk_builder_get_type_from_name (builder, info->class_name);
 
   /* Fetch all properties that are not construct-only */
   gtk_builder_get_parameters (builder, object_type,
@@ -1109,15 +1123,14 @@ gtk_builder_add_objects_from_file (GtkBuilder   *builder,
 }
 
 /* Main private entry point for building composite container
- * components from template XML
+ * components from a template compiled with _gtk_builder_template_compile()
  */
 guint
-_gtk_builder_extend_with_template (GtkBuilder    *builder,
-				   GtkWidget     *widget,
-				   GType          template_type,
-				   const gchar   *buffer,
-				   gsize          length,
-				   GError       **error)
+_gtk_builder_extend_with_template (GtkBuilder         *builder,
+				   GtkWidget          *widget,
+				   GType               template_type,
+				   GtkBuilderTemplate *template,
+				   GError            **error)
 {
   GError *tmp_error;
 
@@ -1125,7 +1138,7 @@ _gtk_builder_extend_with_template (GtkBuilder    *builder,
   g_return_val_if_fail (GTK_IS_WIDGET (widget), 0);
   g_return_val_if_fail (g_type_name (template_type) != NULL, 0);
   g_return_val_if_fail (g_type_is_a (G_OBJECT_TYPE (widget), template_type), 0);
-  g_return_val_if_fail (buffer && buffer[0], 0);
+  g_return_val_if_fail (template != NULL, 0);
 
   tmp_error = NULL;
 
@@ -1136,10 +1149,9 @@ _gtk_builder_extend_with_template (GtkBuilder    *builder,
   builder->priv->template_type = template_type;
 
   gtk_builder_expose_object (builder, g_type_name (template_type), G_OBJECT (widget));
-  _gtk_builder_parser_parse_buffer (builder, "<input>",
-                                    buffer, length,
-                                    NULL,
-                                    &tmp_error);
+  _gtk_builder_parser_parse_template (builder, "<input>",
+                                      template,
+                                      &tmp_error);
 
   if (tmp_error != NULL)
     {
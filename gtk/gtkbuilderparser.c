@@ -64,6 +64,41 @@ state_pop (ParserData *data)
 #define state_peek_info(data, st) ((st*)state_peek(data))
 #define state_pop_info(data, st) ((st*)state_pop(data))
 
+/* When replaying a compiled template there is no parse context for the
+ * core tags, so the position comes from the recorded instruction.
+ * Fragments are parsed with their own context, starting at the position
+ * of their first tag.
+ */
+static void
+get_position (ParserData *data,
+              gint       *line_number,
+              gint       *char_number)
+{
+  gint line, column;
+
+  if (data->ctx == NULL)
+    {
+      line = data->replay_line;
+      column = data->replay_column;
+    }
+  else
+    {
+      g_markup_parse_context_get_position (data->ctx, &line, &column);
+
+      if (data->replay_line > 0)
+        {
+          if (line == 1)
+            column += data->replay_column - 1;
+          line += data->replay_line - 1;
+        }
+    }
+
+  if (line_number)
+    *line_number = line;
+  if (char_number)
+    *char_number = column;
+}
+
 static void
 error_missing_attribute (ParserData *data,
                          const gchar *tag,
@@ -72,9 +107,7 @@ error_missing_attribute (ParserData *data,
 {
   gint line_number, char_number;
 
-  g_markup_parse_context_get_position (data->ctx,
-                                       &line_number,
-                                       &char_number);
+  get_position (data, &line_number, &char_number);
 
   g_set_error (error,
                GTK_BUILDER_ERROR,
@@ -92,9 +125,7 @@ error_invalid_attribute (ParserData *data,
 {
   gint line_number, char_number;
 
-  g_markup_parse_context_get_position (data->ctx,
-                                       &line_number,
-                                       &char_number);
+  get_position (data, &line_number, &char_number);
 
   g_set_error (error,
                GTK_BUILDER_ERROR,
@@ -112,9 +143,7 @@ error_invalid_tag (ParserData *data,
 {
   gint line_number, char_number;
 
-  g_markup_parse_context_get_position (data->ctx,
-                                       &line_number,
-                                       &char_number);
+  get_position (data, &line_number, &char_number);
 
   if (expected)
     g_set_error (error,
@@ -250,9 +279,7 @@ parse_requires (ParserData   *data,
   gint          i, version_major = 0, version_minor = 0;
   gint          line_number, char_number;
 
-  g_markup_parse_context_get_position (data->ctx,
-                                       &line_number,
-                                       &char_number);
+  get_position (data, &line_number, &char_number);
 
   for (i = 0; names[i] != NULL; i++)
     {
@@ -308,70 +335,30 @@ is_requested_object (const gchar *object,
   return FALSE;
 }
 
+/* Takes ownership of @object_class, @object_id and @constructor.
+ * @type is the already resolved class, or %G_TYPE_INVALID to have
+ * it looked up by name when the object gets constructed.
+ */
 static void
-parse_object (GMarkupParseContext  *context,
-              ParserData           *data,
-              const gchar          *element_name,
-              const gchar         **names,
-              const gchar         **values,
-              GError              **error)
+push_object (ParserData   *data,
+             const gchar  *element_name,
+             gchar        *object_class,
+             gchar        *object_id,
+             gchar        *constructor,
+             GType         type,
+             GError      **error)
 {
   ObjectInfo *object_info;
   ChildInfo* child_info;
-  int i;
-  gchar *object_class = NULL;
-  gchar *object_id = NULL;
-  gchar *constructor = NULL;
   gint line, line2;
 
   child_info = state_peek_info (data, ChildInfo);
   if (child_info && strcmp (child_info->tag.name, "object") == 0)
     {
       error_invalid_tag (data, element_name, NULL, error);
-      return;
-    }
-
-  for (i = 0; names[i] != NULL; i++)
-    {
-      if (strcmp (names[i], "class") == 0)
-        object_class = g_strdup (values[i]);
-      else if (strcmp (names[i], "id") == 0)
-        object_id = g_strdup (values[i]);
-      else if (strcmp (names[i], "constructor") == 0)
-        constructor = g_strdup (values[i]);
-      else if (strcmp (names[i], "type-func") == 0)
-        {
-	  /* Call the GType function, and return the name of the GType,
-	   * it's guaranteed afterwards that g_type_from_name on the name
-	   * will return our GType
-	   */
-          object_class = _get_type_by_symbol (values[i]);
-          if (!object_class)
-            {
-              g_markup_parse_context_get_position (context, &line, NULL);
-              g_set_error (error, GTK_BUILDER_ERROR,
-                           GTK_BUILDER_ERROR_INVALID_TYPE_FUNCTION,
-                           _("Invalid type function on line %d: '%s'"),
-                           line, values[i]);
-              return;
-            }
-        }
-      else
-	{
-	  error_invalid_attribute (data, element_name, names[i], error);
-	  return;
-	}
-    }
-
-  if (!object_class)
-    {
-      error_missing_attribute (data, element_name, "class", error);
-      return;
-    }
-
-  if (!object_id)
-    {
-      error_missing_attribute (data, element_name, "id", error);
+      g_free (object_class);
+      g_free (object_id);
+      g_free (constructor);
       return;
     }
 
@@ -403,13 +390,14 @@ parse_object (GMarkupParseContext  *context,
   object_info->class_name = object_class;
   object_info->id = object_id;
   object_info->constructor = constructor;
+  object_info->type = type;
   state_push (data, object_info);
   object_info->tag.name = element_name;
 
   if (child_info)
     object_info->parent = (CommonInfo*)child_info;
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   line2 = GPOINTER_TO_INT (g_hash_table_lookup (data->object_ids, object_id));
   if (line2 != 0)
     {
@@ -424,6 +412,68 @@ parse_object (GMarkupParseContext  *context,
   g_hash_table_insert (data->object_ids, g_strdup (object_id), GINT_TO_POINTER (line));
 }
 
+static void
+parse_object (GMarkupParseContext  *context,
+              ParserData           *data,
+              const gchar          *element_name,
+              const gchar         **names,
+              const gchar         **values,
+              GError              **error)
+{
+  int i;
+  gchar *object_class = NULL;
+  gchar *object_id = NULL;
+  gchar *constructor = NULL;
+  gint line;
+
+  for (i = 0; names[i] != NULL; i++)
+    {
+      if (strcmp (names[i], "class") == 0)
+        object_class = g_strdup (values[i]);
+      else if (strcmp (names[i], "id") == 0)
+        object_id = g_strdup (values[i]);
+      else if (strcmp (names[i], "constructor") == 0)
+        constructor = g_strdup (values[i]);
+      else if (strcmp (names[i], "type-func") == 0)
+        {
+	  /* Call the GType function, and return the name of the GType,
+	   * it's guaranteed afterwards that g_type_from_name on the name
+	   * will return our GType
+	   */
+          object_class = _get_type_by_symbol (values[i]);
+          if (!object_class)
+            {
+              get_position (data, &line, NULL);
+              g_set_error (error, GTK_BUILDER_ERROR,
+                           GTK_BUILDER_ERROR_INVALID_TYPE_FUNCTION,
+                           _("Invalid type function on line %d: '%s'"),
+                           line, values[i]);
+              return;
+            }
+        }
+      else
+	{
+	  error_invalid_attribute (data, element_name, names[i], error);
+	  return;
+	}
+    }
+
+  if (!object_class)
+    {
+      error_missing_attribute (data, element_name, "class", error);
+      return;
+    }
+
+  if (!object_id)
+    {
+      error_missing_attribute (data, element_name, "id", error);
+      return;
+    }
+
+  push_object (data, element_name, object_class, object_id, constructor,
+               G_TYPE_INVALID, error);
+}
+
 static void
 parse_template (GMarkupParseContext  *context,
 		ParserData           *data,
@@ -492,10 +542,11 @@ parse_template (GMarkupParseContext  *context,
   object_info->class_name = object_class;
   object_info->id = g_strdup (object_class);
   object_info->object = gtk_builder_get_object (data->builder, object_class);
+  object_info->type = parsed_type;
   state_push (data, object_info);
   object_info->tag.name = element_name;
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   line2 = GPOINTER_TO_INT (g_hash_table_lookup (data->object_ids, object_class));
   if (line2 != 0)
     {
@@ -579,19 +630,17 @@ free_child_info (ChildInfo *info)
   g_slice_free (ChildInfo, info);
 }
 
-static void
-parse_property (ParserData   *data,
-                const gchar  *element_name,
-                const gchar **names,
-                const gchar **values,
-                GError      **error)
+/* Takes ownership of @name and @context */
+static PropertyInfo *
+push_property (ParserData   *data,
+               const gchar  *element_name,
+               gchar        *name,
+               gboolean      translatable,
+               gchar        *context,
+               GError      **error)
 {
   PropertyInfo *info;
-  gchar *name = NULL;
-  gchar *context = NULL;
-  gboolean translatable = FALSE;
   ObjectInfo *object_info;
-  int i;
 
   object_info = state_peek_info (data, ObjectInfo);
   if (!object_info || 
@@ -599,9 +648,35 @@ parse_property (ParserData   *data,
 	strcmp (object_info->tag.name, "template") == 0))
     {
       error_invalid_tag (data, element_name, NULL, error);
-      return;
+      g_free (name);
+      g_free (context);
+      return NULL;
     }
 
+  info = g_slice_new0 (PropertyInfo);
+  info->name = name;
+  info->translatable = translatable;
+  info->context = context;
+  info->text = g_string_new ("");
+  state_push (data, info);
+
+  info->tag.name = element_name;
+
+  return info;
+}
+
+static void
+parse_property (ParserData   *data,
+                const gchar  *element_name,
+                const gchar **names,
+                const gchar **values,
+                GError      **error)
+{
+  gchar *name = NULL;
+  gchar *context = NULL;
+  gboolean translatable = FALSE;
+  int i;
+
   for (i = 0; names[i] != NULL; i++)
     {
       if (strcmp (names[i], "name") == 0)
@@ -633,14 +708,7 @@ parse_property (ParserData   *data,
       return;
     }
 
-  info = g_slice_new0 (PropertyInfo);
-  info->name = name;
-  info->translatable = translatable;
-  info->context = context;
-  info->text = g_string_new ("");
-  state_push (data, info);
-
-  info->tag.name = element_name;
+  push_property (data, element_name, name, translatable, context, error);
 }
 
 static void
@@ -1199,7 +1267,7 @@ text (GMarkupParseContext *context,
   info = state_peek_info (data, CommonInfo);
   g_assert (info != NULL);
 
-  if (strcmp (g_markup_parse_context_get_element (context), "property") == 0)
+  if (strcmp (info->tag.name, "property") == 0)
     {
       PropertyInfo *prop_info = (PropertyInfo*)info;
 
@@ -1234,29 +1302,17 @@ static const GMarkupParser parser = {
   NULL,
 };
 
-void
-_gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
-                                  const gchar  *filename,
-                                  const gchar  *buffer,
-                                  gsize         length,
-                                  gchar       **requested_objs,
-                                  GError      **error)
+static ParserData *
+parser_data_new (GtkBuilder   *builder,
+                 const gchar  *filename,
+                 gchar       **requested_objs)
 {
-  const gchar* domain;
   ParserData *data;
-  GSList *l;
-  
-  /* Store the original domain so that interface domain attribute can be
-   * applied for the builder and the original domain can be restored after
-   * parsing has finished. This allows subparsers to translate elements with
-   * gtk_builder_get_translation_domain() without breaking the ABI or API
-   */
-  domain = gtk_builder_get_translation_domain (builder);
 
   data = g_new0 (ParserData, 1);
   data->builder = builder;
   data->filename = filename;
-  data->domain = g_strdup (domain);
+  data->domain = g_strdup (gtk_builder_get_translation_domain (builder));
   data->object_ids = g_hash_table_new_full (g_str_hash, g_str_equal,
 					    (GDestroyNotify)g_free, NULL);
 
@@ -1278,12 +1334,14 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
       data->inside_requested_object = TRUE;
     }
 
-  data->ctx = g_markup_parse_context_new (&parser, 
-                                          G_MARKUP_TREAT_CDATA_AS_TEXT, 
-                                          data, NULL);
+  return data;
+}
 
-  if (!g_markup_parse_context_parse (data->ctx, buffer, length, error))
-    goto out;
+static void
+parser_data_finish (ParserData *data)
+{
+  GtkBuilder *builder = data->builder;
+  GSList *l;
 
   _gtk_builder_finish (builder);
 
@@ -1307,9 +1365,11 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
       GtkBuildable *buildable = (GtkBuildable*)l->data;
       gtk_buildable_parser_finished (GTK_BUILDABLE (buildable), builder);
     }
+}
 
- out:
-
+static void
+parser_data_free (ParserData *data)
+{
   g_slist_foreach (data->stack, (GFunc)free_info, NULL);
   g_slist_free (data->stack);
   g_slist_foreach (data->custom_finalizers, (GFunc)free_subparser, NULL);
@@ -1319,8 +1379,617 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_free (data->requested_objects);
   g_free (data->domain);
   g_hash_table_destroy (data->object_ids);
-  g_markup_parse_context_free (data->ctx);
+  if (data->ctx)
+    g_markup_parse_context_free (data->ctx);
   g_free (data);
+}
+
+void
+_gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
+                                  const gchar  *filename,
+                                  const gchar  *buffer,
+                                  gsize         length,
+                                  gchar       **requested_objs,
+                                  GError      **error)
+{
+  const gchar* domain;
+  ParserData *data;
+  
+  /* Store the original domain so that interface domain attribute can be
+   * applied for the builder and the original domain can be restored after
+   * parsing has finished. This allows subparsers to translate elements with
+   * gtk_builder_get_translation_domain() without breaking the ABI or API
+   */
+  domain = gtk_builder_get_translation_domain (builder);
+
+  data = parser_data_new (builder, filename, requested_objs);
+  data->ctx = g_markup_parse_context_new (&parser, 
+                                          G_MARKUP_TREAT_CDATA_AS_TEXT, 
+                                          data, NULL);
+
+  if (g_markup_parse_context_parse (data->ctx, buffer, length, error))
+    parser_data_finish (data);
+
+  parser_data_free (data);
+
+  /* restore the original domain */
+  gtk_builder_set_translation_domain (builder, domain);
+}
+
+/* Compiled templates
+ *
+ * Every instance of a composite widget builds the same template, so the
+ * markup is tokenized once per class into a flat list of instructions
+ * which are then fed straight to the callbacks above.
+ *
+ * Only the tags GtkBuilder handles itself are recorded as individual
+ * elements. Custom tags (and <menu>) hand the parse context over to a
+ * subparser, so they are kept as self-contained XML fragments and get a
+ * real parse context of their own when replayed.
+ *
+ * The attributes of <object> and <property> are parsed at compile time.
+ * The class of an object, the GParamSpec of a property and the value of
+ * a property which does not depend on the instance being built are
+ * resolved by the first replay and kept in the instruction.
+ */
+
+typedef enum {
+  TEMPLATE_START_ELEMENT,
+  TEMPLATE_END_ELEMENT,
+  TEMPLATE_TEXT,
+  TEMPLATE_FRAGMENT,
+  TEMPLATE_OBJECT,
+  TEMPLATE_PROPERTY
+} TemplateOp;
+
+typedef struct {
+  TemplateOp    op;
+  gint          line;
+  gint          column;
+  const gchar  *name;   /* interned element name, or text */
+  gsize         length; /* length of the text */
+  const gchar **names;
+  const gchar **values;
+
+  /* TEMPLATE_OBJECT */
+  const gchar  *class_name;
+  const gchar  *id;
+  const gchar  *constructor;
+  GType         type;
+
+  /* TEMPLATE_PROPERTY */
+  const gchar  *property;
+  const gchar  *context;
+  const gchar  *text;
+  gboolean      translatable;
+  GParamSpec   *pspec;
+  GValue        value;
+} TemplateInstruction;
+
+struct _GtkBuilderTemplate {
+  GArray       *instructions;
+  GStringChunk *strings;
+};
+
+typedef struct {
+  GtkBuilderTemplate *template;
+  GString            *fragment;
+  gint                fragment_depth;
+  gint                fragment_line;
+  gint                fragment_column;
+  GString            *property_text;
+  guint               property;
+} TemplateCompiler;
+
+static gboolean
+is_core_tag (const gchar *element_name)
+{
+  static const gchar *core_tags[] = {
+    "interface", "requires", "object", "template",
+    "child", "property", "signal", "placeholder"
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (core_tags); i++)
+    if (strcmp (element_name, core_tags[i]) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+static TemplateInstruction *
+template_add_instruction (TemplateCompiler    *compiler,
+                          GMarkupParseContext *context,
+                          TemplateOp           op)
+{
+  TemplateInstruction *instruction;
+  GArray *instructions = compiler->template->instructions;
+
+  g_array_set_size (instructions, instructions->len + 1);
+  instruction = &g_array_index (instructions, TemplateInstruction, instructions->len - 1);
+  instruction->op = op;
+  g_markup_parse_context_get_position (context,
+                                       &instruction->line,
+                                       &instruction->column);
+
+  return instruction;
+}
+
+/* Objects with a type-func or invalid attributes, and objects at the
+ * top level, are left to parse_object() so it can report the error.
+ */
+static gboolean
+template_compile_object (TemplateCompiler    *compiler,
+                         GMarkupParseContext *context,
+                         const gchar         *element_name,
+                         const gchar        **names,
+                         const gchar        **values)
+{
+  TemplateInstruction *instruction;
+  GStringChunk *strings = compiler->template->strings;
+  const gchar *class_name = NULL;
+  const gchar *id = NULL;
+  const gchar *constructor = NULL;
+  guint i;
+
+  if (g_markup_parse_context_get_element_stack (context)->next == NULL)
+    return FALSE;
+
+  for (i = 0; names[i]; i++)
+    {
+      if (strcmp (names[i], "class") == 0)
+        class_name = values[i];
+      else if (strcmp (names[i], "id") == 0)
+        id = values[i];
+      else if (strcmp (names[i], "constructor") == 0)
+        constructor = values[i];
+      else
+        return FALSE;
+    }
+
+  if (!class_name || !id)
+    return FALSE;
+
+  instruction = template_add_instruction (compiler, context, TEMPLATE_OBJECT);
+  instruction->name = g_intern_string (element_name);
+  instruction->class_name = g_string_chunk_insert_const (strings, class_name);
+  instruction->id = g_string_chunk_insert (strings, id);
+  if (constructor)
+    instruction->constructor = g_string_chunk_insert (strings, constructor);
+
+  return TRUE;
+}
+
+static gboolean
+template_compile_property (TemplateCompiler    *compiler,
+                           GMarkupParseContext *context,
+                           const gchar         *element_name,
+                           const gchar        **names,
+                           const gchar        **values)
+{
+  TemplateInstruction *instruction;
+  GStringChunk *strings = compiler->template->strings;
+  const gchar *name = NULL;
+  const gchar *property_context = NULL;
+  gboolean translatable = FALSE;
+  gchar *canonical;
+  guint i;
+
+  if (g_markup_parse_context_get_element_stack (context)->next == NULL)
+    return FALSE;
+
+  for (i = 0; names[i]; i++)
+    {
+      if (strcmp (names[i], "name") == 0)
+        name = values[i];
+      else if (strcmp (names[i], "translatable") == 0)
+        {
+          if (!_gtk_builder_boolean_from_string (values[i], &translatable, NULL))
+            return FALSE;
+        }
+      else if (strcmp (names[i], "comments") == 0)
+        {
+          /* do nothing, comments are for translators */
+        }
+      else if (strcmp (names[i], "context") == 0)
+        property_context = values[i];
+      else
+        return FALSE;
+    }
+
+  if (!name)
+    return FALSE;
+
+  canonical = g_strdelimit (g_strdup (name), "_", '-');
+
+  instruction = template_add_instruction (compiler, context, TEMPLATE_PROPERTY);
+  instruction->name = g_intern_string (element_name);
+  instruction->property = g_string_chunk_insert_const (strings, canonical);
+  instruction->translatable = translatable;
+  if (property_context)
+    instruction->context = g_string_chunk_insert (strings, property_context);
+
+  g_free (canonical);
+
+  compiler->property = compiler->template->instructions->len - 1;
+  compiler->property_text = g_string_new (NULL);
+
+  return TRUE;
+}
+
+static void
+template_start_element (GMarkupParseContext *context,
+                        const gchar         *element_name,
+                        const gchar        **names,
+                        const gchar        **values,
+                        gpointer             user_data,
+                        GError             **error)
+{
+  TemplateCompiler *compiler = user_data;
+  TemplateInstruction *instruction;
+  GStringChunk *strings = compiler->template->strings;
+  guint i, n_attributes;
+
+  if (compiler->fragment == NULL && !is_core_tag (element_name))
+    {
+      compiler->fragment = g_string_new (NULL);
+      g_markup_parse_context_get_position (context,
+                                           &compiler->fragment_line,
+                                           &compiler->fragment_column);
+    }
+
+  if (compiler->fragment)
+    {
+      g_string_append_printf (compiler->fragment, "<%s", element_name);
+      for (i = 0; names[i]; i++)
+        {
+          gchar *escaped = g_markup_escape_text (values[i], -1);
+
+          g_string_append_printf (compiler->fragment, " %s=\"%s\"", names[i], escaped);
+          g_free (escaped);
+        }
+      g_string_append_c (compiler->fragment, '>');
+      compiler->fragment_depth++;
+      return;
+    }
+
+  if (strcmp (element_name, "object") == 0 &&
+      template_compile_object (compiler, context, element_name, names, values))
+    return;
+
+  if (strcmp (element_name, "property") == 0 && compiler->property_text == NULL &&
+      template_compile_property (compiler, context, element_name, names, values))
+    return;
+
+  n_attributes = g_strv_length ((gchar **)names);
+
+  instruction = template_add_instruction (compiler, context, TEMPLATE_START_ELEMENT);
+  instruction->name = g_intern_string (element_name);
+  instruction->names = g_new (const gchar *, n_attributes + 1);
+  instruction->values = g_new (const gchar *, n_attributes + 1);
+  for (i = 0; i < n_attributes; i++)
+    {
+      instruction->names[i] = g_string_chunk_insert_const (strings, names[i]);
+      instruction->values[i] = g_string_chunk_insert (strings, values[i]);
+    }
+  instruction->names[n_attributes] = NULL;
+  instruction->values[n_attributes] = NULL;
+}
+
+static void
+template_end_element (GMarkupParseContext *context,
+                      const gchar         *element_name,
+                      gpointer             user_data,
+                      GError             **error)
+{
+  TemplateCompiler *compiler = user_data;
+  TemplateInstruction *instruction;
+
+  if (compiler->fragment)
+    {
+      g_string_append_printf (compiler->fragment, "</%s>", element_name);
+      if (--compiler->fragment_depth > 0)
+        return;
+
+      instruction = template_add_instruction (compiler, context, TEMPLATE_FRAGMENT);
+      instruction->line = compiler->fragment_line;
+      instruction->column = compiler->fragment_column;
+      instruction->name = g_string_chunk_insert_len (compiler->template->strings,
+                                                     compiler->fragment->str,
+                                                     compiler->fragment->len);
+      instruction->length = compiler->fragment->len;
+
+      g_string_free (compiler->fragment, TRUE);
+      compiler->fragment = NULL;
+      return;
+    }
+
+  if (compiler->property_text && strcmp (element_name, "property") == 0)
+    {
+      instruction = &g_array_index (compiler->template->instructions,
+                                    TemplateInstruction, compiler->property);
+      instruction->text = g_string_chunk_insert_len (compiler->template->strings,
+                                                     compiler->property_text->str,
+                                                     compiler->property_text->len);
+      instruction->length = compiler->property_text->len;
+
+      g_string_free (compiler->property_text, TRUE);
+      compiler->property_text = NULL;
+    }
+
+  instruction = template_add_instruction (compiler, context, TEMPLATE_END_ELEMENT);
+  instruction->name = g_intern_string (element_name);
+}
+
+static void
+template_text (GMarkupParseContext *context,
+               const gchar         *text,
+               gsize                text_len,
+               gpointer             user_data,
+               GError             **error)
+{
+  TemplateCompiler *compiler = user_data;
+  TemplateInstruction *instruction;
+
+  if (compiler->fragment)
+    {
+      gchar *escaped = g_markup_escape_text (text, text_len);
+
+      g_string_append (compiler->fragment, escaped);
+      g_free (escaped);
+      return;
+    }
+
+  if (compiler->property_text)
+    {
+      g_string_append_len (compiler->property_text, text, text_len);
+      return;
+    }
+
+  /* Character data is only meaningful inside <property>, everything
+   * else is whitespace between tags.
+   */
+  if (g_strcmp0 (g_markup_parse_context_get_element (context), "property") != 0)
+    return;
+
+  instruction = template_add_instruction (compiler, context, TEMPLATE_TEXT);
+  instruction->name = g_string_chunk_insert_len (compiler->template->strings, text, text_len);
+  instruction->length = text_len;
+}
+
+static const GMarkupParser template_compiler = {
+  template_start_element,
+  template_end_element,
+  template_text,
+  NULL,
+};
+
+GtkBuilderTemplate *
+_gtk_builder_template_compile (const gchar  *buffer,
+                               gsize         length,
+                               GError      **error)
+{
+  TemplateCompiler compiler = { NULL, };
+  GMarkupParseContext *context;
+  gboolean success;
+
+  compiler.template = g_slice_new (GtkBuilderTemplate);
+  compiler.template->instructions = g_array_new (FALSE, TRUE, sizeof (TemplateInstruction));
+  compiler.template->strings = g_string_chunk_new (256);
+
+  context = g_markup_parse_context_new (&template_compiler,
+                                        G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                        &compiler, NULL);
+
+  success = g_markup_parse_context_parse (context, buffer, length, error) &&
+            g_markup_parse_context_end_parse (context, error);
+
+  g_markup_parse_context_free (context);
+  if (compiler.fragment)
+    g_string_free (compiler.fragment, TRUE);
+  if (compiler.property_text)
+    g_string_free (compiler.property_text, TRUE);
+
+  if (!success)
+    {
+      _gtk_builder_template_free (compiler.template);
+      return NULL;
+    }
+
+  return compiler.template;
+}
+
+void
+_gtk_builder_template_free (GtkBuilderTemplate *template)
+{
+  guint i;
+
+  for (i = 0; i < template->instructions->len; i++)
+    {
+      TemplateInstruction *instruction;
+
+      instruction = &g_array_index (template->instructions, TemplateInstruction, i);
+      g_free (instruction->names);
+      g_free (instruction->values);
+      if (instruction->pspec)
+        g_param_spec_unref (instruction->pspec);
+      if (G_IS_VALUE (&instruction->value))
+        g_value_unset (&instruction->value);
+    }
+
+  g_array_free (template->instructions, TRUE);
+  g_string_chunk_free (template->strings);
+  g_slice_free (GtkBuilderTemplate, template);
+}
+
+static gboolean
+parse_fragment (ParserData   *data,
+                const gchar  *fragment,
+                gsize         length,
+                GError      **error)
+{
+  gboolean success;
+
+  data->ctx = g_markup_parse_context_new (&parser,
+                                          G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                          data, NULL);
+
+  success = g_markup_parse_context_parse (data->ctx, fragment, length, error) &&
+            g_markup_parse_context_end_parse (data->ctx, error);
+
+  g_markup_parse_context_free (data->ctx);
+  data->ctx = NULL;
+
+  return success;
+}
+
+static void
+replay_object (ParserData          *data,
+               TemplateInstruction *instruction,
+               GError             **error)
+{
+  if (instruction->type == G_TYPE_INVALID)
+    instruction->type = gtk_builder_get_type_from_name (data->builder,
+                                                        instruction->class_name);
+
+  data->last_element = instruction->name;
+  push_object (data, instruction->name,
+               g_strdup (instruction->class_name),
+               g_strdup (instruction->id),
+               g_strdup (instruction->constructor),
+               instruction->type,
+               error);
+}
+
+/* Whether the value of a property of this type can be converted once
+ * and shared by every instance built from the template.
+ */
+static gboolean
+is_constant_value_type (GType type)
+{
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_STRING:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static void
+replay_property (ParserData          *data,
+                 TemplateInstruction *instruction,
+                 GError             **error)
+{
+  PropertyInfo *info;
+  ObjectInfo *object_info;
+
+  data->last_element = instruction->name;
+  info = push_property (data, instruction->name,
+                        g_strdup (instruction->property),
+                        instruction->translatable,
+                        g_strdup (instruction->context),
+                        error);
+  if (info == NULL)
+    return;
+
+  g_string_append_len (info->text, instruction->text, instruction->length);
+
+  object_info = data->stack->next->data;
+  if (instruction->pspec == NULL && object_info->type != G_TYPE_INVALID)
+    {
+      GObjectClass *oclass = g_type_class_ref (object_info->type);
+      GParamSpec *pspec;
+
+      pspec = g_object_class_find_property (oclass, instruction->property);
+      if (pspec)
+        {
+          instruction->pspec = g_param_spec_ref (pspec);
+
+          if (!instruction->translatable &&
+              is_constant_value_type (G_PARAM_SPEC_VALUE_TYPE (pspec)) &&
+              !gtk_builder_value_from_string (data->builder, pspec,
+                                              info->text->str,
+                                              &instruction->value, NULL) &&
+              G_IS_VALUE (&instruction->value))
+            g_value_unset (&instruction->value);
+        }
+
+      g_type_class_unref (oclass);
+    }
+
+  info->pspec = instruction->pspec;
+  if (G_IS_VALUE (&instruction->value))
+    info->value = &instruction->value;
+}
+
+void
+_gtk_builder_parser_parse_template (GtkBuilder          *builder,
+                                    const gchar         *filename,
+                                    GtkBuilderTemplate  *template,
+                                    GError             **error)
+{
+  const gchar* domain;
+  ParserData *data;
+  GError *tmp_error = NULL;
+  guint i;
+
+  domain = gtk_builder_get_translation_domain (builder);
+
+  data = parser_data_new (builder, filename, NULL);
+
+  for (i = 0; i < template->instructions->len && tmp_error == NULL; i++)
+    {
+      TemplateInstruction *instruction;
+
+      instruction = &g_array_index (template->instructions, TemplateInstruction, i);
+      data->replay_line = instruction->line;
+      data->replay_column = instruction->column;
+
+      switch (instruction->op)
+        {
+        case TEMPLATE_START_ELEMENT:
+          start_element (NULL, instruction->name,
+                         instruction->names, instruction->values,
+                         data, &tmp_error);
+          break;
+        case TEMPLATE_END_ELEMENT:
+          end_element (NULL, instruction->name, data, &tmp_error);
+          break;
+        case TEMPLATE_TEXT:
+          text (NULL, instruction->name, instruction->length, data, &tmp_error);
+          break;
+        case TEMPLATE_FRAGMENT:
+          parse_fragment (data, instruction->name, instruction->length, &tmp_error);
+          break;
+        case TEMPLATE_OBJECT:
+          replay_object (data, instruction, &tmp_error);
+          break;
+        case TEMPLATE_PROPERTY:
+          replay_property (data, instruction, &tmp_error);
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  if (tmp_error == NULL)
+    parser_data_finish (data);
+  else
+    g_propagate_error (error, tmp_error);
+
+  parser_data_free (data);
 
   /* restore the original domain */
   gtk_builder_set_translation_domain (builder, domain);
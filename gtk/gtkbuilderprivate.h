@@ -39,6 +39,7 @@ typedef struct {
   GObject *object;
   CommonInfo *parent;
   gboolean applied_properties;
+  GType type; /* resolved class, or G_TYPE_INVALID to look up class_name */
 } ObjectInfo;
 
 typedef struct {
@@ -64,6 +65,8 @@ typedef struct {
   gchar *data;
   gboolean translatable;
   gchar *context;
+  GParamSpec *pspec;    /* resolved property, if known */
+  const GValue *value;  /* converted value, if it doesn't depend on the instance */
 } PropertyInfo;
 
 typedef struct {
@@ -108,8 +111,14 @@ typedef struct {
   gint cur_object_level;
 
   GHashTable *object_ids;
+
+  /* Position of the instruction being replayed from a compiled template */
+  gint replay_line;
+  gint replay_column;
 } ParserData;
 
+typedef struct _GtkBuilderTemplate GtkBuilderTemplate;
+
 typedef GType (*GTypeGetFunc) (void);
 
 /* Things only GtkBuilder should use */
@@ -119,6 +128,14 @@ void _gtk_builder_parser_parse_buffer (GtkBuilder *builder,
                                        gsize length,
                                        gchar **requested_objs,
                                        GError **error);
+GtkBuilderTemplate * _gtk_builder_template_compile (const gchar  *buffer,
+                                                    gsize         length,
+                                                    GError      **error);
+void      _gtk_builder_template_free (GtkBuilderTemplate *template);
+void _gtk_builder_parser_parse_template (GtkBuilder          *builder,
+                                         const gchar         *filename,
+                                         GtkBuilderTemplate  *template,
+                                         GError             **error);
 GObject * _gtk_builder_construct (GtkBuilder *builder,
                                   ObjectInfo *info,
 				  GError    **error);
@@ -167,8 +184,7 @@ GType     _gtk_builder_get_template_type (GtkBuilder *builder);
 guint     _gtk_builder_extend_with_template (GtkBuilder    *builder,
 					     GtkWidget     *widget,
 					     GType          template_type,
-					     const gchar   *buffer,
-					     gsize          length,
+					     GtkBuilderTemplate *template,
 					     GError       **error);
 
 #endif /* __GTK_BUILDER_PRIVATE_H__ */
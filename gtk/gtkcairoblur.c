@@ -30,35 +30,21 @@
  *   based on exponential-blur algorithm by Jani Huhtanen
  */
 static inline void
-_blurinner (guchar* pixel,
-            gint   *zR,
-            gint   *zG,
-            gint   *zB,
-            gint   *zA,
+_blurinner (guchar *pixel,
+            gint   *z,
+            gint    channels,
             gint    alpha,
             gint    aprec,
             gint    zprec)
 {
-  gint R;
-  gint G;
-  gint B;
-  guchar A;
-
-  R = *pixel;
-  G = *(pixel + 1);
-  B = *(pixel + 2);
-  A = *(pixel + 3);
-
-  *zR += (alpha * ((R << zprec) - *zR)) >> aprec;
-  *zG += (alpha * ((G << zprec) - *zG)) >> aprec;
-  *zB += (alpha * ((B << zprec) - *zB)) >> aprec;
-  *zA += (alpha * ((A << zprec) - *zA)) >> aprec;
-
-  *pixel       = *zR >> zprec;
-  *(pixel + 1) = *zG >> zprec;
-  *(pixel + 2) = *zB >> zprec;
-  *(pixel + 3) = *zA >> zprec;
-} 
+  gint c;
+
+  for (c = 0; c < channels; c++)
+    {
+      z[c] += (alpha * ((pixel[c] << zprec) - z[c])) >> aprec;
+      pixel[c] = z[c] >> zprec;
+    }
+}
 
 static inline void
 _blurrow (guchar* pixels,
@@ -71,87 +57,83 @@ _blurrow (guchar* pixels,
           gint    aprec,
           gint    zprec)
 {
-  gint    zR;
-  gint    zG;
-  gint    zB;
-  gint    zA;
-  gint    index;
+  gint    z[4];
+  gint    index, c;
   guchar* scanline;
 
   scanline = &pixels[line * rowstride];
 
-  zR = *scanline << zprec;
-  zG = *(scanline + 1) << zprec;
-  zB = *(scanline + 2) << zprec;
-  zA = *(scanline + 3) << zprec;
+  for (c = 0; c < channels; c++)
+    z[c] = scanline[c] << zprec;
 
   for (index = 0; index < width; index ++)
     _blurinner (&scanline[index * channels],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
+                z,
+                channels,
                 alpha,
                 aprec,
                 zprec);
 
   for (index = width - 2; index >= 0; index--)
     _blurinner (&scanline[index * channels],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
+                z,
+                channels,
                 alpha,
                 aprec,
                 zprec);
 }
 
+/*
+ * _blurcols:
+ *
+ * Runs the vertical pass for all columns at once. Walking the image
+ * row by row keeps the memory accesses sequential instead of striding
+ * by rowstride for every pixel, and the inner loop has no dependency
+ * between neighbouring bytes, so the compiler can vectorize it.
+ * Every byte of a row is treated as its own column, which gives the
+ * same result as blurring each channel of each column separately.
+ */
 static inline void
-_blurcol (guchar* pixels,
-          gint    width,
-          gint    height,
-          gint    rowstride,
-          gint    channels,
-          gint    x,
-          gint    alpha,
-          gint    aprec,
-          gint    zprec)
+_blurcols (guchar* pixels,
+           gint    width,
+           gint    height,
+           gint    rowstride,
+           gint    channels,
+           gint   *z,
+           gint    alpha,
+           gint    aprec,
+           gint    zprec)
 {
-  gint zR;
-  gint zG;
-  gint zB;
-  gint zA;
-  gint index;
+  gint    n_bytes;
+  gint    index, i;
   guchar* ptr;
 
-  ptr = pixels;
-  
-  ptr += x * channels;
+  n_bytes = width * channels;
 
-  zR = *((guchar*) ptr    ) << zprec;
-  zG = *((guchar*) ptr + 1) << zprec;
-  zB = *((guchar*) ptr + 2) << zprec;
-  zA = *((guchar*) ptr + 3) << zprec;
+  for (i = 0; i < n_bytes; i++)
+    z[i] = pixels[i] << zprec;
 
   for (index = 0; index < height; index++)
-    _blurinner (&ptr[index * rowstride],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+    {
+      ptr = &pixels[index * rowstride];
+
+      for (i = 0; i < n_bytes; i++)
+        {
+          z[i] += (alpha * ((ptr[i] << zprec) - z[i])) >> aprec;
+          ptr[i] = z[i] >> zprec;
+        }
+    }
 
   for (index = height - 2; index >= 0; index--)
-    _blurinner (&ptr[index * rowstride],
-                &zR,
-                &zG,
-                &zB,
-                &zA,
-                alpha,
-                aprec,
-                zprec);
+    {
+      ptr = &pixels[index * rowstride];
+
+      for (i = 0; i < n_bytes; i++)
+        {
+          z[i] += (alpha * ((ptr[i] << zprec) - z[i])) >> aprec;
+          ptr[i] = z[i] >> zprec;
+        }
+    }
 }
 
 /*
@@ -160,7 +142,7 @@ _blurcol (guchar* pixels,
  * @width: image width
  * @height: image height
  * @rowstride: image rowstride
- * @channels: image channels
+ * @channels: image channels, either 1 or 4
  * @radius: kernel radius
  * @aprec: precision of alpha parameter in fixed-point format 0.aprec
  * @zprec: precision of state parameters zR,zG,zB and zA in fp format 8.zprec
@@ -182,7 +164,11 @@ _expblur (guchar* pixels,
           gint    zprec)
 {
   gint alpha;
-  int row, col;
+  gint *z;
+  int row;
+
+  if (width <= 0 || height <= 0)
+    return;
 
   /* Calculate the alpha such that 90% of 
    * the kernel is within the radius.
@@ -200,16 +186,19 @@ _expblur (guchar* pixels,
               aprec,
               zprec);
 
-  for(col = 0; col < width; col++)
-    _blurcol (pixels,
-              width,
-              height,
-              rowstride,
-              channels,
-              col,
-              alpha,
-              aprec,
-              zprec);
+  z = g_new (gint, width * channels);
+
+  _blurcols (pixels,
+             width,
+             height,
+             rowstride,
+             channels,
+             z,
+             alpha,
+             aprec,
+             zprec);
+
+  g_free (z);
 }
 
 
@@ -219,6 +208,10 @@ _expblur (guchar* pixels,
  * @radius: the blur radius.
  *
  * Blurs the cairo image surface at the given radius.
+ * A8 surfaces only carry an alpha channel and are
+ * blurred four times faster than ARGB32 ones, so they
+ * should be preferred for single-colored content
+ * like shadows.
  */
 void
 _gtk_cairo_blur_surface (cairo_surface_t* surface,
@@ -230,7 +223,8 @@ _gtk_cairo_blur_surface (cairo_surface_t* surface,
   g_return_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
 
   format = cairo_image_surface_get_format (surface);
-  g_return_if_fail (format == CAIRO_FORMAT_RGB24 ||
+  g_return_if_fail (format == CAIRO_FORMAT_A8 ||
+                    format == CAIRO_FORMAT_RGB24 ||
                     format == CAIRO_FORMAT_ARGB32);
 
   if (radius == 0)
@@ -243,7 +237,7 @@ _gtk_cairo_blur_surface (cairo_surface_t* surface,
             cairo_image_surface_get_width (surface),
             cairo_image_surface_get_height (surface),
             cairo_image_surface_get_stride (surface),
-            4,
+            format == CAIRO_FORMAT_A8 ? 1 : 4,
             radius,
             16,
             7);
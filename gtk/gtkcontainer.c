@@ -238,6 +238,7 @@ struct _GtkContainerPrivate
 
   guint resize_handler;
   GdkFrameClock *resize_clock;
+  GHashTable *relayout_widgets;
 
   guint border_width : 16;
 
@@ -249,6 +250,20 @@ struct _GtkContainerPrivate
   guint request_mode       : 2;
 };
 
+/* A widget whose size request was invalidated since the last layout of
+ * its resize container, with the request it had when it was allocated.
+ */
+typedef struct {
+  GtkWidget        *widget;
+  SizeRequestCache  request;
+  guint             has_request : 1; /* the widget was allocated with @request */
+  guint             queued      : 1; /* the resize was queued on this widget */
+  guint             reached     : 1;
+  guint             measured    : 1;
+  guint             changed     : 1;
+  guint             owns_ref    : 1;
+} RelayoutWidget;
+
 enum {
   ADD,
   REMOVE,
@@ -1388,6 +1403,12 @@ gtk_container_destroy (GtkWidget *widget)
   if (priv->restyle_pending)
     priv->restyle_pending = FALSE;
 
+  if (priv->relayout_widgets)
+    {
+      g_hash_table_destroy (priv->relayout_widgets);
+      priv->relayout_widgets = NULL;
+    }
+
   if (priv->focus_child)
     {
       g_object_unref (priv->focus_child);
@@ -1654,6 +1675,164 @@ gtk_container_set_reallocate_redraws (GtkContainer *container,
   container->priv->reallocate_redraws = needs_redraws ? TRUE : FALSE;
 }
 
+/* Per-frame layout counters, see GTK_DEBUG=layout */
+static guint n_measured = 0;
+static guint n_allocated = 0;
+
+void
+_gtk_container_count_measure (void)
+{
+  n_measured++;
+}
+
+void
+_gtk_container_count_allocate (void)
+{
+  n_allocated++;
+}
+
+static void
+relayout_widget_free (RelayoutWidget *relayout)
+{
+  _gtk_size_request_cache_free (&relayout->request);
+  if (relayout->owns_ref)
+    g_object_unref (relayout->widget);
+  g_slice_free (RelayoutWidget, relayout);
+}
+
+/* Lays out only the parts of the container below the widgets that
+ * queued a resize. Going up from each of them, their ancestors are
+ * measured again until one has the same request it was last allocated
+ * with. Its parent would allocate it the same way, so that widget is
+ * a relayout boundary: it gets allocated again in place, and everything
+ * above it keeps its request and allocation. The widgets that queued
+ * the resize are never boundaries themselves.
+ *
+ * Returns %FALSE if the container needs a full layout instead, in
+ * which case the requests of the widgets in @relayout_widgets are
+ * left invalidated.
+ */
+static gboolean
+gtk_container_relayout (GtkContainer *container,
+                        GHashTable   *relayout_widgets)
+{
+  GtkWidget *resize_container = GTK_WIDGET (container);
+  RelayoutWidget *relayout, *current;
+  GHashTableIter iter;
+  GPtrArray *boundaries;
+  GtkWidget *widget;
+  gboolean changed;
+  gboolean success = TRUE;
+  guint i;
+
+  boundaries = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&iter, relayout_widgets);
+  while (success && g_hash_table_iter_next (&iter, NULL, (gpointer *) &relayout))
+    {
+      if (!relayout->queued)
+        continue;
+
+      widget = relayout->widget;
+      changed = TRUE;
+
+      while (TRUE)
+        {
+          current = g_hash_table_lookup (relayout_widgets, widget);
+
+          /* Widgets that moved, got hidden or were allocated
+           * behind our back since the resize was queued
+           */
+          if (current == NULL ||
+              !gtk_widget_get_visible (widget) ||
+              !_gtk_widget_get_alloc_needed (widget))
+            {
+              success = FALSE;
+              break;
+            }
+
+          current->reached = TRUE;
+
+          if (changed && !current->measured)
+            {
+              /* Size groups share requests beyond the cache */
+              if (widget == resize_container ||
+                  !current->has_request ||
+                  _gtk_widget_get_sizegroups (widget) != NULL)
+                {
+                  success = FALSE;
+                  break;
+                }
+
+              current->measured = TRUE;
+
+              /* A resize queued on the widget itself may be about how
+               * its parent lays it out, like for changed packing or
+               * expand flags, so only widgets that a change reached
+               * from below can be boundaries
+               */
+              if (current->queued)
+                current->changed = TRUE;
+              else
+                current->changed = !_gtk_widget_request_matches (widget, &current->request);
+
+              if (!current->changed)
+                g_ptr_array_add (boundaries, widget);
+            }
+
+          if (current->measured)
+            changed = current->changed;
+
+          if (widget == resize_container)
+            break;
+
+          widget = gtk_widget_get_parent (widget);
+          if (widget == NULL)
+            {
+              success = FALSE;
+              break;
+            }
+        }
+    }
+
+  /* Everything invalidated must lie on the way up from a queued widget,
+   * and what wasn't measured again must still have its old request.
+   */
+  g_hash_table_iter_init (&iter, relayout_widgets);
+  while (success && g_hash_table_iter_next (&iter, NULL, (gpointer *) &relayout))
+    {
+      if (!relayout->reached ||
+          (!relayout->measured && !relayout->has_request))
+        success = FALSE;
+    }
+
+  if (success)
+    {
+      g_hash_table_iter_init (&iter, relayout_widgets);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &relayout))
+        {
+          SizeRequestCache *cache;
+
+          if (relayout->measured)
+            continue;
+
+          cache = _gtk_widget_peek_request_cache (relayout->widget);
+          _gtk_size_request_cache_free (cache);
+          *cache = relayout->request;
+          _gtk_size_request_cache_init (&relayout->request);
+
+          _gtk_widget_set_alloc_needed (relayout->widget, FALSE);
+        }
+
+      for (i = 0; i < boundaries->len; i++)
+        _gtk_widget_reallocate (g_ptr_array_index (boundaries, i));
+    }
+
+  g_ptr_array_free (boundaries, TRUE);
+
+  return success;
+}
+
 static void
 gtk_container_idle_sizer (GdkFrameClock *clock,
 			  GtkContainer  *container)
@@ -1693,8 +1872,39 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
    */
   if (container->priv->resize_pending)
     {
+      GHashTable *relayout_widgets;
+      gboolean relayout;
+      guint64 hits, misses, evictions;
+      guint64 hits_after, misses_after, evictions_after;
+
+      n_measured = 0;
+      n_allocated = 0;
+      _gtk_size_request_cache_get_stats (&hits, &misses, &evictions);
+
+      /* Resizes queued while laying out go to a new set */
+      relayout_widgets = container->priv->relayout_widgets;
+      container->priv->relayout_widgets = NULL;
+
       container->priv->resize_pending = FALSE;
-      gtk_container_check_resize (container);
+
+      relayout = relayout_widgets != NULL &&
+                 gtk_container_relayout (container, relayout_widgets);
+      if (!relayout)
+        gtk_container_check_resize (container);
+
+      if (relayout_widgets)
+        g_hash_table_destroy (relayout_widgets);
+
+      _gtk_size_request_cache_get_stats (&hits_after, &misses_after, &evictions_after);
+      GTK_NOTE (LAYOUT,
+                g_print ("%s %p: %s layout, %u widgets measured, %u allocated, "
+                         "size cache %" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses, "
+                         "%" G_GUINT64_FORMAT " evictions\n",
+                         G_OBJECT_TYPE_NAME (container), container,
+                         relayout ? "partial" : "full",
+                         n_measured, n_allocated,
+                         hits_after - hits, misses_after - misses,
+                         evictions_after - evictions));
     }
 
   if (!container->priv->restyle_pending && !container->priv->resize_pending)
@@ -1775,17 +1985,71 @@ gtk_container_queue_resize_handler (GtkContainer *container)
 }
 
 static void
-_gtk_container_queue_resize_internal (GtkContainer *container,
-                                      gboolean      invalidate_only)
+_gtk_container_queue_resize_internal (GtkWidget *widget,
+                                      gboolean   invalidate_only)
 {
-  GtkWidget *widget;
+  GtkWidget *resize_container;
+  GtkWidget *queued = widget;
+  GHashTable *relayout_widgets = NULL;
+  RelayoutWidget *relayout;
+  guint i;
 
-  g_return_if_fail (GTK_IS_CONTAINER (container));
+  resize_container = widget;
+  while (resize_container && !GTK_IS_RESIZE_CONTAINER (resize_container))
+    resize_container = gtk_widget_get_parent (resize_container);
 
-  widget = GTK_WIDGET (container);
+  /* Remember what gets invalidated, so the idle sizer can tell
+   * how far up the change needs to be laid out
+   */
+  if (resize_container &&
+      GTK_CONTAINER (resize_container)->priv->resize_mode == GTK_RESIZE_QUEUE)
+    {
+      GtkContainerPrivate *priv = GTK_CONTAINER (resize_container)->priv;
+
+      if (priv->relayout_widgets == NULL)
+        priv->relayout_widgets = g_hash_table_new_full (NULL, NULL, NULL,
+                                                        (GDestroyNotify) relayout_widget_free);
+      relayout_widgets = priv->relayout_widgets;
+    }
 
   do
     {
+      if (relayout_widgets)
+        {
+          relayout = g_hash_table_lookup (relayout_widgets, widget);
+          if (relayout == NULL)
+            {
+              relayout = g_slice_new0 (RelayoutWidget);
+              relayout->widget = widget;
+              g_hash_table_insert (relayout_widgets, widget, relayout);
+            }
+
+          if (widget == queued && !invalidate_only)
+            relayout->queued = TRUE;
+
+          if (!relayout->owns_ref && widget != resize_container)
+            {
+              g_object_ref (widget);
+              relayout->owns_ref = TRUE;
+            }
+
+          /* Keep the request the widget was last allocated with */
+          if (!relayout->has_request && !_gtk_widget_get_alloc_needed (widget))
+            {
+              SizeRequestCache *cache = _gtk_widget_peek_request_cache (widget);
+
+              relayout->request = *cache;
+              relayout->has_request = TRUE;
+              _gtk_size_request_cache_init (cache);
+              /* Let the fresh cache grow as quickly as the old one did */
+              for (i = 0; i < 2; i++)
+                {
+                  cache->flags[i].n_lookups = relayout->request.flags[i].n_lookups;
+                  cache->flags[i].n_misses = relayout->request.flags[i].n_misses;
+                }
+            }
+        }
+
       _gtk_widget_set_alloc_needed (widget, TRUE);
       _gtk_size_request_cache_clear (_gtk_widget_peek_request_cache (widget));
 
@@ -1800,6 +2064,23 @@ _gtk_container_queue_resize_internal (GtkContainer *container,
     gtk_container_queue_resize_handler (GTK_CONTAINER (widget));
 }
 
+/**
+ * _gtk_container_queue_resize_widget:
+ * @widget: a #GtkWidget
+ * @invalidate_only: whether to only invalidate cached sizes
+ *
+ * Like _gtk_container_queue_resize(), but starting from @widget, which
+ * doesn't need to be a container.
+ */
+void
+_gtk_container_queue_resize_widget (GtkWidget *widget,
+                                    gboolean   invalidate_only)
+{
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  _gtk_container_queue_resize_internal (widget, invalidate_only);
+}
+
 void
 _gtk_container_queue_restyle (GtkContainer *container)
 {
@@ -1830,7 +2111,9 @@ _gtk_container_queue_restyle (GtkContainer *container)
 void
 _gtk_container_queue_resize (GtkContainer *container)
 {
-  _gtk_container_queue_resize_internal (container, FALSE);
+  g_return_if_fail (GTK_IS_CONTAINER (container));
+
+  _gtk_container_queue_resize_internal (GTK_WIDGET (container), FALSE);
 }
 
 /**
@@ -1843,7 +2126,9 @@ _gtk_container_queue_resize (GtkContainer *container)
 void
 _gtk_container_resize_invalidate (GtkContainer *container)
 {
-  _gtk_container_queue_resize_internal (container, TRUE);
+  g_return_if_fail (GTK_IS_CONTAINER (container));
+
+  _gtk_container_queue_resize_internal (GTK_WIDGET (container), TRUE);
 }
 
 void
@@ -1858,6 +2143,13 @@ gtk_container_check_resize (GtkContainer *container)
 {
   g_return_if_fail (GTK_IS_CONTAINER (container));
 
+  /* A full layout leaves nothing for a partial one to do */
+  if (container->priv->relayout_widgets)
+    {
+      g_hash_table_destroy (container->priv->relayout_widgets);
+      container->priv->relayout_widgets = NULL;
+    }
+
   g_signal_emit (container, container_signals[CHECK_RESIZE], 0);
 }
 
@@ -29,6 +29,8 @@ GList *  _gtk_container_get_all_children       (GtkContainer *container);
 void     _gtk_container_queue_resize           (GtkContainer *container);
 void     _gtk_container_queue_restyle          (GtkContainer *container);
 void     _gtk_container_resize_invalidate      (GtkContainer *container);
+void     _gtk_container_queue_resize_widget    (GtkWidget    *widget,
+                                                gboolean      invalidate_only);
 void     _gtk_container_clear_resize_widgets   (GtkContainer *container);
 gchar*   _gtk_container_child_composite_name   (GtkContainer *container,
                                                 GtkWidget    *child);
@@ -42,6 +44,9 @@ gboolean _gtk_container_get_reallocate_redraws (GtkContainer *container);
 void      _gtk_container_stop_idle_sizer        (GtkContainer *container);
 void      _gtk_container_maybe_start_idle_sizer (GtkContainer *container);
 
+void      _gtk_container_count_measure          (void);
+void      _gtk_container_count_allocate         (void);
+
 G_END_DECLS
 
 #endif /* __GTK_CONTAINER_PRIVATE_H__ */
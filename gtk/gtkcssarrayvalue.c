@@ -321,12 +321,33 @@ gtk_css_value_array_print (const GtkCssValue *value,
     }
 }
 
+static gboolean
+gtk_css_value_array_serialize (const GtkCssValue  *value,
+                               GtkCssBinaryWriter *writer)
+{
+  guint i;
+
+  if (value->n_values == 0)
+    return FALSE;
+
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_ARRAY);
+  _gtk_css_binary_writer_put_uint (writer, value->n_values);
+  for (i = 0; i < value->n_values; i++)
+    {
+      if (!_gtk_css_binary_writer_put_value (writer, value->values[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_ARRAY = {
   gtk_css_value_array_free,
   gtk_css_value_array_compute,
   gtk_css_value_array_equal,
   gtk_css_value_array_transition,
-  gtk_css_value_array_print
+  gtk_css_value_array_print,
+  gtk_css_value_array_serialize
 };
 
 GtkCssValue *
@@ -353,6 +374,34 @@ _gtk_css_array_value_new_from_array (GtkCssValue **values,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_array_value_deserialize (GtkCssBinaryReader *reader,
+                                  GtkCssBinaryTag     tag)
+{
+  GtkCssValue *result;
+  guint i, n_values;
+
+  n_values = _gtk_css_binary_reader_get_uint (reader);
+  /* don't trust corrupt data with huge allocations */
+  if (n_values == 0 || n_values > G_MAXUINT16)
+    return NULL;
+
+  result = _gtk_css_value_alloc (&GTK_CSS_VALUE_ARRAY, sizeof (GtkCssValue) + sizeof (GtkCssValue *) * (n_values - 1));
+  result->n_values = n_values;
+
+  for (i = 0; i < n_values; i++)
+    {
+      result->values[i] = _gtk_css_binary_reader_get_value (reader);
+      if (result->values[i] == NULL)
+        {
+          _gtk_css_value_unref (result);
+          return NULL;
+        }
+    }
+
+  return result;
+}
+
 GtkCssValue *
 _gtk_css_array_value_parse (GtkCssParser *parser,
                             GtkCssValue  *(* parse_func) (GtkCssParser *parser))
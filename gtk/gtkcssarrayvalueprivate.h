@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_ARRAY_VALUE_PRIVATE_H__
 #define __GTK_CSS_ARRAY_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 #include "gtktypes.h"
@@ -29,6 +30,8 @@ G_BEGIN_DECLS
 GtkCssValue *       _gtk_css_array_value_new            (GtkCssValue           *content);
 GtkCssValue *       _gtk_css_array_value_new_from_array (GtkCssValue          **values,
                                                          guint                  n_values);
+GtkCssValue *       _gtk_css_array_value_deserialize    (GtkCssBinaryReader    *reader,
+                                                         GtkCssBinaryTag        tag);
 GtkCssValue *       _gtk_css_array_value_parse          (GtkCssParser          *parser,
                                                          GtkCssValue *          (* parse_func) (GtkCssParser *));
 
@@ -148,12 +148,24 @@ gtk_css_value_bg_size_print (const GtkCssValue *value,
     }
 }
 
+static gboolean
+gtk_css_value_bg_size_serialize (const GtkCssValue  *value,
+                                 GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_BG_SIZE);
+  _gtk_css_binary_writer_put_uint (writer, value->cover | (value->contain << 1));
+
+  return _gtk_css_binary_writer_put_value (writer, value->x) &&
+         _gtk_css_binary_writer_put_value (writer, value->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BG_SIZE = {
   gtk_css_value_bg_size_free,
   gtk_css_value_bg_size_compute,
   gtk_css_value_bg_size_equal,
   gtk_css_value_bg_size_transition,
-  gtk_css_value_bg_size_print
+  gtk_css_value_bg_size_print,
+  gtk_css_value_bg_size_serialize
 };
 
 static GtkCssValue auto_singleton = { &GTK_CSS_VALUE_BG_SIZE, 1, FALSE, FALSE, NULL, NULL };
@@ -176,6 +188,33 @@ _gtk_css_bg_size_value_new (GtkCssValue *x,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_bg_size_value_deserialize (GtkCssBinaryReader *reader,
+                                    GtkCssBinaryTag     tag)
+{
+  GtkCssValue *x, *y;
+  guint flags;
+
+  flags = _gtk_css_binary_reader_get_uint (reader);
+  x = _gtk_css_binary_reader_get_value (reader);
+  y = _gtk_css_binary_reader_get_value (reader);
+
+  if (_gtk_css_binary_reader_failed (reader) || (flags & 3))
+    {
+      _gtk_css_value_unref (x);
+      _gtk_css_value_unref (y);
+
+      if (_gtk_css_binary_reader_failed (reader))
+        return NULL;
+      else if (flags & 1)
+        return _gtk_css_value_ref (&cover_singleton);
+      else
+        return _gtk_css_value_ref (&contain_singleton);
+    }
+
+  return _gtk_css_bg_size_value_new (x, y);
+}
+
 GtkCssValue *
 _gtk_css_bg_size_value_parse (GtkCssParser *parser)
 {
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_BG_SIZE_VALUE_PRIVATE_H__
 #define __GTK_CSS_BG_SIZE_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssimageprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -28,6 +29,8 @@ G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_bg_size_value_new          (GtkCssValue            *x,
                                                      GtkCssValue            *y);
+GtkCssValue *   _gtk_css_bg_size_value_deserialize  (GtkCssBinaryReader     *reader,
+                                                     GtkCssBinaryTag         tag);
 GtkCssValue *   _gtk_css_bg_size_value_parse        (GtkCssParser           *parser);
 
 void            _gtk_css_bg_size_value_compute_size (const GtkCssValue      *bg_size,
@@ -0,0 +1,439 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcssbinaryprivate.h"
+
+#include "gtkcssarrayvalueprivate.h"
+#include "gtkcssbgsizevalueprivate.h"
+#include "gtkcssbordervalueprivate.h"
+#include "gtkcsscolorvalueprivate.h"
+#include "gtkcsscornervalueprivate.h"
+#include "gtkcsseasevalueprivate.h"
+#include "gtkcssenginevalueprivate.h"
+#include "gtkcssenumvalueprivate.h"
+#include "gtkcssimagevalueprivate.h"
+#include "gtkcssinheritvalueprivate.h"
+#include "gtkcssinitialvalueprivate.h"
+#include "gtkcssnumbervalueprivate.h"
+#include "gtkcsspositionvalueprivate.h"
+#include "gtkcssrepeatvalueprivate.h"
+#include "gtkcssrgbavalueprivate.h"
+#include "gtkcssshadowsvalueprivate.h"
+#include "gtkcssshadowvalueprivate.h"
+#include "gtkcssstringvalueprivate.h"
+
+#include <string.h>
+
+struct _GtkCssBinaryWriter {
+  GByteArray *data;
+};
+
+struct _GtkCssBinaryReader {
+  const guint8 *data;
+  gsize length;
+  gsize pos;
+  gboolean failed;
+};
+
+typedef GtkCssValue * (* GtkCssBinaryDeserializeFunc) (GtkCssBinaryReader *reader,
+                                                       GtkCssBinaryTag     tag);
+
+/* indexed by GtkCssBinaryTag, NONE and TEXT are handled by the reader */
+static const GtkCssBinaryDeserializeFunc deserialize_funcs[GTK_CSS_BINARY_N_TAGS] = {
+  NULL,
+  NULL,
+  _gtk_css_array_value_deserialize,
+  _gtk_css_bg_size_value_deserialize,
+  _gtk_css_border_value_deserialize,
+  _gtk_css_color_value_deserialize,
+  _gtk_css_corner_value_deserialize,
+  _gtk_css_ease_value_deserialize,
+  _gtk_css_engine_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_enum_value_deserialize,
+  _gtk_css_image_value_deserialize,
+  _gtk_css_inherit_value_deserialize,
+  _gtk_css_initial_value_deserialize,
+  _gtk_css_number_value_deserialize,
+  _gtk_css_position_value_deserialize,
+  _gtk_css_repeat_value_deserialize,
+  _gtk_css_repeat_value_deserialize,
+  _gtk_css_rgba_value_deserialize,
+  _gtk_css_shadows_value_deserialize,
+  _gtk_css_shadow_value_deserialize,
+  _gtk_css_string_value_deserialize,
+  _gtk_css_string_value_deserialize
+};
+
+/* WRITER */
+
+GtkCssBinaryWriter *
+_gtk_css_binary_writer_new (void)
+{
+  GtkCssBinaryWriter *writer;
+
+  writer = g_slice_new (GtkCssBinaryWriter);
+  writer->data = g_byte_array_new ();
+
+  return writer;
+}
+
+GBytes *
+_gtk_css_binary_writer_free_to_bytes (GtkCssBinaryWriter *writer)
+{
+  GBytes *bytes;
+
+  bytes = g_byte_array_free_to_bytes (writer->data);
+  g_slice_free (GtkCssBinaryWriter, writer);
+
+  return bytes;
+}
+
+void
+_gtk_css_binary_writer_put_uint (GtkCssBinaryWriter *writer,
+                                 guint32             i)
+{
+  g_byte_array_append (writer->data, (guint8 *) &i, sizeof (i));
+}
+
+void
+_gtk_css_binary_writer_put_int (GtkCssBinaryWriter *writer,
+                                gint32              i)
+{
+  g_byte_array_append (writer->data, (guint8 *) &i, sizeof (i));
+}
+
+void
+_gtk_css_binary_writer_put_int64 (GtkCssBinaryWriter *writer,
+                                  gint64              i)
+{
+  g_byte_array_append (writer->data, (guint8 *) &i, sizeof (i));
+}
+
+void
+_gtk_css_binary_writer_put_double (GtkCssBinaryWriter *writer,
+                                   double              d)
+{
+  g_byte_array_append (writer->data, (guint8 *) &d, sizeof (d));
+}
+
+/* Strings are stored with their length and terminating NUL, so the
+ * reader can hand out pointers into the data. */
+void
+_gtk_css_binary_writer_put_string (GtkCssBinaryWriter *writer,
+                                   const char         *string)
+{
+  gsize len;
+
+  if (string == NULL)
+    {
+      _gtk_css_binary_writer_put_uint (writer, G_MAXUINT32);
+      return;
+    }
+
+  len = strlen (string);
+  _gtk_css_binary_writer_put_uint (writer, len);
+  g_byte_array_append (writer->data, (guint8 *) string, len + 1);
+}
+
+/**
+ * _gtk_css_binary_writer_put_value:
+ * @writer: a #GtkCssBinaryWriter
+ * @value: (allow-none): the value to write
+ *
+ * Writes the binary form of @value. If @value or any value it
+ * contains has no binary form, nothing is written.
+ *
+ * Returns: %TRUE if @value was written
+ **/
+gboolean
+_gtk_css_binary_writer_put_value (GtkCssBinaryWriter *writer,
+                                  const GtkCssValue  *value)
+{
+  guint len;
+
+  if (value == NULL)
+    {
+      _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_NONE);
+      return TRUE;
+    }
+
+  if (value->class->serialize == NULL)
+    return FALSE;
+
+  len = writer->data->len;
+  if (!value->class->serialize (value, writer))
+    {
+      g_byte_array_set_size (writer->data, len);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * _gtk_css_binary_writer_put_value_or_text:
+ * @writer: a #GtkCssBinaryWriter
+ * @value: the value to write
+ *
+ * Writes the binary form of @value, or its CSS text if it has no
+ * binary form. Read it back with _gtk_css_binary_reader_get_value_or_text().
+ **/
+void
+_gtk_css_binary_writer_put_value_or_text (GtkCssBinaryWriter *writer,
+                                          const GtkCssValue  *value)
+{
+  char *text;
+
+  if (_gtk_css_binary_writer_put_value (writer, value))
+    return;
+
+  text = _gtk_css_value_to_string (value);
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_TEXT);
+  _gtk_css_binary_writer_put_string (writer, text);
+  g_free (text);
+}
+
+/* READER */
+
+GtkCssBinaryReader *
+_gtk_css_binary_reader_new (const guint8 *data,
+                            gsize         length)
+{
+  GtkCssBinaryReader *reader;
+
+  reader = g_slice_new0 (GtkCssBinaryReader);
+  reader->data = data;
+  reader->length = length;
+
+  return reader;
+}
+
+void
+_gtk_css_binary_reader_free (GtkCssBinaryReader *reader)
+{
+  g_slice_free (GtkCssBinaryReader, reader);
+}
+
+gboolean
+_gtk_css_binary_reader_failed (GtkCssBinaryReader *reader)
+{
+  return reader->failed;
+}
+
+/* Failures are sticky: once the data turns out to be invalid, all
+ * further reads return 0 or %NULL. */
+void
+_gtk_css_binary_reader_fail (GtkCssBinaryReader *reader)
+{
+  reader->failed = TRUE;
+}
+
+static gboolean
+gtk_css_binary_reader_get_data (GtkCssBinaryReader *reader,
+                                gpointer            data,
+                                gsize               size)
+{
+  if (reader->failed || reader->length - reader->pos < size)
+    {
+      reader->failed = TRUE;
+      memset (data, 0, size);
+      return FALSE;
+    }
+
+  memcpy (data, reader->data + reader->pos, size);
+  reader->pos += size;
+
+  return TRUE;
+}
+
+guint32
+_gtk_css_binary_reader_get_uint (GtkCssBinaryReader *reader)
+{
+  guint32 i;
+
+  gtk_css_binary_reader_get_data (reader, &i, sizeof (i));
+
+  return i;
+}
+
+gint32
+_gtk_css_binary_reader_get_int (GtkCssBinaryReader *reader)
+{
+  gint32 i;
+
+  gtk_css_binary_reader_get_data (reader, &i, sizeof (i));
+
+  return i;
+}
+
+gint64
+_gtk_css_binary_reader_get_int64 (GtkCssBinaryReader *reader)
+{
+  gint64 i;
+
+  gtk_css_binary_reader_get_data (reader, &i, sizeof (i));
+
+  return i;
+}
+
+double
+_gtk_css_binary_reader_get_double (GtkCssBinaryReader *reader)
+{
+  double d;
+
+  gtk_css_binary_reader_get_data (reader, &d, sizeof (d));
+
+  return d;
+}
+
+/* Returns a pointer into the reader's data, so copy it if it needs
+ * to outlive the reader. */
+const char *
+_gtk_css_binary_reader_get_string (GtkCssBinaryReader *reader)
+{
+  const char *string;
+  guint32 len;
+
+  len = _gtk_css_binary_reader_get_uint (reader);
+  if (reader->failed || len == G_MAXUINT32)
+    return NULL;
+
+  if (reader->length - reader->pos <= len ||
+      reader->data[reader->pos + len] != '\0')
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  string = (const char *) reader->data + reader->pos;
+  reader->pos += len + 1;
+
+  return string;
+}
+
+/**
+ * _gtk_css_binary_reader_get_value:
+ * @reader: a #GtkCssBinaryReader
+ *
+ * Reads a value written by _gtk_css_binary_writer_put_value().
+ * Check _gtk_css_binary_reader_failed() to tell a %NULL value
+ * from invalid data.
+ *
+ * Returns: (transfer full) (allow-none): the value
+ **/
+GtkCssValue *
+_gtk_css_binary_reader_get_value (GtkCssBinaryReader *reader)
+{
+  GtkCssValue *value;
+  guint32 tag;
+
+  tag = _gtk_css_binary_reader_get_uint (reader);
+  if (reader->failed || tag == GTK_CSS_BINARY_TAG_NONE)
+    return NULL;
+
+  if (tag >= GTK_CSS_BINARY_N_TAGS || deserialize_funcs[tag] == NULL)
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  value = deserialize_funcs[tag] (reader, tag);
+  if (value == NULL)
+    reader->failed = TRUE;
+
+  return value;
+}
+
+static void
+gtk_css_binary_reader_parser_error (GtkCssParser *parser,
+                                    const GError *error,
+                                    gpointer      user_data)
+{
+  GtkCssBinaryReader *reader = user_data;
+
+  reader->failed = TRUE;
+}
+
+/**
+ * _gtk_css_binary_reader_get_value_or_text:
+ * @reader: a #GtkCssBinaryReader
+ * @parse_func: function to parse the text form of the value
+ * @data: data to pass to @parse_func
+ *
+ * Reads a value written by _gtk_css_binary_writer_put_value_or_text(),
+ * parsing it with @parse_func if it was saved as text.
+ *
+ * Returns: (transfer full): the value or %NULL on failure
+ **/
+GtkCssValue *
+_gtk_css_binary_reader_get_value_or_text (GtkCssBinaryReader    *reader,
+                                          GtkCssBinaryParseFunc  parse_func,
+                                          gpointer               data)
+{
+  GtkCssParser *parser;
+  GtkCssValue *value;
+  const char *text;
+  gsize pos;
+
+  pos = reader->pos;
+  if (_gtk_css_binary_reader_get_uint (reader) != GTK_CSS_BINARY_TAG_TEXT)
+    {
+      reader->pos = pos;
+      value = _gtk_css_binary_reader_get_value (reader);
+      if (value == NULL)
+        reader->failed = TRUE;
+
+      return value;
+    }
+
+  text = _gtk_css_binary_reader_get_string (reader);
+  if (text == NULL)
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  parser = _gtk_css_parser_new (text, NULL, gtk_css_binary_reader_parser_error, reader);
+  value = parse_func (parser, data);
+  if (value && !_gtk_css_parser_is_eof (parser))
+    {
+      _gtk_css_value_unref (value);
+      value = NULL;
+    }
+  _gtk_css_parser_free (parser);
+
+  if (value == NULL || reader->failed)
+    {
+      reader->failed = TRUE;
+      if (value)
+        _gtk_css_value_unref (value);
+      return NULL;
+    }
+
+  return value;
+}
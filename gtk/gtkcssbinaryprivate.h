@@ -0,0 +1,106 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_BINARY_PRIVATE_H__
+#define __GTK_CSS_BINARY_PRIVATE_H__
+
+#include "gtkcssparserprivate.h"
+#include "gtkcssvalueprivate.h"
+
+G_BEGIN_DECLS
+
+/* The binary form is only ever read by the GTK+ version that wrote it,
+ * so it uses host byte order and has no compatibility guarantees.
+ */
+
+typedef enum {
+  GTK_CSS_BINARY_TAG_NONE,
+  GTK_CSS_BINARY_TAG_TEXT,
+  GTK_CSS_BINARY_TAG_ARRAY,
+  GTK_CSS_BINARY_TAG_BG_SIZE,
+  GTK_CSS_BINARY_TAG_BORDER,
+  GTK_CSS_BINARY_TAG_COLOR,
+  GTK_CSS_BINARY_TAG_CORNER,
+  GTK_CSS_BINARY_TAG_EASE,
+  GTK_CSS_BINARY_TAG_ENGINE,
+  GTK_CSS_BINARY_TAG_BORDER_STYLE,
+  GTK_CSS_BINARY_TAG_FONT_SIZE,
+  GTK_CSS_BINARY_TAG_FONT_STYLE,
+  GTK_CSS_BINARY_TAG_FONT_VARIANT,
+  GTK_CSS_BINARY_TAG_FONT_WEIGHT,
+  GTK_CSS_BINARY_TAG_AREA,
+  GTK_CSS_BINARY_TAG_DIRECTION,
+  GTK_CSS_BINARY_TAG_PLAY_STATE,
+  GTK_CSS_BINARY_TAG_FILL_MODE,
+  GTK_CSS_BINARY_TAG_IMAGE_EFFECT,
+  GTK_CSS_BINARY_TAG_IMAGE,
+  GTK_CSS_BINARY_TAG_INHERIT,
+  GTK_CSS_BINARY_TAG_INITIAL,
+  GTK_CSS_BINARY_TAG_NUMBER,
+  GTK_CSS_BINARY_TAG_POSITION,
+  GTK_CSS_BINARY_TAG_BACKGROUND_REPEAT,
+  GTK_CSS_BINARY_TAG_BORDER_REPEAT,
+  GTK_CSS_BINARY_TAG_RGBA,
+  GTK_CSS_BINARY_TAG_SHADOWS,
+  GTK_CSS_BINARY_TAG_SHADOW,
+  GTK_CSS_BINARY_TAG_STRING,
+  GTK_CSS_BINARY_TAG_IDENT,
+  /* < private > */
+  GTK_CSS_BINARY_N_TAGS
+} GtkCssBinaryTag;
+
+typedef GtkCssValue * (* GtkCssBinaryParseFunc) (GtkCssParser *parser,
+                                                 gpointer      data);
+
+GtkCssBinaryWriter *    _gtk_css_binary_writer_new              (void);
+GBytes *                _gtk_css_binary_writer_free_to_bytes    (GtkCssBinaryWriter     *writer);
+
+void                    _gtk_css_binary_writer_put_uint         (GtkCssBinaryWriter     *writer,
+                                                                 guint32                 i);
+void                    _gtk_css_binary_writer_put_int          (GtkCssBinaryWriter     *writer,
+                                                                 gint32                  i);
+void                    _gtk_css_binary_writer_put_int64        (GtkCssBinaryWriter     *writer,
+                                                                 gint64                  i);
+void                    _gtk_css_binary_writer_put_double       (GtkCssBinaryWriter     *writer,
+                                                                 double                  d);
+void                    _gtk_css_binary_writer_put_string       (GtkCssBinaryWriter     *writer,
+                                                                 const char             *string);
+gboolean                _gtk_css_binary_writer_put_value        (GtkCssBinaryWriter     *writer,
+                                                                 const GtkCssValue      *value);
+void                    _gtk_css_binary_writer_put_value_or_text(GtkCssBinaryWriter     *writer,
+                                                                 const GtkCssValue      *value);
+
+GtkCssBinaryReader *    _gtk_css_binary_reader_new              (const guint8           *data,
+                                                                 gsize                   length);
+void                    _gtk_css_binary_reader_free             (GtkCssBinaryReader     *reader);
+
+gboolean                _gtk_css_binary_reader_failed           (GtkCssBinaryReader     *reader);
+void                    _gtk_css_binary_reader_fail             (GtkCssBinaryReader     *reader);
+
+guint32                 _gtk_css_binary_reader_get_uint         (GtkCssBinaryReader     *reader);
+gint32                  _gtk_css_binary_reader_get_int          (GtkCssBinaryReader     *reader);
+gint64                  _gtk_css_binary_reader_get_int64        (GtkCssBinaryReader     *reader);
+double                  _gtk_css_binary_reader_get_double       (GtkCssBinaryReader     *reader);
+const char *            _gtk_css_binary_reader_get_string       (GtkCssBinaryReader     *reader);
+GtkCssValue *           _gtk_css_binary_reader_get_value        (GtkCssBinaryReader     *reader);
+GtkCssValue *           _gtk_css_binary_reader_get_value_or_text(GtkCssBinaryReader     *reader,
+                                                                 GtkCssBinaryParseFunc   parse_func,
+                                                                 gpointer                data);
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_BINARY_PRIVATE_H__ */
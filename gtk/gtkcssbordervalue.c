@@ -134,12 +134,30 @@ gtk_css_value_border_print (const GtkCssValue *value,
     g_string_append (string, " fill");
 }
 
+static gboolean
+gtk_css_value_border_serialize (const GtkCssValue  *value,
+                                GtkCssBinaryWriter *writer)
+{
+  guint i;
+
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_BORDER);
+  _gtk_css_binary_writer_put_uint (writer, value->fill);
+  for (i = 0; i < 4; i++)
+    {
+      if (!_gtk_css_binary_writer_put_value (writer, value->values[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER = {
   gtk_css_value_border_free,
   gtk_css_value_border_compute,
   gtk_css_value_border_equal,
   gtk_css_value_border_transition,
-  gtk_css_value_border_print
+  gtk_css_value_border_print,
+  gtk_css_value_border_serialize
 };
 
 GtkCssValue *
@@ -159,6 +177,27 @@ _gtk_css_border_value_new (GtkCssValue *top,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_border_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  GtkCssValue *result;
+  guint i;
+
+  result = _gtk_css_border_value_new (NULL, NULL, NULL, NULL);
+  result->fill = _gtk_css_binary_reader_get_uint (reader) ? TRUE : FALSE;
+  for (i = 0; i < 4; i++)
+    result->values[i] = _gtk_css_binary_reader_get_value (reader);
+
+  if (_gtk_css_binary_reader_failed (reader))
+    {
+      _gtk_css_value_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
+
 GtkCssValue *
 _gtk_css_border_value_parse (GtkCssParser           *parser,
                              GtkCssNumberParseFlags  flags,
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_BORDER_VALUE_PRIVATE_H__
 #define __GTK_CSS_BORDER_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -30,6 +31,8 @@ GtkCssValue *   _gtk_css_border_value_new           (GtkCssValue            *top
                                                      GtkCssValue            *right,
                                                      GtkCssValue            *bottom,
                                                      GtkCssValue            *left);
+GtkCssValue *   _gtk_css_border_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                     GtkCssBinaryTag         tag);
 GtkCssValue *   _gtk_css_border_value_parse         (GtkCssParser           *parser,
                                                      GtkCssNumberParseFlags  flags,
                                                      gboolean                allow_auto,
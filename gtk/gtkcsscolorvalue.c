@@ -459,12 +459,57 @@ gtk_css_value_color_print (const GtkCssValue *value,
     }
 }
 
+static gboolean
+gtk_css_value_color_serialize (const GtkCssValue  *value,
+                               GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_COLOR);
+  _gtk_css_binary_writer_put_uint (writer, value->type);
+
+  switch (value->type)
+    {
+    case COLOR_TYPE_LITERAL:
+      {
+        const GdkRGBA *rgba = _gtk_css_rgba_value_get_rgba (value->last_value);
+
+        _gtk_css_binary_writer_put_double (writer, rgba->red);
+        _gtk_css_binary_writer_put_double (writer, rgba->green);
+        _gtk_css_binary_writer_put_double (writer, rgba->blue);
+        _gtk_css_binary_writer_put_double (writer, rgba->alpha);
+      }
+      return TRUE;
+    case COLOR_TYPE_NAME:
+      _gtk_css_binary_writer_put_string (writer, value->sym_col.name);
+      return TRUE;
+    case COLOR_TYPE_SHADE:
+      _gtk_css_binary_writer_put_double (writer, value->sym_col.shade.factor);
+      return _gtk_css_binary_writer_put_value (writer, value->sym_col.shade.color);
+    case COLOR_TYPE_ALPHA:
+      _gtk_css_binary_writer_put_double (writer, value->sym_col.alpha.factor);
+      return _gtk_css_binary_writer_put_value (writer, value->sym_col.alpha.color);
+    case COLOR_TYPE_MIX:
+      _gtk_css_binary_writer_put_double (writer, value->sym_col.mix.factor);
+      return _gtk_css_binary_writer_put_value (writer, value->sym_col.mix.color1) &&
+             _gtk_css_binary_writer_put_value (writer, value->sym_col.mix.color2);
+    case COLOR_TYPE_WIN32:
+      _gtk_css_binary_writer_put_string (writer, value->sym_col.win32.theme_class);
+      _gtk_css_binary_writer_put_int (writer, value->sym_col.win32.id);
+      return TRUE;
+    case COLOR_TYPE_CURRENT_COLOR:
+      return TRUE;
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_COLOR = {
   gtk_css_value_color_free,
   gtk_css_value_color_compute,
   gtk_css_value_color_equal,
   gtk_css_value_color_transition,
-  gtk_css_value_color_print
+  gtk_css_value_color_print,
+  gtk_css_value_color_serialize
 };
 
 GtkCssValue *
@@ -581,6 +626,96 @@ _gtk_css_color_value_new_current_color (void)
   return _gtk_css_value_ref (&current_color);
 }
 
+static GtkCssValue *
+gtk_css_color_value_deserialize_color (GtkCssBinaryReader *reader)
+{
+  GtkCssValue *color;
+
+  color = _gtk_css_binary_reader_get_value (reader);
+  if (color != NULL && color->class != &GTK_CSS_VALUE_COLOR)
+    {
+      _gtk_css_value_unref (color);
+      color = NULL;
+    }
+
+  return color;
+}
+
+GtkCssValue *
+_gtk_css_color_value_deserialize (GtkCssBinaryReader *reader,
+                                  GtkCssBinaryTag     tag)
+{
+  GtkCssValue *value, *color1, *color2;
+  const char *string;
+  double factor;
+  ColorType type;
+  int id;
+
+  type = _gtk_css_binary_reader_get_uint (reader);
+
+  switch (type)
+    {
+    case COLOR_TYPE_LITERAL:
+      {
+        GdkRGBA rgba;
+
+        rgba.red = _gtk_css_binary_reader_get_double (reader);
+        rgba.green = _gtk_css_binary_reader_get_double (reader);
+        rgba.blue = _gtk_css_binary_reader_get_double (reader);
+        rgba.alpha = _gtk_css_binary_reader_get_double (reader);
+        if (_gtk_css_binary_reader_failed (reader))
+          return NULL;
+
+        return _gtk_css_color_value_new_literal (&rgba);
+      }
+    case COLOR_TYPE_NAME:
+      string = _gtk_css_binary_reader_get_string (reader);
+      if (string == NULL)
+        return NULL;
+
+      return _gtk_css_color_value_new_name (string);
+    case COLOR_TYPE_SHADE:
+    case COLOR_TYPE_ALPHA:
+      factor = _gtk_css_binary_reader_get_double (reader);
+      color1 = gtk_css_color_value_deserialize_color (reader);
+      if (color1 == NULL)
+        return NULL;
+
+      if (type == COLOR_TYPE_SHADE)
+        value = _gtk_css_color_value_new_shade (color1, factor);
+      else
+        value = _gtk_css_color_value_new_alpha (color1, factor);
+      _gtk_css_value_unref (color1);
+      return value;
+    case COLOR_TYPE_MIX:
+      factor = _gtk_css_binary_reader_get_double (reader);
+      color1 = gtk_css_color_value_deserialize_color (reader);
+      color2 = gtk_css_color_value_deserialize_color (reader);
+      if (color1 == NULL || color2 == NULL)
+        {
+          _gtk_css_value_unref (color1);
+          _gtk_css_value_unref (color2);
+          return NULL;
+        }
+
+      value = _gtk_css_color_value_new_mix (color1, color2, factor);
+      _gtk_css_value_unref (color1);
+      _gtk_css_value_unref (color2);
+      return value;
+    case COLOR_TYPE_WIN32:
+      string = _gtk_css_binary_reader_get_string (reader);
+      id = _gtk_css_binary_reader_get_int (reader);
+      if (string == NULL || _gtk_css_binary_reader_failed (reader))
+        return NULL;
+
+      return _gtk_css_color_value_new_win32 (string, id);
+    case COLOR_TYPE_CURRENT_COLOR:
+      return _gtk_css_color_value_new_current_color ();
+    default:
+      return NULL;
+    }
+}
+
 typedef enum {
   COLOR_RGBA,
   COLOR_RGB,
@@ -18,6 +18,7 @@
 #ifndef __GTK_CSS_COLOR_VALUE_PRIVATE_H__
 #define __GTK_CSS_COLOR_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 
@@ -41,6 +42,9 @@ GtkCssValue *   _gtk_css_color_value_new_win32          (const gchar    *theme_c
                                                          gint            id);
 GtkCssValue *   _gtk_css_color_value_new_current_color  (void);
 
+GtkCssValue *   _gtk_css_color_value_deserialize        (GtkCssBinaryReader *reader,
+                                                         GtkCssBinaryTag     tag);
+
 GtkCssValue *   _gtk_css_color_value_parse              (GtkCssParser   *parser);
 
 GtkCssValue *   _gtk_css_color_value_resolve            (GtkCssValue             *color,
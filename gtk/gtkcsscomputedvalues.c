@@ -19,6 +19,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "gtkprivate.h"
 #include "gtkcsscomputedvaluesprivate.h"
 
@@ -39,24 +41,90 @@
 
 G_DEFINE_TYPE (GtkCssComputedValues, _gtk_css_computed_values, G_TYPE_OBJECT)
 
+static guint last_serial = 0;
+
+static inline void
+gtk_css_computed_values_changed (GtkCssComputedValues *values)
+{
+  values->serial = ++last_serial;
+}
+
+#define MASK_GET(mask, id) (((mask)[(id) / 32] >> ((id) % 32)) & 1)
+#define MASK_SET(mask, id) ((mask)[(id) / 32] |= 1u << ((id) % 32))
+#define MASK_CLEAR(mask, id) ((mask)[(id) / 32] &= ~(1u << ((id) % 32)))
+
+static void
+maybe_unref_section (gpointer section)
+{
+  if (section)
+    gtk_css_section_unref (section);
+}
+
+static void
+gtk_css_computed_values_clear_value_array (GtkCssValue **array)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (array[i])
+        _gtk_css_value_unref (array[i]);
+    }
+
+  g_free (array);
+}
+
+static void
+gtk_css_computed_values_clear_sections (GtkCssSection **sections)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (sections[i])
+        gtk_css_section_unref (sections[i]);
+    }
+
+  g_free (sections);
+}
+
 static void
 gtk_css_computed_values_dispose (GObject *object)
 {
   GtkCssComputedValues *values = GTK_CSS_COMPUTED_VALUES (object);
+  guint i;
 
-  if (values->values)
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
     {
-      g_ptr_array_unref (values->values);
-      values->values = NULL;
+      if (values->values[i])
+        {
+          _gtk_css_value_unref (values->values[i]);
+          values->values[i] = NULL;
+        }
     }
   if (values->sections)
     {
-      g_ptr_array_unref (values->sections);
+      gtk_css_computed_values_clear_sections (values->sections);
       values->sections = NULL;
     }
+  if (values->specified)
+    {
+      gtk_css_computed_values_clear_value_array (values->specified);
+      values->specified = NULL;
+    }
+  if (values->custom_values)
+    {
+      g_ptr_array_unref (values->custom_values);
+      values->custom_values = NULL;
+    }
+  if (values->custom_sections)
+    {
+      g_ptr_array_unref (values->custom_sections);
+      values->custom_sections = NULL;
+    }
   if (values->animated_values)
     {
-      g_ptr_array_unref (values->animated_values);
+      gtk_css_computed_values_clear_value_array (values->animated_values);
       values->animated_values = NULL;
     }
 
@@ -66,35 +134,18 @@ gtk_css_computed_values_dispose (GObject *object)
   G_OBJECT_CLASS (_gtk_css_computed_values_parent_class)->dispose (object);
 }
 
-static void
-gtk_css_computed_values_finalize (GObject *object)
-{
-  GtkCssComputedValues *values = GTK_CSS_COMPUTED_VALUES (object);
-
-  _gtk_bitmask_free (values->depends_on_parent);
-  _gtk_bitmask_free (values->equals_parent);
-  _gtk_bitmask_free (values->depends_on_color);
-  _gtk_bitmask_free (values->depends_on_font_size);
-
-  G_OBJECT_CLASS (_gtk_css_computed_values_parent_class)->finalize (object);
-}
-
 static void
 _gtk_css_computed_values_class_init (GtkCssComputedValuesClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_css_computed_values_dispose;
-  object_class->finalize = gtk_css_computed_values_finalize;
 }
 
 static void
 _gtk_css_computed_values_init (GtkCssComputedValues *values)
 {
-  values->depends_on_parent = _gtk_bitmask_new ();
-  values->equals_parent = _gtk_bitmask_new ();
-  values->depends_on_color = _gtk_bitmask_new ();
-  values->depends_on_font_size = _gtk_bitmask_new ();
+  gtk_css_computed_values_changed (values);
 }
 
 GtkCssComputedValues *
@@ -103,11 +154,137 @@ _gtk_css_computed_values_new (void)
   return g_object_new (GTK_TYPE_CSS_COMPUTED_VALUES, NULL);
 }
 
+static GPtrArray *
+copy_ptr_array (GPtrArray      *array,
+                GBoxedCopyFunc  ref_func,
+                GDestroyNotify  unref_func)
+{
+  GPtrArray *copy;
+  guint i;
+
+  if (array == NULL)
+    return NULL;
+
+  copy = g_ptr_array_new_full (array->len, unref_func);
+  for (i = 0; i < array->len; i++)
+    {
+      gpointer item = g_ptr_array_index (array, i);
+
+      g_ptr_array_add (copy, item ? ref_func (item) : NULL);
+    }
+
+  return copy;
+}
+
+/*
+ * _gtk_css_computed_values_copy:
+ * @values: the values to copy
+ *
+ * Creates a new #GtkCssComputedValues containing the same values,
+ * sections, dependencies and running animations as @values. The
+ * copy can be modified without affecting @values.
+ *
+ * Returns: a new #GtkCssComputedValues
+ */
+GtkCssComputedValues *
+_gtk_css_computed_values_copy (GtkCssComputedValues *values)
+{
+  GtkCssComputedValues *copy;
+  guint i;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
+
+  copy = _gtk_css_computed_values_new ();
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (values->values[i])
+        copy->values[i] = _gtk_css_value_ref (values->values[i]);
+    }
+  if (values->sections)
+    {
+      copy->sections = g_new0 (GtkCssSection *, GTK_CSS_PROPERTY_N_PROPERTIES);
+      for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+        {
+          if (values->sections[i])
+            copy->sections[i] = gtk_css_section_ref (values->sections[i]);
+        }
+    }
+  if (values->specified)
+    {
+      copy->specified = g_new0 (GtkCssValue *, GTK_CSS_PROPERTY_N_PROPERTIES);
+      for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+        {
+          if (values->specified[i])
+            copy->specified[i] = _gtk_css_value_ref (values->specified[i]);
+        }
+    }
+  copy->custom_values = copy_ptr_array (values->custom_values,
+                                        (GBoxedCopyFunc) _gtk_css_value_ref,
+                                        (GDestroyNotify) _gtk_css_value_unref);
+  copy->custom_sections = copy_ptr_array (values->custom_sections,
+                                          (GBoxedCopyFunc) gtk_css_section_ref,
+                                          maybe_unref_section);
+
+  if (values->animated_values)
+    {
+      copy->animated_values = g_new0 (GtkCssValue *, GTK_CSS_PROPERTY_N_PROPERTIES);
+      for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+        {
+          if (values->animated_values[i])
+            copy->animated_values[i] = _gtk_css_value_ref (values->animated_values[i]);
+        }
+    }
+  copy->current_time = values->current_time;
+  copy->animations = g_slist_copy_deep (values->animations, (GCopyFunc) g_object_ref, NULL);
+
+  memcpy (copy->depends_on_parent, values->depends_on_parent, sizeof (GtkCssComputedMask));
+  memcpy (copy->equals_parent, values->equals_parent, sizeof (GtkCssComputedMask));
+  memcpy (copy->depends_on_color, values->depends_on_color, sizeof (GtkCssComputedMask));
+  memcpy (copy->depends_on_font_size, values->depends_on_font_size, sizeof (GtkCssComputedMask));
+  memcpy (copy->has_specified, values->has_specified, sizeof (GtkCssComputedMask));
+
+  return copy;
+}
+
+/*
+ * _gtk_css_computed_values_get_serial:
+ * @values: the values
+ *
+ * Gets the serial of @values. The serial is unique among all
+ * #GtkCssComputedValues and changes whenever a value is set, so it
+ * can be used to check if values changed since they were last looked
+ * at.
+ *
+ * Returns: the serial
+ */
+guint
+_gtk_css_computed_values_get_serial (GtkCssComputedValues *values)
+{
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), 0);
+
+  return values->serial;
+}
+
+/* Remembers the declaration the value of @id was computed from.
+ * Only styles that have declarations need to store them, so the
+ * array is allocated on demand. A %NULL @declared still marks the
+ * declaration as known.
+ */
 static void
-maybe_unref_section (gpointer section)
+gtk_css_computed_values_set_specified (GtkCssComputedValues *values,
+                                       guint                 id,
+                                       GtkCssValue          *declared)
 {
-  if (section)
-    gtk_css_section_unref (section);
+  if (declared)
+    {
+      if (values->specified == NULL)
+        values->specified = g_new0 (GtkCssValue *, GTK_CSS_PROPERTY_N_PROPERTIES);
+
+      values->specified[id] = _gtk_css_value_ref (declared);
+    }
+
+  MASK_SET (values->has_specified, id);
 }
 
 void
@@ -120,12 +297,14 @@ _gtk_css_computed_values_compute_value (GtkCssComputedValues    *values,
                                         GtkCssSection           *section)
 {
   GtkCssDependencies dependencies;
-  GtkCssValue *value;
+  GtkCssValue *value, *declared;
 
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER_PRIVATE (provider));
   gtk_internal_return_if_fail (parent_values == NULL || GTK_IS_CSS_COMPUTED_VALUES (parent_values));
 
+  declared = specified;
+
   /* http://www.w3.org/TR/css3-cascade/#cascade
    * Then, for every element, the value for each property can be found
    * by following this pseudo-algorithm:
@@ -145,12 +324,95 @@ _gtk_css_computed_values_compute_value (GtkCssComputedValues    *values,
 
   value = _gtk_css_value_compute (specified, id, provider, scale, values, parent_values, &dependencies);
 
+  /* Values are immutable, so if we computed a value identical to the
+   * parent's, keep the parent's value instead of our own copy. Setting
+   * the value again replaces it without touching the parent. Inherited
+   * values are the parent's value already. */
+  if (parent_values && id < GTK_CSS_PROPERTY_N_PROPERTIES &&
+      parent_values->values[id] != NULL &&
+      parent_values->values[id] != value &&
+      _gtk_css_value_equal (parent_values->values[id], value))
+    {
+      _gtk_css_value_unref (value);
+      value = _gtk_css_value_ref (parent_values->values[id]);
+    }
+
   _gtk_css_computed_values_set_value (values, id, value, dependencies, section);
 
+  if (id < GTK_CSS_PROPERTY_N_PROPERTIES)
+    {
+      gtk_css_computed_values_set_specified (values, id, declared);
+    }
+
   _gtk_css_value_unref (value);
   _gtk_css_value_unref (specified);
 }
 
+/*
+ * _gtk_css_computed_values_reuse_value:
+ * @values: the values to set the value in
+ * @previous: values computed for the same widget before it changed
+ * @id: id of the property
+ * @specified: (allow-none): the winning declaration for @id
+ * @section: (allow-none): the section @specified was defined in
+ *
+ * Sets the value of @id to the one in @previous if computing
+ * @specified would produce the same value. This is the case when
+ * @previous was computed from an equal declaration and the value
+ * neither depends on the parent nor on a color or font size that
+ * changed. Values for properties with lower ids must have been set
+ * already.
+ *
+ * The provider and scale must not have changed since @previous was
+ * computed.
+ *
+ * Returns: %TRUE if the value was reused, %FALSE if it needs to be
+ *     computed with _gtk_css_computed_values_compute_value().
+ */
+gboolean
+_gtk_css_computed_values_reuse_value (GtkCssComputedValues *values,
+                                      GtkCssComputedValues *previous,
+                                      guint                 id,
+                                      GtkCssValue          *specified,
+                                      GtkCssSection        *section)
+{
+  GtkCssDependencies dependencies;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), FALSE);
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (previous), FALSE);
+
+  /* Inheriting is cheap, so don't bother tracking the parent */
+  if (id >= GTK_CSS_PROPERTY_N_PROPERTIES ||
+      !MASK_GET (previous->has_specified, id) ||
+      MASK_GET (previous->depends_on_parent, id))
+    return FALSE;
+
+  if (!_gtk_css_value_equal0 (previous->specified ? previous->specified[id] : NULL, specified))
+    return FALSE;
+
+  dependencies = 0;
+  if (MASK_GET (previous->depends_on_color, id))
+    {
+      if (!_gtk_css_value_equal0 (values->values[GTK_CSS_PROPERTY_COLOR],
+                                  previous->values[GTK_CSS_PROPERTY_COLOR]))
+        return FALSE;
+      dependencies |= GTK_CSS_DEPENDS_ON_COLOR;
+    }
+  if (MASK_GET (previous->depends_on_font_size, id))
+    {
+      if (!_gtk_css_value_equal0 (values->values[GTK_CSS_PROPERTY_FONT_SIZE],
+                                  previous->values[GTK_CSS_PROPERTY_FONT_SIZE]))
+        return FALSE;
+      dependencies |= GTK_CSS_DEPENDS_ON_FONT_SIZE;
+    }
+
+  _gtk_css_computed_values_set_value (values, id, previous->values[id], dependencies, section);
+
+  gtk_css_computed_values_set_specified (values, id, specified);
+
+  return TRUE;
+}
+
 void
 _gtk_css_computed_values_set_animated_value (GtkCssComputedValues *values,
                                              guint                 id,
@@ -158,16 +420,58 @@ _gtk_css_computed_values_set_animated_value (GtkCssComputedValues *values,
 {
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
   gtk_internal_return_if_fail (value != NULL);
+  /* Custom properties can't be animated */
+  gtk_internal_return_if_fail (id < GTK_CSS_PROPERTY_N_PROPERTIES);
 
   if (values->animated_values == NULL)
-    values->animated_values = g_ptr_array_new_with_free_func ((GDestroyNotify)_gtk_css_value_unref);
-  if (id >= values->animated_values->len)
-   g_ptr_array_set_size (values->animated_values, id + 1);
+    values->animated_values = g_new0 (GtkCssValue *, GTK_CSS_PROPERTY_N_PROPERTIES);
+
+  if (values->animated_values[id])
+    _gtk_css_value_unref (values->animated_values[id]);
+  values->animated_values[id] = _gtk_css_value_ref (value);
+
+  gtk_css_computed_values_changed (values);
+}
 
-  if (g_ptr_array_index (values->animated_values, id))
-    _gtk_css_value_unref (g_ptr_array_index (values->animated_values, id));
-  g_ptr_array_index (values->animated_values, id) = _gtk_css_value_ref (value);
+/* Custom properties registered with the deprecated
+ * gtk_style_properties_register_property() get ids after the builtin
+ * ones. They are rare, so they are kept in separate arrays. They can
+ * only depend on the parent by inheriting, and
+ * _gtk_css_computed_values_compute_dependencies() assumes they always
+ * do, so we don't need to track their dependencies.
+ */
+static void
+gtk_css_computed_values_set_custom_value (GtkCssComputedValues *values,
+                                          guint                 id,
+                                          GtkCssValue          *value,
+                                          GtkCssSection        *section)
+{
+  id -= GTK_CSS_PROPERTY_N_PROPERTIES;
 
+  if (values->custom_values == NULL)
+    values->custom_values = g_ptr_array_new_with_free_func ((GDestroyNotify)_gtk_css_value_unref);
+  if (id >= values->custom_values->len)
+   g_ptr_array_set_size (values->custom_values, id + 1);
+
+  if (g_ptr_array_index (values->custom_values, id))
+    _gtk_css_value_unref (g_ptr_array_index (values->custom_values, id));
+  g_ptr_array_index (values->custom_values, id) = _gtk_css_value_ref (value);
+
+  if (values->custom_sections && values->custom_sections->len > id && g_ptr_array_index (values->custom_sections, id))
+    {
+      gtk_css_section_unref (g_ptr_array_index (values->custom_sections, id));
+      g_ptr_array_index (values->custom_sections, id) = NULL;
+    }
+
+  if (section)
+    {
+      if (values->custom_sections == NULL)
+        values->custom_sections = g_ptr_array_new_with_free_func (maybe_unref_section);
+      if (values->custom_sections->len <= id)
+        g_ptr_array_set_size (values->custom_sections, id + 1);
+
+      g_ptr_array_index (values->custom_sections, id) = gtk_css_section_ref (section);
+    }
 }
 
 void
@@ -179,39 +483,58 @@ _gtk_css_computed_values_set_value (GtkCssComputedValues *values,
 {
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
 
-  if (values->values == NULL)
-    values->values = g_ptr_array_new_full (_gtk_css_style_property_get_n_properties (),
-					   (GDestroyNotify)_gtk_css_value_unref);
-  if (id >= values->values->len)
-   g_ptr_array_set_size (values->values, id + 1);
+  gtk_css_computed_values_changed (values);
 
-  if (g_ptr_array_index (values->values, id))
-    _gtk_css_value_unref (g_ptr_array_index (values->values, id));
-  g_ptr_array_index (values->values, id) = _gtk_css_value_ref (value);
+  if (id >= GTK_CSS_PROPERTY_N_PROPERTIES)
+    {
+      gtk_css_computed_values_set_custom_value (values, id, value, section);
+      return;
+    }
 
+  /* Values equal to the parent's are the parent's GtkCssValue, so
+   * we only keep another reference to it here. */
+  _gtk_css_value_ref (value);
+  if (values->values[id])
+    _gtk_css_value_unref (values->values[id]);
+  values->values[id] = value;
+
+  /* Values can be set again when they are recomputed, so clear
+   * dependencies that no longer apply */
+  MASK_CLEAR (values->depends_on_parent, id);
+  MASK_CLEAR (values->equals_parent, id);
+  MASK_CLEAR (values->depends_on_color, id);
+  MASK_CLEAR (values->depends_on_font_size, id);
   if (dependencies & (GTK_CSS_DEPENDS_ON_PARENT | GTK_CSS_EQUALS_PARENT))
-    values->depends_on_parent = _gtk_bitmask_set (values->depends_on_parent, id, TRUE);
+    MASK_SET (values->depends_on_parent, id);
   if (dependencies & (GTK_CSS_EQUALS_PARENT))
-    values->equals_parent = _gtk_bitmask_set (values->equals_parent, id, TRUE);
+    MASK_SET (values->equals_parent, id);
   if (dependencies & (GTK_CSS_DEPENDS_ON_COLOR))
-    values->depends_on_color = _gtk_bitmask_set (values->depends_on_color, id, TRUE);
+    MASK_SET (values->depends_on_color, id);
   if (dependencies & (GTK_CSS_DEPENDS_ON_FONT_SIZE))
-    values->depends_on_font_size = _gtk_bitmask_set (values->depends_on_font_size, id, TRUE);
+    MASK_SET (values->depends_on_font_size, id);
 
-  if (values->sections && values->sections->len > id && g_ptr_array_index (values->sections, id))
+  /* The value wasn't computed from a declaration we know about */
+  MASK_CLEAR (values->has_specified, id);
+  if (values->specified && values->specified[id])
     {
-      gtk_css_section_unref (g_ptr_array_index (values->sections, id));
-      g_ptr_array_index (values->sections, id) = NULL;
+      _gtk_css_value_unref (values->specified[id]);
+      values->specified[id] = NULL;
+    }
+
+  /* Sections are only passed in when GTK_CSS_DEBUG keeps them around,
+   * so only allocate the array when we get one */
+  if (values->sections && values->sections[id])
+    {
+      gtk_css_section_unref (values->sections[id]);
+      values->sections[id] = NULL;
     }
 
   if (section)
     {
       if (values->sections == NULL)
-        values->sections = g_ptr_array_new_with_free_func (maybe_unref_section);
-      if (values->sections->len <= id)
-        g_ptr_array_set_size (values->sections, id + 1);
+        values->sections = g_new0 (GtkCssSection *, GTK_CSS_PROPERTY_N_PROPERTIES);
 
-      g_ptr_array_index (values->sections, id) = gtk_css_section_ref (section);
+      values->sections[id] = gtk_css_section_ref (section);
     }
 }
 
@@ -222,9 +545,9 @@ _gtk_css_computed_values_get_value (GtkCssComputedValues *values,
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
   if (values->animated_values &&
-      id < values->animated_values->len &&
-      g_ptr_array_index (values->animated_values, id))
-    return g_ptr_array_index (values->animated_values, id);
+      id < GTK_CSS_PROPERTY_N_PROPERTIES &&
+      values->animated_values[id])
+    return values->animated_values[id];
 
   return _gtk_css_computed_values_get_intrinsic_value (values, id);
 }
@@ -235,11 +558,15 @@ _gtk_css_computed_values_get_intrinsic_value (GtkCssComputedValues *values,
 {
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
-  if (values->values == NULL ||
-      id >= values->values->len)
+  if (G_LIKELY (id < GTK_CSS_PROPERTY_N_PROPERTIES))
+    return values->values[id];
+
+  id -= GTK_CSS_PROPERTY_N_PROPERTIES;
+  if (values->custom_values == NULL ||
+      id >= values->custom_values->len)
     return NULL;
 
-  return g_ptr_array_index (values->values, id);
+  return g_ptr_array_index (values->custom_values, id);
 }
 
 GtkCssSection *
@@ -248,11 +575,15 @@ _gtk_css_computed_values_get_section (GtkCssComputedValues *values,
 {
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), NULL);
 
-  if (values->sections == NULL ||
-      id >= values->sections->len)
+  if (G_LIKELY (id < GTK_CSS_PROPERTY_N_PROPERTIES))
+    return values->sections ? values->sections[id] : NULL;
+
+  id -= GTK_CSS_PROPERTY_N_PROPERTIES;
+  if (values->custom_sections == NULL ||
+      id >= values->custom_sections->len)
     return NULL;
 
-  return g_ptr_array_index (values->sections, id);
+  return g_ptr_array_index (values->custom_sections, id);
 }
 
 GtkBitmask *
@@ -262,15 +593,20 @@ _gtk_css_computed_values_get_difference (GtkCssComputedValues *values,
   GtkBitmask *result;
   guint i, len;
 
-  len = MIN (values->values->len, other->values->len);
   result = _gtk_bitmask_new ();
-  if (values->values->len != other->values->len)
-    result = _gtk_bitmask_invert_range (result, len, MAX (values->values->len, other->values->len));
-  
-  for (i = 0; i < len; i++)
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (!_gtk_css_value_equal0 (values->values[i], other->values[i]))
+        result = _gtk_bitmask_set (result, i, TRUE);
+    }
+
+  len = MAX (values->custom_values ? values->custom_values->len : 0,
+             other->custom_values ? other->custom_values->len : 0);
+  for (i = GTK_CSS_PROPERTY_N_PROPERTIES; i < GTK_CSS_PROPERTY_N_PROPERTIES + len; i++)
     {
-      if (!_gtk_css_value_equal (g_ptr_array_index (values->values, i),
-                                 g_ptr_array_index (other->values, i)))
+      if (!_gtk_css_value_equal0 (_gtk_css_computed_values_get_intrinsic_value (values, i),
+                                  _gtk_css_computed_values_get_intrinsic_value (other, i)))
         result = _gtk_bitmask_set (result, i, TRUE);
     }
 
@@ -529,7 +865,7 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
                                   gint64                timestamp)
 {
   GtkBitmask *changed;
-  GPtrArray *old_computed_values;
+  GtkCssValue **old_computed_values;
   GSList *list;
   guint i;
 
@@ -540,6 +876,9 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
   old_computed_values = values->animated_values;
   values->animated_values = NULL;
 
+  if (old_computed_values || values->animations)
+    gtk_css_computed_values_changed (values);
+
   list = values->animations;
   while (list)
     {
@@ -565,15 +904,15 @@ _gtk_css_computed_values_advance (GtkCssComputedValues *values,
     {
       GtkCssValue *old_animated, *new_animated;
 
-      old_animated = old_computed_values && i < old_computed_values->len ? g_ptr_array_index (old_computed_values, i) : NULL;
-      new_animated = values->animated_values && i < values->animated_values->len ? g_ptr_array_index (values->animated_values, i) : NULL;
+      old_animated = old_computed_values ? old_computed_values[i] : NULL;
+      new_animated = values->animated_values ? values->animated_values[i] : NULL;
 
       if (!_gtk_css_value_equal0 (old_animated, new_animated))
         changed = _gtk_bitmask_set (changed, i, TRUE);
     }
 
   if (old_computed_values)
-    g_ptr_array_unref (old_computed_values);
+    gtk_css_computed_values_clear_value_array (old_computed_values);
 
   return changed;
 }
@@ -599,14 +938,66 @@ _gtk_css_computed_values_cancel_animations (GtkCssComputedValues *values)
 {
   gtk_internal_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
 
+  if (values->animated_values == NULL && values->animations == NULL)
+    return;
+
   if (values->animated_values)
     {
-      g_ptr_array_unref (values->animated_values);
+      gtk_css_computed_values_clear_value_array (values->animated_values);
       values->animated_values = NULL;
     }
 
   g_slist_free_full (values->animations, g_object_unref);
   values->animations = NULL;
+
+  gtk_css_computed_values_changed (values);
+}
+
+/*
+ * _gtk_css_computed_values_may_animate:
+ * @values: the values
+ *
+ * Checks if _gtk_css_computed_values_create_animations() might add
+ * transitions or animations to @values. If this returns %FALSE, it is
+ * guaranteed to not modify @values.
+ *
+ * Returns: %TRUE if @values defines transitions or animations
+ */
+gboolean
+_gtk_css_computed_values_may_animate (GtkCssComputedValues *values)
+{
+  GtkCssValue *durations, *delays, *animations;
+  guint i;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), TRUE);
+
+  if (values->animations)
+    return TRUE;
+
+  durations = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_TRANSITION_DURATION);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (durations); i++)
+    {
+      if (_gtk_css_number_value_get (_gtk_css_array_value_get_nth (durations, i), 100) != 0.0)
+        return TRUE;
+    }
+
+  delays = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_TRANSITION_DELAY);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (delays); i++)
+    {
+      if (_gtk_css_number_value_get (_gtk_css_array_value_get_nth (delays, i), 100) != 0.0)
+        return TRUE;
+    }
+
+  animations = _gtk_css_computed_values_get_value (values, GTK_CSS_PROPERTY_ANIMATION_NAME);
+  for (i = 0; i < _gtk_css_array_value_get_n_values (animations); i++)
+    {
+      const char *name = _gtk_css_ident_value_get (_gtk_css_array_value_get_nth (animations, i));
+
+      if (g_ascii_strcasecmp (name, "none") != 0)
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 GtkBitmask *
@@ -614,15 +1005,36 @@ _gtk_css_computed_values_compute_dependencies (GtkCssComputedValues *values,
                                                const GtkBitmask     *parent_changes)
 {
   GtkBitmask *changes;
+  gboolean color_changed, font_size_changed;
+  guint i, n;
 
   gtk_internal_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), _gtk_bitmask_new ());
 
-  changes = _gtk_bitmask_copy (parent_changes);
-  changes = _gtk_bitmask_intersect (changes, values->depends_on_parent);
-  if (_gtk_bitmask_get (changes, GTK_CSS_PROPERTY_COLOR))
-    changes = _gtk_bitmask_union (changes, values->depends_on_color);
-  if (_gtk_bitmask_get (changes, GTK_CSS_PROPERTY_FONT_SIZE))
-    changes = _gtk_bitmask_union (changes, values->depends_on_font_size);
+  changes = _gtk_bitmask_new ();
+
+  if (_gtk_bitmask_is_empty (parent_changes))
+    return changes;
+
+  color_changed = MASK_GET (values->depends_on_parent, GTK_CSS_PROPERTY_COLOR) &&
+                  _gtk_bitmask_get (parent_changes, GTK_CSS_PROPERTY_COLOR);
+  font_size_changed = MASK_GET (values->depends_on_parent, GTK_CSS_PROPERTY_FONT_SIZE) &&
+                      _gtk_bitmask_get (parent_changes, GTK_CSS_PROPERTY_FONT_SIZE);
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if ((MASK_GET (values->depends_on_parent, i) && _gtk_bitmask_get (parent_changes, i)) ||
+          (color_changed && MASK_GET (values->depends_on_color, i)) ||
+          (font_size_changed && MASK_GET (values->depends_on_font_size, i)))
+        changes = _gtk_bitmask_set (changes, i, TRUE);
+    }
+
+  /* see gtk_css_computed_values_set_custom_value() */
+  n = _gtk_css_style_property_get_n_properties ();
+  for (i = GTK_CSS_PROPERTY_N_PROPERTIES; i < n; i++)
+    {
+      if (_gtk_bitmask_get (parent_changes, i))
+        changes = _gtk_bitmask_set (changes, i, TRUE);
+    }
 
   return changes;
 }
@@ -38,21 +38,30 @@ G_BEGIN_DECLS
 /* typedef struct _GtkCssComputedValues           GtkCssComputedValues; */
 typedef struct _GtkCssComputedValuesClass      GtkCssComputedValuesClass;
 
+/* one bit per builtin property */
+typedef guint32 GtkCssComputedMask[(GTK_CSS_PROPERTY_N_PROPERTIES + 31) / 32];
+
 struct _GtkCssComputedValues
 {
   GObject parent;
 
-  GPtrArray             *values;               /* the unanimated (aka intrinsic) values */
-  GPtrArray             *sections;             /* sections the values are defined in */
+  GtkCssValue           *values[GTK_CSS_PROPERTY_N_PROPERTIES];   /* the unanimated (aka intrinsic) values */
+  GtkCssSection        **sections;             /* NULL or GTK_CSS_PROPERTY_N_PROPERTIES sections the values are defined in */
+  GPtrArray             *custom_values;        /* NULL or intrinsic values of custom properties */
+  GPtrArray             *custom_sections;      /* NULL or sections of custom properties */
 
-  GPtrArray             *animated_values;      /* NULL or array of animated values/NULL if not animated */
+  GtkCssValue          **specified;            /* NULL or GTK_CSS_PROPERTY_N_PROPERTIES winning declarations the values were computed from/NULL if none */
+  GtkCssValue          **animated_values;      /* NULL or GTK_CSS_PROPERTY_N_PROPERTIES animated values/NULL if not animated */
   gint64                 current_time;         /* the current time in our world */
   GSList                *animations;           /* the running animations, least important one first */
 
-  GtkBitmask            *depends_on_parent;    /* for intrinsic values */
-  GtkBitmask            *equals_parent;        /* dito */
-  GtkBitmask            *depends_on_color;     /* dito */
-  GtkBitmask            *depends_on_font_size; /* dito */
+  GtkCssComputedMask     depends_on_parent;    /* for intrinsic values */
+  GtkCssComputedMask     equals_parent;        /* dito */
+  GtkCssComputedMask     depends_on_color;     /* dito */
+  GtkCssComputedMask     depends_on_font_size; /* dito */
+  GtkCssComputedMask     has_specified;        /* set if specified is known, see _gtk_css_computed_values_reuse_value() */
+
+  guint                  serial;               /* changes whenever any value changes */
 };
 
 struct _GtkCssComputedValuesClass
@@ -63,6 +72,8 @@ struct _GtkCssComputedValuesClass
 GType                   _gtk_css_computed_values_get_type             (void) G_GNUC_CONST;
 
 GtkCssComputedValues *  _gtk_css_computed_values_new                  (void);
+GtkCssComputedValues *  _gtk_css_computed_values_copy                 (GtkCssComputedValues     *values);
+guint                   _gtk_css_computed_values_get_serial           (GtkCssComputedValues     *values);
 
 void                    _gtk_css_computed_values_compute_value        (GtkCssComputedValues     *values,
                                                                        GtkStyleProviderPrivate  *provider,
@@ -76,6 +87,11 @@ void                    _gtk_css_computed_values_set_value            (GtkCssCom
                                                                        GtkCssValue              *value,
                                                                        GtkCssDependencies        dependencies,
                                                                        GtkCssSection            *section);
+gboolean                _gtk_css_computed_values_reuse_value          (GtkCssComputedValues     *values,
+                                                                       GtkCssComputedValues     *previous,
+                                                                       guint                     id,
+                                                                       GtkCssValue              *specified,
+                                                                       GtkCssSection            *section);
 void                    _gtk_css_computed_values_set_animated_value   (GtkCssComputedValues     *values,
                                                                        guint                     id,
                                                                        GtkCssValue              *value);
@@ -101,6 +117,7 @@ GtkBitmask *            _gtk_css_computed_values_advance              (GtkCssCom
                                                                        gint64                    timestamp);
 void                    _gtk_css_computed_values_cancel_animations    (GtkCssComputedValues     *values);
 gboolean                _gtk_css_computed_values_is_static            (GtkCssComputedValues     *values);
+gboolean                _gtk_css_computed_values_may_animate          (GtkCssComputedValues     *values);
 
 G_END_DECLS
 
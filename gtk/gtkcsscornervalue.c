@@ -102,12 +102,23 @@ gtk_css_value_corner_print (const GtkCssValue *corner,
     }
 }
 
+static gboolean
+gtk_css_value_corner_serialize (const GtkCssValue  *value,
+                               GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_CORNER);
+
+  return _gtk_css_binary_writer_put_value (writer, value->x) &&
+         _gtk_css_binary_writer_put_value (writer, value->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_CORNER = {
   gtk_css_value_corner_free,
   gtk_css_value_corner_compute,
   gtk_css_value_corner_equal,
   gtk_css_value_corner_transition,
-  gtk_css_value_corner_print
+  gtk_css_value_corner_print,
+  gtk_css_value_corner_serialize
 };
 
 GtkCssValue *
@@ -123,6 +134,24 @@ _gtk_css_corner_value_new (GtkCssValue *x,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_corner_value_deserialize (GtkCssBinaryReader *reader,
+                                  GtkCssBinaryTag     tag)
+{
+  GtkCssValue *x, *y;
+
+  x = _gtk_css_binary_reader_get_value (reader);
+  y = _gtk_css_binary_reader_get_value (reader);
+  if (x == NULL || y == NULL)
+    {
+      _gtk_css_value_unref (x);
+      _gtk_css_value_unref (y);
+      return NULL;
+    }
+
+  return _gtk_css_corner_value_new (x, y);
+}
+
 GtkCssValue *
 _gtk_css_corner_value_parse (GtkCssParser *parser)
 {
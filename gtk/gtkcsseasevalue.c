@@ -136,12 +136,38 @@ gtk_css_value_ease_print (const GtkCssValue *ease,
     }
 }
 
+static gboolean
+gtk_css_value_ease_serialize (const GtkCssValue  *ease,
+                              GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_EASE);
+  _gtk_css_binary_writer_put_uint (writer, ease->type);
+
+  switch (ease->type)
+    {
+    case GTK_CSS_EASE_CUBIC_BEZIER:
+      _gtk_css_binary_writer_put_double (writer, ease->u.cubic.x1);
+      _gtk_css_binary_writer_put_double (writer, ease->u.cubic.y1);
+      _gtk_css_binary_writer_put_double (writer, ease->u.cubic.x2);
+      _gtk_css_binary_writer_put_double (writer, ease->u.cubic.y2);
+      return TRUE;
+    case GTK_CSS_EASE_STEPS:
+      _gtk_css_binary_writer_put_uint (writer, ease->u.steps.steps);
+      _gtk_css_binary_writer_put_uint (writer, ease->u.steps.start);
+      return TRUE;
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_EASE = {
   gtk_css_value_ease_free,
   gtk_css_value_ease_compute,
   gtk_css_value_ease_equal,
   gtk_css_value_ease_transition,
-  gtk_css_value_ease_print
+  gtk_css_value_ease_print,
+  gtk_css_value_ease_serialize
 };
 
 GtkCssValue *
@@ -185,6 +211,43 @@ _gtk_css_ease_value_new_steps (guint n_steps,
   return value;
 }
 
+GtkCssValue *
+_gtk_css_ease_value_deserialize (GtkCssBinaryReader *reader,
+                                 GtkCssBinaryTag     tag)
+{
+  switch (_gtk_css_binary_reader_get_uint (reader))
+    {
+    case GTK_CSS_EASE_CUBIC_BEZIER:
+      {
+        double x1, y1, x2, y2;
+
+        x1 = _gtk_css_binary_reader_get_double (reader);
+        y1 = _gtk_css_binary_reader_get_double (reader);
+        x2 = _gtk_css_binary_reader_get_double (reader);
+        y2 = _gtk_css_binary_reader_get_double (reader);
+        if (_gtk_css_binary_reader_failed (reader) ||
+            !(x1 >= 0.0 && x1 <= 1.0 && x2 >= 0.0 && x2 <= 1.0))
+          return NULL;
+
+        return _gtk_css_ease_value_new_cubic_bezier (x1, y1, x2, y2);
+      }
+    case GTK_CSS_EASE_STEPS:
+      {
+        guint n_steps;
+        gboolean start;
+
+        n_steps = _gtk_css_binary_reader_get_uint (reader);
+        start = _gtk_css_binary_reader_get_uint (reader);
+        if (_gtk_css_binary_reader_failed (reader) || n_steps == 0)
+          return NULL;
+
+        return _gtk_css_ease_value_new_steps (n_steps, start);
+      }
+    default:
+      return NULL;
+    }
+}
+
 static const struct {
   const char *name;
   guint is_bezier :1;
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_EASE_VALUE_PRIVATE_H__
 #define __GTK_CSS_EASE_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 
@@ -29,6 +30,8 @@ GtkCssValue *   _gtk_css_ease_value_new_cubic_bezier  (double                x1,
                                                        double                y1,
                                                        double                x2,
                                                        double                y2);
+GtkCssValue *   _gtk_css_ease_value_deserialize       (GtkCssBinaryReader   *reader,
+                                                       GtkCssBinaryTag       tag);
 gboolean        _gtk_css_ease_value_can_parse         (GtkCssParser         *parser);
 GtkCssValue *   _gtk_css_ease_value_parse             (GtkCssParser         *parser);
 
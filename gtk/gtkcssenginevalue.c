@@ -78,12 +78,29 @@ gtk_css_value_engine_print (const GtkCssValue *value,
   g_free (name);
 }
 
+static gboolean
+gtk_css_value_engine_serialize (const GtkCssValue  *value,
+                                GtkCssBinaryWriter *writer)
+{
+  char *name;
+
+  g_object_get (value->engine, "name", &name, NULL);
+
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_ENGINE);
+  _gtk_css_binary_writer_put_string (writer, name);
+
+  g_free (name);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_ENGINE = {
   gtk_css_value_engine_free,
   gtk_css_value_engine_compute,
   gtk_css_value_engine_equal,
   gtk_css_value_engine_transition,
-  gtk_css_value_engine_print
+  gtk_css_value_engine_print,
+  gtk_css_value_engine_serialize
 };
 
 GtkCssValue *
@@ -131,6 +148,24 @@ _gtk_css_engine_value_parse (GtkCssParser *parser)
   return _gtk_css_engine_value_new (engine);
 }
 
+GtkCssValue *
+_gtk_css_engine_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  GtkThemingEngine *engine;
+  const char *name;
+
+  name = _gtk_css_binary_reader_get_string (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+
+  engine = gtk_theming_engine_load (name);
+  if (engine == NULL)
+    return NULL;
+
+  return _gtk_css_engine_value_new (engine);
+}
+
 GtkThemingEngine *
 _gtk_css_engine_value_get_engine (const GtkCssValue *value)
 {
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_ENGINE_VALUE_PRIVATE_H__
 #define __GTK_CSS_ENGINE_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 #include "gtkthemingengine.h"
@@ -27,6 +28,8 @@
 G_BEGIN_DECLS
 
 GtkCssValue *       _gtk_css_engine_value_new           (GtkThemingEngine       *engine);
+GtkCssValue *       _gtk_css_engine_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                         GtkCssBinaryTag         tag);
 GtkCssValue *       _gtk_css_engine_value_parse         (GtkCssParser           *parser);
 
 GtkThemingEngine *  _gtk_css_engine_value_get_engine    (const GtkCssValue      *engine);
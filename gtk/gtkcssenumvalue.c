@@ -72,6 +72,18 @@ gtk_css_value_enum_print (const GtkCssValue *value,
   g_string_append (string, value->name);
 }
 
+static GtkCssBinaryTag gtk_css_value_enum_get_tag (const GtkCssValue *value);
+
+static gboolean
+gtk_css_value_enum_serialize (const GtkCssValue  *value,
+                              GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, gtk_css_value_enum_get_tag (value));
+  _gtk_css_binary_writer_put_int (writer, value->value);
+
+  return TRUE;
+}
+
 /* GtkBorderStyle */
 
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER_STYLE = {
@@ -79,7 +91,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BORDER_STYLE = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue border_style_values[] = {
@@ -226,7 +239,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_SIZE = {
   gtk_css_value_font_size_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_size_values[] = {
@@ -280,7 +294,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_STYLE = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_style_values[] = {
@@ -328,7 +343,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_variant_values[] = {
@@ -375,7 +391,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_WEIGHT = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_weight_values[] = {
@@ -443,7 +460,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_AREA = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue area_values[] = {
@@ -497,7 +515,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_DIRECTION = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue direction_values[] = {
@@ -552,7 +571,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_PLAY_STATE = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue play_state_values[] = {
@@ -605,7 +625,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FILL_MODE = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue fill_mode_values[] = {
@@ -660,7 +681,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_IMAGE_EFFECT = {
   gtk_css_value_enum_compute,
   gtk_css_value_enum_equal,
   gtk_css_value_enum_transition,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue image_effect_values[] = {
@@ -706,3 +728,64 @@ _gtk_css_image_effect_value_get (const GtkCssValue *value)
 
   return value->value;
 }
+
+/* binary form */
+
+static const struct {
+  GtkCssBinaryTag tag;
+  const GtkCssValueClass *class;
+  GtkCssValue *values;
+  guint n_values;
+} enum_types[] = {
+  { GTK_CSS_BINARY_TAG_BORDER_STYLE, &GTK_CSS_VALUE_BORDER_STYLE, border_style_values, G_N_ELEMENTS (border_style_values) },
+  { GTK_CSS_BINARY_TAG_FONT_SIZE, &GTK_CSS_VALUE_FONT_SIZE, font_size_values, G_N_ELEMENTS (font_size_values) },
+  { GTK_CSS_BINARY_TAG_FONT_STYLE, &GTK_CSS_VALUE_FONT_STYLE, font_style_values, G_N_ELEMENTS (font_style_values) },
+  { GTK_CSS_BINARY_TAG_FONT_VARIANT, &GTK_CSS_VALUE_FONT_VARIANT, font_variant_values, G_N_ELEMENTS (font_variant_values) },
+  { GTK_CSS_BINARY_TAG_FONT_WEIGHT, &GTK_CSS_VALUE_FONT_WEIGHT, font_weight_values, G_N_ELEMENTS (font_weight_values) },
+  { GTK_CSS_BINARY_TAG_AREA, &GTK_CSS_VALUE_AREA, area_values, G_N_ELEMENTS (area_values) },
+  { GTK_CSS_BINARY_TAG_DIRECTION, &GTK_CSS_VALUE_DIRECTION, direction_values, G_N_ELEMENTS (direction_values) },
+  { GTK_CSS_BINARY_TAG_PLAY_STATE, &GTK_CSS_VALUE_PLAY_STATE, play_state_values, G_N_ELEMENTS (play_state_values) },
+  { GTK_CSS_BINARY_TAG_FILL_MODE, &GTK_CSS_VALUE_FILL_MODE, fill_mode_values, G_N_ELEMENTS (fill_mode_values) },
+  { GTK_CSS_BINARY_TAG_IMAGE_EFFECT, &GTK_CSS_VALUE_IMAGE_EFFECT, image_effect_values, G_N_ELEMENTS (image_effect_values) }
+};
+
+static GtkCssBinaryTag
+gtk_css_value_enum_get_tag (const GtkCssValue *value)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (enum_types); i++)
+    {
+      if (enum_types[i].class == value->class)
+        return enum_types[i].tag;
+    }
+
+  g_assert_not_reached ();
+  return GTK_CSS_BINARY_TAG_NONE;
+}
+
+GtkCssValue *
+_gtk_css_enum_value_deserialize (GtkCssBinaryReader *reader,
+                                 GtkCssBinaryTag     tag)
+{
+  guint i, j;
+  int value;
+
+  value = _gtk_css_binary_reader_get_int (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+
+  for (i = 0; i < G_N_ELEMENTS (enum_types); i++)
+    {
+      if (enum_types[i].tag != tag)
+        continue;
+
+      for (j = 0; j < enum_types[i].n_values; j++)
+        {
+          if (enum_types[i].values[j].value == value)
+            return _gtk_css_value_ref (&enum_types[i].values[j]);
+        }
+    }
+
+  return NULL;
+}
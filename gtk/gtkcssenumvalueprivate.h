@@ -21,6 +21,7 @@
 #define __GTK_CSS_ENUM_VALUE_PRIVATE_H__
 
 #include "gtkenums.h"
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcsstypesprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -68,6 +69,9 @@ GtkCssValue *     _gtk_css_image_effect_value_new       (GtkCssImageEffect  imag
 GtkCssValue *     _gtk_css_image_effect_value_try_parse (GtkCssParser      *parser);
 GtkCssImageEffect _gtk_css_image_effect_value_get       (const GtkCssValue *value);
 
+GtkCssValue *     _gtk_css_enum_value_deserialize       (GtkCssBinaryReader *reader,
+                                                         GtkCssBinaryTag     tag);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_ENUM_VALUE_PRIVATE_H__ */
@@ -127,13 +127,11 @@ gtk_css_image_linear_compute_start_point (double angle_in_degrees,
   *y = perpendicular * *x + c;
 }
                                          
-static void
-gtk_css_image_linear_draw (GtkCssImage        *image,
-                           cairo_t            *cr,
-                           double              width,
-                           double              height)
+static cairo_pattern_t *
+gtk_css_image_linear_create_pattern (GtkCssImageLinear *linear,
+                                     double             width,
+                                     double             height)
 {
-  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
   cairo_pattern_t *pattern;
   double x, y; /* coordinates of start point */
   double length; /* distance in pixels for 100% */
@@ -219,12 +217,35 @@ gtk_css_image_linear_draw (GtkCssImage        *image,
       last = i;
     }
 
+  return pattern;
+}
+
+static void
+gtk_css_image_linear_draw (GtkCssImage        *image,
+                           cairo_t            *cr,
+                           double              width,
+                           double              height)
+{
+  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
+
+  /* Computed images are immutable, so the pattern only needs to
+   * be rebuilt when the size changes */
+  if (linear->pattern == NULL ||
+      linear->pattern_width != width ||
+      linear->pattern_height != height)
+    {
+      if (linear->pattern)
+        cairo_pattern_destroy (linear->pattern);
+
+      linear->pattern = gtk_css_image_linear_create_pattern (linear, width, height);
+      linear->pattern_width = width;
+      linear->pattern_height = height;
+    }
+
   cairo_rectangle (cr, 0, 0, width, height);
   cairo_translate (cr, width / 2, height / 2);
-  cairo_set_source (cr, pattern);
+  cairo_set_source (cr, linear->pattern);
   cairo_fill (cr);
-
-  cairo_pattern_destroy (pattern);
 }
 
 
@@ -580,6 +601,12 @@ gtk_css_image_linear_dispose (GObject *object)
       linear->angle = NULL;
     }
 
+  if (linear->pattern)
+    {
+      cairo_pattern_destroy (linear->pattern);
+      linear->pattern = NULL;
+    }
+
   G_OBJECT_CLASS (_gtk_css_image_linear_parent_class)->dispose (object);
 }
 
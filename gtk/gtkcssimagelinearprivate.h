@@ -48,6 +48,10 @@ struct _GtkCssImageLinear
   GtkCssValue *angle; /* warning: We use GTK_CSS_NUMBER as an enum for the corners */
   GArray *stops;
   guint repeating :1;
+
+  cairo_pattern_t *pattern;     /* NULL or pattern last drawn, for pattern_width x pattern_height */
+  double pattern_width;
+  double pattern_height;
 };
 
 struct _GtkCssImageLinearClass
@@ -185,3 +185,15 @@ _gtk_css_image_url_init (GtkCssImageUrl *image_url)
 {
 }
 
+GtkCssImage *
+_gtk_css_image_url_new (GFile *file)
+{
+  GtkCssImageUrl *url;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+  url = g_object_new (GTK_TYPE_CSS_IMAGE_URL, NULL);
+  url->file = g_object_ref (file);
+
+  return GTK_CSS_IMAGE (url);
+}
@@ -49,6 +49,8 @@ struct _GtkCssImageUrlClass
 
 GType          _gtk_css_image_url_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  _gtk_css_image_url_new                  (GFile          *file);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_URL_PRIVATE_H__ */
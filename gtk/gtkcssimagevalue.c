@@ -20,6 +20,7 @@
 #include "gtkcssimagevalueprivate.h"
 
 #include "gtkcssimagecrossfadeprivate.h"
+#include "gtkcssimageurlprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -93,12 +94,36 @@ gtk_css_value_image_print (const GtkCssValue *value,
     g_string_append (string, "none");
 }
 
+/* Only "none" and url() images have a binary form. url() images are
+ * stored by their URI, so saving them doesn't load the image. */
+static gboolean
+gtk_css_value_image_serialize (const GtkCssValue  *value,
+                               GtkCssBinaryWriter *writer)
+{
+  char *uri;
+
+  if (value->image == NULL)
+    uri = NULL;
+  else if (GTK_IS_CSS_IMAGE_URL (value->image))
+    uri = g_file_get_uri (GTK_CSS_IMAGE_URL (value->image)->file);
+  else
+    return FALSE;
+
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_IMAGE);
+  _gtk_css_binary_writer_put_string (writer, uri);
+
+  g_free (uri);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_IMAGE = {
   gtk_css_value_image_free,
   gtk_css_value_image_compute,
   gtk_css_value_image_equal,
   gtk_css_value_image_transition,
-  gtk_css_value_image_print
+  gtk_css_value_image_print,
+  gtk_css_value_image_serialize
 };
 
 GtkCssValue *
@@ -116,6 +141,28 @@ _gtk_css_image_value_new (GtkCssImage *image)
   return value;
 }
 
+GtkCssValue *
+_gtk_css_image_value_deserialize (GtkCssBinaryReader *reader,
+                                  GtkCssBinaryTag     tag)
+{
+  GtkCssImage *image;
+  const char *uri;
+  GFile *file;
+
+  uri = _gtk_css_binary_reader_get_string (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+
+  if (uri == NULL)
+    return _gtk_css_image_value_new (NULL);
+
+  file = g_file_new_for_uri (uri);
+  image = _gtk_css_image_url_new (file);
+  g_object_unref (file);
+
+  return _gtk_css_image_value_new (image);
+}
+
 GtkCssImage *
 _gtk_css_image_value_get_image (const GtkCssValue *value)
 {
@@ -20,12 +20,15 @@
 #ifndef __GTK_CSS_IMAGE_VALUE_PRIVATE_H__
 #define __GTK_CSS_IMAGE_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssimageprivate.h"
 #include "gtkcssvalueprivate.h"
 
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_image_value_new           (GtkCssImage         *image);
+GtkCssValue *   _gtk_css_image_value_deserialize   (GtkCssBinaryReader  *reader,
+                                                    GtkCssBinaryTag      tag);
 
 GtkCssImage *   _gtk_css_image_value_get_image     (const GtkCssValue   *image);
 
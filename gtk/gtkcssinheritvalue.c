@@ -82,12 +82,22 @@ gtk_css_value_inherit_print (const GtkCssValue *value,
   g_string_append (string, "inherit");
 }
 
+static gboolean
+gtk_css_value_inherit_serialize (const GtkCssValue  *value,
+                                 GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_INHERIT);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_INHERIT = {
   gtk_css_value_inherit_free,
   gtk_css_value_inherit_compute,
   gtk_css_value_inherit_equal,
   gtk_css_value_inherit_transition,
-  gtk_css_value_inherit_print
+  gtk_css_value_inherit_print,
+  gtk_css_value_inherit_serialize
 };
 
 static GtkCssValue inherit = { &GTK_CSS_VALUE_INHERIT, 1 };
@@ -97,3 +107,10 @@ _gtk_css_inherit_value_new (void)
 {
   return _gtk_css_value_ref (&inherit);
 }
+
+GtkCssValue *
+_gtk_css_inherit_value_deserialize (GtkCssBinaryReader *reader,
+                                    GtkCssBinaryTag     tag)
+{
+  return _gtk_css_value_ref (&inherit);
+}
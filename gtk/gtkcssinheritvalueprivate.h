@@ -20,11 +20,14 @@
 #ifndef __GTK_CSS_INHERIT_VALUE_PRIVATE_H__
 #define __GTK_CSS_INHERIT_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssvalueprivate.h"
 
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_inherit_value_new            (void);
+GtkCssValue *   _gtk_css_inherit_value_deserialize    (GtkCssBinaryReader *reader,
+                                                       GtkCssBinaryTag     tag);
 
 G_END_DECLS
 
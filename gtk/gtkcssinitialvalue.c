@@ -110,12 +110,22 @@ gtk_css_value_initial_print (const GtkCssValue *value,
   g_string_append (string, "initial");
 }
 
+static gboolean
+gtk_css_value_initial_serialize (const GtkCssValue  *value,
+                                 GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_INITIAL);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_INITIAL = {
   gtk_css_value_initial_free,
   gtk_css_value_initial_compute,
   gtk_css_value_initial_equal,
   gtk_css_value_initial_transition,
-  gtk_css_value_initial_print
+  gtk_css_value_initial_print,
+  gtk_css_value_initial_serialize
 };
 
 static GtkCssValue initial = { &GTK_CSS_VALUE_INITIAL, 1 };
@@ -131,3 +141,10 @@ _gtk_css_initial_value_get (void)
 {
   return &initial;
 }
+
+GtkCssValue *
+_gtk_css_initial_value_deserialize (GtkCssBinaryReader *reader,
+                                    GtkCssBinaryTag     tag)
+{
+  return _gtk_css_value_ref (&initial);
+}
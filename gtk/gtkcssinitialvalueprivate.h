@@ -20,12 +20,15 @@
 #ifndef __GTK_CSS_INITIAL_VALUE_PRIVATE_H__
 #define __GTK_CSS_INITIAL_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssvalueprivate.h"
 
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_initial_value_new            (void);
 GtkCssValue *   _gtk_css_initial_value_get            (void);
+GtkCssValue *   _gtk_css_initial_value_deserialize    (GtkCssBinaryReader *reader,
+                                                       GtkCssBinaryTag     tag);
 
 G_END_DECLS
 
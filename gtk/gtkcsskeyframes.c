@@ -424,6 +424,141 @@ _gtk_css_keyframes_print (GtkCssKeyframes *keyframes,
   g_free (sorted);
 }
 
+void
+_gtk_css_keyframes_serialize (GtkCssKeyframes    *keyframes,
+                              GtkCssBinaryWriter *writer)
+{
+  guint k, p;
+
+  g_return_if_fail (keyframes != NULL);
+  g_return_if_fail (writer != NULL);
+
+  _gtk_css_binary_writer_put_uint (writer, keyframes->n_keyframes);
+  _gtk_css_binary_writer_put_uint (writer, keyframes->n_properties);
+
+  /* property ids depend on the order properties were registered in */
+  for (p = 0; p < keyframes->n_properties; p++)
+    {
+      GtkStyleProperty *property;
+
+      property = GTK_STYLE_PROPERTY (_gtk_css_style_property_lookup_by_id (keyframes->property_ids[p]));
+      _gtk_css_binary_writer_put_string (writer, _gtk_style_property_get_name (property));
+    }
+
+  for (k = 0; k < keyframes->n_keyframes; k++)
+    {
+      _gtk_css_binary_writer_put_double (writer, keyframes->keyframe_progress[k]);
+
+      for (p = 0; p < keyframes->n_properties; p++)
+        {
+          GtkCssValue *value = KEYFRAMES_VALUE (keyframes, k, p);
+
+          _gtk_css_binary_writer_put_uint (writer, value != NULL);
+          if (value)
+            _gtk_css_binary_writer_put_value_or_text (writer, value);
+        }
+    }
+}
+
+static GtkCssValue *
+parse_property_value (GtkCssParser *parser,
+                      gpointer      property)
+{
+  return _gtk_style_property_parse_value (property, parser);
+}
+
+GtkCssKeyframes *
+_gtk_css_keyframes_deserialize (GtkCssBinaryReader *reader)
+{
+  GtkCssKeyframes *keyframes;
+  GtkCssStyleProperty **properties;
+  guint n_keyframes, n_properties;
+  guint i, k, p;
+
+  g_return_val_if_fail (reader != NULL, NULL);
+
+  n_keyframes = _gtk_css_binary_reader_get_uint (reader);
+  n_properties = _gtk_css_binary_reader_get_uint (reader);
+  /* don't trust corrupt data with huge allocations */
+  if (_gtk_css_binary_reader_failed (reader) ||
+      n_keyframes > G_MAXUINT16 ||
+      n_properties > _gtk_css_style_property_get_n_properties ())
+    {
+      _gtk_css_binary_reader_fail (reader);
+      return NULL;
+    }
+
+  properties = g_new0 (GtkCssStyleProperty *, n_properties);
+  for (p = 0; p < n_properties; p++)
+    {
+      GtkStyleProperty *property;
+      const char *name;
+
+      name = _gtk_css_binary_reader_get_string (reader);
+      if (name == NULL)
+        break;
+
+      property = _gtk_style_property_lookup (name);
+      if (!GTK_IS_CSS_STYLE_PROPERTY (property))
+        break;
+
+      properties[p] = GTK_CSS_STYLE_PROPERTY (property);
+    }
+
+  if (p < n_properties)
+    {
+      _gtk_css_binary_reader_fail (reader);
+      g_free (properties);
+      return NULL;
+    }
+
+  keyframes = gtk_css_keyframes_new ();
+
+  for (i = 0; i < n_keyframes; i++)
+    {
+      double progress;
+
+      progress = _gtk_css_binary_reader_get_double (reader);
+      if (_gtk_css_binary_reader_failed (reader) ||
+          !(progress >= 0 && progress <= 1))
+        break;
+
+      k = gtk_css_keyframes_add_keyframe (keyframes, progress);
+
+      for (p = 0; p < n_properties; p++)
+        {
+          GtkCssValue *value;
+          gboolean set;
+
+          if (!_gtk_css_binary_reader_get_uint (reader))
+            continue;
+
+          value = _gtk_css_binary_reader_get_value_or_text (reader, parse_property_value, properties[p]);
+          if (value == NULL)
+            break;
+
+          set = keyframes_set_value (keyframes, k, properties[p], value);
+          _gtk_css_value_unref (value);
+          if (!set)
+            break;
+        }
+
+      if (p < n_properties)
+        break;
+    }
+
+  g_free (properties);
+
+  if (i < n_keyframes || _gtk_css_binary_reader_failed (reader))
+    {
+      _gtk_css_binary_reader_fail (reader);
+      _gtk_css_keyframes_unref (keyframes);
+      return NULL;
+    }
+
+  return keyframes;
+}
+
 GtkCssKeyframes *
 _gtk_css_keyframes_compute (GtkCssKeyframes         *keyframes,
                             GtkStyleProviderPrivate *provider,
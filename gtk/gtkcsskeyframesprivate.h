@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_KEYFRAMES_PRIVATE_H__
 #define __GTK_CSS_KEYFRAMES_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 #include "gtktypes.h"
@@ -36,6 +37,10 @@ void                _gtk_css_keyframes_unref                  (GtkCssKeyframes
 void                _gtk_css_keyframes_print                  (GtkCssKeyframes        *keyframes,
                                                                GString                *string);
 
+void                _gtk_css_keyframes_serialize              (GtkCssKeyframes        *keyframes,
+                                                               GtkCssBinaryWriter     *writer);
+GtkCssKeyframes *   _gtk_css_keyframes_deserialize            (GtkCssBinaryReader     *reader);
+
 GtkCssKeyframes *   _gtk_css_keyframes_compute                (GtkCssKeyframes         *keyframes,
                                                                GtkStyleProviderPrivate *provider,
 							       int                      scale,
@@ -130,28 +130,38 @@ _gtk_css_lookup_set_computed (GtkCssLookup  *lookup,
  * @lookup: the lookup
  * @context: the context the values are resolved for
  * @values: a new #GtkCssComputedValues to be filled with the new properties
+ * @previous: (allow-none): values computed for the same widget before
+ *     it changed or %NULL
  *
  * Resolves the current lookup into a styleproperties object. This is done
  * by converting from the "winning declaration" to the "computed value".
  *
+ * If @previous is given, values that would compute to the same result
+ * are taken from it instead, see _gtk_css_computed_values_reuse_value().
+ *
  * XXX: This bypasses the notion of "specified value". If this ever becomes
  * an issue, go fix it.
+ *
+ * Returns: the number of values that had to be computed
  **/
-void
+guint
 _gtk_css_lookup_resolve (GtkCssLookup            *lookup,
                          GtkStyleProviderPrivate *provider,
 			 int                      scale,
                          GtkCssComputedValues    *values,
-                         GtkCssComputedValues    *parent_values)
+                         GtkCssComputedValues    *parent_values,
+                         GtkCssComputedValues    *previous)
 {
-  guint i, n;
+  guint i, n, n_computed;
 
-  g_return_if_fail (lookup != NULL);
-  g_return_if_fail (GTK_IS_STYLE_PROVIDER_PRIVATE (provider));
-  g_return_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values));
-  g_return_if_fail (parent_values == NULL || GTK_IS_CSS_COMPUTED_VALUES (parent_values));
+  g_return_val_if_fail (lookup != NULL, 0);
+  g_return_val_if_fail (GTK_IS_STYLE_PROVIDER_PRIVATE (provider), 0);
+  g_return_val_if_fail (GTK_IS_CSS_COMPUTED_VALUES (values), 0);
+  g_return_val_if_fail (parent_values == NULL || GTK_IS_CSS_COMPUTED_VALUES (parent_values), 0);
+  g_return_val_if_fail (previous == NULL || GTK_IS_CSS_COMPUTED_VALUES (previous), 0);
 
   n = _gtk_css_style_property_get_n_properties ();
+  n_computed = 0;
 
   for (i = 0; i < n; i++)
     {
@@ -163,13 +173,26 @@ _gtk_css_lookup_resolve (GtkCssLookup            *lookup,
                                             lookup->values[i].section);
       else if (lookup->values[i].value ||
                _gtk_bitmask_get (lookup->missing, i))
-        _gtk_css_computed_values_compute_value (values,
-                                                provider,
-						scale,
-                                                parent_values,
-                                                i,
-                                                lookup->values[i].value,
-                                                lookup->values[i].section);
+        {
+          if (previous &&
+              _gtk_css_computed_values_reuse_value (values,
+                                                    previous,
+                                                    i,
+                                                    lookup->values[i].value,
+                                                    lookup->values[i].section))
+            continue;
+
+          _gtk_css_computed_values_compute_value (values,
+                                                  provider,
+                                                  scale,
+                                                  parent_values,
+                                                  i,
+                                                  lookup->values[i].value,
+                                                  lookup->values[i].section);
+          n_computed++;
+        }
       /* else not a relevant property */
     }
+
+  return n_computed;
 }
@@ -53,11 +53,12 @@ void                    _gtk_css_lookup_set_computed            (GtkCssLookup
                                                                  guint                       id,
                                                                  GtkCssSection              *section,
                                                                  GtkCssValue                *value);
-void                    _gtk_css_lookup_resolve                 (GtkCssLookup               *lookup,
+guint                   _gtk_css_lookup_resolve                 (GtkCssLookup               *lookup,
                                                                  GtkStyleProviderPrivate    *provider,
 								 int                         scale,
                                                                  GtkCssComputedValues       *values,
-                                                                 GtkCssComputedValues       *parent_values);
+                                                                 GtkCssComputedValues       *parent_values,
+                                                                 GtkCssComputedValues       *previous);
 
 static inline const GtkBitmask *
 _gtk_css_lookup_get_missing (const GtkCssLookup *lookup)
@@ -19,7 +19,88 @@
 
 #include "gtkcssmatcherprivate.h"
 
-#include "gtkwidgetpath.h"
+#include <string.h>
+
+#include "gtkwidgetpathprivate.h"
+
+/* BLOOM FILTER */
+
+static inline guint
+gtk_css_matcher_bloom_hash (GtkCssMatcherKey key,
+                            guint            value)
+{
+  /* multiplicative hashing, the top bits are the well-mixed ones */
+  return (value * 4 + key) * 2654435761u;
+}
+
+static void
+gtk_css_matcher_bloom_add (GtkCssMatcherBloom *bloom,
+                           GtkCssMatcherKey    key,
+                           guint               value)
+{
+  guint hash = gtk_css_matcher_bloom_hash (key, value);
+  guint a = hash >> 24;
+  guint b = (hash >> 16) & 0xFF;
+
+  bloom->bits[a / 32] |= 1u << (a % 32);
+  bloom->bits[b / 32] |= 1u << (b % 32);
+}
+
+static gboolean
+gtk_css_matcher_bloom_contains (const GtkCssMatcherBloom *bloom,
+                                GtkCssMatcherKey          key,
+                                guint                     value)
+{
+  guint hash = gtk_css_matcher_bloom_hash (key, value);
+  guint a = hash >> 24;
+  guint b = (hash >> 16) & 0xFF;
+
+  return (bloom->bits[a / 32] & (1u << (a % 32)))
+      && (bloom->bits[b / 32] & (1u << (b % 32)));
+}
+
+static void
+gtk_css_matcher_bloom_init (GtkCssMatcherBloom  *bloom,
+                            const GtkWidgetPath *path,
+                            guint                n_elements)
+{
+  guint i, j, n_classes;
+
+  memset (bloom, 0, sizeof (GtkCssMatcherBloom));
+
+  for (i = 0; i < n_elements; i++)
+    {
+      const GQuark *classes;
+      GHashTable *regions;
+      GQuark name;
+      GType type;
+
+      /* type selectors match subtypes, so add all the parents */
+      for (type = gtk_widget_path_iter_get_object_type (path, i);
+           type != 0;
+           type = g_type_parent (type))
+        gtk_css_matcher_bloom_add (bloom, GTK_CSS_MATCHER_KEY_TYPE, (guint) type);
+
+      name = _gtk_widget_path_iter_get_qname (path, i);
+      if (name)
+        gtk_css_matcher_bloom_add (bloom, GTK_CSS_MATCHER_KEY_ID, name);
+
+      classes = _gtk_widget_path_iter_get_qclasses (path, i, &n_classes);
+      for (j = 0; j < n_classes; j++)
+        gtk_css_matcher_bloom_add (bloom, GTK_CSS_MATCHER_KEY_CLASS, classes[j]);
+
+      regions = _gtk_widget_path_iter_get_qregions (path, i);
+      if (regions)
+        {
+          GHashTableIter iter;
+          gpointer region;
+
+          g_hash_table_iter_init (&iter, regions);
+          while (g_hash_table_iter_next (&iter, &region, NULL))
+            gtk_css_matcher_bloom_add (bloom, GTK_CSS_MATCHER_KEY_REGION, GPOINTER_TO_UINT (region));
+        }
+    }
+}
 
 /* GTK_CSS_MATCHER_WIDGET_PATH */
 
@@ -35,6 +116,8 @@ gtk_css_matcher_widget_path_get_parent (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = child->path.index - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (matcher->path.path, matcher->path.index);
+  /* A superset of our ancestors, which is all the filter needs */
+  matcher->path.ancestors = child->path.ancestors;
 
   return TRUE;
 }
@@ -51,6 +134,7 @@ gtk_css_matcher_widget_path_get_previous (GtkCssMatcher       *matcher,
   matcher->path.state_flags = 0;
   matcher->path.index = next->path.index;
   matcher->path.sibling_index = next->path.sibling_index - 1;
+  matcher->path.ancestors = next->path.ancestors;
 
   return TRUE;
 }
@@ -89,15 +173,15 @@ gtk_css_matcher_widget_path_has_class (const GtkCssMatcher *matcher,
 
 static gboolean
 gtk_css_matcher_widget_path_has_id (const GtkCssMatcher *matcher,
-                                    const char          *id)
+                                    GQuark               id)
 {
   const GtkWidgetPath *siblings;
   
   siblings = gtk_widget_path_iter_get_siblings (matcher->path.path, matcher->path.index);
   if (siblings && matcher->path.sibling_index != gtk_widget_path_iter_get_sibling_index (matcher->path.path, matcher->path.index))
-    return gtk_widget_path_iter_has_name (siblings, matcher->path.sibling_index, id);
+    return gtk_widget_path_iter_has_qname (siblings, matcher->path.sibling_index, id);
   else
-    return gtk_widget_path_iter_has_name (matcher->path.path, matcher->path.index, id);
+    return gtk_widget_path_iter_has_qname (matcher->path.path, matcher->path.index, id);
 }
 
 static gboolean
@@ -120,7 +204,7 @@ gtk_css_matcher_widget_path_has_regions (const GtkCssMatcher *matcher)
 
 static gboolean
 gtk_css_matcher_widget_path_has_region (const GtkCssMatcher *matcher,
-                                        const char          *region,
+                                        GQuark               region,
                                         GtkRegionFlags       flags)
 {
   const GtkWidgetPath *siblings;
@@ -129,12 +213,12 @@ gtk_css_matcher_widget_path_has_region (const GtkCssMatcher *matcher,
   siblings = gtk_widget_path_iter_get_siblings (matcher->path.path, matcher->path.index);
   if (siblings && matcher->path.sibling_index != gtk_widget_path_iter_get_sibling_index (matcher->path.path, matcher->path.index))
     {
-      if (!gtk_widget_path_iter_has_region (siblings, matcher->path.sibling_index, region, &region_flags))
+      if (!gtk_widget_path_iter_has_qregion (siblings, matcher->path.sibling_index, region, &region_flags))
         return FALSE;
     }
   else
     {
-      if (!gtk_widget_path_iter_has_region (matcher->path.path, matcher->path.index, region, &region_flags))
+      if (!gtk_widget_path_iter_has_qregion (matcher->path.path, matcher->path.index, region, &region_flags))
         return FALSE;
     }
 
@@ -173,6 +257,14 @@ gtk_css_matcher_widget_path_has_position (const GtkCssMatcher *matcher,
   return x / a > 0;
 }
 
+static gboolean
+gtk_css_matcher_widget_path_may_have_ancestor (const GtkCssMatcher *matcher,
+                                               GtkCssMatcherKey     key,
+                                               guint                value)
+{
+  return gtk_css_matcher_bloom_contains (&matcher->path.ancestors, key, value);
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_WIDGET_PATH = {
   gtk_css_matcher_widget_path_get_parent,
   gtk_css_matcher_widget_path_get_previous,
@@ -183,6 +275,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_WIDGET_PATH = {
   gtk_css_matcher_widget_path_has_regions,
   gtk_css_matcher_widget_path_has_region,
   gtk_css_matcher_widget_path_has_position,
+  gtk_css_matcher_widget_path_may_have_ancestor,
   FALSE
 };
 
@@ -199,6 +292,7 @@ _gtk_css_matcher_init (GtkCssMatcher       *matcher,
   matcher->path.state_flags = state;
   matcher->path.index = gtk_widget_path_length (path) - 1;
   matcher->path.sibling_index = gtk_widget_path_iter_get_sibling_index (path, matcher->path.index);
+  gtk_css_matcher_bloom_init (&matcher->path.ancestors, path, matcher->path.index);
 
   return TRUE;
 }
@@ -249,7 +343,7 @@ gtk_css_matcher_any_has_class (const GtkCssMatcher *matcher,
 
 static gboolean
 gtk_css_matcher_any_has_id (const GtkCssMatcher *matcher,
-                                    const char          *id)
+                                    GQuark               id)
 {
   return TRUE;
 }
@@ -262,7 +356,7 @@ gtk_css_matcher_any_has_regions (const GtkCssMatcher *matcher)
 
 static gboolean
 gtk_css_matcher_any_has_region (const GtkCssMatcher *matcher,
-                                const char          *region,
+                                GQuark               region,
                                 GtkRegionFlags       flags)
 {
   return TRUE;
@@ -277,6 +371,14 @@ gtk_css_matcher_any_has_position (const GtkCssMatcher *matcher,
   return TRUE;
 }
 
+static gboolean
+gtk_css_matcher_any_may_have_ancestor (const GtkCssMatcher *matcher,
+                                       GtkCssMatcherKey     key,
+                                       guint                value)
+{
+  return TRUE;
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_ANY = {
   gtk_css_matcher_any_get_parent,
   gtk_css_matcher_any_get_previous,
@@ -287,6 +389,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_ANY = {
   gtk_css_matcher_any_has_regions,
   gtk_css_matcher_any_has_region,
   gtk_css_matcher_any_has_position,
+  gtk_css_matcher_any_may_have_ancestor,
   TRUE
 };
 
@@ -351,7 +454,7 @@ gtk_css_matcher_superset_has_class (const GtkCssMatcher *matcher,
 
 static gboolean
 gtk_css_matcher_superset_has_id (const GtkCssMatcher *matcher,
-                                 const char          *id)
+                                 GQuark               id)
 {
   if (matcher->superset.relevant & GTK_CSS_CHANGE_NAME)
     return _gtk_css_matcher_has_id (matcher->superset.subset, id);
@@ -370,7 +473,7 @@ gtk_css_matcher_superset_has_regions (const GtkCssMatcher *matcher)
 
 static gboolean
 gtk_css_matcher_superset_has_region (const GtkCssMatcher *matcher,
-                                     const char          *region,
+                                     GQuark               region,
                                      GtkRegionFlags       flags)
 {
   if (matcher->superset.relevant & GTK_CSS_CHANGE_NAME)
@@ -396,6 +499,15 @@ gtk_css_matcher_superset_has_position (const GtkCssMatcher *matcher,
     return TRUE;
 }
 
+static gboolean
+gtk_css_matcher_superset_may_have_ancestor (const GtkCssMatcher *matcher,
+                                            GtkCssMatcherKey     key,
+                                            guint                value)
+{
+  /* our parents are any matchers */
+  return TRUE;
+}
+
 static const GtkCssMatcherClass GTK_CSS_MATCHER_SUPERSET = {
   gtk_css_matcher_superset_get_parent,
   gtk_css_matcher_superset_get_previous,
@@ -406,6 +518,7 @@ static const GtkCssMatcherClass GTK_CSS_MATCHER_SUPERSET = {
   gtk_css_matcher_superset_has_regions,
   gtk_css_matcher_superset_has_region,
   gtk_css_matcher_superset_has_position,
+  gtk_css_matcher_superset_may_have_ancestor,
   FALSE
 };
 
@@ -28,6 +28,24 @@ typedef union _GtkCssMatcher GtkCssMatcher;
 typedef struct _GtkCssMatcherSuperset GtkCssMatcherSuperset;
 typedef struct _GtkCssMatcherWidgetPath GtkCssMatcherWidgetPath;
 typedef struct _GtkCssMatcherClass GtkCssMatcherClass;
+typedef struct _GtkCssMatcherBloom GtkCssMatcherBloom;
+
+typedef enum {
+  GTK_CSS_MATCHER_KEY_TYPE,
+  GTK_CSS_MATCHER_KEY_CLASS,
+  GTK_CSS_MATCHER_KEY_ID,
+  GTK_CSS_MATCHER_KEY_REGION
+} GtkCssMatcherKey;
+
+/* A small Bloom filter over the types, classes, names and regions of
+ * all ancestors of a matcher. It can have false positives but never
+ * false negatives, so it is only used to reject descendant selectors.
+ */
+#define GTK_CSS_MATCHER_BLOOM_BITS 256
+
+struct _GtkCssMatcherBloom {
+  guint32 bits[GTK_CSS_MATCHER_BLOOM_BITS / 32];
+};
 
 struct _GtkCssMatcherClass {
   gboolean        (* get_parent)                  (GtkCssMatcher          *matcher,
@@ -41,15 +59,18 @@ struct _GtkCssMatcherClass {
   gboolean        (* has_class)                   (const GtkCssMatcher   *matcher,
                                                    GQuark                 class_name);
   gboolean        (* has_id)                      (const GtkCssMatcher   *matcher,
-                                                   const char            *id);
+                                                   GQuark                 id);
   gboolean        (* has_regions)                 (const GtkCssMatcher   *matcher);
   gboolean        (* has_region)                  (const GtkCssMatcher   *matcher,
-                                                   const char            *region,
+                                                   GQuark                 region,
                                                    GtkRegionFlags         flags);
   gboolean        (* has_position)                (const GtkCssMatcher   *matcher,
                                                    gboolean               forward,
                                                    int                    a,
                                                    int                    b);
+  gboolean        (* may_have_ancestor)           (const GtkCssMatcher   *matcher,
+                                                   GtkCssMatcherKey       key,
+                                                   guint                  value);
   gboolean is_any;
 };
 
@@ -59,6 +80,7 @@ struct _GtkCssMatcherWidgetPath {
   GtkStateFlags             state_flags;
   guint                     index;
   guint                     sibling_index;
+  GtkCssMatcherBloom        ancestors;
 };
 
 struct _GtkCssMatcherSuperset {
@@ -118,7 +140,7 @@ _gtk_css_matcher_has_class (const GtkCssMatcher *matcher,
 
 static inline gboolean
 _gtk_css_matcher_has_id (const GtkCssMatcher *matcher,
-                         const char          *id)
+                         GQuark               id)
 {
   return matcher->klass->has_id (matcher, id);
 }
@@ -132,7 +154,7 @@ _gtk_css_matcher_has_regions (const GtkCssMatcher *matcher)
 
 static inline gboolean
 _gtk_css_matcher_has_region (const GtkCssMatcher *matcher,
-                             const char          *region,
+                             GQuark               region,
                              GtkRegionFlags       flags)
 {
   return matcher->klass->has_region (matcher, region, flags);
@@ -147,6 +169,14 @@ _gtk_css_matcher_has_position (const GtkCssMatcher *matcher,
   return matcher->klass->has_position (matcher, forward, a, b);
 }
 
+static inline gboolean
+_gtk_css_matcher_may_have_ancestor (const GtkCssMatcher *matcher,
+                                    GtkCssMatcherKey     key,
+                                    guint                value)
+{
+  return matcher->klass->may_have_ancestor (matcher, key, value);
+}
+
 static inline gboolean
 _gtk_css_matcher_matches_any (const GtkCssMatcher *matcher)
 {
@@ -178,12 +178,24 @@ gtk_css_value_number_print (const GtkCssValue *number,
     g_string_append (string, names[number->unit]);
 }
 
+static gboolean
+gtk_css_value_number_serialize (const GtkCssValue  *number,
+                                GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_NUMBER);
+  _gtk_css_binary_writer_put_uint (writer, number->unit);
+  _gtk_css_binary_writer_put_double (writer, number->value);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_NUMBER = {
   gtk_css_value_number_free,
   gtk_css_value_number_compute,
   gtk_css_value_number_equal,
   gtk_css_value_number_transition,
-  gtk_css_value_number_print
+  gtk_css_value_number_print,
+  gtk_css_value_number_serialize
 };
 
 GtkCssValue *
@@ -223,6 +235,21 @@ _gtk_css_number_value_new (double     value,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_number_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  GtkCssUnit unit;
+  double value;
+
+  unit = _gtk_css_binary_reader_get_uint (reader);
+  value = _gtk_css_binary_reader_get_double (reader);
+  if (_gtk_css_binary_reader_failed (reader) || unit > GTK_CSS_MS)
+    return NULL;
+
+  return _gtk_css_number_value_new (value, unit);
+}
+
 GtkCssUnit
 _gtk_css_number_value_get_unit (const GtkCssValue *value)
 {
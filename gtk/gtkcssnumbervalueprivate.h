@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_NUMBER_VALUE_PRIVATE_H__
 #define __GTK_CSS_NUMBER_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcsstypesprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -38,6 +39,8 @@ typedef enum /*< skip >*/ {
 
 GtkCssValue *   _gtk_css_number_value_new           (double                  value,
                                                      GtkCssUnit              unit);
+GtkCssValue *   _gtk_css_number_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                     GtkCssBinaryTag         tag);
 /* This function implemented in gtkcssparser.c */
 GtkCssValue *   _gtk_css_number_value_parse         (GtkCssParser           *parser,
                                                      GtkCssNumberParseFlags  flags);
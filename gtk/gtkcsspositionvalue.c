@@ -153,12 +153,23 @@ done:
   _gtk_css_value_unref (center);
 }
 
+static gboolean
+gtk_css_value_position_serialize (const GtkCssValue  *value,
+                                 GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_POSITION);
+
+  return _gtk_css_binary_writer_put_value (writer, value->x) &&
+         _gtk_css_binary_writer_put_value (writer, value->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_POSITION = {
   gtk_css_value_position_free,
   gtk_css_value_position_compute,
   gtk_css_value_position_equal,
   gtk_css_value_position_transition,
-  gtk_css_value_position_print
+  gtk_css_value_position_print,
+  gtk_css_value_position_serialize
 };
 
 GtkCssValue *
@@ -174,6 +185,24 @@ _gtk_css_position_value_new (GtkCssValue *x,
   return result;
 }
 
+GtkCssValue *
+_gtk_css_position_value_deserialize (GtkCssBinaryReader *reader,
+                                    GtkCssBinaryTag     tag)
+{
+  GtkCssValue *x, *y;
+
+  x = _gtk_css_binary_reader_get_value (reader);
+  y = _gtk_css_binary_reader_get_value (reader);
+  if (x == NULL || y == NULL)
+    {
+      _gtk_css_value_unref (x);
+      _gtk_css_value_unref (y);
+      return NULL;
+    }
+
+  return _gtk_css_position_value_new (x, y);
+}
+
 static GtkCssValue *
 position_value_parse (GtkCssParser *parser, gboolean try)
 {
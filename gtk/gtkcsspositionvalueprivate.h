@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_POSITION_VALUE_PRIVATE_H__
 #define __GTK_CSS_POSITION_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 
@@ -27,6 +28,8 @@ G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_position_value_new           (GtkCssValue            *x,
                                                        GtkCssValue            *y);
+GtkCssValue *   _gtk_css_position_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                       GtkCssBinaryTag         tag);
 GtkCssValue *   _gtk_css_position_value_parse         (GtkCssParser           *parser);
 GtkCssValue *   _gtk_css_position_value_try_parse     (GtkCssParser           *parser);
 
@@ -22,11 +22,13 @@
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <cairo-gobject.h>
+#include <glib/gstdio.h>
 
 #include "gtkcssproviderprivate.h"
 
 #include "gtkbitmaskprivate.h"
 #include "gtkcssarrayvalueprivate.h"
+#include "gtkcssbinaryprivate.h"
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcsskeyframesprivate.h"
 #include "gtkcssparserprivate.h"
@@ -39,9 +41,11 @@
 #include "gtkstylepropertiesprivate.h"
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
+#include "gtkthemingengine.h"
 #include "gtkbindings.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
+#include "gtkversion.h"
 #include "gtkintl.h"
 
 /**
@@ -1017,6 +1021,10 @@ struct _GtkCssProviderPrivate
   GArray *rulesets;
   GtkCssSelectorTree *tree;
   GResource *resource;
+
+  /* only needed for gtk_css_provider_save_cache() */
+  GPtrArray *sources;           /* GFiles that were loaded */
+  GPtrArray *bindings;          /* pairs of binding set name, binding */
 };
 
 enum {
@@ -1395,7 +1403,10 @@ gtk_css_provider_init (GtkCssProvider *css_provider)
                                                  (GDestroyNotify) _gtk_css_value_unref);
   priv->keyframes = g_hash_table_new_full (g_str_hash, g_str_equal,
                                            (GDestroyNotify) g_free,
-                                           (GDestroyNotify) _gtk_css_value_unref);
+                                           (GDestroyNotify) _gtk_css_keyframes_unref);
+
+  priv->sources = g_ptr_array_new_with_free_func (g_object_unref);
+  priv->bindings = g_ptr_array_new_with_free_func (g_free);
 }
 
 static void
@@ -1662,6 +1673,9 @@ gtk_css_provider_finalize (GObject *object)
   g_hash_table_destroy (priv->symbolic_colors);
   g_hash_table_destroy (priv->keyframes);
 
+  g_ptr_array_unref (priv->sources);
+  g_ptr_array_unref (priv->bindings);
+
   if (priv->resource)
     {
       g_resources_unregister (priv->resource);
@@ -1798,6 +1812,8 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
   _gtk_css_selector_tree_free (priv->tree);
   priv->tree = NULL;
 
+  g_ptr_array_set_size (priv->sources, 0);
+  g_ptr_array_set_size (priv->bindings, 0);
 }
 
 static void
@@ -1958,7 +1974,7 @@ static gboolean
 parse_binding_set (GtkCssScanner *scanner)
 {
   GtkBindingSet *binding_set;
-  char *name;
+  char *name, *binding;
 
   gtk_css_scanner_push_section (scanner, GTK_CSS_SECTION_BINDING_SET);
 
@@ -1986,7 +2002,6 @@ parse_binding_set (GtkCssScanner *scanner)
       binding_set = gtk_binding_set_new (name);
       binding_set->parsed = TRUE;
     }
-  g_free (name);
 
   if (!_gtk_css_parser_try (scanner->parser, "{", TRUE))
     {
@@ -2002,23 +2017,29 @@ parse_binding_set (GtkCssScanner *scanner)
   while (!_gtk_css_parser_is_eof (scanner->parser) &&
          !_gtk_css_parser_begins_with (scanner->parser, '}'))
     {
-      name = _gtk_css_parser_read_value (scanner->parser);
-      if (name == NULL)
+      binding = _gtk_css_parser_read_value (scanner->parser);
+      if (binding == NULL)
         {
           _gtk_css_parser_resync (scanner->parser, TRUE, '}');
           continue;
         }
 
-      if (gtk_binding_entry_add_signal_from_string (binding_set, name) != G_TOKEN_NONE)
+      if (gtk_binding_entry_add_signal_from_string (binding_set, binding) != G_TOKEN_NONE)
         {
           gtk_css_provider_error_literal (scanner->provider,
                                           scanner,
                                           GTK_CSS_PROVIDER_ERROR,
                                           GTK_CSS_PROVIDER_ERROR_SYNTAX,
                                           "Failed to parse binding set.");
+          g_free (binding);
+        }
+      else
+        {
+          /* Bindings aren't part of the provider, so remember them for
+           * gtk_css_provider_save_cache() */
+          g_ptr_array_add (scanner->provider->priv->bindings, g_strdup (name));
+          g_ptr_array_add (scanner->provider->priv->bindings, binding);
         }
-
-      g_free (name);
 
       if (!_gtk_css_parser_try (scanner->parser, ";", TRUE))
         {
@@ -2057,6 +2078,8 @@ skip_semicolon:
       _gtk_css_parser_try (scanner->parser, ";", TRUE);
     }
 
+  g_free (name);
+
   gtk_css_scanner_pop_section (scanner, GTK_CSS_SECTION_BINDING_SET);
 
   return TRUE;
@@ -2485,6 +2508,9 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
   else
     error_handler = 0; /* silence gcc */
 
+  if (file)
+    g_ptr_array_add (css_provider->priv->sources, g_object_ref (file));
+
   if (text == NULL)
     {
       GError *load_error = NULL;
@@ -2689,6 +2715,634 @@ gtk_css_provider_load_from_resource (GtkCssProvider  *css_provider,
   g_object_unref (file);
 }
 
+/* COMPILED THEMES */
+
+/* Compiled themes are a binary dump of a provider, written by
+ * gtk_css_provider_save_cache() and used by _gtk_css_provider_load_named()
+ * instead of the CSS when none of the source files changed. They are
+ * only valid for the GTK+ version and host that wrote them.
+ *
+ * The cache is mapped, but not used in place: GtkCssValues are
+ * refcounted objects with a class pointer, shared with values created
+ * at runtime, so they are rebuilt from the mapped data. What the cache
+ * saves is tokenizing and parsing the CSS, resolving the selectors and
+ * building the selector tree; values the format can't represent are
+ * stored as CSS text and parsed on load.
+ */
+#define GTK_CSS_CACHE_MAGIC "GTK CSS cache"
+#define GTK_CSS_CACHE_VERSION 1
+
+static GtkCssValue *
+parse_property_value (GtkCssParser *parser,
+                      gpointer      property)
+{
+  return _gtk_style_property_parse_value (property, parser);
+}
+
+static GtkCssValue *
+parse_color_value (GtkCssParser *parser,
+                   gpointer      unused)
+{
+  return _gtk_css_color_value_parse (parser);
+}
+
+static void
+gtk_css_provider_serialize_engines (GtkCssProvider     *css_provider,
+                                    GtkCssBinaryWriter *writer)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  GtkCssStyleProperty *engine_property;
+  GPtrArray *names;
+  guint i, j;
+
+  engine_property = _gtk_css_style_property_lookup_by_id (GTK_CSS_PROPERTY_ENGINE);
+  names = g_ptr_array_new_with_free_func (g_free);
+
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      for (j = 0; j < ruleset->n_styles; j++)
+        {
+          char *name;
+
+          if (ruleset->styles[j].property != engine_property)
+            continue;
+
+          /* the value might as well be inherit or initial */
+          name = _gtk_css_value_to_string (ruleset->styles[j].value);
+          if (g_str_equal (name, "none") ||
+              g_str_equal (name, "inherit") ||
+              g_str_equal (name, "initial"))
+            g_free (name);
+          else
+            g_ptr_array_add (names, name);
+        }
+    }
+
+  _gtk_css_binary_writer_put_uint (writer, names->len);
+  for (i = 0; i < names->len; i++)
+    _gtk_css_binary_writer_put_string (writer, g_ptr_array_index (names, i));
+
+  g_ptr_array_unref (names);
+}
+
+static void
+gtk_css_provider_serialize_rulesets (GtkCssProvider     *css_provider,
+                                     GtkCssBinaryWriter *writer)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  GHashTable *style_ids, *widget_style_ids, *match_ids;
+  GPtrArray *styles, *widget_styles;
+  GtkCssRuleset *ruleset;
+  guint i, j;
+
+  /* Rulesets with several selectors share their declarations,
+   * so only save those once */
+  style_ids = g_hash_table_new (NULL, NULL);
+  widget_style_ids = g_hash_table_new (NULL, NULL);
+  match_ids = g_hash_table_new (NULL, NULL);
+  styles = g_ptr_array_new ();
+  widget_styles = g_ptr_array_new ();
+
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      g_hash_table_insert (match_ids, ruleset, GUINT_TO_POINTER (i + 1));
+
+      if (ruleset->styles && !g_hash_table_contains (style_ids, ruleset->styles))
+        {
+          g_hash_table_insert (style_ids, ruleset->styles, GUINT_TO_POINTER (styles->len + 1));
+          g_ptr_array_add (styles, ruleset);
+        }
+      if (ruleset->widget_style && !g_hash_table_contains (widget_style_ids, ruleset->widget_style))
+        {
+          g_hash_table_insert (widget_style_ids, ruleset->widget_style, GUINT_TO_POINTER (widget_styles->len + 1));
+          g_ptr_array_add (widget_styles, ruleset->widget_style);
+        }
+    }
+
+  _gtk_css_binary_writer_put_uint (writer, styles->len);
+  for (i = 0; i < styles->len; i++)
+    {
+      ruleset = g_ptr_array_index (styles, i);
+
+      _gtk_css_binary_writer_put_uint (writer, ruleset->n_styles);
+      for (j = 0; j < ruleset->n_styles; j++)
+        {
+          _gtk_css_binary_writer_put_string (writer, _gtk_style_property_get_name (GTK_STYLE_PROPERTY (ruleset->styles[j].property)));
+          _gtk_css_binary_writer_put_value_or_text (writer, ruleset->styles[j].value);
+        }
+    }
+
+  _gtk_css_binary_writer_put_uint (writer, widget_styles->len);
+  for (i = 0; i < widget_styles->len; i++)
+    {
+      WidgetPropertyValue *l;
+
+      j = 0;
+      for (l = g_ptr_array_index (widget_styles, i); l; l = l->next)
+        j++;
+
+      _gtk_css_binary_writer_put_uint (writer, j);
+      for (l = g_ptr_array_index (widget_styles, i); l; l = l->next)
+        {
+          _gtk_css_binary_writer_put_string (writer, l->name);
+          _gtk_css_binary_writer_put_string (writer, l->value);
+        }
+    }
+
+  _gtk_css_binary_writer_put_uint (writer, priv->rulesets->len);
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      _gtk_css_binary_writer_put_int (writer, GPOINTER_TO_INT (g_hash_table_lookup (style_ids, ruleset->styles)) - 1);
+      _gtk_css_binary_writer_put_int (writer, GPOINTER_TO_INT (g_hash_table_lookup (widget_style_ids, ruleset->widget_style)) - 1);
+    }
+
+  _gtk_css_selector_tree_serialize (priv->tree, writer, match_ids);
+
+  g_ptr_array_free (widget_styles, TRUE);
+  g_ptr_array_free (styles, TRUE);
+  g_hash_table_unref (match_ids);
+  g_hash_table_unref (widget_style_ids);
+  g_hash_table_unref (style_ids);
+}
+
+/**
+ * gtk_css_provider_save_cache:
+ * @css_provider: a #GtkCssProvider
+ * @filename: (type filename): the file to write to
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Saves the contents of @css_provider in a binary format that GTK+
+ * can load much faster than CSS. If it is saved next to the CSS file
+ * of a theme as <filename>gtk.css.cache</filename>, it will be used
+ * instead of <filename>gtk.css</filename> as long as none of the
+ * loaded files changed. The gtk-compile-theme utility uses this.
+ *
+ * This only works if @css_provider was loaded from local files.
+ * The cache is specific to the GTK+ version writing it.
+ *
+ * Returns: %TRUE if the cache was written
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_css_provider_save_cache (GtkCssProvider  *css_provider,
+                             const gchar     *filename,
+                             GError         **error)
+{
+  GtkCssProviderPrivate *priv;
+  GtkCssBinaryWriter *writer;
+  GHashTableIter iter;
+  gpointer key, value;
+  GBytes *bytes;
+  gboolean result;
+  guint i;
+
+  g_return_val_if_fail (GTK_IS_CSS_PROVIDER (css_provider), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  priv = css_provider->priv;
+
+  if (priv->sources->len == 0)
+    {
+      g_set_error_literal (error, GTK_CSS_PROVIDER_ERROR, GTK_CSS_PROVIDER_ERROR_FAILED,
+                           "Provider was not loaded from a file");
+      return FALSE;
+    }
+
+  writer = _gtk_css_binary_writer_new ();
+
+  _gtk_css_binary_writer_put_string (writer, GTK_CSS_CACHE_MAGIC);
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_CACHE_VERSION);
+  _gtk_css_binary_writer_put_uint (writer, GTK_MAJOR_VERSION);
+  _gtk_css_binary_writer_put_uint (writer, GTK_MINOR_VERSION);
+  _gtk_css_binary_writer_put_uint (writer, GTK_MICRO_VERSION);
+  _gtk_css_binary_writer_put_uint (writer, sizeof (gpointer));
+
+  _gtk_css_binary_writer_put_uint (writer, priv->sources->len);
+  for (i = 0; i < priv->sources->len; i++)
+    {
+      GStatBuf stat_buf;
+      char *path;
+
+      path = g_file_get_path (g_ptr_array_index (priv->sources, i));
+      if (path == NULL || g_stat (path, &stat_buf) != 0)
+        {
+          char *uri = g_file_get_uri (g_ptr_array_index (priv->sources, i));
+
+          g_set_error (error, GTK_CSS_PROVIDER_ERROR, GTK_CSS_PROVIDER_ERROR_FAILED,
+                       "Cannot cache %s: not a local file", uri);
+          g_free (uri);
+          g_free (path);
+          g_bytes_unref (_gtk_css_binary_writer_free_to_bytes (writer));
+          return FALSE;
+        }
+
+      _gtk_css_binary_writer_put_string (writer, path);
+      _gtk_css_binary_writer_put_int64 (writer, stat_buf.st_mtime);
+      _gtk_css_binary_writer_put_int64 (writer, stat_buf.st_size);
+      g_free (path);
+    }
+
+  gtk_css_provider_serialize_engines (css_provider, writer);
+
+  _gtk_css_binary_writer_put_uint (writer, g_hash_table_size (priv->symbolic_colors));
+  g_hash_table_iter_init (&iter, priv->symbolic_colors);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      _gtk_css_binary_writer_put_string (writer, key);
+      _gtk_css_binary_writer_put_value_or_text (writer, value);
+    }
+
+  _gtk_css_binary_writer_put_uint (writer, g_hash_table_size (priv->keyframes));
+  g_hash_table_iter_init (&iter, priv->keyframes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      _gtk_css_binary_writer_put_string (writer, key);
+      _gtk_css_keyframes_serialize (value, writer);
+    }
+
+  gtk_css_provider_serialize_rulesets (css_provider, writer);
+
+  _gtk_css_binary_writer_put_uint (writer, priv->bindings->len / 2);
+  for (i = 0; i < priv->bindings->len; i++)
+    _gtk_css_binary_writer_put_string (writer, g_ptr_array_index (priv->bindings, i));
+
+  bytes = _gtk_css_binary_writer_free_to_bytes (writer);
+  result = g_file_set_contents (filename,
+                                g_bytes_get_data (bytes, NULL),
+                                g_bytes_get_size (bytes),
+                                error);
+  g_bytes_unref (bytes);
+
+  return result;
+}
+
+static void
+gtk_css_provider_deserialize_rulesets (GtkCssProvider     *css_provider,
+                                       GtkCssBinaryReader *reader)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  PropertyValue **styles;
+  WidgetPropertyValue **widget_styles;
+  guint *n_styles;
+  gboolean *styles_owned, *widget_styles_owned;
+  guint n_style_blocks, n_widget_blocks, n_rulesets;
+  guint i, j, n;
+
+  /* don't trust corrupt data with huge allocations */
+  n_style_blocks = _gtk_css_binary_reader_get_uint (reader);
+  if (n_style_blocks > G_MAXUINT16)
+    {
+      _gtk_css_binary_reader_fail (reader);
+      return;
+    }
+
+  styles = g_new0 (PropertyValue *, n_style_blocks);
+  n_styles = g_new0 (guint, n_style_blocks);
+  styles_owned = g_new0 (gboolean, n_style_blocks);
+
+  for (i = 0; i < n_style_blocks && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      n = _gtk_css_binary_reader_get_uint (reader);
+      if (n == 0 || n > _gtk_css_style_property_get_n_properties ())
+        {
+          _gtk_css_binary_reader_fail (reader);
+          break;
+        }
+
+      styles[i] = g_new0 (PropertyValue, n);
+      for (j = 0; j < n; j++)
+        {
+          GtkStyleProperty *property;
+          GtkCssValue *value;
+          const char *name;
+
+          name = _gtk_css_binary_reader_get_string (reader);
+          property = name ? _gtk_style_property_lookup (name) : NULL;
+          if (!GTK_IS_CSS_STYLE_PROPERTY (property))
+            {
+              _gtk_css_binary_reader_fail (reader);
+              break;
+            }
+
+          value = _gtk_css_binary_reader_get_value_or_text (reader, parse_property_value, property);
+          if (value == NULL)
+            break;
+
+          styles[i][j].property = GTK_CSS_STYLE_PROPERTY (property);
+          styles[i][j].value = value;
+          n_styles[i]++;
+        }
+    }
+
+  n_widget_blocks = _gtk_css_binary_reader_get_uint (reader);
+  if (n_widget_blocks > G_MAXUINT16)
+    _gtk_css_binary_reader_fail (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    n_widget_blocks = 0;
+
+  widget_styles = g_new0 (WidgetPropertyValue *, n_widget_blocks);
+  widget_styles_owned = g_new0 (gboolean, n_widget_blocks);
+
+  for (i = 0; i < n_widget_blocks && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      WidgetPropertyValue **last = &widget_styles[i];
+
+      n = _gtk_css_binary_reader_get_uint (reader);
+      if (n == 0)
+        _gtk_css_binary_reader_fail (reader);
+
+      for (j = 0; j < n && !_gtk_css_binary_reader_failed (reader); j++)
+        {
+          WidgetPropertyValue *value;
+          const char *name, *string;
+
+          name = _gtk_css_binary_reader_get_string (reader);
+          string = _gtk_css_binary_reader_get_string (reader);
+          if (name == NULL || string == NULL)
+            {
+              _gtk_css_binary_reader_fail (reader);
+              break;
+            }
+
+          value = widget_property_value_new (g_strdup (name), NULL);
+          value->value = g_strdup (string);
+          *last = value;
+          last = &value->next;
+        }
+    }
+
+  n_rulesets = _gtk_css_binary_reader_get_uint (reader);
+  if (n_rulesets > G_MAXINT32 / sizeof (GtkCssRuleset))
+    _gtk_css_binary_reader_fail (reader);
+
+  for (i = 0; i < n_rulesets && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      GtkCssRuleset ruleset = { NULL, };
+      gint32 style_id, widget_style_id;
+
+      style_id = _gtk_css_binary_reader_get_int (reader);
+      widget_style_id = _gtk_css_binary_reader_get_int (reader);
+      if (style_id < -1 || style_id >= (gint32) n_style_blocks ||
+          widget_style_id < -1 || widget_style_id >= (gint32) n_widget_blocks ||
+          (style_id < 0 && widget_style_id < 0))
+        {
+          _gtk_css_binary_reader_fail (reader);
+          break;
+        }
+
+      /* Like in css_provider_commit(), the first ruleset
+       * using a block owns it */
+      if (style_id >= 0)
+        {
+          ruleset.styles = styles[style_id];
+          ruleset.n_styles = n_styles[style_id];
+          ruleset.owns_styles = !styles_owned[style_id];
+          styles_owned[style_id] = TRUE;
+
+          ruleset.set_styles = _gtk_bitmask_new ();
+          for (j = 0; j < ruleset.n_styles; j++)
+            {
+              ruleset.set_styles = _gtk_bitmask_set (ruleset.set_styles,
+                                                     _gtk_css_style_property_get_id (ruleset.styles[j].property),
+                                                     TRUE);
+            }
+        }
+
+      if (widget_style_id >= 0)
+        {
+          ruleset.widget_style = widget_styles[widget_style_id];
+          ruleset.owns_widget_style = !widget_styles_owned[widget_style_id];
+          widget_styles_owned[widget_style_id] = TRUE;
+        }
+
+      g_array_append_val (priv->rulesets, ruleset);
+    }
+
+  /* free everything no ruleset took over */
+  for (i = 0; i < n_style_blocks; i++)
+    {
+      if (styles_owned[i])
+        continue;
+
+      for (j = 0; j < n_styles[i]; j++)
+        _gtk_css_value_unref (styles[i][j].value);
+      g_free (styles[i]);
+    }
+  for (i = 0; i < n_widget_blocks; i++)
+    {
+      if (!widget_styles_owned[i])
+        widget_property_value_list_free (widget_styles[i]);
+    }
+
+  g_free (widget_styles_owned);
+  g_free (widget_styles);
+  g_free (styles_owned);
+  g_free (n_styles);
+  g_free (styles);
+}
+
+static gboolean
+gtk_css_provider_is_cache_fresh (GtkCssBinaryReader *reader,
+                                 GPtrArray          *sources)
+{
+  guint i, n_sources;
+
+  if (g_strcmp0 (_gtk_css_binary_reader_get_string (reader), GTK_CSS_CACHE_MAGIC) != 0 ||
+      _gtk_css_binary_reader_get_uint (reader) != GTK_CSS_CACHE_VERSION ||
+      _gtk_css_binary_reader_get_uint (reader) != GTK_MAJOR_VERSION ||
+      _gtk_css_binary_reader_get_uint (reader) != GTK_MINOR_VERSION ||
+      _gtk_css_binary_reader_get_uint (reader) != GTK_MICRO_VERSION ||
+      _gtk_css_binary_reader_get_uint (reader) != sizeof (gpointer))
+    return FALSE;
+
+  n_sources = _gtk_css_binary_reader_get_uint (reader);
+  if (n_sources == 0 || _gtk_css_binary_reader_failed (reader))
+    return FALSE;
+
+  for (i = 0; i < n_sources; i++)
+    {
+      GStatBuf stat_buf;
+      const char *path;
+      gint64 mtime, size;
+
+      path = _gtk_css_binary_reader_get_string (reader);
+      mtime = _gtk_css_binary_reader_get_int64 (reader);
+      size = _gtk_css_binary_reader_get_int64 (reader);
+
+      if (path == NULL ||
+          g_stat (path, &stat_buf) != 0 ||
+          stat_buf.st_mtime != mtime ||
+          stat_buf.st_size != size)
+        return FALSE;
+
+      g_ptr_array_add (sources, g_file_new_for_path (path));
+    }
+
+  return TRUE;
+}
+
+/* Loads the compiled theme next to the CSS file at @path if it is up
+ * to date. On failure, nothing is loaded. */
+static gboolean
+gtk_css_provider_load_cache (GtkCssProvider *css_provider,
+                             const char     *path)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  GtkCssBinaryReader *reader;
+  GtkCssSelectorTree **selector_matches;
+  GMappedFile *mapped;
+  gpointer *matches;
+  const char **bindings;
+  char *cache_path;
+  guint i, n;
+
+#ifdef VERIFY_TREE
+  /* the cache doesn't contain the selectors needed for verifying */
+  return FALSE;
+#endif
+
+  /* sections aren't cached */
+  if (gtk_keep_css_sections)
+    return FALSE;
+
+  cache_path = g_strconcat (path, ".cache", NULL);
+  mapped = g_mapped_file_new (cache_path, FALSE, NULL);
+  g_free (cache_path);
+  if (mapped == NULL)
+    return FALSE;
+
+  reader = _gtk_css_binary_reader_new ((const guint8 *) g_mapped_file_get_contents (mapped),
+                                       g_mapped_file_get_length (mapped));
+  bindings = NULL;
+
+  if (!gtk_css_provider_is_cache_fresh (reader, priv->sources))
+    goto fail;
+
+  /* Engines register their custom properties when loaded,
+   * so make sure they are before looking up any properties */
+  n = _gtk_css_binary_reader_get_uint (reader);
+  for (i = 0; i < n && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      const char *name = _gtk_css_binary_reader_get_string (reader);
+
+      if (name == NULL || gtk_theming_engine_load (name) == NULL)
+        goto fail;
+    }
+
+  n = _gtk_css_binary_reader_get_uint (reader);
+  for (i = 0; i < n && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      GtkCssValue *color;
+      const char *name;
+
+      name = _gtk_css_binary_reader_get_string (reader);
+      color = _gtk_css_binary_reader_get_value_or_text (reader, parse_color_value, NULL);
+      if (name == NULL || color == NULL)
+        {
+          if (color)
+            _gtk_css_value_unref (color);
+          goto fail;
+        }
+
+      g_hash_table_insert (priv->symbolic_colors, g_strdup (name), color);
+    }
+
+  n = _gtk_css_binary_reader_get_uint (reader);
+  for (i = 0; i < n && !_gtk_css_binary_reader_failed (reader); i++)
+    {
+      GtkCssKeyframes *keyframes;
+      const char *name;
+
+      name = _gtk_css_binary_reader_get_string (reader);
+      if (name == NULL)
+        goto fail;
+
+      keyframes = _gtk_css_keyframes_deserialize (reader);
+      if (keyframes == NULL)
+        goto fail;
+
+      g_hash_table_insert (priv->keyframes, g_strdup (name), keyframes);
+    }
+
+  gtk_css_provider_deserialize_rulesets (css_provider, reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    goto fail;
+
+  n = priv->rulesets->len;
+  matches = g_new (gpointer, n);
+  selector_matches = g_new0 (GtkCssSelectorTree *, n);
+  for (i = 0; i < n; i++)
+    matches[i] = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+  priv->tree = _gtk_css_selector_tree_deserialize (reader, matches, selector_matches, n);
+  for (i = 0; i < n; i++)
+    g_array_index (priv->rulesets, GtkCssRuleset, i).selector_match = selector_matches[i];
+
+  g_free (selector_matches);
+  g_free (matches);
+
+  /* every ruleset must be in the tree */
+  for (i = 0; i < n; i++)
+    {
+      if (g_array_index (priv->rulesets, GtkCssRuleset, i).selector_match == NULL)
+        goto fail;
+    }
+
+  /* Bindings change global state, so only apply them
+   * once we know the cache is good */
+  n = _gtk_css_binary_reader_get_uint (reader);
+  if (n > G_MAXUINT16)
+    goto fail;
+  bindings = g_new (const char *, n * 2);
+  for (i = 0; i < n * 2; i++)
+    {
+      bindings[i] = _gtk_css_binary_reader_get_string (reader);
+      if (bindings[i] == NULL)
+        goto fail;
+    }
+
+  if (_gtk_css_binary_reader_failed (reader))
+    goto fail;
+
+  for (i = 0; i < n; i++)
+    {
+      GtkBindingSet *binding_set;
+
+      binding_set = gtk_binding_set_find (bindings[2 * i]);
+      if (!binding_set)
+        {
+          binding_set = gtk_binding_set_new (bindings[2 * i]);
+          binding_set->parsed = TRUE;
+        }
+
+      gtk_binding_entry_add_signal_from_string (binding_set, bindings[2 * i + 1]);
+      g_ptr_array_add (priv->bindings, g_strdup (bindings[2 * i]));
+      g_ptr_array_add (priv->bindings, g_strdup (bindings[2 * i + 1]));
+    }
+
+  g_free (bindings);
+  _gtk_css_binary_reader_free (reader);
+  g_mapped_file_unref (mapped);
+
+  return TRUE;
+
+fail:
+  g_free (bindings);
+  _gtk_css_binary_reader_free (reader);
+  g_mapped_file_unref (mapped);
+  gtk_css_provider_reset (css_provider);
+
+  return FALSE;
+}
+
 /**
  * gtk_css_provider_get_default:
  *
@@ -2819,7 +3473,10 @@ _gtk_css_provider_load_named (GtkCssProvider *provider,
       if (resource != NULL)
         g_resources_register (resource);
 
-      gtk_css_provider_load_from_path (provider, path, NULL);
+      if (gtk_css_provider_load_cache (provider, path))
+        _gtk_style_provider_private_changed (GTK_STYLE_PROVIDER_PRIVATE (provider));
+      else
+        gtk_css_provider_load_from_path (provider, path, NULL);
 
       /* Only set this after load, as load_from_path will clear it */
       provider->priv->resource = resource;
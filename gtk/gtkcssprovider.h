@@ -92,6 +92,11 @@ gboolean         gtk_css_provider_load_from_path (GtkCssProvider  *css_provider,
                                                   const gchar     *path,
                                                   GError         **error);
 
+GDK_AVAILABLE_IN_3_10
+gboolean         gtk_css_provider_save_cache     (GtkCssProvider  *css_provider,
+                                                  const gchar     *filename,
+                                                  GError         **error);
+
 GDK_AVAILABLE_IN_ALL
 GtkCssProvider * gtk_css_provider_get_default (void);
 
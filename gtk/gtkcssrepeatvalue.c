@@ -114,12 +114,35 @@ gtk_css_value_border_repeat_print (const GtkCssValue *repeat,
     }
 }
 
+static gboolean
+gtk_css_value_background_repeat_serialize (const GtkCssValue  *repeat,
+                                           GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_BACKGROUND_REPEAT);
+  _gtk_css_binary_writer_put_uint (writer, repeat->x);
+  _gtk_css_binary_writer_put_uint (writer, repeat->y);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_value_border_repeat_serialize (const GtkCssValue  *repeat,
+                                       GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_BORDER_REPEAT);
+  _gtk_css_binary_writer_put_uint (writer, repeat->x);
+  _gtk_css_binary_writer_put_uint (writer, repeat->y);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BACKGROUND_REPEAT = {
   gtk_css_value_repeat_free,
   gtk_css_value_repeat_compute,
   gtk_css_value_repeat_equal,
   gtk_css_value_repeat_transition,
-  gtk_css_value_background_repeat_print
+  gtk_css_value_background_repeat_print,
+  gtk_css_value_background_repeat_serialize
 };
 
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER_REPEAT = {
@@ -127,7 +150,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BORDER_REPEAT = {
   gtk_css_value_repeat_compute,
   gtk_css_value_repeat_equal,
   gtk_css_value_repeat_transition,
-  gtk_css_value_border_repeat_print
+  gtk_css_value_border_repeat_print,
+  gtk_css_value_border_repeat_serialize
 };
 /* BACKGROUND REPEAT */
 
@@ -312,3 +336,23 @@ _gtk_css_border_repeat_value_get_y (const GtkCssValue *repeat)
   return repeat->y;
 }
 
+/* BINARY FORM */
+
+GtkCssValue *
+_gtk_css_repeat_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  GtkCssRepeatStyle x, y;
+
+  x = _gtk_css_binary_reader_get_uint (reader);
+  y = _gtk_css_binary_reader_get_uint (reader);
+  if (_gtk_css_binary_reader_failed (reader) ||
+      x > GTK_CSS_REPEAT_STYLE_SPACE ||
+      y > GTK_CSS_REPEAT_STYLE_SPACE)
+    return NULL;
+
+  if (tag == GTK_CSS_BINARY_TAG_BACKGROUND_REPEAT)
+    return _gtk_css_background_repeat_value_new (x, y);
+  else
+    return _gtk_css_border_repeat_value_new (x, y);
+}
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_REPEAT_VALUE_PRIVATE_H__
 #define __GTK_CSS_REPEAT_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 
@@ -45,6 +46,9 @@ GtkCssValue *       _gtk_css_border_repeat_value_try_parse      (GtkCssParser
 GtkCssRepeatStyle   _gtk_css_border_repeat_value_get_x          (const GtkCssValue      *repeat);
 GtkCssRepeatStyle   _gtk_css_border_repeat_value_get_y          (const GtkCssValue      *repeat);
 
+GtkCssValue *       _gtk_css_repeat_value_deserialize           (GtkCssBinaryReader     *reader,
+                                                                 GtkCssBinaryTag         tag);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_REPEAT_VALUE_PRIVATE_H__ */
@@ -78,12 +78,26 @@ gtk_css_value_rgba_print (const GtkCssValue *rgba,
   g_free (s);
 }
 
+static gboolean
+gtk_css_value_rgba_serialize (const GtkCssValue  *rgba,
+                              GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_RGBA);
+  _gtk_css_binary_writer_put_double (writer, rgba->rgba.red);
+  _gtk_css_binary_writer_put_double (writer, rgba->rgba.green);
+  _gtk_css_binary_writer_put_double (writer, rgba->rgba.blue);
+  _gtk_css_binary_writer_put_double (writer, rgba->rgba.alpha);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_RGBA = {
   gtk_css_value_rgba_free,
   gtk_css_value_rgba_compute,
   gtk_css_value_rgba_equal,
   gtk_css_value_rgba_transition,
-  gtk_css_value_rgba_print
+  gtk_css_value_rgba_print,
+  gtk_css_value_rgba_serialize
 };
 
 GtkCssValue *
@@ -99,6 +113,22 @@ _gtk_css_rgba_value_new_from_rgba (const GdkRGBA *rgba)
   return value;
 }
 
+GtkCssValue *
+_gtk_css_rgba_value_deserialize (GtkCssBinaryReader *reader,
+                                 GtkCssBinaryTag     tag)
+{
+  GdkRGBA rgba;
+
+  rgba.red = _gtk_css_binary_reader_get_double (reader);
+  rgba.green = _gtk_css_binary_reader_get_double (reader);
+  rgba.blue = _gtk_css_binary_reader_get_double (reader);
+  rgba.alpha = _gtk_css_binary_reader_get_double (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+
+  return _gtk_css_rgba_value_new_from_rgba (&rgba);
+}
+
 const GdkRGBA *
 _gtk_css_rgba_value_get_rgba (const GtkCssValue *rgba)
 {
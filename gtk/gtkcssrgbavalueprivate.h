@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_RGBA_VALUE_PRIVATE_H__
 #define __GTK_CSS_RGBA_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcsstypesprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -27,6 +28,8 @@
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_rgba_value_new_from_rgba (const GdkRGBA          *rgba);
+GtkCssValue *   _gtk_css_rgba_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                   GtkCssBinaryTag         tag);
 
 const GdkRGBA * _gtk_css_rgba_value_get_rgba      (const GtkCssValue      *rgba);
 
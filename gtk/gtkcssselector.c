@@ -66,7 +66,8 @@ struct _GtkCssSelector
 {
   const GtkCssSelectorClass *class;       /* type of check this selector does */
   gconstpointer              data;        /* data for matching:
-                                             - interned string for CLASS, NAME and ID
+                                             - GQuark for CLASS, ID and REGION
+                                             - TypeReference for NAME
                                              - GUINT_TO_POINTER() for PSEUDOCLASS_REGION/STATE */
 };
 
@@ -223,6 +224,9 @@ gtk_css_selector_tree_get_previous_change (const GtkCssSelectorTree *tree,
   return previous_change;
 }
 
+static gboolean gtk_css_selector_tree_may_match_ancestor (const GtkCssSelectorTree *tree,
+                                                          const GtkCssMatcher      *matcher);
+
 /* DESCENDANT */
 
 static void
@@ -254,18 +258,30 @@ gtk_css_selector_descendant_tree_match (const GtkCssSelectorTree *tree,
 					const GtkCssMatcher  *matcher,
 					GHashTable *res)
 {
+  const GtkCssSelectorTree *prev;
+  const GtkCssMatcher *child;
   GtkCssMatcher ancestor;
 
-  while (_gtk_css_matcher_get_parent (&ancestor, matcher))
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
     {
-      matcher = &ancestor;
+      /* Don't walk up the path if no ancestor can possibly match */
+      if (!gtk_css_selector_tree_may_match_ancestor (prev, matcher))
+        continue;
 
-      gtk_css_selector_tree_match_previous (tree, matcher, res);
+      child = matcher;
+      while (_gtk_css_matcher_get_parent (&ancestor, child))
+        {
+          child = &ancestor;
 
-      /* any matchers are dangerous here, as we may loop forever, but
-	 we can terminate now as all possible matches have already been added */
-      if (_gtk_css_matcher_matches_any (matcher))
-	break;
+          gtk_css_selector_tree_match (prev, child, res);
+
+          /* any matchers are dangerous here, as we may loop forever, but
+             we can terminate now as all possible matches have already been added */
+          if (_gtk_css_matcher_matches_any (child))
+            break;
+        }
     }
 }
 
@@ -825,7 +841,7 @@ static void
 gtk_css_selector_region_print (const GtkCssSelector *selector,
                                GString              *string)
 {
-  g_string_append (string, selector->data);
+  g_string_append (string, g_quark_to_string (GPOINTER_TO_UINT (selector->data)));
 }
 
 static gboolean
@@ -834,7 +850,7 @@ gtk_css_selector_region_match (const GtkCssSelector *selector,
 {
   const GtkCssSelector *previous;
 
-  if (!_gtk_css_matcher_has_region (matcher, selector->data, 0))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (selector->data), 0))
     return FALSE;
 
   previous = gtk_css_selector_previous (selector);
@@ -852,7 +868,7 @@ gtk_css_selector_region_tree_match (const GtkCssSelectorTree *tree,
 {
   const GtkCssSelectorTree *prev;
 
-  if (!_gtk_css_matcher_has_region (matcher, tree->selector.data, 0))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (tree->selector.data), 0))
     return;
 
   gtk_css_selector_tree_found_match (tree, res);
@@ -875,7 +891,7 @@ gtk_css_selector_region_tree_get_change (const GtkCssSelectorTree *tree,
   const GtkCssSelectorTree *prev;
   GtkCssChange change, previous_change;
 
-  if (!_gtk_css_matcher_has_region (matcher, tree->selector.data, 0))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (tree->selector.data), 0))
     return 0;
 
   change = 0;
@@ -920,7 +936,8 @@ static int
 gtk_css_selector_region_compare_one (const GtkCssSelector *a,
 				     const GtkCssSelector *b)
 {
-  return strcmp (a->data, b->data);
+  return strcmp (g_quark_to_string (GPOINTER_TO_UINT (a->data)),
+		 g_quark_to_string (GPOINTER_TO_UINT (b->data)));
 }
 
 static const GtkCssSelectorClass GTK_CSS_SELECTOR_REGION = {
@@ -1021,14 +1038,14 @@ gtk_css_selector_id_print (const GtkCssSelector *selector,
                            GString              *string)
 {
   g_string_append_c (string, '#');
-  g_string_append (string, selector->data);
+  g_string_append (string, g_quark_to_string (GPOINTER_TO_UINT (selector->data)));
 }
 
 static gboolean
 gtk_css_selector_id_match (const GtkCssSelector *selector,
                            const GtkCssMatcher  *matcher)
 {
-  if (!_gtk_css_matcher_has_id (matcher, selector->data))
+  if (!_gtk_css_matcher_has_id (matcher, GPOINTER_TO_UINT (selector->data)))
     return FALSE;
 
   return gtk_css_selector_match (gtk_css_selector_previous (selector), matcher);
@@ -1039,7 +1056,7 @@ gtk_css_selector_id_tree_match (const GtkCssSelectorTree *tree,
 				const GtkCssMatcher  *matcher,
 				GHashTable *res)
 {
-  if (!_gtk_css_matcher_has_id (matcher, tree->selector.data))
+  if (!_gtk_css_matcher_has_id (matcher, GPOINTER_TO_UINT (tree->selector.data)))
     return;
 
   gtk_css_selector_tree_found_match (tree, res);
@@ -1053,7 +1070,7 @@ gtk_css_selector_id_tree_get_change (const GtkCssSelectorTree *tree,
 {
   GtkCssChange change, previous_change;
 
-  if (!_gtk_css_matcher_has_id (matcher, tree->selector.data))
+  if (!_gtk_css_matcher_has_id (matcher, GPOINTER_TO_UINT (tree->selector.data)))
     return 0;
 
   change = 0;
@@ -1080,7 +1097,8 @@ static int
 gtk_css_selector_id_compare_one (const GtkCssSelector *a,
 				 const GtkCssSelector *b)
 {
-  return strcmp (a->data, b->data);
+  return strcmp (g_quark_to_string (GPOINTER_TO_UINT (a->data)),
+		 g_quark_to_string (GPOINTER_TO_UINT (b->data)));
 }
 
 static const GtkCssSelectorClass GTK_CSS_SELECTOR_ID = {
@@ -1094,6 +1112,51 @@ static const GtkCssSelectorClass GTK_CSS_SELECTOR_ID = {
   TRUE, FALSE, FALSE, TRUE, FALSE
 };
 
+/* ANCESTOR FILTER */
+
+/* Checks the simple selector at the root of @tree against the Bloom
+ * filter of the ancestors of @matcher. A %FALSE return means that
+ * @tree cannot match any ancestor. */
+static gboolean
+gtk_css_selector_tree_may_match_ancestor (const GtkCssSelectorTree *tree,
+                                          const GtkCssMatcher      *matcher)
+{
+  const GtkCssSelector *selector = &tree->selector;
+
+  if (selector->class == &GTK_CSS_SELECTOR_CLASS)
+    {
+      return _gtk_css_matcher_may_have_ancestor (matcher,
+                                                 GTK_CSS_MATCHER_KEY_CLASS,
+                                                 GPOINTER_TO_UINT (selector->data));
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_NAME)
+    {
+      GType type = ((TypeReference *) selector->data)->type;
+
+      /* interfaces aren't in the filter */
+      if (type == G_TYPE_INVALID || G_TYPE_IS_INTERFACE (type))
+        return TRUE;
+
+      return _gtk_css_matcher_may_have_ancestor (matcher,
+                                                 GTK_CSS_MATCHER_KEY_TYPE,
+                                                 (guint) type);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_ID)
+    {
+      return _gtk_css_matcher_may_have_ancestor (matcher,
+                                                 GTK_CSS_MATCHER_KEY_ID,
+                                                 GPOINTER_TO_UINT (selector->data));
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_REGION)
+    {
+      return _gtk_css_matcher_may_have_ancestor (matcher,
+                                                 GTK_CSS_MATCHER_KEY_REGION,
+                                                 GPOINTER_TO_UINT (selector->data));
+    }
+
+  return TRUE;
+}
+
 /* PSEUDOCLASS FOR STATE */
 
 static void
@@ -1391,7 +1454,7 @@ gtk_css_selector_pseudoclass_position_match_for_region (const GtkCssSelector *se
 
   selector = gtk_css_selector_previous (selector);
 
-  if (!_gtk_css_matcher_has_region (matcher, selector->data, selector_flags))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (selector->data), selector_flags))
     return FALSE;
 
   previous = gtk_css_selector_previous (selector);
@@ -1463,7 +1526,7 @@ gtk_css_selector_pseudoclass_position_tree_match_for_region (const GtkCssSelecto
   if (!get_selector_flags_for_position_region_match (&tree->selector, &selector_flags))
       return;
 
-  if (!_gtk_css_matcher_has_region (matcher, prev->selector.data, selector_flags))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (prev->selector.data), selector_flags))
     return;
 
   gtk_css_selector_tree_found_match (prev, res);
@@ -1517,7 +1580,7 @@ gtk_css_selector_pseudoclass_position_tree_get_change_for_region (const GtkCssSe
   if (!get_selector_flags_for_position_region_match (&tree->selector, &selector_flags))
       return 0;
 
-  if (!_gtk_css_matcher_has_region (matcher, prev->selector.data, selector_flags))
+  if (!_gtk_css_matcher_has_region (matcher, GPOINTER_TO_UINT (prev->selector.data), selector_flags))
     return 0;
 
   change = 0;
@@ -1677,7 +1740,7 @@ parse_selector_id (GtkCssParser *parser, GtkCssSelector *selector)
 
   selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_ID,
                                    selector,
-                                   g_intern_string (name));
+                                   GUINT_TO_POINTER (g_quark_from_string (name)));
 
   g_free (name);
 
@@ -1872,7 +1935,7 @@ try_parse_name (GtkCssParser   *parser,
       if (_gtk_style_context_check_region_name (name))
 	selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_REGION,
 					 selector,
-					 g_intern_string (name));
+					 GUINT_TO_POINTER (g_quark_from_string (name)));
       else
 	selector = gtk_css_selector_new (&GTK_CSS_SELECTOR_NAME,
 					 selector,
@@ -2492,3 +2555,270 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
 
   return tree;
 }
+
+/* BINARY FORM */
+
+/* indexes into this table are saved in compiled themes */
+static const GtkCssSelectorClass *selector_classes[] = {
+  &GTK_CSS_SELECTOR_DESCENDANT,
+  &GTK_CSS_SELECTOR_CHILD,
+  &GTK_CSS_SELECTOR_SIBLING,
+  &GTK_CSS_SELECTOR_ADJACENT,
+  &GTK_CSS_SELECTOR_ANY,
+  &GTK_CSS_SELECTOR_NAME,
+  &GTK_CSS_SELECTOR_REGION,
+  &GTK_CSS_SELECTOR_CLASS,
+  &GTK_CSS_SELECTOR_ID,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_STATE,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_POSITION
+};
+
+static void
+gtk_css_selector_tree_collect (const GtkCssSelectorTree *tree,
+                               GPtrArray                *nodes)
+{
+  for (; tree != NULL; tree = gtk_css_selector_tree_get_sibling (tree))
+    {
+      g_ptr_array_add (nodes, (gpointer) tree);
+      gtk_css_selector_tree_collect (gtk_css_selector_tree_get_previous (tree), nodes);
+    }
+}
+
+static gint32
+gtk_css_selector_tree_get_index (GHashTable               *node_ids,
+                                 const GtkCssSelectorTree *tree)
+{
+  if (tree == NULL)
+    return -1;
+
+  return GPOINTER_TO_INT (g_hash_table_lookup (node_ids, tree)) - 1;
+}
+
+/**
+ * _gtk_css_selector_tree_serialize:
+ * @tree: (allow-none): the tree to save
+ * @writer: the writer
+ * @match_ids: maps every match in @tree to its index + 1,
+ *   as a GUINT_TO_POINTER()
+ *
+ * Writes @tree so that _gtk_css_selector_tree_deserialize() can
+ * rebuild it. Nodes are saved in depth-first order, so parents
+ * always come before and previous and sibling nodes after a node.
+ **/
+void
+_gtk_css_selector_tree_serialize (const GtkCssSelectorTree *tree,
+                                  GtkCssBinaryWriter       *writer,
+                                  GHashTable               *match_ids)
+{
+  const GtkCssSelectorTree *node;
+  GHashTable *node_ids;
+  GPtrArray *nodes;
+  gpointer *matches;
+  guint i, j, n;
+
+  nodes = g_ptr_array_new ();
+  gtk_css_selector_tree_collect (tree, nodes);
+
+  node_ids = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < nodes->len; i++)
+    g_hash_table_insert (node_ids, nodes->pdata[i], GUINT_TO_POINTER (i + 1));
+
+  _gtk_css_binary_writer_put_uint (writer, nodes->len);
+
+  for (i = 0; i < nodes->len; i++)
+    {
+      node = nodes->pdata[i];
+
+      for (j = 0; j < G_N_ELEMENTS (selector_classes); j++)
+        {
+          if (selector_classes[j] == node->selector.class)
+            break;
+        }
+      g_assert (j < G_N_ELEMENTS (selector_classes));
+      _gtk_css_binary_writer_put_uint (writer, j);
+
+      if (node->selector.class == &GTK_CSS_SELECTOR_NAME)
+        _gtk_css_binary_writer_put_string (writer, ((TypeReference *) node->selector.data)->name);
+      else if (node->selector.class == &GTK_CSS_SELECTOR_CLASS ||
+               node->selector.class == &GTK_CSS_SELECTOR_REGION ||
+               node->selector.class == &GTK_CSS_SELECTOR_ID)
+        _gtk_css_binary_writer_put_string (writer, g_quark_to_string (GPOINTER_TO_UINT (node->selector.data)));
+      else
+        _gtk_css_binary_writer_put_int64 (writer, GPOINTER_TO_SIZE (node->selector.data));
+
+      _gtk_css_binary_writer_put_int (writer, gtk_css_selector_tree_get_index (node_ids, gtk_css_selector_tree_get_parent (node)));
+      _gtk_css_binary_writer_put_int (writer, gtk_css_selector_tree_get_index (node_ids, gtk_css_selector_tree_get_previous (node)));
+      _gtk_css_binary_writer_put_int (writer, gtk_css_selector_tree_get_index (node_ids, gtk_css_selector_tree_get_sibling (node)));
+
+      matches = gtk_css_selector_tree_get_matches (node);
+      for (n = 0; matches && matches[n] != NULL; n++)
+        ;
+      _gtk_css_binary_writer_put_uint (writer, n);
+      for (j = 0; j < n; j++)
+        _gtk_css_binary_writer_put_uint (writer, GPOINTER_TO_UINT (g_hash_table_lookup (match_ids, matches[j])) - 1);
+    }
+
+  g_hash_table_unref (node_ids);
+  g_ptr_array_free (nodes, TRUE);
+}
+
+static gint32
+gtk_css_selector_tree_offset_between (gint32 from,
+                                      gint32 to)
+{
+  if (to < 0)
+    return GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+
+  return (to - from) * (gint32) sizeof (GtkCssSelectorTree);
+}
+
+/**
+ * _gtk_css_selector_tree_deserialize:
+ * @reader: the reader
+ * @matches: the matches, indexed like the @match_ids passed to
+ *   _gtk_css_selector_tree_serialize()
+ * @selector_matches: array of @n_matches that gets set to the node
+ *   each match was found in, like _gtk_css_selector_tree_builder_add()
+ *   does
+ * @n_matches: number of matches
+ *
+ * Reads a tree written by _gtk_css_selector_tree_serialize(). On
+ * invalid data, the reader is marked as failed and %NULL is returned.
+ *
+ * Returns: (transfer full) (allow-none): the tree
+ **/
+GtkCssSelectorTree *
+_gtk_css_selector_tree_deserialize (GtkCssBinaryReader  *reader,
+                                    gpointer            *matches,
+                                    GtkCssSelectorTree **selector_matches,
+                                    guint                n_matches)
+{
+  GtkCssSelectorTree *tree, *node;
+  GArray *match_ids;
+  guint *n_node_matches;
+  guint n_nodes, i, j, n;
+  gsize matches_start;
+  gpointer *node_matches;
+
+  n_nodes = _gtk_css_binary_reader_get_uint (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+  if (n_nodes == 0)
+    return NULL;
+  /* don't trust corrupt data with huge allocations */
+  if (n_nodes > G_MAXINT32 / sizeof (GtkCssSelectorTree) / 2)
+    {
+      _gtk_css_binary_reader_fail (reader);
+      return NULL;
+    }
+
+  /* Matches are placed after all nodes, so we don't know their
+   * offsets before everything is read */
+  tree = g_new0 (GtkCssSelectorTree, n_nodes);
+  n_node_matches = g_new0 (guint, n_nodes);
+  match_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < n_nodes; i++)
+    {
+      const GtkCssSelectorClass *class;
+      gint32 parent, previous, sibling;
+      const char *name;
+      guint class_id;
+
+      node = &tree[i];
+
+      class_id = _gtk_css_binary_reader_get_uint (reader);
+      if (class_id >= G_N_ELEMENTS (selector_classes))
+        break;
+      class = selector_classes[class_id];
+      node->selector.class = class;
+
+      if (class == &GTK_CSS_SELECTOR_NAME ||
+          class == &GTK_CSS_SELECTOR_CLASS ||
+          class == &GTK_CSS_SELECTOR_REGION ||
+          class == &GTK_CSS_SELECTOR_ID)
+        {
+          name = _gtk_css_binary_reader_get_string (reader);
+          if (name == NULL)
+            break;
+
+          if (class == &GTK_CSS_SELECTOR_NAME)
+            node->selector.data = get_type_reference (name);
+          else
+            node->selector.data = GUINT_TO_POINTER (g_quark_from_string (name));
+        }
+      else
+        node->selector.data = GSIZE_TO_POINTER (_gtk_css_binary_reader_get_int64 (reader));
+
+      /* Only allow links in the order they were saved in, so
+       * the tree can't contain loops */
+      parent = _gtk_css_binary_reader_get_int (reader);
+      previous = _gtk_css_binary_reader_get_int (reader);
+      sibling = _gtk_css_binary_reader_get_int (reader);
+      if (parent < -1 || parent >= (gint32) i ||
+          (previous != -1 && (previous <= (gint32) i || previous >= (gint32) n_nodes)) ||
+          (sibling != -1 && (sibling <= (gint32) i || sibling >= (gint32) n_nodes)))
+        break;
+
+      node->parent_offset = gtk_css_selector_tree_offset_between (i, parent);
+      node->previous_offset = gtk_css_selector_tree_offset_between (i, previous);
+      node->sibling_offset = gtk_css_selector_tree_offset_between (i, sibling);
+
+      n = _gtk_css_binary_reader_get_uint (reader);
+      if (_gtk_css_binary_reader_failed (reader) || n > n_matches)
+        break;
+
+      n_node_matches[i] = n;
+      for (j = 0; j < n; j++)
+        {
+          guint id = _gtk_css_binary_reader_get_uint (reader);
+
+          if (id >= n_matches)
+            break;
+
+          g_array_append_val (match_ids, id);
+        }
+      if (j < n || _gtk_css_binary_reader_failed (reader))
+        break;
+    }
+
+  if (i < n_nodes)
+    {
+      _gtk_css_binary_reader_fail (reader);
+      g_array_free (match_ids, TRUE);
+      g_free (n_node_matches);
+      g_free (tree);
+      return NULL;
+    }
+
+  /* Now append the NULL-terminated matches of every node */
+  matches_start = sizeof (GtkCssSelectorTree) * n_nodes;
+  tree = g_realloc (tree, matches_start + sizeof (gpointer) * (match_ids->len + n_nodes));
+  node_matches = (gpointer *) ((guint8 *) tree + matches_start);
+
+  for (i = 0, n = 0; i < n_nodes; i++)
+    {
+      node = &tree[i];
+
+      if (n_node_matches[i] == 0)
+        {
+          node->matches_offset = GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+          continue;
+        }
+
+      node->matches_offset = (guint8 *) node_matches - (guint8 *) node;
+      for (j = 0; j < n_node_matches[i]; j++)
+        {
+          guint id = g_array_index (match_ids, guint, n++);
+
+          *node_matches++ = matches[id];
+          selector_matches[id] = node;
+        }
+      *node_matches++ = NULL;
+    }
+
+  g_array_free (match_ids, TRUE);
+  g_free (n_node_matches);
+
+  return tree;
+}
@@ -18,6 +18,7 @@
 #ifndef __GTK_CSS_SELECTOR_PRIVATE_H__
 #define __GTK_CSS_SELECTOR_PRIVATE_H__
 
+#include "gtk/gtkcssbinaryprivate.h"
 #include "gtk/gtkcssmatcherprivate.h"
 #include "gtk/gtkcssparserprivate.h"
 
@@ -48,6 +49,15 @@ void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *
 						      GString                  *str);
 GtkCssChange _gtk_css_selector_tree_match_get_change (const GtkCssSelectorTree *tree);
 
+void         _gtk_css_selector_tree_serialize        (const GtkCssSelectorTree *tree,
+                                                      GtkCssBinaryWriter       *writer,
+                                                      GHashTable               *match_ids);
+GtkCssSelectorTree *
+             _gtk_css_selector_tree_deserialize      (GtkCssBinaryReader       *reader,
+                                                      gpointer                 *matches,
+                                                      GtkCssSelectorTree      **selector_matches,
+                                                      guint                     n_matches);
+
 
 GtkCssSelectorTreeBuilder *_gtk_css_selector_tree_builder_new   (void);
 void                       _gtk_css_selector_tree_builder_add   (GtkCssSelectorTreeBuilder *builder,
@@ -179,12 +179,31 @@ gtk_css_value_shadows_print (const GtkCssValue *value,
     }
 }
 
+static gboolean
+gtk_css_value_shadows_serialize (const GtkCssValue  *value,
+                                 GtkCssBinaryWriter *writer)
+{
+  guint i;
+
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_SHADOWS);
+  _gtk_css_binary_writer_put_uint (writer, value->len);
+
+  for (i = 0; i < value->len; i++)
+    {
+      if (!_gtk_css_binary_writer_put_value (writer, value->values[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_SHADOWS = {
   gtk_css_value_shadows_free,
   gtk_css_value_shadows_compute,
   gtk_css_value_shadows_equal,
   gtk_css_value_shadows_transition,
-  gtk_css_value_shadows_print
+  gtk_css_value_shadows_print,
+  gtk_css_value_shadows_serialize
 };
 
 static GtkCssValue none_singleton = { &GTK_CSS_VALUE_SHADOWS, 1, 0, { NULL } };
@@ -240,6 +259,51 @@ _gtk_css_shadows_value_parse (GtkCssParser *parser)
   return result;
 }
 
+GtkCssValue *
+_gtk_css_shadows_value_deserialize (GtkCssBinaryReader *reader,
+                                    GtkCssBinaryTag     tag)
+{
+  GtkCssValue *result;
+  GPtrArray *values;
+  guint i, n;
+
+  n = _gtk_css_binary_reader_get_uint (reader);
+  if (_gtk_css_binary_reader_failed (reader) || n > G_MAXUINT16)
+    return NULL;
+
+  if (n == 0)
+    return _gtk_css_shadows_value_new_none ();
+
+  values = g_ptr_array_new_with_free_func ((GDestroyNotify) _gtk_css_value_unref);
+
+  for (i = 0; i < n; i++)
+    {
+      GtkCssValue *value;
+
+      /* only accept shadows, anything else is corrupt data */
+      if (_gtk_css_binary_reader_get_uint (reader) != GTK_CSS_BINARY_TAG_SHADOW)
+        break;
+
+      value = _gtk_css_shadow_value_deserialize (reader, GTK_CSS_BINARY_TAG_SHADOW);
+      if (value == NULL)
+        break;
+
+      g_ptr_array_add (values, value);
+    }
+
+  if (i < n)
+    {
+      g_ptr_array_free (values, TRUE);
+      return NULL;
+    }
+
+  result = gtk_css_shadows_value_new ((GtkCssValue **) values->pdata, values->len);
+  g_ptr_array_set_free_func (values, NULL);
+  g_ptr_array_free (values, TRUE);
+
+  return result;
+}
+
 void
 _gtk_css_shadows_value_paint_layout (const GtkCssValue *shadows,
                                      cairo_t           *cr,
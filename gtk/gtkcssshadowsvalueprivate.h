@@ -24,6 +24,7 @@
 #include <pango/pango.h>
 
 #include "gtktypes.h"
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 #include "gtkroundedboxprivate.h"
@@ -32,6 +33,8 @@ G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_shadows_value_new_none       (void);
 GtkCssValue *   _gtk_css_shadows_value_parse          (GtkCssParser             *parser);
+GtkCssValue *   _gtk_css_shadows_value_deserialize    (GtkCssBinaryReader       *reader,
+                                                       GtkCssBinaryTag           tag);
 
 void            _gtk_css_shadows_value_paint_layout   (const GtkCssValue        *shadows,
                                                        cairo_t                  *cr,
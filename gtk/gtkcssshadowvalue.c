@@ -30,6 +30,7 @@
 #include "gtkpango.h"
 
 #include <math.h>
+#include <string.h>
 
 /* The blur of _gtk_cairo_blur_surface only approximately ends at radius,
    so we add an extra pixel to make the clips less dramatic */
@@ -158,12 +159,27 @@ gtk_css_value_shadow_print (const GtkCssValue *shadow,
 
 }
 
+static gboolean
+gtk_css_value_shadow_serialize (const GtkCssValue  *shadow,
+                                GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_SHADOW);
+  _gtk_css_binary_writer_put_uint (writer, shadow->inset);
+
+  return _gtk_css_binary_writer_put_value (writer, shadow->hoffset) &&
+         _gtk_css_binary_writer_put_value (writer, shadow->voffset) &&
+         _gtk_css_binary_writer_put_value (writer, shadow->radius) &&
+         _gtk_css_binary_writer_put_value (writer, shadow->spread) &&
+         _gtk_css_binary_writer_put_value (writer, shadow->color);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_SHADOW = {
   gtk_css_value_shadow_free,
   gtk_css_value_shadow_compute,
   gtk_css_value_shadow_equal,
   gtk_css_value_shadow_transition,
-  gtk_css_value_shadow_print
+  gtk_css_value_shadow_print,
+  gtk_css_value_shadow_serialize
 };
 
 static GtkCssValue *
@@ -203,6 +219,34 @@ _gtk_css_shadow_value_new_for_transition (GtkCssValue *target)
                                    _gtk_css_rgba_value_new_from_rgba (&transparent));
 }
 
+GtkCssValue *
+_gtk_css_shadow_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  GtkCssValue *values[5];
+  gboolean inset;
+  guint i;
+
+  inset = _gtk_css_binary_reader_get_uint (reader);
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    values[i] = _gtk_css_binary_reader_get_value (reader);
+
+  if (_gtk_css_binary_reader_failed (reader) ||
+      values[0] == NULL || values[1] == NULL || values[2] == NULL ||
+      values[3] == NULL || values[4] == NULL)
+    {
+      for (i = 0; i < G_N_ELEMENTS (values); i++)
+        {
+          if (values[i])
+            _gtk_css_value_unref (values[i]);
+        }
+      return NULL;
+    }
+
+  return gtk_css_shadow_value_new (values[0], values[1], values[2], values[3],
+                                   inset, values[4]);
+}
+
 static gboolean
 value_is_done_parsing (GtkCssParser *parser)
 {
@@ -329,8 +373,11 @@ gtk_css_shadow_value_start_drawing (const GtkCssValue *shadow,
 
   clip_radius = radius + CLIP_RADIUS_EXTRA;
 
-  /* Create a larger surface to center the blur. */
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+  /* Create a larger surface to center the blur.
+   * Shadows are a single color, so we only need to keep track of
+   * the coverage, which makes the blur a lot cheaper. The color
+   * is applied when compositing in finish_drawing(). */
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
                                         clip_rect.width + 2 * clip_radius,
                                         clip_rect.height + 2 * clip_radius);
   cairo_surface_set_device_offset (surface, clip_radius - clip_rect.x, clip_radius - clip_rect.y);
@@ -355,6 +402,7 @@ gtk_css_shadow_value_finish_drawing (const GtkCssValue *shadow,
   gdouble radius;
   cairo_t *original_cr;
   cairo_surface_t *surface;
+  GdkRGBA color;
 
   radius = _gtk_css_number_value_get (shadow->radius, 0);
   if (radius == 0.0)
@@ -366,8 +414,12 @@ gtk_css_shadow_value_finish_drawing (const GtkCssValue *shadow,
   /* Blur the surface. */
   _gtk_cairo_blur_surface (surface, radius);
 
-  cairo_set_source_surface (original_cr, surface, 0, 0);
-  cairo_paint (original_cr);
+  /* The alpha of the shadow color has already been applied when
+   * drawing into the mask, so only use the color channels here. */
+  color = *_gtk_css_rgba_value_get_rgba (shadow->color);
+  color.alpha = 1.0;
+  gdk_cairo_set_source_rgba (original_cr, &color);
+  cairo_mask_surface (original_cr, surface, 0, 0);
 
   cairo_destroy (cr);
   cairo_surface_destroy (surface);
@@ -520,6 +572,306 @@ draw_shadow (const GtkCssValue   *shadow,
     gtk_css_shadow_value_finish_drawing (shadow, shadow_cr);
 }
 
+/* Blurred outset box shadows are cut into nine slices, like a border
+ * image: the corners, one row or column for each side that gets
+ * stretched, and the middle. The blurred coverage of those slices only
+ * depends on the blur radius, the spread and the corner radii, so it is
+ * kept in a small cache of A8 masks and shared by all boxes that are
+ * large enough. Smaller boxes are blurred at their exact size, which is
+ * part of the key as their size class.
+ */
+#define SHADOW_MASK_CACHE_SIZE 32
+
+typedef struct _ShadowMask ShadowMask;
+
+typedef struct {
+  double radius;
+  double spread;
+  GtkRoundedBoxCorner corner[4];
+  int width_class;                      /* the width, or 0 if stretched */
+  int height_class;                     /* the height, or 0 if stretched */
+} ShadowMaskKey;
+
+struct _ShadowMask {
+  ShadowMaskKey key;
+  GList link;
+  cairo_surface_t *surface;
+  int left, right, top, bottom;         /* sizes of the corner slices */
+};
+
+static GHashTable *shadow_masks = NULL;
+static GQueue shadow_masks_lru = G_QUEUE_INIT;  /* most recently used first */
+
+static guint
+shadow_mask_key_hash (gconstpointer data)
+{
+  const ShadowMaskKey *key = data;
+  guint hash;
+  int i;
+
+  hash = (guint) (key->radius * 16) ^ ((guint) (key->spread * 16) << 8);
+  for (i = 0; i < 4; i++)
+    hash = hash * 31 + (guint) (key->corner[i].horizontal * 16 + key->corner[i].vertical);
+
+  return hash ^ (key->width_class << 16) ^ key->height_class;
+}
+
+static gboolean
+shadow_mask_key_equal (gconstpointer data1,
+                       gconstpointer data2)
+{
+  const ShadowMaskKey *key1 = data1;
+  const ShadowMaskKey *key2 = data2;
+
+  return memcmp (key1, key2, sizeof (ShadowMaskKey)) == 0;
+}
+
+static void
+shadow_mask_free (ShadowMask *mask)
+{
+  cairo_surface_destroy (mask->surface);
+  g_slice_free (ShadowMask, mask);
+}
+
+/* Computes the sizes of the slices in one direction: @start and @end
+ * are the slices with the corners, @size the size of the mask.
+ * Returns the size class of @length. */
+static int
+shadow_mask_get_slices (int     length,
+                        int     margin,
+                        double  start_corner,
+                        double  end_corner,
+                        int    *start,
+                        int    *end,
+                        int    *size)
+{
+  int min_length;
+
+  /* Everything between the slices is at least margin away from
+   * both corners, so the blur doesn't vary along it */
+  *start = 2 * margin + ceil (start_corner);
+  *end = 2 * margin + ceil (end_corner);
+  min_length = *start + *end + 1 - 2 * margin;
+
+  if (length <= min_length)
+    {
+      *start = length + 2 * margin;
+      *end = 0;
+      *size = *start;
+      return length;
+    }
+
+  *size = min_length + 2 * margin;
+  return 0;
+}
+
+static ShadowMask *
+shadow_mask_lookup (const ShadowMaskKey *key,
+                    const GtkRoundedBox *box,
+                    int                  margin)
+{
+  ShadowMask *mask;
+  GtkRoundedBox mask_box;
+  int width, height;
+  cairo_t *cr;
+
+  if (shadow_masks == NULL)
+    shadow_masks = g_hash_table_new_full (shadow_mask_key_hash,
+                                          shadow_mask_key_equal,
+                                          NULL,
+                                          (GDestroyNotify) shadow_mask_free);
+
+  mask = g_hash_table_lookup (shadow_masks, key);
+  if (mask)
+    {
+      g_queue_unlink (&shadow_masks_lru, &mask->link);
+      g_queue_push_head_link (&shadow_masks_lru, &mask->link);
+      return mask;
+    }
+
+  mask = g_slice_new0 (ShadowMask);
+  mask->key = *key;
+  mask->link.data = mask;
+
+  shadow_mask_get_slices (box->box.width, margin,
+                          MAX (box->corner[GTK_CSS_TOP_LEFT].horizontal,
+                               box->corner[GTK_CSS_BOTTOM_LEFT].horizontal),
+                          MAX (box->corner[GTK_CSS_TOP_RIGHT].horizontal,
+                               box->corner[GTK_CSS_BOTTOM_RIGHT].horizontal),
+                          &mask->left, &mask->right, &width);
+  shadow_mask_get_slices (box->box.height, margin,
+                          MAX (box->corner[GTK_CSS_TOP_LEFT].vertical,
+                               box->corner[GTK_CSS_TOP_RIGHT].vertical),
+                          MAX (box->corner[GTK_CSS_BOTTOM_LEFT].vertical,
+                               box->corner[GTK_CSS_BOTTOM_RIGHT].vertical),
+                          &mask->top, &mask->bottom, &height);
+
+  /* The coverage of a box of the mask's size, the color is
+   * applied when the mask is drawn */
+  mask->surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  mask_box = *box;
+  mask_box.box.x = margin;
+  mask_box.box.y = margin;
+  mask_box.box.width = width - 2 * margin;
+  mask_box.box.height = height - 2 * margin;
+
+  cr = cairo_create (mask->surface);
+  _gtk_rounded_box_path (&mask_box, cr);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  _gtk_cairo_blur_surface (mask->surface, key->radius);
+
+  g_hash_table_insert (shadow_masks, &mask->key, mask);
+  g_queue_push_head_link (&shadow_masks_lru, &mask->link);
+
+  if (g_hash_table_size (shadow_masks) > SHADOW_MASK_CACHE_SIZE)
+    {
+      ShadowMask *oldest = g_queue_peek_tail (&shadow_masks_lru);
+
+      g_queue_unlink (&shadow_masks_lru, &oldest->link);
+      g_hash_table_remove (shadow_masks, &oldest->key);
+    }
+
+  return mask;
+}
+
+/* Draws the part of @mask at @src_x, @src_y over the destination
+ * rectangle, repeating its last row and column if the destination
+ * is larger. */
+static void
+draw_shadow_mask_slice (cairo_t         *cr,
+                        cairo_surface_t *mask,
+                        int              src_x,
+                        int              src_y,
+                        int              src_width,
+                        int              src_height,
+                        int              dest_x,
+                        int              dest_y,
+                        int              dest_width,
+                        int              dest_height)
+{
+  cairo_surface_t *slice;
+  cairo_pattern_t *pattern;
+  cairo_matrix_t matrix;
+
+  if (src_width <= 0 || src_height <= 0 ||
+      dest_width <= 0 || dest_height <= 0)
+    return;
+
+  slice = cairo_surface_create_for_rectangle (mask, src_x, src_y, src_width, src_height);
+  pattern = cairo_pattern_create_for_surface (slice);
+  cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+  cairo_pattern_set_filter (pattern, CAIRO_FILTER_NEAREST);
+  cairo_matrix_init_translate (&matrix, -dest_x, -dest_y);
+  cairo_pattern_set_matrix (pattern, &matrix);
+
+  cairo_save (cr);
+  cairo_rectangle (cr, dest_x, dest_y, dest_width, dest_height);
+  cairo_clip (cr);
+  cairo_mask (cr, pattern);
+  cairo_restore (cr);
+
+  cairo_pattern_destroy (pattern);
+  cairo_surface_destroy (slice);
+}
+
+/* Paints a blurred outset shadow from the mask cache. This only works
+ * for boxes that are aligned to the pixel grid, returns %FALSE if @box
+ * isn't.
+ */
+static gboolean
+draw_cached_shadow (const GtkCssValue   *shadow,
+                    cairo_t             *cr,
+                    const GtkRoundedBox *padding_box,
+                    const GtkRoundedBox *box,
+                    double               radius,
+                    double               spread,
+                    double               clip_radius)
+{
+  ShadowMaskKey key;
+  ShadowMask *mask;
+  cairo_matrix_t matrix;
+  int x, y, width, height, margin, unused;
+  int src_x[3], src_width[3], dest_x[3], dest_width[3];
+  int src_y[3], src_height[3], dest_y[3], dest_height[3];
+  int i, j;
+
+  cairo_get_matrix (cr, &matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 ||
+      matrix.xy != 0.0 || matrix.yx != 0.0 ||
+      matrix.x0 != floor (matrix.x0) || matrix.y0 != floor (matrix.y0))
+    return FALSE;
+
+  x = box->box.x;
+  y = box->box.y;
+  width = box->box.width;
+  height = box->box.height;
+  if (x != box->box.x || y != box->box.y ||
+      width != box->box.width || height != box->box.height)
+    return FALSE;
+
+  margin = ceil (clip_radius);
+
+  memset (&key, 0, sizeof (key));
+  key.radius = radius;
+  key.spread = spread;
+  memcpy (key.corner, padding_box->corner, sizeof (key.corner));
+  key.width_class = shadow_mask_get_slices (width, margin,
+                                            MAX (box->corner[GTK_CSS_TOP_LEFT].horizontal,
+                                                 box->corner[GTK_CSS_BOTTOM_LEFT].horizontal),
+                                            MAX (box->corner[GTK_CSS_TOP_RIGHT].horizontal,
+                                                 box->corner[GTK_CSS_BOTTOM_RIGHT].horizontal),
+                                            &unused, &unused, &unused);
+  key.height_class = shadow_mask_get_slices (height, margin,
+                                             MAX (box->corner[GTK_CSS_TOP_LEFT].vertical,
+                                                  box->corner[GTK_CSS_TOP_RIGHT].vertical),
+                                             MAX (box->corner[GTK_CSS_BOTTOM_LEFT].vertical,
+                                                  box->corner[GTK_CSS_BOTTOM_RIGHT].vertical),
+                                             &unused, &unused, &unused);
+
+  mask = shadow_mask_lookup (&key, box, margin);
+
+  /* start slice, the stretched row or column, end slice */
+  src_x[0] = 0;
+  src_width[0] = mask->left;
+  src_x[1] = mask->left;
+  src_width[1] = mask->right > 0 ? 1 : 0;
+  src_x[2] = cairo_image_surface_get_width (mask->surface) - mask->right;
+  src_width[2] = mask->right;
+
+  dest_x[0] = x - margin;
+  dest_width[0] = mask->left;
+  dest_x[1] = dest_x[0] + mask->left;
+  dest_width[1] = width + 2 * margin - mask->left - mask->right;
+  dest_x[2] = x + width + margin - mask->right;
+  dest_width[2] = mask->right;
+
+  src_y[0] = 0;
+  src_height[0] = mask->top;
+  src_y[1] = mask->top;
+  src_height[1] = mask->bottom > 0 ? 1 : 0;
+  src_y[2] = cairo_image_surface_get_height (mask->surface) - mask->bottom;
+  src_height[2] = mask->bottom;
+
+  dest_y[0] = y - margin;
+  dest_height[0] = mask->top;
+  dest_y[1] = dest_y[0] + mask->top;
+  dest_height[1] = height + 2 * margin - mask->top - mask->bottom;
+  dest_y[2] = y + height + margin - mask->bottom;
+  dest_height[2] = mask->bottom;
+
+  gdk_cairo_set_source_rgba (cr, _gtk_css_rgba_value_get_rgba (shadow->color));
+
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 3; j++)
+      draw_shadow_mask_slice (cr, mask->surface,
+                              src_x[i], src_y[j], src_width[i], src_height[j],
+                              dest_x[i], dest_y[j], dest_width[i], dest_height[j]);
+
+  return TRUE;
+}
+
 void
 _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
                                  cairo_t             *cr,
@@ -575,7 +927,8 @@ _gtk_css_shadow_value_paint_box (const GtkCssValue   *shadow,
 
   if (radius == 0)
     draw_shadow (shadow, cr, &box, &clip_box, FALSE);
-  else
+  else if (shadow->inset ||
+           !draw_cached_shadow (shadow, cr, padding_box, &box, radius, spread, clip_radius))
     {
       int i, x1, x2, y1, y2;
       cairo_region_t *remaining;
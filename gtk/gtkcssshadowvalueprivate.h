@@ -24,6 +24,7 @@
 #include <pango/pango.h>
 
 #include "gtktypes.h"
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssvalueprivate.h"
 #include "gtkroundedboxprivate.h"
@@ -31,6 +32,8 @@
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_shadow_value_new_for_transition (GtkCssValue           *target);
+GtkCssValue *   _gtk_css_shadow_value_deserialize     (GtkCssBinaryReader       *reader,
+                                                       GtkCssBinaryTag           tag);
 
 GtkCssValue *   _gtk_css_shadow_value_parse           (GtkCssParser             *parser);
 
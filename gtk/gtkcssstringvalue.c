@@ -148,12 +148,33 @@ gtk_css_value_ident_print (const GtkCssValue *value,
   } while (*string);
 }
 
+static gboolean
+gtk_css_value_string_serialize (const GtkCssValue  *value,
+                                GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_STRING);
+  _gtk_css_binary_writer_put_string (writer, value->string);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_value_ident_serialize (const GtkCssValue  *value,
+                               GtkCssBinaryWriter *writer)
+{
+  _gtk_css_binary_writer_put_uint (writer, GTK_CSS_BINARY_TAG_IDENT);
+  _gtk_css_binary_writer_put_string (writer, value->string);
+
+  return TRUE;
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_STRING = {
   gtk_css_value_string_free,
   gtk_css_value_string_compute,
   gtk_css_value_string_equal,
   gtk_css_value_string_transition,
-  gtk_css_value_string_print
+  gtk_css_value_string_print,
+  gtk_css_value_string_serialize
 };
 
 static const GtkCssValueClass GTK_CSS_VALUE_IDENT = {
@@ -161,7 +182,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_IDENT = {
   gtk_css_value_string_compute,
   gtk_css_value_string_equal,
   gtk_css_value_string_transition,
-  gtk_css_value_ident_print
+  gtk_css_value_ident_print,
+  gtk_css_value_ident_serialize
 };
 
 GtkCssValue *
@@ -244,3 +266,18 @@ _gtk_css_ident_value_get (const GtkCssValue *value)
   return value->string;
 }
 
+GtkCssValue *
+_gtk_css_string_value_deserialize (GtkCssBinaryReader *reader,
+                                   GtkCssBinaryTag     tag)
+{
+  const char *string;
+
+  string = _gtk_css_binary_reader_get_string (reader);
+  if (_gtk_css_binary_reader_failed (reader))
+    return NULL;
+
+  if (tag == GTK_CSS_BINARY_TAG_IDENT)
+    return _gtk_css_ident_value_new (string);
+  else
+    return _gtk_css_string_value_new (string);
+}
@@ -20,6 +20,7 @@
 #ifndef __GTK_CSS_STRING_VALUE_PRIVATE_H__
 #define __GTK_CSS_STRING_VALUE_PRIVATE_H__
 
+#include "gtkcssbinaryprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcsstypesprivate.h"
 #include "gtkcssvalueprivate.h"
@@ -38,6 +39,8 @@ GtkCssValue *   _gtk_css_string_value_parse         (GtkCssParser           *par
 
 const char *    _gtk_css_string_value_get           (const GtkCssValue      *string);
 
+GtkCssValue *   _gtk_css_string_value_deserialize   (GtkCssBinaryReader     *reader,
+                                                     GtkCssBinaryTag         tag);
 
 G_END_DECLS
 
@@ -26,6 +26,8 @@ G_BEGIN_DECLS
 /* forward declaration for GtkCssValue */
 typedef struct _GtkCssComputedValues GtkCssComputedValues;
 typedef struct _GtkStyleProviderPrivate GtkStyleProviderPrivate; /* dummy typedef */
+typedef struct _GtkCssBinaryWriter GtkCssBinaryWriter;
+typedef struct _GtkCssBinaryReader GtkCssBinaryReader;
 
 typedef enum { /*< skip >*/
   GTK_CSS_CHANGE_CLASS                    = (1 <<  0),
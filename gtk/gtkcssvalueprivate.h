@@ -55,6 +55,10 @@ struct _GtkCssValueClass {
                                                        double                      progress);
   void          (* print)                             (const GtkCssValue          *value,
                                                        GString                    *string);
+  /* write the binary form to writer, optional. Returns FALSE if the value
+   * can only be saved as text. */
+  gboolean      (* serialize)                         (const GtkCssValue          *value,
+                                                       GtkCssBinaryWriter         *writer);
 };
 
 GType        _gtk_css_value_get_type                  (void) G_GNUC_CONST;
@@ -51,7 +51,8 @@ typedef enum {
   GTK_DEBUG_NO_CSS_CACHE    = 1 << 13,
   GTK_DEBUG_BASELINES       = 1 << 14,
   GTK_DEBUG_PIXEL_CACHE     = 1 << 15,
-  GTK_DEBUG_NO_PIXEL_CACHE  = 1 << 16
+  GTK_DEBUG_NO_PIXEL_CACHE  = 1 << 16,
+  GTK_DEBUG_LAYOUT          = 1 << 17
 } GtkDebugFlag;
 
 #ifdef G_ENABLE_DEBUG
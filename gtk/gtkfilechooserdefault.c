@@ -4121,7 +4121,9 @@ file_system_model_set (GtkFileSystemModel *model,
     case MODEL_COL_NAME_COLLATED:
       if (info == NULL)
         g_value_take_string (value, g_utf8_collate_key_for_filename (DEFAULT_NEW_FOLDER_NAME, -1));
-      else 
+      else if (g_file_info_has_attribute (info, GTK_FILE_INFO_COLLATE_KEY))
+        g_value_set_string (value, g_file_info_get_attribute_string (info, GTK_FILE_INFO_COLLATE_KEY));
+      else
         g_value_take_string (value, g_utf8_collate_key_for_filename (g_file_info_get_display_name (info), -1));
       break;
     case MODEL_COL_IS_FOLDER:
@@ -115,6 +115,18 @@
  * freeze_updates()) during the intial population process.  When the model is
  * frozen, sorting will not happen.  The model will sort itself when the freeze
  * count goes back to zero, via corresponding calls to thaw_updates().
+ *
+ * New files are appended to the array, so the nodes before model->n_nodes_sorted
+ * stay in order.  Sorting only sorts the nodes after it and merges them into
+ * the sorted ones; anything that may change the order resets the count.
+ *
+ * Loading
+ * -------
+ *
+ * Directories are enumerated in batches.  As soon as a batch arrives, the next
+ * one is requested, and the batch is handed to a thread that computes the
+ * collation keys of the file names (see GTK_FILE_INFO_COLLATE_KEY) before it
+ * gets added in the main loop.
  */
 
 /*** DEFINES ***/
@@ -159,6 +171,7 @@ struct _GtkFileSystemModel
   GArray *              files;          /* array of FileModelNode containing all our files */
   gsize                 node_size;	/* Size of a FileModelNode structure once its ->values field has n_columns */
   guint                 n_nodes_valid;  /* count of valid nodes (i.e. those whose node->row is accurate) */
+  guint                 n_nodes_sorted; /* count of nodes at the start of the array that are known to be in sort order */
   GHashTable *          file_lookup;    /* mapping of GFile => array index in model->files
 					 * This hash table doesn't always have the same number of entries as the files array;
 					 * it can get cleared completely when we resort.
@@ -182,8 +195,12 @@ struct _GtkFileSystemModel
 
   guint                 frozen;         /* number of times we're frozen */
 
+  guint                 n_batches_pending;/* batches of enumerated files still being prepared in a thread */
+  GError *              loading_error;  /* error that ended the enumeration while batches were pending */
+
   gboolean              filter_on_thaw :1;/* set when filtering needs to happen upon thawing */
   gboolean              sort_on_thaw :1;/* set when sorting needs to happen upon thawing */
+  gboolean              enumeration_done :1;/* set when the enumerator has no more files */
 
   guint                 show_hidden :1; /* whether to show hidden files */
   guint                 show_folders :1;/* whether to show folders */
@@ -766,6 +783,51 @@ compare_array_element (gconstpointer a, gconstpointer b, gpointer user_data)
   return data->func (GTK_TREE_MODEL (data->model), &itera, &iterb, data->data) * data->order;
 }
 
+/* Merges the sorted nodes from @middle to the end of the array into the
+ * sorted nodes before it. As the comparison functions only work on nodes
+ * in the array, all positions are found before anything is moved. */
+static void
+merge_sorted_nodes (GtkFileSystemModel *model, SortData *data, guint middle)
+{
+  guint n_tail, t, lo, hi, mid, end;
+  guint *pos;
+  gchar *tail;
+
+  n_tail = model->files->len - middle;
+  pos = g_new (guint, n_tail);
+
+  lo = 1; /* don't sort the editable row */
+  for (t = 0; t < n_tail; t++)
+    {
+      /* insert after equal nodes, to keep the sort stable */
+      hi = middle;
+      while (lo < hi)
+        {
+          mid = (lo + hi) / 2;
+          if (compare_array_element (get_node (model, middle + t), get_node (model, mid), data) < 0)
+            hi = mid;
+          else
+            lo = mid + 1;
+        }
+      pos[t] = lo;
+    }
+
+  tail = g_memdup (get_node (model, middle), n_tail * model->node_size);
+
+  end = middle;
+  for (t = n_tail; t > 0; t--)
+    {
+      memmove (get_node (model, pos[t - 1] + t), get_node (model, pos[t - 1]),
+               (end - pos[t - 1]) * model->node_size);
+      memcpy (get_node (model, pos[t - 1] + t - 1), tail + (t - 1) * model->node_size,
+              model->node_size);
+      end = pos[t - 1];
+    }
+
+  g_free (tail);
+  g_free (pos);
+}
+
 static void
 gtk_file_system_model_sort (GtkFileSystemModel *model)
 {
@@ -777,21 +839,26 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
       return;
     }
 
-  if (sort_data_init (&data, model))
+  if (model->n_nodes_sorted < model->files->len &&
+      sort_data_init (&data, model))
     {
       GtkTreePath *path;
-      guint i;
+      guint i, n_sorted;
       guint r, n_visible_rows;
 
       node_validate_rows (model, G_MAXUINT, G_MAXUINT);
       n_visible_rows = node_get_tree_row (model, model->files->len - 1) + 1;
       model->n_nodes_valid = 0;
       g_hash_table_remove_all (model->file_lookup);
-      g_qsort_with_data (get_node (model, 1), /* start at index 1; don't sort the editable row */
-                         model->files->len - 1,
+      n_sorted = MAX (model->n_nodes_sorted, 1); /* start at index 1; don't sort the editable row */
+      g_qsort_with_data (get_node (model, n_sorted),
+                         model->files->len - n_sorted,
                          model->node_size,
                          compare_array_element,
                          &data);
+      if (n_sorted > 1)
+        merge_sorted_nodes (model, &data, n_sorted);
+      model->n_nodes_sorted = model->files->len;
       g_assert (model->n_nodes_valid == 0);
       g_assert (g_hash_table_size (model->file_lookup) == 0);
       if (n_visible_rows)
@@ -885,6 +952,7 @@ gtk_file_system_model_set_sort_column_id (GtkTreeSortable  *sortable,
 
   model->sort_column_id = sort_column_id;
   model->sort_order = order;
+  model->n_nodes_sorted = 0;
 
   gtk_tree_sortable_sort_column_changed (sortable);
 
@@ -905,7 +973,10 @@ gtk_file_system_model_set_sort_func (GtkTreeSortable        *sortable,
                                                      func, data, destroy);
 
   if (model->sort_column_id == sort_column_id)
-    gtk_file_system_model_sort (model);
+    {
+      model->n_nodes_sorted = 0;
+      gtk_file_system_model_sort (model);
+    }
 }
 
 static void
@@ -929,7 +1000,10 @@ gtk_file_system_model_set_default_sort_func (GtkTreeSortable        *sortable,
   model->default_sort_destroy = destroy;
 
   if (model->sort_column_id == GTK_TREE_SORTABLE_DEFAULT_SORT_COLUMN_ID)
-    gtk_file_system_model_sort (model);
+    {
+      model->n_nodes_sorted = 0;
+      gtk_file_system_model_sort (model);
+    }
 }
 
 static gboolean
@@ -1059,6 +1133,7 @@ gtk_file_system_model_finalize (GObject *object)
     }
   g_array_free (model->files, TRUE);
 
+  g_clear_error (&model->loading_error);
   g_object_unref (model->cancellable);
   g_free (model->attributes);
   if (model->dir)
@@ -1129,12 +1204,109 @@ thaw_func (gpointer data)
   return FALSE;
 }
 
+static void
+gtk_file_system_model_finish_loading (GtkFileSystemModel *model)
+{
+  if (model->dir_thaw_source != 0)
+    {
+      g_source_remove (model->dir_thaw_source);
+      model->dir_thaw_source = 0;
+      thaw_updates (model);
+    }
+
+  g_signal_emit (model, file_system_model_signals[FINISHED_LOADING], 0, model->loading_error);
+  g_clear_error (&model->loading_error);
+}
+
+static void
+free_file_infos (gpointer files)
+{
+  g_list_free_full (files, g_object_unref);
+}
+
+/* Runs in a thread, the infos belong to it until it is done */
+static void
+gtk_file_system_model_prepare_files (GTask        *task,
+                                     gpointer      source_object,
+                                     gpointer      task_data,
+                                     GCancellable *cancellable)
+{
+  GList *walk;
+
+  for (walk = task_data; walk; walk = walk->next)
+    {
+      GFileInfo *info = walk->data;
+      char *key;
+
+      if (g_cancellable_is_cancelled (cancellable))
+        break;
+
+      if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME))
+        continue;
+
+      key = g_utf8_collate_key_for_filename (g_file_info_get_display_name (info), -1);
+      g_file_info_set_attribute_string (info, GTK_FILE_INFO_COLLATE_KEY, key);
+      g_free (key);
+    }
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+gtk_file_system_model_prepared_files (GObject *object, GAsyncResult *res, gpointer data)
+{
+  GtkFileSystemModel *model = GTK_FILE_SYSTEM_MODEL (object);
+  GList *walk, *files;
+
+  model->n_batches_pending--;
+
+  if (!g_task_propagate_boolean (G_TASK (res), NULL))
+    return; /* cancelled */
+
+  gdk_threads_enter ();
+
+  files = g_task_get_task_data (G_TASK (res));
+
+  if (model->dir_thaw_source == 0)
+    {
+      freeze_updates (model);
+      model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
+                                                             50,
+                                                             thaw_func,
+                                                             model,
+                                                             NULL);
+    }
+
+  for (walk = files; walk; walk = walk->next)
+    {
+      const char *name;
+      GFileInfo *info;
+      GFile *file;
+
+      info = walk->data;
+      name = g_file_info_get_name (info);
+      if (name == NULL)
+        {
+          /* Shouldn't happen, but the APIs allow it */
+          continue;
+        }
+      file = g_file_get_child (model->dir, name);
+      add_file (model, file, info);
+      g_object_unref (file);
+    }
+
+  if (model->enumeration_done && model->n_batches_pending == 0)
+    gtk_file_system_model_finish_loading (model);
+
+  gdk_threads_leave ();
+}
+
 static void
 gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer data)
 {
   GFileEnumerator *enumerator = G_FILE_ENUMERATOR (object);
   GtkFileSystemModel *model = data;
-  GList *walk, *files;
+  GList *files;
   GError *error = NULL;
 
   gdk_threads_enter ();
@@ -1143,43 +1315,21 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
 
   if (files)
     {
-      if (model->dir_thaw_source == 0)
-        {
-          freeze_updates (model);
-          model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
-                                                                 50,
-                                                                 thaw_func,
-                                                                 model,
-                                                                 NULL);
-        }
-
-      for (walk = files; walk; walk = walk->next)
-        {
-          const char *name;
-          GFileInfo *info;
-          GFile *file;
-          
-          info = walk->data;
-          name = g_file_info_get_name (info);
-          if (name == NULL)
-            {
-              /* Shouldn't happen, but the APIs allow it */
-              g_object_unref (info);
-              continue;
-            }
-          file = g_file_get_child (model->dir, name);
-          add_file (model, file, info);
-          g_object_unref (file);
-          g_object_unref (info);
-        }
-      g_list_free (files);
+      GTask *task;
 
+      /* Keep the enumerator busy while this batch is being added */
       g_file_enumerator_next_files_async (enumerator,
 					  g_file_is_native (model->dir) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
 					  IO_PRIORITY,
 					  model->cancellable,
 					  gtk_file_system_model_got_files,
 					  model);
+
+      task = g_task_new (model, model->cancellable, gtk_file_system_model_prepared_files, NULL);
+      g_task_set_task_data (task, files, free_file_infos);
+      g_task_run_in_thread (task, gtk_file_system_model_prepare_files);
+      g_object_unref (task);
+      model->n_batches_pending++;
     }
   else
     {
@@ -1190,14 +1340,13 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
                                          model->cancellable,
                                          gtk_file_system_model_closed_enumerator,
                                          NULL);
-          if (model->dir_thaw_source != 0)
-            {
-              g_source_remove (model->dir_thaw_source);
-              model->dir_thaw_source = 0;
-              thaw_updates (model);
-            }
 
-          g_signal_emit (model, file_system_model_signals[FINISHED_LOADING], 0, error);
+          model->enumeration_done = TRUE;
+          model->loading_error = error;
+          error = NULL;
+
+          if (model->n_batches_pending == 0)
+            gtk_file_system_model_finish_loading (model);
         }
 
       if (error)
@@ -1906,6 +2055,8 @@ remove_file (GtkFileSystemModel *model,
     g_object_unref (node->info);
 
   g_array_remove_index (model->files, id);
+  if (id < model->n_nodes_sorted)
+    model->n_nodes_sorted--;
 
   /* We don't need to resort, as removing a row doesn't change the sorting order of the other rows */
 
@@ -1949,6 +2100,9 @@ _gtk_file_system_model_update_file (GtkFileSystemModel *model,
   if (old_info)
     g_object_unref (old_info);
 
+  /* the node may have to move now */
+  model->n_nodes_sorted = MIN (model->n_nodes_sorted, id);
+
   for (i = 0; i < model->n_columns; i++)
     {
       if (G_VALUE_TYPE (&node->values[i]))
@@ -2134,6 +2288,7 @@ _gtk_file_system_model_clear_cache (GtkFileSystemModel *model,
     }
 
   /* FIXME: resort? */
+  model->n_nodes_sorted = 0;
 }
 
 /**
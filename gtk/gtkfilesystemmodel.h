@@ -31,6 +31,10 @@ G_BEGIN_DECLS
 
 typedef struct _GtkFileSystemModel      GtkFileSystemModel;
 
+/* String attribute holding g_utf8_collate_key_for_filename() of the display
+ * name, set on the infos of files the model enumerated itself */
+#define GTK_FILE_INFO_COLLATE_KEY "gtk::collate-key"
+
 GType _gtk_file_system_model_get_type (void) G_GNUC_CONST;
 
 typedef gboolean (*GtkFileSystemModelGetValue)   (GtkFileSystemModel *model,
@@ -26,6 +26,7 @@
 #include "gtksizerequest.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
+#include "gtkwidgetprivate.h"
 
 
 /**
@@ -1440,6 +1441,8 @@ gtk_grid_get_size (GtkGrid        *grid,
   if (grid->priv->children == NULL)
     return;
 
+  _gtk_widget_prefetch_child_sizes (GTK_WIDGET (grid), orientation);
+
   request.grid = grid;
   gtk_grid_request_count_lines (&request);
   lines = &request.lines[orientation];
@@ -1479,6 +1482,8 @@ gtk_grid_get_size_for_size (GtkGrid        *grid,
   if (grid->priv->children == NULL)
     return;
 
+  _gtk_widget_prefetch_child_sizes (GTK_WIDGET (grid), 1 - orientation);
+
   request.grid = grid;
   gtk_grid_request_count_lines (&request);
   lines = &request.lines[0];
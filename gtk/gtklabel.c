@@ -47,6 +47,7 @@
 #include "gtkshow.h"
 #include "gtktooltip.h"
 #include "gtkprivate.h"
+#include "gtkwidgetprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkmain.h"
 
@@ -233,6 +234,8 @@
  * </refsect2>
  */
 
+typedef struct _GtkLabelMeasure GtkLabelMeasure;
+
 struct _GtkLabelPrivate
 {
   GtkLabelSelectionInfo *select_info;
@@ -243,6 +246,8 @@ struct _GtkLabelPrivate
   PangoAttrList *markup_attrs;
   PangoLayout   *layout;
 
+  GtkLabelMeasure *measure; /* extents measured off the main thread */
+
   gchar   *label;
   gchar   *text;
 
@@ -526,6 +531,20 @@ static void    gtk_label_get_preferred_height_and_baseline_for_width (GtkWidget
 								      gint               *minimum_baseline,
 								      gint               *natural_baseline);
 
+static gpointer gtk_label_measure_prepare (GtkWidget      *widget,
+                                           GtkOrientation  orientation);
+static void     gtk_label_measure_run     (gpointer        data);
+static void     gtk_label_measure_apply   (GtkWidget      *widget,
+                                           gpointer        data);
+static void     gtk_label_measure_clear   (GtkWidget      *widget);
+
+static const GtkWidgetMeasureFuncs label_measure_funcs = {
+  gtk_label_measure_prepare,
+  gtk_label_measure_run,
+  gtk_label_measure_apply,
+  gtk_label_measure_clear
+};
+
 static GtkBuildableIface *buildable_parent_iface = NULL;
 
 G_DEFINE_TYPE_WITH_CODE (GtkLabel, gtk_label, GTK_TYPE_MISC,
@@ -594,6 +613,8 @@ gtk_label_class_init (GtkLabelClass *class)
   widget_class->get_preferred_height_for_width = gtk_label_get_preferred_height_for_width;
   widget_class->get_preferred_height_and_baseline_for_width = gtk_label_get_preferred_height_and_baseline_for_width;
 
+  _gtk_widget_class_set_measure_funcs (widget_class, &label_measure_funcs);
+
   class->move_cursor = gtk_label_move_cursor;
   class->copy_clipboard = gtk_label_copy_clipboard;
   class->activate_link = gtk_label_activate_link;
@@ -3156,6 +3177,8 @@ gtk_label_finalize (GObject *object)
   if (priv->layout)
     g_object_unref (priv->layout);
 
+  gtk_label_measure_clear (GTK_WIDGET (label));
+
   if (priv->attrs)
     pango_attr_list_unref (priv->attrs);
 
@@ -3482,6 +3505,63 @@ gtk_label_get_request_mode (GtkWidget *widget)
     return GTK_SIZE_REQUEST_CONSTANT_SIZE;
 }
 
+/* Extents of the label's layout at the widths a size request will ask
+ * for, computed by a container in parallel with other labels. They are
+ * only kept while the container requests the label's size, so they
+ * can't go stale.
+ */
+#define GTK_LABEL_MEASURE_WIDTHS 4
+
+struct _GtkLabelMeasure
+{
+  PangoContext   *context; /* owned by the job, gets a font map in the worker */
+  PangoLayout    *layout;  /* a copy of the label's layout on @context */
+  GtkOrientation  orientation;
+  gint            char_pixels;
+  gint            width_chars;
+  gint            max_width_chars;
+  guint           narrow : 1; /* wrapping or ellipsizing */
+
+  guint           n_extents;
+  struct {
+    gint           width;
+    PangoRectangle logical;
+    gint           baseline;
+  } extents[GTK_LABEL_MEASURE_WIDTHS];
+};
+
+/* Like pango_layout_get_extents() for the logical rectangle, but uses
+ * the prefetched extents for the layout's width if there are any.
+ */
+static void
+gtk_label_get_layout_extents (GtkLabel       *label,
+                              PangoLayout    *layout,
+                              PangoRectangle *logical,
+                              gint           *baseline)
+{
+  GtkLabelMeasure *measure = label->priv->measure;
+
+  if (measure)
+    {
+      gint width = pango_layout_get_width (layout);
+      guint i;
+
+      for (i = 0; i < measure->n_extents; i++)
+        {
+          if (measure->extents[i].width == width)
+            {
+              *logical = measure->extents[i].logical;
+              if (baseline)
+                *baseline = measure->extents[i].baseline;
+              return;
+            }
+        }
+    }
+
+  pango_layout_get_extents (layout, NULL, logical);
+  if (baseline)
+    *baseline = pango_layout_get_baseline (layout);
+}
 
 static void
 get_size_for_allocation (GtkLabel        *label,
@@ -3493,11 +3573,14 @@ get_size_for_allocation (GtkLabel        *label,
                          gint            *natural_baseline)
 {
   PangoLayout *layout;
+  PangoRectangle logical;
   gint text_height, baseline;
 
   layout = gtk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
 
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+  gtk_label_get_layout_extents (label, layout, &logical, &baseline);
+  pango_extents_to_pixels (&logical, NULL);
+  text_height = logical.height;
 
   if (minimum_size)
     *minimum_size = text_height;
@@ -3507,7 +3590,7 @@ get_size_for_allocation (GtkLabel        *label,
 
   if (minimum_baseline || natural_baseline)
     {
-      baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+      baseline = baseline / PANGO_SCALE;
       if (minimum_baseline)
 	*minimum_baseline = baseline;
 
@@ -3537,6 +3620,194 @@ get_char_pixels (GtkWidget   *label,
   return MAX (char_width, digit_width);;
 }
 
+/* Pango objects can't be shared between threads, so the job measures
+ * with a context and layout of its own. They are set up like the
+ * label's here, but the context only gets a font map in the worker:
+ * the default cairo font map of the thread that measures.
+ */
+static PangoContext *
+create_measure_context (PangoContext *context)
+{
+  PangoContext *copy;
+  const cairo_font_options_t *options;
+
+  copy = pango_context_new ();
+  pango_context_set_font_description (copy, pango_context_get_font_description (context));
+  pango_context_set_language (copy, pango_context_get_language (context));
+  pango_context_set_base_dir (copy, pango_context_get_base_dir (context));
+  pango_context_set_base_gravity (copy, pango_context_get_base_gravity (context));
+  pango_context_set_gravity_hint (copy, pango_context_get_gravity_hint (context));
+  pango_context_set_matrix (copy, pango_context_get_matrix (context));
+
+  options = pango_cairo_context_get_font_options (context);
+  if (options)
+    pango_cairo_context_set_font_options (copy, options);
+  pango_cairo_context_set_resolution (copy, pango_cairo_context_get_resolution (context));
+
+  return copy;
+}
+
+static PangoLayout *
+create_measure_layout (PangoContext *context,
+                       PangoLayout  *layout)
+{
+  PangoLayout *copy;
+  PangoAttrList *attrs;
+  PangoTabArray *tabs;
+
+  copy = pango_layout_new (context);
+  pango_layout_set_text (copy, pango_layout_get_text (layout), -1);
+
+  attrs = pango_layout_get_attributes (layout);
+  if (attrs)
+    {
+      attrs = pango_attr_list_copy (attrs);
+      pango_layout_set_attributes (copy, attrs);
+      pango_attr_list_unref (attrs);
+    }
+
+  tabs = pango_layout_get_tabs (layout);
+  if (tabs)
+    {
+      pango_layout_set_tabs (copy, tabs);
+      pango_tab_array_free (tabs);
+    }
+
+  pango_layout_set_font_description (copy, pango_layout_get_font_description (layout));
+  pango_layout_set_height (copy, pango_layout_get_height (layout));
+  pango_layout_set_wrap (copy, pango_layout_get_wrap (layout));
+  pango_layout_set_ellipsize (copy, pango_layout_get_ellipsize (layout));
+  pango_layout_set_indent (copy, pango_layout_get_indent (layout));
+  pango_layout_set_spacing (copy, pango_layout_get_spacing (layout));
+  pango_layout_set_justify (copy, pango_layout_get_justify (layout));
+  pango_layout_set_auto_dir (copy, pango_layout_get_auto_dir (layout));
+  pango_layout_set_alignment (copy, pango_layout_get_alignment (layout));
+  pango_layout_set_single_paragraph_mode (copy, pango_layout_get_single_paragraph_mode (layout));
+
+  return copy;
+}
+
+static gpointer
+gtk_label_measure_prepare (GtkWidget      *widget,
+                           GtkOrientation  orientation)
+{
+  GtkLabel *label = GTK_LABEL (widget);
+  GtkLabelPrivate *priv = label->priv;
+  GtkLabelMeasure *measure;
+  PangoContext *context;
+
+  gtk_label_ensure_layout (label);
+
+  /* Rotated labels measure in ways that are not worth duplicating */
+  if (priv->have_transform || priv->angle != 0)
+    return NULL;
+
+  /* Only the default font map has a counterpart in the worker */
+  context = pango_layout_get_context (priv->layout);
+  if (pango_context_get_font_map (context) != pango_cairo_font_map_get_default ())
+    return NULL;
+
+  measure = g_slice_new0 (GtkLabelMeasure);
+  measure->context = create_measure_context (context);
+  measure->layout = create_measure_layout (measure->context, priv->layout);
+  measure->orientation = orientation;
+  if (priv->width_chars > -1 || priv->max_width_chars > -1)
+    measure->char_pixels = get_char_pixels (widget, priv->layout);
+  measure->width_chars = priv->width_chars;
+  measure->max_width_chars = priv->max_width_chars;
+  measure->narrow = priv->ellipsize || priv->wrap;
+
+  return measure;
+}
+
+static gint
+gtk_label_measure_add (GtkLabelMeasure *measure,
+                       gint             width)
+{
+  guint i;
+
+  for (i = 0; i < measure->n_extents; i++)
+    {
+      if (measure->extents[i].width == width)
+        return measure->extents[i].logical.width;
+    }
+
+  g_assert (i < GTK_LABEL_MEASURE_WIDTHS);
+
+  pango_layout_set_width (measure->layout, width);
+  measure->extents[i].width = width;
+  pango_layout_get_extents (measure->layout, NULL, &measure->extents[i].logical);
+  measure->extents[i].baseline = pango_layout_get_baseline (measure->layout);
+  measure->n_extents++;
+
+  return measure->extents[i].logical.width;
+}
+
+/* Runs in a worker thread. This follows the measuring done by
+ * gtk_label_get_preferred_size() for unrotated labels, so it
+ * computes the extents that will be looked up there.
+ */
+static void
+gtk_label_measure_run (gpointer data)
+{
+  GtkLabelMeasure *measure = data;
+  gint char_pixels = measure->char_pixels;
+  gint widest, smallest;
+
+  pango_context_set_font_map (measure->context, pango_cairo_font_map_get_default ());
+  pango_layout_context_changed (measure->layout);
+
+  widest = gtk_label_measure_add (measure, -1);
+  widest = MAX (widest, char_pixels * measure->width_chars);
+
+  if (measure->narrow)
+    {
+      smallest = gtk_label_measure_add (measure,
+                                        measure->width_chars > -1 ? char_pixels * measure->width_chars
+                                                                  : 0);
+      smallest = MAX (smallest, char_pixels * measure->width_chars);
+
+      if (measure->max_width_chars > -1 && widest > char_pixels * measure->max_width_chars)
+        {
+          widest = gtk_label_measure_add (measure,
+                                          MAX (smallest, char_pixels * measure->max_width_chars));
+          widest = MAX (widest, char_pixels * measure->width_chars);
+        }
+    }
+
+  /* The base height is the height for the natural width */
+  if (measure->orientation == GTK_ORIENTATION_VERTICAL)
+    gtk_label_measure_add (measure, PANGO_PIXELS_CEIL (widest) * PANGO_SCALE);
+
+  /* The fonts belong to this thread's font map, so let go of them here */
+  g_clear_object (&measure->layout);
+  g_clear_object (&measure->context);
+}
+
+static void
+gtk_label_measure_apply (GtkWidget *widget,
+                         gpointer   data)
+{
+  GtkLabel *label = GTK_LABEL (widget);
+
+  gtk_label_measure_clear (widget);
+  label->priv->measure = data;
+}
+
+static void
+gtk_label_measure_clear (GtkWidget *widget)
+{
+  GtkLabelPrivate *priv = GTK_LABEL (widget)->priv;
+
+  if (priv->measure)
+    {
+      g_clear_object (&priv->measure->layout);
+      g_clear_object (&priv->measure->context);
+      g_slice_free (GtkLabelMeasure, priv->measure);
+      priv->measure = NULL;
+    }
+}
+
 static void
 gtk_label_get_preferred_layout_size (GtkLabel *label,
                                      PangoRectangle *smallest,
@@ -3570,7 +3841,7 @@ gtk_label_get_preferred_layout_size (GtkLabel *label,
   else
     char_pixels = 0;
       
-  pango_layout_get_extents (layout, NULL, widest);
+  gtk_label_get_layout_extents (label, layout, widest, NULL);
   widest->width = MAX (widest->width, char_pixels * priv->width_chars);
   widest->x = widest->y = 0;
 
@@ -3582,7 +3853,7 @@ gtk_label_get_preferred_layout_size (GtkLabel *label,
                                                priv->width_chars > -1 ? char_pixels * priv->width_chars
                                                                       : 0);
 
-      pango_layout_get_extents (layout, NULL, smallest);
+      gtk_label_get_layout_extents (label, layout, smallest, NULL);
       smallest->width = MAX (smallest->width, char_pixels * priv->width_chars);
       smallest->x = smallest->y = 0;
 
@@ -3591,7 +3862,7 @@ gtk_label_get_preferred_layout_size (GtkLabel *label,
           layout = gtk_label_get_measuring_layout (label,
                                                    layout,
                                                    MAX (smallest->width, char_pixels * priv->max_width_chars));
-          pango_layout_get_extents (layout, NULL, widest);
+          gtk_label_get_layout_extents (label, layout, widest, NULL);
           widest->width = MAX (widest->width, char_pixels * priv->width_chars);
           widest->x = widest->y = 0;
         }
@@ -27,6 +27,7 @@
 #include "gtkintl.h"
 #include "gtkbuildable.h"
 #include "gtkbuilderprivate.h"
+#include "gtktreeprivate.h"
 
 
 /**
@@ -116,6 +117,10 @@
  * that #GtkTreeIter<!-- -->s can be cached while the row exists.  Thus, if
  * access to a particular row is needed often and your code is expected to
  * run on older versions of GTK+, it is worth keeping the iter around.
+ * Since GTK+ 3.10, the values are stored per column, so getting or setting
+ * a value takes the same time for every column, and identical strings are
+ * only stored once per list store. To fill a list store with many rows,
+ * use gtk_list_store_insert_rows() before connecting it to a view.
  * </refsect2>
  * <refsect2>
  * <title>Atomic Operations</title>
@@ -203,8 +208,22 @@ struct _GtkListStorePrivate
 
   gpointer default_sort_data;
   gpointer seq;         /* head of the list */
+
+  /* Row storage: the items in seq are slot indexes into one array
+   * of cells per column. Slots of removed rows are reused.
+   */
+  GtkTreeDataValue **columns;
+  guint n_slots;
+  guint slots_size;
+  GArray *free_slots;
+
+  /* Interned strings of all string columns, mapped to a use count */
+  GHashTable *strings;
 };
 
+#define ROW_SLOT(ptr) GPOINTER_TO_UINT (g_sequence_get (ptr))
+#define CELL(priv, column, slot) (&(priv)->columns[column][slot])
+
 #define GTK_LIST_STORE_IS_SORTED(list) (((GtkListStore*)(list))->priv->sort_column_id != GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID)
 static void         gtk_list_store_tree_model_init (GtkTreeModelIface *iface);
 static void         gtk_list_store_drag_source_init(GtkTreeDragSourceIface *iface);
@@ -394,6 +413,8 @@ gtk_list_store_init (GtkListStore *list_store)
   priv->sort_column_id = GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID;
   priv->columns_dirty = FALSE;
   priv->length = 0;
+  priv->free_slots = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->strings = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static gboolean
@@ -545,6 +566,13 @@ gtk_list_store_set_n_columns (GtkListStore *list_store,
   priv->column_headers = g_renew (GType, priv->column_headers, n_columns);
   for (i = priv->n_columns; i < n_columns; i++)
     priv->column_headers[i] = G_TYPE_INVALID;
+
+  for (i = n_columns; i < priv->n_columns; i++)
+    g_free (priv->columns[i]);
+  priv->columns = g_renew (GtkTreeDataValue *, priv->columns, n_columns);
+  for (i = priv->n_columns; i < n_columns; i++)
+    priv->columns[i] = g_new0 (GtkTreeDataValue, priv->slots_size);
+
   priv->n_columns = n_columns;
 
   if (priv->sort_list)
@@ -568,17 +596,194 @@ gtk_list_store_set_column_type (GtkListStore *list_store,
   priv->column_headers[column] = type;
 }
 
+static inline gboolean
+is_string_column (GtkListStorePrivate *priv,
+                  gint                 column)
+{
+  return G_TYPE_FUNDAMENTAL (priv->column_headers[column]) == G_TYPE_STRING;
+}
+
+static gchar *
+gtk_list_store_intern_string (GtkListStore *list_store,
+                              const gchar  *string)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  gpointer interned, count;
+
+  if (string == NULL)
+    return NULL;
+
+  if (g_hash_table_lookup_extended (priv->strings, string, &interned, &count))
+    {
+      g_hash_table_insert (priv->strings, interned,
+                           GUINT_TO_POINTER (GPOINTER_TO_UINT (count) + 1));
+      return interned;
+    }
+
+  interned = g_strdup (string);
+  g_hash_table_insert (priv->strings, interned, GUINT_TO_POINTER (1));
+
+  return interned;
+}
+
+static void
+gtk_list_store_release_string (GtkListStore *list_store,
+                               gchar        *interned)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  guint count;
+
+  if (interned == NULL)
+    return;
+
+  count = GPOINTER_TO_UINT (g_hash_table_lookup (priv->strings, interned));
+  if (count > 1)
+    {
+      g_hash_table_insert (priv->strings, interned, GUINT_TO_POINTER (count - 1));
+    }
+  else
+    {
+      g_hash_table_remove (priv->strings, interned);
+      g_free (interned);
+    }
+}
+
+static void
+gtk_list_store_clear_cell (GtkListStore *list_store,
+                           guint         slot,
+                           gint          column)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  GtkTreeDataValue *cell = CELL (priv, column, slot);
+
+  if (is_string_column (priv, column))
+    {
+      gtk_list_store_release_string (list_store, cell->v_pointer);
+      cell->v_pointer = NULL;
+    }
+  else
+    _gtk_tree_data_value_clear (cell, priv->column_headers[column]);
+}
+
+static void
+gtk_list_store_set_cell (GtkListStore *list_store,
+                         guint         slot,
+                         gint          column,
+                         GValue       *value)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  GtkTreeDataValue *cell = CELL (priv, column, slot);
+
+  if (is_string_column (priv, column))
+    {
+      gchar *old = cell->v_pointer;
+
+      /* intern first, the value may be the string we release */
+      cell->v_pointer = gtk_list_store_intern_string (list_store, g_value_get_string (value));
+      gtk_list_store_release_string (list_store, old);
+    }
+  else
+    _gtk_tree_data_value_set (cell, value);
+}
+
+static void
+gtk_list_store_copy_cell (GtkListStore *list_store,
+                          guint         src_slot,
+                          guint         dest_slot,
+                          gint          column)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  GtkTreeDataValue *src = CELL (priv, column, src_slot);
+  GtkTreeDataValue *dest = CELL (priv, column, dest_slot);
+
+  gtk_list_store_clear_cell (list_store, dest_slot, column);
+
+  if (is_string_column (priv, column))
+    dest->v_pointer = gtk_list_store_intern_string (list_store, src->v_pointer);
+  else
+    _gtk_tree_data_value_copy (src, dest, priv->column_headers[column]);
+}
+
+/* Returns an empty slot for a new row */
+static guint
+gtk_list_store_alloc_slot (GtkListStore *list_store)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  gint i;
+
+  if (priv->free_slots->len > 0)
+    {
+      guint slot;
+
+      slot = g_array_index (priv->free_slots, guint, priv->free_slots->len - 1);
+      g_array_set_size (priv->free_slots, priv->free_slots->len - 1);
+
+      return slot;
+    }
+
+  if (priv->n_slots == priv->slots_size)
+    {
+      guint new_size = MAX (16, priv->slots_size * 2);
+
+      for (i = 0; i < priv->n_columns; i++)
+        {
+          priv->columns[i] = g_renew (GtkTreeDataValue, priv->columns[i], new_size);
+          memset (priv->columns[i] + priv->slots_size, 0,
+                  (new_size - priv->slots_size) * sizeof (GtkTreeDataValue));
+        }
+
+      priv->slots_size = new_size;
+    }
+
+  return priv->n_slots++;
+}
+
+static void
+gtk_list_store_free_slot (GtkListStore *list_store,
+                          guint         slot)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  gint i;
+
+  for (i = 0; i < priv->n_columns; i++)
+    gtk_list_store_clear_cell (list_store, slot, i);
+
+  if (slot + 1 == priv->n_slots)
+    priv->n_slots--;
+  else
+    g_array_append_val (priv->free_slots, slot);
+}
+
 static void
 gtk_list_store_finalize (GObject *object)
 {
   GtkListStore *list_store = GTK_LIST_STORE (object);
   GtkListStorePrivate *priv = list_store->priv;
-
-  g_sequence_foreach (priv->seq,
-		      (GFunc) _gtk_tree_data_list_free, priv->column_headers);
+  GHashTableIter iter;
+  gpointer string;
+  gint i;
 
   g_sequence_free (priv->seq);
 
+  for (i = 0; i < priv->n_columns; i++)
+    {
+      if (!is_string_column (priv, i))
+        {
+          guint slot;
+
+          for (slot = 0; slot < priv->n_slots; slot++)
+            _gtk_tree_data_value_clear (CELL (priv, i, slot), priv->column_headers[i]);
+        }
+      g_free (priv->columns[i]);
+    }
+  g_free (priv->columns);
+  g_array_free (priv->free_slots, TRUE);
+
+  g_hash_table_iter_init (&iter, priv->strings);
+  while (g_hash_table_iter_next (&iter, &string, NULL))
+    g_free (string);
+  g_hash_table_destroy (priv->strings);
+
   _gtk_tree_data_list_header_free (priv->sort_list);
   g_free (priv->column_headers);
 
@@ -681,23 +886,20 @@ gtk_list_store_get_value (GtkTreeModel *tree_model,
 {
   GtkListStore *list_store = GTK_LIST_STORE (tree_model);
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  gint tmp_column = column;
+  GtkTreeDataValue *cell;
 
   g_return_if_fail (column < priv->n_columns);
   g_return_if_fail (iter_is_valid (iter, list_store));
-		    
-  list = g_sequence_get (iter->user_data);
 
-  while (tmp_column-- > 0 && list)
-    list = list->next;
+  cell = CELL (priv, column, ROW_SLOT (iter->user_data));
 
-  if (list == NULL)
-    g_value_init (value, priv->column_headers[column]);
+  if (is_string_column (priv, column))
+    {
+      g_value_init (value, priv->column_headers[column]);
+      g_value_set_string (value, cell->v_pointer);
+    }
   else
-    _gtk_tree_data_list_node_to_value (list,
-				       priv->column_headers[column],
-				       value);
+    _gtk_tree_data_value_get (cell, priv->column_headers[column], value);
 }
 
 static gboolean
@@ -831,9 +1033,6 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
 			       gboolean      sort)
 {
   GtkListStorePrivate *priv = list_store->priv;
-  GtkTreeDataList *list;
-  GtkTreeDataList *prev;
-  gint old_column = column;
   GValue real_value = G_VALUE_INIT;
   gboolean converted = FALSE;
   gboolean retval = FALSE;
@@ -862,60 +1061,15 @@ gtk_list_store_real_set_value (GtkListStore *list_store,
       converted = TRUE;
     }
 
-  prev = list = g_sequence_get (iter->user_data);
-
-  while (list != NULL)
-    {
-      if (column == 0)
-	{
-	  if (converted)
-	    _gtk_tree_data_list_value_to_node (list, &real_value);
-	  else
-	    _gtk_tree_data_list_value_to_node (list, value);
-	  retval = TRUE;
-	  if (converted)
-	    g_value_unset (&real_value);
-         if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-            gtk_list_store_sort_iter_changed (list_store, iter, old_column);
-	  return retval;
-	}
-
-      column--;
-      prev = list;
-      list = list->next;
-    }
-
-  if (g_sequence_get (iter->user_data) == NULL)
-    {
-      list = _gtk_tree_data_list_alloc();
-      g_sequence_set (iter->user_data, list);
-      list->next = NULL;
-    }
-  else
-    {
-      list = prev->next = _gtk_tree_data_list_alloc ();
-      list->next = NULL;
-    }
-
-  while (column != 0)
-    {
-      list->next = _gtk_tree_data_list_alloc ();
-      list = list->next;
-      list->next = NULL;
-      column --;
-    }
-
-  if (converted)
-    _gtk_tree_data_list_value_to_node (list, &real_value);
-  else
-    _gtk_tree_data_list_value_to_node (list, value);
+  gtk_list_store_set_cell (list_store, ROW_SLOT (iter->user_data), column,
+                           converted ? &real_value : value);
 
   retval = TRUE;
   if (converted)
     g_value_unset (&real_value);
 
   if (sort && GTK_LIST_STORE_IS_SORTED (list_store))
-    gtk_list_store_sort_iter_changed (list_store, iter, old_column);
+    gtk_list_store_sort_iter_changed (list_store, iter, column);
 
   return retval;
 }
@@ -1222,7 +1376,7 @@ gtk_list_store_remove (GtkListStore *list_store,
   ptr = iter->user_data;
   next = g_sequence_iter_next (ptr);
   
-  _gtk_tree_data_list_free (g_sequence_get (ptr), priv->column_headers);
+  gtk_list_store_free_slot (list_store, ROW_SLOT (ptr));
   g_sequence_remove (iter->user_data);
 
   priv->length--;
@@ -1281,7 +1435,7 @@ gtk_list_store_insert (GtkListStore *list_store,
     position = length;
 
   ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
+  ptr = g_sequence_insert_before (ptr, GUINT_TO_POINTER (gtk_list_store_alloc_slot (list_store)));
 
   iter->stamp = priv->stamp;
   iter->user_data = ptr;
@@ -1577,33 +1731,16 @@ gtk_list_store_drag_data_received (GtkTreeDragDest   *drag_dest,
        */
       if (retval)
         {
-          GtkTreeDataList *dl = g_sequence_get (src_iter.user_data);
-          GtkTreeDataList *copy_head = NULL;
-          GtkTreeDataList *copy_prev = NULL;
-          GtkTreeDataList *copy_iter = NULL;
 	  GtkTreePath *path;
           gint col;
 
-          col = 0;
-          while (dl)
-            {
-              copy_iter = _gtk_tree_data_list_node_copy (dl,
-                                                         priv->column_headers[col]);
-
-              if (copy_head == NULL)
-                copy_head = copy_iter;
-
-              if (copy_prev)
-                copy_prev->next = copy_iter;
-
-              copy_prev = copy_iter;
-
-              dl = dl->next;
-              ++col;
-            }
+          for (col = 0; col < priv->n_columns; col++)
+            gtk_list_store_copy_cell (list_store,
+                                      ROW_SLOT (src_iter.user_data),
+                                      ROW_SLOT (dest_iter.user_data),
+                                      col);
 
 	  dest_iter.stamp = priv->stamp;
-          g_sequence_set (dest_iter.user_data, copy_head);
 
 	  path = gtk_list_store_get_path (tree_model, &dest_iter);
 	  gtk_tree_model_row_changed (tree_model, path, &dest_iter);
@@ -2222,7 +2359,7 @@ gtk_list_store_insert_with_values (GtkListStore *list_store,
     position = length;
 
   ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
+  ptr = g_sequence_insert_before (ptr, GUINT_TO_POINTER (gtk_list_store_alloc_slot (list_store)));
 
   iter->stamp = priv->stamp;
   iter->user_data = ptr;
@@ -2302,7 +2439,7 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
     position = length;
 
   ptr = g_sequence_get_iter_at_pos (seq, position);
-  ptr = g_sequence_insert_before (ptr, NULL);
+  ptr = g_sequence_insert_before (ptr, GUINT_TO_POINTER (gtk_list_store_alloc_slot (list_store)));
 
   iter->stamp = priv->stamp;
   iter->user_data = ptr;
@@ -2327,6 +2464,167 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
   gtk_tree_path_free (path);
 }
 
+/**
+ * gtk_list_store_insert_rows:
+ * @list_store: A #GtkListStore
+ * @position: position to insert the first new row, or -1 to append
+ *     after existing rows
+ * @n_rows: the number of rows to insert
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values of the first row followed by those of the second row
+ *     and so on
+ * @n_values: the length of the @columns array
+ *
+ * Inserts @n_rows rows at @position, filled with the values given in
+ * @values. Each row is inserted like with gtk_list_store_insert_with_valuesv(),
+ * but the per-row bookkeeping is skipped entirely while nothing is
+ * connected to the model, so this is the fastest way to fill a list store
+ * before it is handed to a view.
+ *
+ * Since: 3.10
+ */
+void
+gtk_list_store_insert_rows (GtkListStore *list_store,
+                            gint          position,
+                            gint          n_rows,
+                            gint         *columns,
+                            GValue       *values,
+                            gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+  GSequenceIter *ptr;
+  gboolean observed;
+  gint length, row;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  if (n_rows == 0)
+    return;
+
+  priv->columns_dirty = TRUE;
+
+  length = g_sequence_get_length (priv->seq);
+  if (position > length || position < 0)
+    position = length;
+
+  observed = _gtk_tree_model_is_observed (GTK_TREE_MODEL (list_store));
+  ptr = g_sequence_get_iter_at_pos (priv->seq, position);
+
+  for (row = 0; row < n_rows; row++)
+    {
+      gboolean changed = FALSE;
+      gboolean maybe_need_sort = FALSE;
+
+      /* signal handlers may have changed the list */
+      if (observed)
+        ptr = g_sequence_get_iter_at_pos (priv->seq, position + row);
+
+      iter.stamp = priv->stamp;
+      iter.user_data = g_sequence_insert_before (ptr, GUINT_TO_POINTER (gtk_list_store_alloc_slot (list_store)));
+      priv->length++;
+
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + row * n_values, n_values);
+
+      if (maybe_need_sort && GTK_LIST_STORE_IS_SORTED (list_store))
+        g_sequence_sort_changed_iter (iter.user_data,
+                                      gtk_list_store_compare_func,
+                                      list_store);
+
+      if (observed)
+        {
+          path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), &iter);
+          gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, &iter);
+          gtk_tree_path_free (path);
+        }
+    }
+}
+
+/**
+ * gtk_list_store_set_rows:
+ * @list_store: A #GtkListStore
+ * @position: position of the first row to change
+ * @n_rows: the number of rows to change
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values of the first row followed by those of the second row
+ *     and so on
+ * @n_values: the length of the @columns array
+ *
+ * Replaces the values of the @n_rows rows starting at @position with
+ * the values given in @values. Unlike calling gtk_list_store_set_valuesv()
+ * for every row, a sorted list store is only resorted once, after all
+ * rows have been changed, and row_changed is only emitted if something
+ * is connected to the model.
+ *
+ * Since: 3.10
+ */
+void
+gtk_list_store_set_rows (GtkListStore *list_store,
+                         gint          position,
+                         gint          n_rows,
+                         gint         *columns,
+                         GValue       *values,
+                         gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+  gboolean observed;
+  gboolean need_sort = FALSE;
+  gint row;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (position >= 0 && n_rows >= 0);
+  g_return_if_fail (position + n_rows <= g_sequence_get_length (list_store->priv->seq));
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  observed = _gtk_tree_model_is_observed (GTK_TREE_MODEL (list_store));
+
+  iter.stamp = priv->stamp;
+  iter.user_data = g_sequence_get_iter_at_pos (priv->seq, position);
+
+  for (row = 0; row < n_rows; row++)
+    {
+      gboolean changed = FALSE;
+      gboolean maybe_need_sort = FALSE;
+
+      /* signal handlers may have changed the list */
+      if (observed)
+        iter.user_data = g_sequence_get_iter_at_pos (priv->seq, position + row);
+
+      if (g_sequence_iter_is_end (iter.user_data))
+        break;
+
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + row * n_values, n_values);
+      need_sort |= maybe_need_sort;
+
+      if (changed && observed)
+        {
+          path = gtk_list_store_get_path (GTK_TREE_MODEL (list_store), &iter);
+          gtk_tree_model_row_changed (GTK_TREE_MODEL (list_store), path, &iter);
+          gtk_tree_path_free (path);
+        }
+
+      iter.user_data = g_sequence_iter_next (iter.user_data);
+    }
+
+  if (need_sort)
+    gtk_list_store_sort (list_store);
+}
+
 /* GtkBuildable custom tag implementation
  *
  * <columns>
@@ -174,7 +174,8 @@ static const GDebugKey gtk_debug_keys[] = {
   {"no-css-cache", GTK_DEBUG_NO_CSS_CACHE},
   {"baselines", GTK_DEBUG_BASELINES},
   {"pixel-cache", GTK_DEBUG_PIXEL_CACHE},
-  {"no-pixel-cache", GTK_DEBUG_NO_PIXEL_CACHE}
+  {"no-pixel-cache", GTK_DEBUG_NO_PIXEL_CACHE},
+  {"layout", GTK_DEBUG_LAYOUT}
 };
 #endif /* G_ENABLE_DEBUG */
 
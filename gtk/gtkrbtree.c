@@ -21,7 +21,8 @@
 
 static GtkRBNode * _gtk_rbnode_new                (GtkRBTree  *tree,
 						   gint        height);
-static void        _gtk_rbnode_free               (GtkRBNode  *node);
+static void        _gtk_rbnode_free               (GtkRBTree  *tree,
+                                                   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_left        (GtkRBTree  *tree,
 						   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_right       (GtkRBTree  *tree,
@@ -53,11 +54,58 @@ _gtk_rbtree_is_nil (GtkRBNode *node)
   return node == &nil;
 }
 
+/* Small trees, like the children of an expanded row, start with small
+ * chunks; big trees end up with chunks of a few pages.
+ */
+#define GTK_RBNODE_CHUNK_MIN_SIZE 8
+#define GTK_RBNODE_CHUNK_MAX_SIZE 1024
+
+struct _GtkRBNodeChunk
+{
+  GtkRBNodeChunk *next;
+  guint n_nodes;
+  guint n_used;
+  GtkRBNode nodes[1];
+};
+
+static GtkRBNode *
+_gtk_rbnode_alloc (GtkRBTree *tree)
+{
+  GtkRBNodeChunk *chunk;
+  GtkRBNode *node;
+
+  if (tree->free_nodes)
+    {
+      node = tree->free_nodes;
+      tree->free_nodes = node->parent;
+      return node;
+    }
+
+  chunk = tree->chunks;
+  if (chunk == NULL || chunk->n_used == chunk->n_nodes)
+    {
+      guint n_nodes;
+
+      if (chunk == NULL)
+        n_nodes = GTK_RBNODE_CHUNK_MIN_SIZE;
+      else
+        n_nodes = MIN (chunk->n_nodes * 2, GTK_RBNODE_CHUNK_MAX_SIZE);
+
+      chunk = g_malloc (sizeof (GtkRBNodeChunk) + (n_nodes - 1) * sizeof (GtkRBNode));
+      chunk->next = tree->chunks;
+      chunk->n_nodes = n_nodes;
+      chunk->n_used = 0;
+      tree->chunks = chunk;
+    }
+
+  return &chunk->nodes[chunk->n_used++];
+}
+
 static GtkRBNode *
 _gtk_rbnode_new (GtkRBTree *tree,
 		 gint       height)
 {
-  GtkRBNode *node = g_slice_new (GtkRBNode);
+  GtkRBNode *node = _gtk_rbnode_alloc (tree);
 
   node->left = (GtkRBNode *) &nil;
   node->right = (GtkRBNode *) &nil;
@@ -71,21 +119,22 @@ _gtk_rbnode_new (GtkRBTree *tree,
 }
 
 static void
-_gtk_rbnode_free (GtkRBNode *node)
+_gtk_rbnode_free (GtkRBTree *tree,
+                  GtkRBNode *node)
 {
 #ifdef G_ENABLE_DEBUG
   if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
     {
       node->left = (gpointer) 0xdeadbeef;
       node->right = (gpointer) 0xdeadbeef;
-      node->parent = (gpointer) 0xdeadbeef;
       node->total_count = 56789;
       node->offset = 56789;
       node->count = 56789;
       node->flags = 0;
     }
 #endif
-  g_slice_free (GtkRBNode, node);
+  node->parent = tree->free_nodes;
+  tree->free_nodes = node;
 }
 
 static void
@@ -334,6 +383,8 @@ _gtk_rbtree_new (void)
   retval->parent_node = NULL;
 
   retval->root = (GtkRBNode *) &nil;
+  retval->chunks = NULL;
+  retval->free_nodes = NULL;
 
   return retval;
 }
@@ -345,19 +396,26 @@ _gtk_rbtree_free_helper (GtkRBTree  *tree,
 {
   if (node->children)
     _gtk_rbtree_free (node->children);
-
-  _gtk_rbnode_free (node);
 }
 
 void
 _gtk_rbtree_free (GtkRBTree *tree)
 {
+  GtkRBNodeChunk *chunk, *next;
+
+  /* the nodes themselves go away with the chunks */
   _gtk_rbtree_traverse (tree,
 			tree->root,
 			G_POST_ORDER,
 			_gtk_rbtree_free_helper,
 			NULL);
 
+  for (chunk = tree->chunks; chunk; chunk = next)
+    {
+      next = chunk->next;
+      g_free (chunk);
+    }
+
   if (tree->parent_node &&
       tree->parent_node->children == tree)
     tree->parent_node->children = NULL;
@@ -1224,7 +1282,7 @@ _gtk_rbtree_remove_node (GtkRBTree *tree,
                          y_height - node_height);
     }
 
-  _gtk_rbnode_free (node);
+  _gtk_rbnode_free (tree, node);
 
 #ifdef G_ENABLE_DEBUG  
   if (gtk_get_debug_flags () & GTK_DEBUG_TREE)
@@ -46,6 +46,7 @@ typedef enum
 
 typedef struct _GtkRBTree GtkRBTree;
 typedef struct _GtkRBNode GtkRBNode;
+typedef struct _GtkRBNodeChunk GtkRBNodeChunk;
 typedef struct _GtkRBTreeView GtkRBTreeView;
 
 typedef void (*GtkRBTreeTraverseFunc) (GtkRBTree  *tree,
@@ -57,16 +58,22 @@ struct _GtkRBTree
   GtkRBNode *root;
   GtkRBTree *parent_tree;
   GtkRBNode *parent_node;
+
+  /* The nodes are allocated in chunks, so that lookups walking
+   * down the tree touch few cache lines. Freed nodes are kept
+   * in a list linked through their parent pointer.
+   */
+  GtkRBNodeChunk *chunks;
+  GtkRBNode *free_nodes;
 };
 
+/* The fields are ordered so that nothing needs padding and the
+ * fields read by lookups come first.
+ */
 struct _GtkRBNode
 {
   guint flags : 14;
 
-  GtkRBNode *left;
-  GtkRBNode *right;
-  GtkRBNode *parent;
-
   /* count is the number of nodes beneath us, plus 1 for ourselves.
    * i.e. node->left->count + node->right->count + 1
    */
@@ -84,6 +91,10 @@ struct _GtkRBNode
    */
   gint offset;
 
+  GtkRBNode *left;
+  GtkRBNode *right;
+  GtkRBNode *parent;
+
   /* Child trees */
   GtkRBTree *children;
 };
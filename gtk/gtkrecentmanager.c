@@ -117,6 +117,64 @@
 /* keep in sync with xdgmime */
 #define GTK_RECENT_DEFAULT_MIME	"application/octet-stream"
 
+/* Instead of rewriting the whole file for every change, changes are
+ * appended to a journal next to it, and other instances only read the
+ * records they have not seen yet. The file is written again, and the
+ * journal emptied, when the journal grows beyond JOURNAL_MAX_SIZE, when
+ * items are removed wholesale and when a manager that appended to the
+ * journal goes away. Readers that don't know about the journal only
+ * see the file.
+ *
+ * The journal is a header followed by records, each one a serialized
+ * GVariant padded to 8 bytes. It is only read by GTK+, so it uses host
+ * byte order. Records hold the resulting state of an item rather than
+ * the change, so applying one twice is harmless.
+ *
+ * The header of a new journal names the journal it continues and how
+ * far the written file includes it. The changes of the writer that were
+ * not in the old journal are the first records of the new one. Other
+ * instances that had read exactly that much then only switch to the new
+ * journal, instead of reading the whole file again.
+ */
+#define JOURNAL_SUFFIX          ".journal"
+#define JOURNAL_MAGIC           "GtkRJnl2"
+#define JOURNAL_MAX_SIZE        (64 * 1024)
+#define JOURNAL_ALIGN(n)        (((n) + 7) & ~((gsize) 7))
+
+/* uri, display name, description, MIME type, groups, application name,
+ * application exec, count, stamp, private, added, modified */
+#define JOURNAL_PUT_TYPE        "(smsmssasssuxbxx)"
+/* uri */
+#define JOURNAL_REMOVE_TYPE     "(s)"
+/* uri, new uri */
+#define JOURNAL_MOVE_TYPE       "(sms)"
+
+typedef enum {
+  JOURNAL_OP_PUT,
+  JOURNAL_OP_REMOVE,
+  JOURNAL_OP_MOVE
+} JournalOp;
+
+typedef struct {
+  gchar   magic[8];
+  guint64 generation;
+
+  /* the journal this one continues, and the offset up to which
+   * the file includes it; 0 if the file needs to be read again */
+  guint64 parent_generation;
+  guint64 parent_offset;
+
+  /* the file that was written when this journal was started */
+  gint64  file_mtime;
+  gint64  file_size;
+  guint64 file_inode;
+} JournalHeader;
+
+typedef struct {
+  guint32 size;
+  guint32 op;
+} JournalRecord;
+
 typedef struct
 {
   gchar *name;
@@ -168,6 +226,8 @@ struct _GtkRecentManagerPrivate
   gchar *filename;
 
   guint is_dirty : 1;
+  guint needs_compaction : 1;
+  guint journal_appended : 1;   /* since the file was last written */
   
   gint size;
 
@@ -175,6 +235,17 @@ struct _GtkRecentManagerPrivate
 
   GFileMonitor *monitor;
 
+  /* used to tell whether another instance wrote the file */
+  gint64 file_mtime;
+  gint64 file_size;
+  guint64 file_inode;
+
+  gchar *journal_filename;
+  GFileMonitor *journal_monitor;
+  guint64 journal_generation;
+  gsize journal_offset;
+  GByteArray *journal_pending;
+
   guint changed_timeout;
   guint changed_age;
 };
@@ -216,6 +287,8 @@ static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manag
 
 
 static void build_recent_items_list (GtkRecentManager  *manager);
+static gboolean replay_journal      (GtkRecentManager  *manager);
+static void     gtk_recent_manager_flush_compaction (GtkRecentManager *manager);
 static void purge_recent_items_list (GtkRecentManager  *manager,
                                      GError           **error);
 
@@ -399,10 +472,14 @@ gtk_recent_manager_finalize (GObject *object)
   GtkRecentManagerPrivate *priv = manager->priv;
 
   g_free (priv->filename);
+  g_free (priv->journal_filename);
 
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
 
+  if (priv->journal_pending != NULL)
+    g_byte_array_unref (priv->journal_pending);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->finalize (object);
 }
 
@@ -421,6 +498,15 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->monitor = NULL;
     }
 
+  if (priv->journal_monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                            G_CALLBACK (gtk_recent_manager_monitor_changed),
+                                            manager);
+      g_object_unref (priv->journal_monitor);
+      priv->journal_monitor = NULL;
+    }
+
   if (priv->changed_timeout != 0)
     {
       g_source_remove (priv->changed_timeout);
@@ -435,6 +521,9 @@ gtk_recent_manager_dispose (GObject *gobject)
       g_object_unref (manager);
     }
 
+  /* leave the file complete for readers that don't know the journal */
+  gtk_recent_manager_flush_compaction (manager);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
@@ -442,82 +531,556 @@ static void
 gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
 {
   manager->priv->is_dirty = TRUE;
+  manager->priv->needs_compaction = TRUE;
   gtk_recent_manager_changed (manager);
 }
 
+/* returns whether the file changed since the last call */
+static gboolean
+update_file_stat (GtkRecentManagerPrivate *priv)
+{
+  GStatBuf st;
+  gint64 mtime, size;
+  guint64 inode;
+  gboolean changed;
+
+  if (g_stat (priv->filename, &st) == 0)
+    {
+      mtime = st.st_mtime;
+      size = st.st_size;
+      inode = st.st_ino;
+    }
+  else
+    {
+      mtime = size = -1;
+      inode = 0;
+    }
+
+  changed = mtime != priv->file_mtime ||
+            size != priv->file_size ||
+            inode != priv->file_inode;
+
+  priv->file_mtime = mtime;
+  priv->file_size = size;
+  priv->file_inode = inode;
+
+  return changed;
+}
+
 static void
-gtk_recent_manager_real_changed (GtkRecentManager *manager)
+update_size (GtkRecentManager *manager)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
+  gint size;
 
-  g_object_freeze_notify (G_OBJECT (manager));
+  size = priv->recent_items ? g_bookmark_file_get_size (priv->recent_items) : 0;
+  if (priv->size != size)
+    {
+      priv->size = size;
 
-  if (priv->is_dirty)
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+}
+
+static void
+journal_add_record (GtkRecentManager *manager,
+                    JournalOp         op,
+                    GVariant         *record)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  JournalRecord header;
+  gsize start, padded_size;
+
+  g_variant_ref_sink (record);
+
+  if (priv->journal_pending == NULL)
+    priv->journal_pending = g_byte_array_new ();
+
+  header.size = g_variant_get_size (record);
+  header.op = op;
+  g_byte_array_append (priv->journal_pending, (const guint8 *) &header, sizeof (header));
+
+  start = priv->journal_pending->len;
+  padded_size = JOURNAL_ALIGN (header.size);
+  g_byte_array_set_size (priv->journal_pending, start + padded_size);
+  memset (priv->journal_pending->data + start, 0, padded_size);
+  g_variant_store (record, priv->journal_pending->data + start);
+
+  g_variant_unref (record);
+}
+
+static void
+journal_put_item (GtkRecentManager    *manager,
+                  const gchar         *uri,
+                  const GtkRecentData *data)
+{
+  GBookmarkFile *items = manager->priv->recent_items;
+  const gchar * const no_groups[] = { NULL };
+  guint count = 0;
+  time_t stamp = 0;
+
+  g_bookmark_file_get_app_info (items, uri, data->app_name,
+                                NULL, &count, &stamp,
+                                NULL);
+
+  journal_add_record (manager, JOURNAL_OP_PUT,
+                      g_variant_new ("(smsmss^asssuxbxx)",
+                                     uri,
+                                     data->display_name,
+                                     data->description,
+                                     data->mime_type,
+                                     data->groups ? (const gchar * const *) data->groups : no_groups,
+                                     data->app_name,
+                                     data->app_exec,
+                                     count,
+                                     (gint64) stamp,
+                                     data->is_private,
+                                     (gint64) g_bookmark_file_get_added (items, uri, NULL),
+                                     (gint64) g_bookmark_file_get_modified (items, uri, NULL)));
+}
+
+static void
+journal_apply_record (GtkRecentManager *manager,
+                      guint32           op,
+                      gconstpointer     data,
+                      gsize             size)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GVariant *record;
+  const gchar *uri, *new_uri;
+
+  if (priv->recent_items == NULL)
+    priv->recent_items = g_bookmark_file_new ();
+
+  switch (op)
     {
-      GError *write_error;
-      
-      /* we are marked as dirty, so we dump the content of our
-       * recently used items list
-       */
-      g_assert (priv->filename != NULL);
+    case JOURNAL_OP_PUT:
+      {
+        const gchar *display_name, *description, *mime_type;
+        const gchar *app_name, *app_exec;
+        const gchar **groups;
+        guint32 count;
+        gint64 stamp, added, modified;
+        gboolean is_private;
+        gint i;
+
+        record = g_variant_new_from_data (G_VARIANT_TYPE (JOURNAL_PUT_TYPE),
+                                          data, size, FALSE,
+                                          NULL, NULL);
+        g_variant_get (record, "(&sm&sm&s&s^a&s&s&suxbxx)",
+                       &uri, &display_name, &description, &mime_type,
+                       &groups, &app_name, &app_exec, &count, &stamp,
+                       &is_private, &added, &modified);
+
+        /* the same calls as gtk_recent_manager_add_full(), with
+         * the registration count and time it ended up with */
+        if (display_name)
+          g_bookmark_file_set_title (priv->recent_items, uri, display_name);
+        if (description)
+          g_bookmark_file_set_description (priv->recent_items, uri, description);
+        g_bookmark_file_set_mime_type (priv->recent_items, uri, mime_type);
+        for (i = 0; groups[i] != NULL; i++)
+          g_bookmark_file_add_group (priv->recent_items, uri, groups[i]);
+        g_bookmark_file_set_app_info (priv->recent_items, uri,
+                                      app_name, app_exec,
+                                      count, (time_t) stamp,
+                                      NULL);
+        g_bookmark_file_set_is_private (priv->recent_items, uri, is_private);
+        g_bookmark_file_set_added (priv->recent_items, uri, (time_t) added);
+        g_bookmark_file_set_modified (priv->recent_items, uri, (time_t) modified);
+
+        g_free (groups);
+      }
+      break;
 
-      if (!priv->recent_items)
-        {
-          /* if no container object has been defined, we create a new
-           * empty container, and dump it
-           */
-          priv->recent_items = g_bookmark_file_new ();
-	  priv->size = 0;
-	}
-      else
+    case JOURNAL_OP_REMOVE:
+      record = g_variant_new_from_data (G_VARIANT_TYPE (JOURNAL_REMOVE_TYPE),
+                                        data, size, FALSE,
+                                        NULL, NULL);
+      g_variant_get (record, "(&s)", &uri);
+      g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
+      break;
+
+    case JOURNAL_OP_MOVE:
+      record = g_variant_new_from_data (G_VARIANT_TYPE (JOURNAL_MOVE_TYPE),
+                                        data, size, FALSE,
+                                        NULL, NULL);
+      g_variant_get (record, "(&sm&s)", &uri, &new_uri);
+      g_bookmark_file_move_item (priv->recent_items, uri, new_uri, NULL);
+      break;
+
+    default:
+      /* written by a newer version */
+      return;
+    }
+
+  g_variant_unref (record);
+}
+
+/* Applies the records appended to the journal since the last call.
+ * Returns %FALSE if another instance wrote the file and started a new
+ * journal in the meantime, in which case both need to be read again.
+ */
+static gboolean
+replay_journal (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  const JournalHeader *header;
+  GMappedFile *file;
+  const gchar *contents;
+  gsize length, offset;
+
+  file = g_mapped_file_new (priv->journal_filename, FALSE, NULL);
+  if (file == NULL)
+    return priv->journal_generation == 0;
+
+  contents = g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+  header = (const JournalHeader *) contents;
+
+  if (length < sizeof (JournalHeader) ||
+      memcmp (header->magic, JOURNAL_MAGIC, sizeof (header->magic)) != 0)
+    {
+      g_mapped_file_unref (file);
+      return priv->journal_generation == 0;
+    }
+
+  if (priv->journal_generation != header->generation)
+    {
+      if (priv->journal_generation != 0)
         {
-          GtkSettings *settings = gtk_settings_get_default ();
-          gint age = 30;
-          gboolean enabled;
-
-          g_object_get (G_OBJECT (settings),
-                        "gtk-recent-files-max-age", &age,
-                        "gtk-recent-files-enabled", &enabled,
-                        NULL);
-
-          if (age == 0 || !enabled)
-            {
-              g_bookmark_file_free (priv->recent_items);
-              priv->recent_items = g_bookmark_file_new ();
-            }
-          else if (age > 0)
-            gtk_recent_manager_clamp_to_age (manager, age);
+          g_mapped_file_unref (file);
+          return FALSE;
         }
 
-      write_error = NULL;
-      g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-      if (write_error)
-        {
-          filename_warning ("Attempting to store changes into `%s', "
-			    "but failed: %s",
-			    priv->filename,
-			    write_error->message);
-	  g_error_free (write_error);
-	}
+      priv->journal_generation = header->generation;
+      priv->journal_offset = sizeof (JournalHeader);
+    }
+
+  offset = priv->journal_offset;
+  if (offset > length)
+    {
+      g_mapped_file_unref (file);
+      return FALSE;
+    }
+
+  while (length - offset >= sizeof (JournalRecord))
+    {
+      const JournalRecord *record = (const JournalRecord *) (contents + offset);
+      gsize record_size = sizeof (JournalRecord) + JOURNAL_ALIGN ((gsize) record->size);
+
+      /* still being written */
+      if (record_size > length - offset)
+        break;
+
+      journal_apply_record (manager, record->op, record + 1, record->size);
+      offset += record_size;
+    }
+
+  priv->journal_offset = offset;
 
-      if (g_chmod (priv->filename, 0600) < 0)
+  g_mapped_file_unref (file);
+
+  return TRUE;
+}
+
+/* Called when the file changed. Returns %TRUE if it was written by an
+ * instance that had read the same part of the journal as we did, and
+ * switches to the journal it started; the file doesn't need to be read
+ * again then, replaying the new journal is enough.
+ */
+static gboolean
+follow_journal (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  const JournalHeader *header;
+  GMappedFile *file;
+  gboolean retval;
+
+  if (priv->journal_generation == 0)
+    return FALSE;
+
+  file = g_mapped_file_new (priv->journal_filename, FALSE, NULL);
+  if (file == NULL)
+    return FALSE;
+
+  header = (const JournalHeader *) g_mapped_file_get_contents (file);
+
+  retval = g_mapped_file_get_length (file) >= sizeof (JournalHeader) &&
+           memcmp (header->magic, JOURNAL_MAGIC, sizeof (header->magic)) == 0 &&
+           header->parent_generation == priv->journal_generation &&
+           header->parent_offset == priv->journal_offset &&
+           header->file_mtime == priv->file_mtime &&
+           header->file_size == priv->file_size &&
+           header->file_inode == priv->file_inode;
+
+  if (retval)
+    {
+      priv->journal_generation = header->generation;
+      priv->journal_offset = sizeof (JournalHeader);
+    }
+
+  g_mapped_file_unref (file);
+
+  return retval;
+}
+
+/* returns %FALSE if the file needs to be written instead */
+static gboolean
+append_journal (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GFileOutputStream *stream;
+  GFile *file;
+  GStatBuf st;
+  gboolean retval;
+
+  if (priv->journal_pending == NULL || priv->journal_pending->len == 0)
+    return FALSE;
+
+  /* there is no journal to append to until the file was written once */
+  if (priv->journal_generation == 0)
+    return FALSE;
+
+  if (g_stat (priv->journal_filename, &st) != 0 ||
+      st.st_size + priv->journal_pending->len > JOURNAL_MAX_SIZE)
+    return FALSE;
+
+  file = g_file_new_for_path (priv->journal_filename);
+  stream = g_file_append_to (file, G_FILE_CREATE_PRIVATE, NULL, NULL);
+  g_object_unref (file);
+
+  if (stream == NULL)
+    return FALSE;
+
+  /* a single write, so that records appended by other
+   * instances at the same time don't end up interleaved */
+  retval = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                      priv->journal_pending->data,
+                                      priv->journal_pending->len,
+                                      NULL, NULL, NULL);
+  if (!g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, NULL))
+    retval = FALSE;
+
+  g_object_unref (stream);
+
+  /* our own records don't need to be applied again, unless
+   * another instance appended something in between */
+  if (retval && (gsize) st.st_size == priv->journal_offset)
+    priv->journal_offset += priv->journal_pending->len;
+
+  return retval;
+}
+
+/* Starts a new journal for the file that was just written. If
+ * @continues, the file holds what the old journal held up to our
+ * offset, plus our pending changes, which are put into the new
+ * journal for the instances that follow it.
+ */
+static void
+reset_journal (GtkRecentManager *manager,
+               gboolean          continues)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  JournalHeader header;
+  GByteArray *contents;
+  GError *error;
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, JOURNAL_MAGIC, sizeof (header.magic));
+  do
+    header.generation = ((guint64) g_random_int () << 32) | g_random_int ();
+  while (header.generation == 0);
+
+  if (continues)
+    {
+      header.parent_generation = priv->journal_generation;
+      header.parent_offset = priv->journal_offset;
+    }
+
+  header.file_mtime = priv->file_mtime;
+  header.file_size = priv->file_size;
+  header.file_inode = priv->file_inode;
+
+  contents = g_byte_array_new ();
+  g_byte_array_append (contents, (const guint8 *) &header, sizeof (header));
+  if (continues && priv->journal_pending != NULL)
+    g_byte_array_append (contents, priv->journal_pending->data, priv->journal_pending->len);
+
+  error = NULL;
+  if (!g_file_set_contents (priv->journal_filename,
+                            (const gchar *) contents->data, contents->len,
+                            &error))
+    {
+      filename_warning ("Attempting to reset the journal `%s', "
+                        "but failed: %s",
+                        priv->journal_filename,
+                        error->message);
+      g_error_free (error);
+      g_byte_array_unref (contents);
+
+      /* keep writing the whole file */
+      priv->journal_generation = 0;
+      priv->journal_offset = 0;
+      return;
+    }
+
+  g_chmod (priv->journal_filename, 0600);
+
+  /* our own records are applied already */
+  priv->journal_generation = header.generation;
+  priv->journal_offset = contents->len;
+
+  g_byte_array_unref (contents);
+}
+
+static void
+write_recent_items (GtkRecentManager *manager,
+                    gint              age,
+                    gboolean          enabled)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *write_error;
+  gboolean continues;
+
+  g_assert (priv->filename != NULL);
+
+  /* the journal is about to be emptied, so pick up what other
+   * instances appended to it; unless everything is going away */
+  continues = !priv->needs_compaction &&
+              replay_journal (manager) &&
+              priv->journal_generation != 0;
+
+  if (!priv->recent_items)
+    {
+      /* if no container object has been defined, we create a new
+       * empty container, and dump it
+       */
+      priv->recent_items = g_bookmark_file_new ();
+      priv->size = 0;
+      continues = FALSE;
+    }
+  else
+    {
+      if (age == 0 || !enabled)
         {
-          filename_warning ("Attempting to set the permissions of `%s', "
-                            "but failed: %s",
-                            priv->filename,
-                            g_strerror (errno));
+          g_bookmark_file_free (priv->recent_items);
+          priv->recent_items = g_bookmark_file_new ();
+          continues = FALSE;
         }
+      else if (age > 0)
+        {
+          gint n_items = g_bookmark_file_get_size (priv->recent_items);
+
+          /* other instances don't know what was dropped */
+          gtk_recent_manager_clamp_to_age (manager, age);
+          if (g_bookmark_file_get_size (priv->recent_items) != n_items)
+            continues = FALSE;
+        }
+    }
+
+  write_error = NULL;
+  g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
+  if (write_error)
+    {
+      filename_warning ("Attempting to store changes into `%s', "
+                        "but failed: %s",
+                        priv->filename,
+                        write_error->message);
+      g_error_free (write_error);
+
+      /* the journal still holds the changes */
+      return;
+    }
+
+  if (g_chmod (priv->filename, 0600) < 0)
+    {
+      filename_warning ("Attempting to set the permissions of `%s', "
+                        "but failed: %s",
+                        priv->filename,
+                        g_strerror (errno));
+    }
+
+  update_file_stat (priv);
+  reset_journal (manager, continues);
+  priv->journal_appended = FALSE;
+}
+
+static void
+get_recent_files_settings (gint     *age,
+                           gboolean *enabled)
+{
+  GtkSettings *settings = gtk_settings_get_default ();
+
+  *age = 30;
+  *enabled = TRUE;
+
+  g_object_get (G_OBJECT (settings),
+                "gtk-recent-files-max-age", age,
+                "gtk-recent-files-enabled", enabled,
+                NULL);
+}
+
+/* Writes the file if we appended to the journal since it was last
+ * written, so that it is complete for readers that don't know about
+ * the journal */
+static void
+gtk_recent_manager_flush_compaction (GtkRecentManager *manager)
+{
+  gint age;
+  gboolean enabled;
+
+  if (!manager->priv->journal_appended)
+    return;
+
+  get_recent_files_settings (&age, &enabled);
+  write_recent_items (manager, age, enabled);
+}
+
+static void
+gtk_recent_manager_real_changed (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+
+  g_object_freeze_notify (G_OBJECT (manager));
+
+  if (priv->is_dirty)
+    {
+      gint age;
+      gboolean enabled;
+
+      get_recent_files_settings (&age, &enabled);
+
+      /* we are marked as dirty, so we append our changes to the
+       * journal, or dump the content of our recently used items
+       * list if it needs pruning
+       */
+      if (priv->needs_compaction || age == 0 || !enabled ||
+          !append_journal (manager))
+        write_recent_items (manager, age, enabled);
+      else
+        priv->journal_appended = TRUE;
+
+      if (priv->journal_pending)
+        g_byte_array_set_size (priv->journal_pending, 0);
 
       /* mark us as clean */
+      priv->needs_compaction = FALSE;
       priv->is_dirty = FALSE;
     }
   else
     {
       /* we are not marked as dirty, so we have been called
-       * because the recently used resources file has been
-       * changed (and not from us).
+       * because the recently used resources file or its journal
+       * has been changed (and not from us); unless the file itself
+       * was written by an instance that didn't follow the journal
+       * like we did, the new journal records are all we need
        */
-      build_recent_items_list (manager);
+      if ((update_file_stat (priv) && !follow_journal (manager)) ||
+          !replay_journal (manager))
+        build_recent_items_list (manager);
+      else
+        update_size (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -590,7 +1153,12 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
    */
   if (priv->filename)
     {
+      /* the journal of the old file must not be left behind */
+      gtk_recent_manager_flush_compaction (manager);
+
       g_free (priv->filename);
+      g_free (priv->journal_filename);
+      priv->journal_filename = NULL;
 
       if (priv->monitor)
         {
@@ -601,6 +1169,18 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
           priv->monitor = NULL;
         }
 
+      if (priv->journal_monitor)
+        {
+          g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                                G_CALLBACK (gtk_recent_manager_monitor_changed),
+                                                manager);
+          g_object_unref (priv->journal_monitor);
+          priv->journal_monitor = NULL;
+        }
+
+      if (priv->journal_pending)
+        g_byte_array_set_size (priv->journal_pending, 0);
+
       if (!filename || *filename == '\0')
         return;
       else
@@ -635,23 +1215,38 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
 
   g_object_unref (file);
 
+  priv->journal_filename = g_strconcat (priv->filename, JOURNAL_SUFFIX, NULL);
+  file = g_file_new_for_path (priv->journal_filename);
+
+  /* without it we still see the changes once the file is written */
+  priv->journal_monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+  if (priv->journal_monitor)
+    g_signal_connect (priv->journal_monitor, "changed",
+                      G_CALLBACK (gtk_recent_manager_monitor_changed),
+                      manager);
+
+  g_object_unref (file);
+
   priv->is_dirty = FALSE;
+  priv->needs_compaction = FALSE;
+  priv->journal_appended = FALSE;
   build_recent_items_list (manager);
 }
 
-/* reads the recently used resources file and builds the items list.
- * we keep the items list inside the parser object, and build the
- * RecentInfo object only on user's demand to avoid useless replication.
- * this function resets the dirty bit of the manager.
+/* reads the recently used resources file and its journal, and builds
+ * the items list. we keep the items list inside the parser object, and
+ * build the RecentInfo object only on user's demand to avoid useless
+ * replication. this function resets the dirty bit of the manager.
  */
 static void
 build_recent_items_list (GtkRecentManager *manager)
 {
   GtkRecentManagerPrivate *priv = manager->priv;
   GError *read_error;
-  gint size;
 
   g_assert (priv->filename != NULL);
+
+  update_file_stat (priv);
   
   if (!priv->recent_items)
     {
@@ -683,16 +1278,13 @@ build_recent_items_list (GtkRecentManager *manager)
 
       g_error_free (read_error);
     }
-  else
-    {
-      size = g_bookmark_file_get_size (priv->recent_items);
-      if (priv->size != size)
-        {
-          priv->size = size;
 
-          g_object_notify (G_OBJECT (manager), "size");
-        }
-    }
+  /* the journal holds the changes made since the file was written */
+  priv->journal_generation = 0;
+  priv->journal_offset = 0;
+  replay_journal (manager);
+
+  update_size (manager);
 
   priv->is_dirty = FALSE;
 }
@@ -982,6 +1574,8 @@ gtk_recent_manager_add_full (GtkRecentManager     *manager,
   
   g_bookmark_file_set_is_private (priv->recent_items, uri,
 		  		  data->is_private);
+
+  journal_put_item (manager, uri, data);
   
   /* mark us as dirty, so that when emitting the "changed" signal we
    * will dump our changes
@@ -1046,6 +1640,9 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
       return FALSE;
     }
 
+  journal_add_record (manager, JOURNAL_OP_REMOVE,
+                      g_variant_new (JOURNAL_REMOVE_TYPE, uri));
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
   
@@ -1268,6 +1865,9 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
       return FALSE;
     }
 
+  journal_add_record (recent_manager, JOURNAL_OP_MOVE,
+                      g_variant_new (JOURNAL_MOVE_TYPE, uri, new_uri));
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (recent_manager);
 
@@ -1332,6 +1932,7 @@ purge_recent_items_list (GtkRecentManager  *manager,
 
   /* emit the changed signal, to ensure that the purge is written */
   priv->is_dirty = TRUE;
+  priv->needs_compaction = TRUE;
   gtk_recent_manager_changed (manager);
 }
 
@@ -0,0 +1,258 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkrendercacheprivate.h"
+
+/* A cache of rendered image surfaces, limited by the memory used by
+ * their pixels. When it's full, the least recently used entries are
+ * evicted. Only image surfaces are stored, so the memory they use is
+ * known exactly and they can be painted to any target.
+ */
+
+typedef struct _GtkRenderCacheEntry GtkRenderCacheEntry;
+
+struct _GtkRenderCache {
+  GHashTable *entries;
+  GQueue lru;                   /* most recently used entry first */
+  gsize size;                   /* bytes used by all surfaces */
+  gsize max_size;
+
+  guint hits;
+  guint misses;
+};
+
+struct _GtkRenderCacheEntry {
+  GtkRenderCacheKey key;
+  GtkRenderCache *cache;
+  GList link;
+  cairo_surface_t *surface;
+  int x_offset;
+  int y_offset;
+  gsize size;
+};
+
+static guint
+gtk_render_cache_key_hash (gconstpointer data)
+{
+  const GtkRenderCacheKey *key = data;
+
+  return g_direct_hash (key->owner)
+         ^ ((guint) key->width << 16)
+         ^ (guint) key->height
+         ^ (key->flags << 24);
+}
+
+/* The serial is not part of the key, so outdated entries are
+ * found and replaced */
+static gboolean
+gtk_render_cache_key_equal (gconstpointer data1,
+                            gconstpointer data2)
+{
+  const GtkRenderCacheKey *key1 = data1;
+  const GtkRenderCacheKey *key2 = data2;
+
+  return key1->owner == key2->owner &&
+         key1->width == key2->width &&
+         key1->height == key2->height &&
+         key1->flags == key2->flags &&
+         key1->scale == key2->scale;
+}
+
+static void
+gtk_render_cache_unlink (GtkRenderCache      *cache,
+                         GtkRenderCacheEntry *entry)
+{
+  g_hash_table_remove (cache->entries, &entry->key);
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->size -= entry->size;
+
+  cairo_surface_destroy (entry->surface);
+}
+
+static void
+gtk_render_cache_owner_finalized (gpointer  data,
+                                  GObject  *where_the_object_was)
+{
+  GtkRenderCacheEntry *entry = data;
+
+  gtk_render_cache_unlink (entry->cache, entry);
+  g_slice_free (GtkRenderCacheEntry, entry);
+}
+
+static void
+gtk_render_cache_remove (GtkRenderCache      *cache,
+                         GtkRenderCacheEntry *entry)
+{
+  gtk_render_cache_unlink (cache, entry);
+  g_object_weak_unref (entry->key.owner,
+                       gtk_render_cache_owner_finalized,
+                       entry);
+  g_slice_free (GtkRenderCacheEntry, entry);
+}
+
+GtkRenderCache *
+_gtk_render_cache_new (gsize max_size)
+{
+  GtkRenderCache *cache;
+
+  cache = g_slice_new0 (GtkRenderCache);
+  cache->entries = g_hash_table_new (gtk_render_cache_key_hash,
+                                     gtk_render_cache_key_equal);
+  g_queue_init (&cache->lru);
+  cache->max_size = max_size;
+
+  return cache;
+}
+
+void
+_gtk_render_cache_free (GtkRenderCache *cache)
+{
+  GtkRenderCacheEntry *entry;
+
+  while ((entry = g_queue_peek_head (&cache->lru)))
+    gtk_render_cache_remove (cache, entry);
+
+  g_hash_table_unref (cache->entries);
+  g_slice_free (GtkRenderCache, cache);
+}
+
+/* Larger surfaces would evict too much of the cache, so they
+ * are not added */
+gsize
+_gtk_render_cache_get_max_entry_size (GtkRenderCache *cache)
+{
+  return cache->max_size / 8;
+}
+
+/*
+ * _gtk_render_cache_lookup:
+ * @cache: a render cache
+ * @key: the key to look up
+ * @x_offset: (out): return location for the offset passed to
+ *     _gtk_render_cache_add()
+ * @y_offset: (out): return location for the offset passed to
+ *     _gtk_render_cache_add()
+ *
+ * Looks up the surface rendered for @key. An outdated surface for
+ * the same owner is dropped.
+ *
+ * Returns: (transfer none): the surface or %NULL
+ */
+cairo_surface_t *
+_gtk_render_cache_lookup (GtkRenderCache          *cache,
+                          const GtkRenderCacheKey *key,
+                          int                     *x_offset,
+                          int                     *y_offset)
+{
+  GtkRenderCacheEntry *entry;
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry && entry->key.serial != key->serial)
+    {
+      gtk_render_cache_remove (cache, entry);
+      entry = NULL;
+    }
+
+  if (entry == NULL)
+    {
+      cache->misses++;
+      return NULL;
+    }
+
+  cache->hits++;
+
+  g_queue_unlink (&cache->lru, &entry->link);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+
+  *x_offset = entry->x_offset;
+  *y_offset = entry->y_offset;
+
+  return entry->surface;
+}
+
+/*
+ * _gtk_render_cache_add:
+ * @cache: a render cache
+ * @key: the key to store @surface for
+ * @surface: an image surface
+ * @x_offset: offset to remember with @surface
+ * @y_offset: offset to remember with @surface
+ *
+ * Stores @surface for @key, evicting the least recently used
+ * entries if the cache gets too large.
+ *
+ * Returns: %FALSE if @surface is too large to be cached
+ */
+gboolean
+_gtk_render_cache_add (GtkRenderCache          *cache,
+                       const GtkRenderCacheKey *key,
+                       cairo_surface_t         *surface,
+                       int                      x_offset,
+                       int                      y_offset)
+{
+  GtkRenderCacheEntry *entry;
+  gsize size;
+
+  g_return_val_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE, FALSE);
+
+  size = (gsize) cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+  if (size > _gtk_render_cache_get_max_entry_size (cache))
+    return FALSE;
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry)
+    gtk_render_cache_remove (cache, entry);
+
+  entry = g_slice_new0 (GtkRenderCacheEntry);
+  entry->key = *key;
+  entry->cache = cache;
+  entry->link.data = entry;
+  entry->surface = cairo_surface_reference (surface);
+  entry->x_offset = x_offset;
+  entry->y_offset = y_offset;
+  entry->size = size;
+
+  g_object_weak_ref (key->owner, gtk_render_cache_owner_finalized, entry);
+
+  g_hash_table_add (cache->entries, &entry->key);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->size += size;
+
+  while (cache->size > cache->max_size)
+    gtk_render_cache_remove (cache, g_queue_peek_tail (&cache->lru));
+
+  return TRUE;
+}
+
+void
+_gtk_render_cache_get_stats (GtkRenderCache *cache,
+                             guint          *hits,
+                             guint          *misses,
+                             guint          *n_entries,
+                             gsize          *size)
+{
+  if (hits)
+    *hits = cache->hits;
+  if (misses)
+    *misses = cache->misses;
+  if (n_entries)
+    *n_entries = g_hash_table_size (cache->entries);
+  if (size)
+    *size = cache->size;
+}
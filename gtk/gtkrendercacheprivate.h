@@ -0,0 +1,63 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_RENDER_CACHE_PRIVATE_H__
+#define __GTK_RENDER_CACHE_PRIVATE_H__
+
+#include <glib-object.h>
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkRenderCache GtkRenderCache;
+typedef struct _GtkRenderCacheKey GtkRenderCacheKey;
+
+/* Everything a rendering depends on. @owner is not referenced, entries
+ * go away with it. Entries with a different @serial are outdated. */
+struct _GtkRenderCacheKey {
+  GObject *owner;
+  guint serial;
+  double width;
+  double height;
+  guint flags;
+  double scale;
+};
+
+GtkRenderCache *        _gtk_render_cache_new                   (gsize                    max_size);
+void                    _gtk_render_cache_free                  (GtkRenderCache          *cache);
+
+gsize                   _gtk_render_cache_get_max_entry_size    (GtkRenderCache          *cache);
+
+cairo_surface_t *       _gtk_render_cache_lookup                (GtkRenderCache          *cache,
+                                                                 const GtkRenderCacheKey *key,
+                                                                 int                     *x_offset,
+                                                                 int                     *y_offset);
+gboolean                _gtk_render_cache_add                   (GtkRenderCache          *cache,
+                                                                 const GtkRenderCacheKey *key,
+                                                                 cairo_surface_t         *surface,
+                                                                 int                      x_offset,
+                                                                 int                      y_offset);
+
+void                    _gtk_render_cache_get_stats             (GtkRenderCache          *cache,
+                                                                 guint                   *hits,
+                                                                 guint                   *misses,
+                                                                 guint                   *n_entries,
+                                                                 gsize                   *size);
+
+G_END_DECLS
+
+#endif /* __GTK_RENDER_CACHE_PRIVATE_H__ */
@@ -21,21 +21,10 @@
 
 #include "config.h"
 
-/* these must be defined even when HAVE_GNU_FTW is not defined
- * because (really) old versions of GNU libc have ftw.h but do
- * export ftw() and friends only if _XOPEN_SOURCE and _GNU_SOURCE
- * are defined. see bug #444097.
- */
-#define _XOPEN_SOURCE 600
-#define _GNU_SOURCE
-
-#ifdef HAVE_FTW_H
-#include <ftw.h>
-#endif
-
 #include <gdk/gdk.h>
 
 #include "gtksearchenginesimple.h"
+#include "gtksearchindexprivate.h"
 #include "gtkprivate.h"
 
 #include <string.h>
@@ -47,16 +36,33 @@ typedef struct
   GtkSearchEngineSimple *engine;
   
   gchar *path;
+  gchar *text;
   gchar **words;
-  GList *found_list;
+
+  /* the hits of the search this one refines, if any */
+  GtkSearchIndex *previous_index;
+  GArray *previous_hits;
+
+  /* the ranked hits, kept by the engine when the search finishes */
+  GtkSearchIndex *index;
+  GArray *hits;
   
   gint n_processed_files;
   GList *uri_hits;
+  /* TRUE if the hits were sent while the index was built */
+  gboolean streamed;
   
   /* accessed on both threads: */
   volatile gboolean cancelled;
 } SearchThreadData;
 
+typedef struct
+{
+  guint id;
+  gint score;
+  guint depth;
+  guint length;
+} RankedHit;
 
 struct _GtkSearchEngineSimplePrivate 
 {
@@ -65,11 +71,26 @@ struct _GtkSearchEngineSimplePrivate
   SearchThreadData *active_search;
   
   gboolean query_finished;
+
+  /* the last completed search, which the next one can refine */
+  GtkSearchIndex *last_index;
+  GArray *last_hits;
+  gchar *last_path;
+  gchar *last_text;
 };
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkSearchEngineSimple, _gtk_search_engine_simple, GTK_TYPE_SEARCH_ENGINE)
 
+static void
+clear_last_search (GtkSearchEngineSimplePrivate *priv)
+{
+  g_clear_pointer (&priv->last_index, _gtk_search_index_unref);
+  g_clear_pointer (&priv->last_hits, g_array_unref);
+  g_clear_pointer (&priv->last_path, g_free);
+  g_clear_pointer (&priv->last_text, g_free);
+}
+
 static void
 gtk_search_engine_simple_dispose (GObject *object)
 {
@@ -90,6 +111,8 @@ gtk_search_engine_simple_dispose (GObject *object)
       priv->active_search->cancelled = TRUE;
       priv->active_search = NULL;
     }
+
+  clear_last_search (priv);
   
   G_OBJECT_CLASS (_gtk_search_engine_simple_parent_class)->dispose (object);
 }
@@ -99,7 +122,7 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
 			GtkQuery              *query)
 {
   SearchThreadData *data;
-  char *text, *lower, *uri;
+  char *text, *uri;
   
   data = g_new0 (SearchThreadData, 1);
   
@@ -114,10 +137,19 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
     data->path = g_strdup (g_get_home_dir ());
 	
   text = _gtk_query_get_text (query);
-  lower = g_ascii_strdown (text, -1);
-  data->words = g_strsplit (lower, " ", -1);
+  data->text = g_ascii_strdown (text, -1);
+  data->words = g_strsplit (data->text, " ", -1);
   g_free (text);
-  g_free (lower);
+
+  /* Typing more of the query can only remove hits, so look at the
+   * previous hits instead of the whole index */
+  if (engine->priv->last_index != NULL &&
+      strcmp (engine->priv->last_path, data->path) == 0 &&
+      g_str_has_prefix (data->text, engine->priv->last_text))
+    {
+      data->previous_index = _gtk_search_index_ref (engine->priv->last_index);
+      data->previous_hits = g_array_ref (engine->priv->last_hits);
+    }
   
   return data;
 }
@@ -127,7 +159,17 @@ search_thread_data_free (SearchThreadData *data)
 {
   g_object_unref (data->engine);
   g_free (data->path);
+  g_free (data->text);
   g_strfreev (data->words);
+  if (data->previous_index)
+    _gtk_search_index_unref (data->previous_index);
+  if (data->previous_hits)
+    g_array_unref (data->previous_hits);
+  if (data->index)
+    _gtk_search_index_unref (data->index);
+  if (data->hits)
+    g_array_unref (data->hits);
+  g_list_free_full (data->uri_hits, g_free);
   g_free (data);
 }
 
@@ -135,13 +177,32 @@ static gboolean
 search_thread_done_idle (gpointer user_data)
 {
   SearchThreadData *data;
+  GtkSearchEngineSimplePrivate *priv;
 
   data = user_data;
+  priv = data->engine->priv;
   
   if (!data->cancelled)
-    _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
+    {
+      if (data->index != NULL)
+        {
+          clear_last_search (priv);
+          priv->last_index = data->index;
+          priv->last_hits = data->hits;
+          priv->last_path = data->path;
+          priv->last_text = data->text;
+          data->index = NULL;
+          data->hits = NULL;
+          data->path = NULL;
+          data->text = NULL;
+        }
+
+      _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
+    }
      
-  data->engine->priv->active_search = NULL;
+  /* a newer search may have been started in the meantime */
+  if (priv->active_search == data)
+    priv->active_search = NULL;
   search_thread_data_free (data);
   
   return FALSE;
@@ -183,7 +244,7 @@ send_batch (SearchThreadData *data)
   if (data->uri_hits) 
     {
       hits = g_new (SearchHits, 1);
-      hits->uris = data->uri_hits;
+      hits->uris = g_list_reverse (data->uri_hits);
       hits->thread_data = data;
       
       gdk_threads_add_idle (search_thread_add_hits_idle, hits);
@@ -192,100 +253,179 @@ send_batch (SearchThreadData *data)
   data->uri_hits = NULL;
 }
 
-static GPrivate search_thread_data;
+static gint
+rank_hit (const gchar  *name,
+          gchar       **words)
+{
+  const gchar *match;
+  gint score, i;
+
+  score = 0;
+
+  for (i = 0; words[i] != NULL; i++)
+    {
+      if (words[i][0] == '\0')
+        continue;
+
+      match = strstr (name, words[i]);
+      if (match == NULL)
+        return -1;
+
+      /* Prefer whole names, then names starting with the word,
+       * then words starting within the name */
+      if (match == name)
+        score += name[strlen (words[i])] == '\0' ? 8 : 4;
+      else if (!g_ascii_isalnum (match[-1]))
+        score += 2;
+    }
 
-#ifdef HAVE_FTW_H
-static int
-search_visit_func (const char        *fpath,
-		   const struct stat *sb,
-		   int                typeflag,
-		   struct FTW        *ftwbuf)
+  return score;
+}
+
+static gint
+compare_hits (gconstpointer a,
+              gconstpointer b)
 {
-  SearchThreadData *data;
-  gint i;
-  const gchar *name;
-  gchar *lower_name;
-  gchar *uri;
-  gboolean hit;
-  gboolean is_hidden;
+  const RankedHit *ha = a;
+  const RankedHit *hb = b;
 
-  data = (SearchThreadData*)g_private_get (&search_thread_data);
+  if (ha->score != hb->score)
+    return hb->score - ha->score;
 
-  if (data->cancelled)
-#ifdef HAVE_GNU_FTW
-    return FTW_STOP;
-#else
-    return 1;
-#endif /* HAVE_GNU_FTW */
+  if (ha->depth != hb->depth)
+    return ha->depth < hb->depth ? -1 : 1;
 
-  name = strrchr (fpath, '/');
-  if (name)
-    name++;
-  else
-    name = fpath;
+  if (ha->length != hb->length)
+    return ha->length < hb->length ? -1 : 1;
 
-  is_hidden = *name == '.';
-	
-  hit = FALSE;
-  
-  if (!is_hidden) 
+  return ha->id < hb->id ? -1 : (ha->id > hb->id ? 1 : 0);
+}
+
+static guint
+get_depth (const gchar *path)
+{
+  guint depth = 0;
+
+  for (; *path; path++)
     {
-      lower_name = g_ascii_strdown (name, -1);
-      
-      hit = TRUE;
-      for (i = 0; data->words[i] != NULL; i++) 
-	{
-	  if (strstr (lower_name, data->words[i]) == NULL) 
-	    {
-	      hit = FALSE;
-	      break;
-	    }
-	}
-      g_free (lower_name);
+      if (*path == G_DIR_SEPARATOR)
+        depth++;
     }
 
-  if (hit) 
+  return depth;
+}
+
+/* Called for the files found while the index is built, so that hits
+ * show up right away. They can't be ranked before all files are known.
+ */
+static void
+search_thread_visit_func (const gchar *path,
+                          gpointer     user_data)
+{
+  SearchThreadData *data = user_data;
+  const gchar *basename;
+  gchar *name, *uri;
+
+  data->streamed = TRUE;
+
+  basename = strrchr (path, G_DIR_SEPARATOR);
+  name = g_ascii_strdown (basename ? basename + 1 : path, -1);
+
+  if (rank_hit (name, data->words) >= 0)
     {
-      uri = g_filename_to_uri (fpath, NULL, NULL);
-      data->uri_hits = g_list_prepend (data->uri_hits, uri);
-    }
+      uri = g_filename_to_uri (path, NULL, NULL);
+      if (uri)
+        data->uri_hits = g_list_prepend (data->uri_hits, uri);
 
-  data->n_processed_files++;
-  
-  if (data->n_processed_files > BATCH_SIZE)
-    send_batch (data);
+      data->n_processed_files++;
+      if (data->n_processed_files >= BATCH_SIZE)
+        send_batch (data);
+    }
 
-#ifdef HAVE_GNU_FTW
-  if (is_hidden)
-    return FTW_SKIP_SUBTREE;
-  else
-    return FTW_CONTINUE;
-#else
-  return 0;
-#endif /* HAVE_GNU_FTW */
+  g_free (name);
 }
-#endif /* HAVE_FTW_H */
 
 static gpointer 
 search_thread_func (gpointer user_data)
 {
-#ifdef HAVE_FTW_H
   SearchThreadData *data;
+  GtkSearchIndex *index;
+  GArray *candidates, *ranked;
+  RankedHit *hit;
+  const gchar *name, *path;
+  gchar *uri;
+  guint i, n;
   
   data = user_data;
-  
-  g_private_set (&search_thread_data, data);
 
-  nftw (data->path, search_visit_func, 20,
-#ifdef HAVE_GNU_FTW
-        FTW_ACTIONRETVAL |
-#endif
-        FTW_PHYS);
+  index = _gtk_search_index_get (data->path,
+                                 search_thread_visit_func, data,
+                                 &data->cancelled);
+  if (index == NULL)
+    goto out;
 
+  /* Send what was found while building the index */
   send_batch (data);
-  
+
+  if (index == data->previous_index)
+    candidates = g_array_ref (data->previous_hits);
+  else
+    candidates = _gtk_search_index_lookup (index, data->words);
+
+  n = candidates ? candidates->len : _gtk_search_index_get_n_entries (index);
+  ranked = g_array_new (FALSE, FALSE, sizeof (RankedHit));
+
+  for (i = 0; i < n && !data->cancelled; i++)
+    {
+      RankedHit candidate;
+
+      candidate.id = candidates ? g_array_index (candidates, guint, i) : i;
+      name = _gtk_search_index_get_name (index, candidate.id);
+      candidate.score = rank_hit (name, data->words);
+      if (candidate.score < 0)
+        continue;
+
+      path = _gtk_search_index_get_path (index, candidate.id);
+      candidate.depth = get_depth (path);
+      candidate.length = strlen (name);
+      g_array_append_val (ranked, candidate);
+    }
+
+  if (candidates)
+    g_array_unref (candidates);
+
+  /* Send the best hits first */
+  g_array_sort (ranked, compare_hits);
+
+  data->hits = g_array_sized_new (FALSE, FALSE, sizeof (guint), ranked->len);
+
+  for (i = 0; i < ranked->len && !data->cancelled; i++)
+    {
+      hit = &g_array_index (ranked, RankedHit, i);
+      g_array_append_val (data->hits, hit->id);
+
+      /* The hits were sent already, but the next search can still
+       * refine them */
+      if (data->streamed)
+        continue;
+
+      uri = g_filename_to_uri (_gtk_search_index_get_path (index, hit->id), NULL, NULL);
+      if (uri)
+        data->uri_hits = g_list_prepend (data->uri_hits, uri);
+
+      data->n_processed_files++;
+      if (data->n_processed_files >= BATCH_SIZE)
+        send_batch (data);
+    }
+
+  g_array_unref (ranked);
+
+  send_batch (data);
+
+  data->index = index;
+
+out:
   gdk_threads_add_idle (search_thread_done_idle, data);
-#endif /* HAVE_FTW_H */
   
   return NULL;
 }
@@ -373,9 +513,5 @@ _gtk_search_engine_simple_init (GtkSearchEngineSimple *engine)
 GtkSearchEngine *
 _gtk_search_engine_simple_new (void)
 {
-#ifdef HAVE_FTW_H
   return g_object_new (GTK_TYPE_SEARCH_ENGINE_SIMPLE, NULL);
-#else
-  return NULL;
-#endif
 }
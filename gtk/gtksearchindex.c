@@ -0,0 +1,1087 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtksearchindexprivate.h"
+
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
+
+/* The index of all file names below a directory, used by the simple
+ * search engine.
+ *
+ * It is stored in the user cache directory and mapped into memory as
+ * is. It is only ever read by the GTK+ version that wrote it, so it uses
+ * host byte order; a file that doesn't look right is thrown away and
+ * the file system is walked again.
+ *
+ * The file consists of a header followed by the directories, the
+ * entries, the trigram table, the posting lists and the strings. The
+ * entries of each directory are consecutive. For every trigram of a
+ * lowercased name, the posting list contains the ids of the entries
+ * with that trigram, so a query only needs to look at the entries in
+ * the shortest posting list of its trigrams.
+ *
+ * Instead of monitoring every directory, which quickly runs into the
+ * limits of the file monitoring backends, the index remembers the
+ * modification time of every directory and rereads just the
+ * directories that changed.
+ *
+ * Indexes are built or refreshed by an IndexJob in a thread of its
+ * own, so a search that is cancelled because the query changed doesn't
+ * throw away the work done so far. The next search for the same
+ * directory waits for the running job instead of starting another one.
+ * Once a search for another directory took over and nobody waits for
+ * a job anymore, the job stops without saving anything.
+ *
+ * The cache keeps at most GTK_SEARCH_INDEX_MAX_FILES indexes of at
+ * most GTK_SEARCH_INDEX_MAX_SIZE bytes together. Loading an index
+ * updates its modification time, and the indexes that were used least
+ * recently are removed first.
+ */
+
+#define INDEX_MAGIC "GtkSIdx1"
+#define INDEX_BYTE_ORDER 0x01020304
+
+/* How long a cached index is used before it is checked against
+ * the file system again */
+#define REFRESH_INTERVAL (5 * G_TIME_SPAN_SECOND)
+
+typedef struct {
+  gchar   magic[8];
+  guint32 byte_order;
+  guint32 n_dirs;
+  guint32 n_entries;
+  guint32 n_trigrams;
+  guint32 n_postings;
+  guint32 strings_size;
+} IndexHeader;
+
+typedef struct {
+  gint64  mtime;
+  guint32 path;
+  guint32 first_entry;
+  guint32 n_entries;
+  guint32 padding;
+} IndexDir;
+
+typedef struct {
+  guint32 path;
+  guint32 name;
+} IndexEntry;
+
+typedef struct {
+  guint32 trigram;
+  guint32 first_posting;
+  guint32 n_postings;
+} IndexTrigram;
+
+struct _GtkSearchIndex {
+  gint ref_count;
+
+  gchar *root;
+  GBytes *bytes;
+  gint64 checked_time;
+
+  const IndexHeader *header;
+  const IndexDir *dirs;
+  const IndexEntry *entries;
+  const IndexTrigram *trigrams;
+  const guint32 *postings;
+  const gchar *strings;
+};
+
+typedef struct {
+  gchar *path;
+  gint64 mtime;
+  guint first_entry;
+  guint n_entries;
+} BuilderDir;
+
+typedef struct {
+  GArray *dirs;
+  GPtrArray *entries;         /* appended with index_lock held */
+  /* directories that are taken from the old index when refreshing */
+  GHashTable *known_dirs;
+  gint64 start_time;
+  gboolean stopped;           /* protected by index_lock */
+} IndexBuilder;
+
+typedef struct {
+  gint ref_count;
+
+  gchar *root;
+  GtkSearchIndex *old_index;  /* the index to refresh, or NULL */
+  IndexBuilder *builder;
+
+  /* protected by index_lock */
+  guint n_waiters;
+  gboolean from_scratch;      /* TRUE if builder->entries are all entries found so far */
+  gboolean done;
+  GtkSearchIndex *result;
+} IndexJob;
+
+/* protects cached_index, current_job and the jobs */
+static GMutex index_lock;
+/* signalled when a job makes progress */
+static GCond index_cond;
+static GtkSearchIndex *cached_index = NULL;
+static IndexJob *current_job = NULL;
+
+static inline guint32
+make_trigram (const gchar *s)
+{
+  return ((guchar) s[0] << 16) | ((guchar) s[1] << 8) | (guchar) s[2];
+}
+
+static inline const gchar *
+index_string (GtkSearchIndex *index,
+              guint32         offset)
+{
+  if (offset >= index->header->strings_size)
+    return "";
+
+  return index->strings + offset;
+}
+
+static GtkSearchIndex *
+gtk_search_index_new_from_bytes (const gchar *root,
+                                 GBytes      *bytes)
+{
+  GtkSearchIndex *index;
+  const IndexHeader *header;
+  const guint8 *data;
+  guint64 expected_size;
+  gsize size;
+  guint i;
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size < sizeof (IndexHeader))
+    return NULL;
+
+  header = (const IndexHeader *) data;
+  if (memcmp (header->magic, INDEX_MAGIC, sizeof (header->magic)) != 0 ||
+      header->byte_order != INDEX_BYTE_ORDER)
+    return NULL;
+
+  expected_size = sizeof (IndexHeader)
+                  + (guint64) header->n_dirs * sizeof (IndexDir)
+                  + (guint64) header->n_entries * sizeof (IndexEntry)
+                  + (guint64) header->n_trigrams * sizeof (IndexTrigram)
+                  + (guint64) header->n_postings * sizeof (guint32)
+                  + header->strings_size;
+  if (expected_size != size ||
+      header->strings_size == 0 ||
+      data[size - 1] != '\0')
+    return NULL;
+
+  index = g_slice_new0 (GtkSearchIndex);
+  index->ref_count = 1;
+  index->root = g_strdup (root);
+  index->bytes = g_bytes_ref (bytes);
+
+  index->header = header;
+  index->dirs = (const IndexDir *) (header + 1);
+  index->entries = (const IndexEntry *) (index->dirs + header->n_dirs);
+  index->trigrams = (const IndexTrigram *) (index->entries + header->n_entries);
+  index->postings = (const guint32 *) (index->trigrams + header->n_trigrams);
+  index->strings = (const gchar *) (index->postings + header->n_postings);
+
+  for (i = 0; i < header->n_dirs; i++)
+    {
+      if ((guint64) index->dirs[i].first_entry + index->dirs[i].n_entries > header->n_entries)
+        goto fail;
+    }
+
+  for (i = 0; i < header->n_trigrams; i++)
+    {
+      if ((guint64) index->trigrams[i].first_posting + index->trigrams[i].n_postings > header->n_postings)
+        goto fail;
+    }
+
+  return index;
+
+fail:
+  _gtk_search_index_unref (index);
+  return NULL;
+}
+
+GtkSearchIndex *
+_gtk_search_index_ref (GtkSearchIndex *index)
+{
+  g_return_val_if_fail (index != NULL, NULL);
+
+  g_atomic_int_inc (&index->ref_count);
+
+  return index;
+}
+
+void
+_gtk_search_index_unref (GtkSearchIndex *index)
+{
+  g_return_if_fail (index != NULL);
+
+  if (!g_atomic_int_dec_and_test (&index->ref_count))
+    return;
+
+  g_bytes_unref (index->bytes);
+  g_free (index->root);
+  g_slice_free (GtkSearchIndex, index);
+}
+
+/*
+ * _gtk_search_index_get_filename:
+ * @root: the indexed directory
+ *
+ * Returns: the file the index of @root is saved in
+ */
+gchar *
+_gtk_search_index_get_filename (const gchar *root)
+{
+  gchar *checksum, *basename, *filename;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, root, -1);
+  basename = g_strconcat (checksum, ".index", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gtk-3.0", "search", basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+
+  return filename;
+}
+
+static GtkSearchIndex *
+gtk_search_index_load (const gchar *root)
+{
+  GtkSearchIndex *index;
+  GMappedFile *file;
+  GBytes *bytes;
+  gchar *filename;
+
+  filename = _gtk_search_index_get_filename (root);
+  file = g_mapped_file_new (filename, FALSE, NULL);
+  if (file == NULL)
+    {
+      g_free (filename);
+      return NULL;
+    }
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  index = gtk_search_index_new_from_bytes (root, bytes);
+  g_bytes_unref (bytes);
+
+  /* Guard against checksum collisions */
+  if (index != NULL &&
+      (index->header->n_dirs == 0 ||
+       strcmp (index_string (index, index->dirs[0].path), root) != 0))
+    {
+      _gtk_search_index_unref (index);
+      index = NULL;
+    }
+
+  /* Mark the index as recently used */
+  if (index != NULL)
+    g_utime (filename, NULL);
+
+  g_free (filename);
+
+  return index;
+}
+
+typedef struct {
+  gchar *filename;
+  gint64 mtime;
+  gint64 size;
+} IndexFile;
+
+static gint
+compare_index_files (gconstpointer a,
+                     gconstpointer b)
+{
+  const IndexFile *fa = a;
+  const IndexFile *fb = b;
+
+  /* most recently used first */
+  return fa->mtime > fb->mtime ? -1 : (fa->mtime < fb->mtime ? 1 : 0);
+}
+
+/* Removes the least recently used indexes in @dirname until the
+ * limits are met again. The index in @keep is never removed. */
+static void
+gtk_search_index_prune (const gchar *dirname,
+                        const gchar *keep)
+{
+  GArray *files;
+  const gchar *name;
+  GStatBuf st;
+  GDir *dir;
+  gint64 size;
+  guint i, n_files;
+
+  dir = g_dir_open (dirname, 0, NULL);
+  if (dir == NULL)
+    return;
+
+  files = g_array_new (FALSE, FALSE, sizeof (IndexFile));
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      IndexFile file;
+
+      if (!g_str_has_suffix (name, ".index"))
+        continue;
+
+      file.filename = g_build_filename (dirname, name, NULL);
+      if (g_stat (file.filename, &st) != 0 || !S_ISREG (st.st_mode))
+        {
+          g_free (file.filename);
+          continue;
+        }
+
+      /* The index that was just saved goes first */
+      file.mtime = strcmp (file.filename, keep) == 0 ? G_MAXINT64 : st.st_mtime;
+      file.size = st.st_size;
+      g_array_append_val (files, file);
+    }
+
+  g_dir_close (dir);
+
+  g_array_sort (files, compare_index_files);
+
+  size = 0;
+  n_files = 0;
+
+  for (i = 0; i < files->len; i++)
+    {
+      IndexFile *file = &g_array_index (files, IndexFile, i);
+
+      size += file->size;
+      n_files++;
+
+      if (i > 0 &&
+          (n_files > GTK_SEARCH_INDEX_MAX_FILES || size > GTK_SEARCH_INDEX_MAX_SIZE))
+        {
+          g_remove (file->filename);
+          size -= file->size;
+          n_files--;
+        }
+
+      g_free (file->filename);
+    }
+
+  g_array_unref (files);
+}
+
+static void
+gtk_search_index_save (GtkSearchIndex *index)
+{
+  gchar *filename, *dirname;
+  gconstpointer data;
+  gsize size;
+
+  filename = _gtk_search_index_get_filename (index->root);
+  dirname = g_path_get_dirname (filename);
+
+  /* Failing to save only means we walk the file system again next time */
+  if (g_mkdir_with_parents (dirname, 0700) == 0)
+    {
+      data = g_bytes_get_data (index->bytes, &size);
+      if (g_file_set_contents (filename, data, size, NULL))
+        gtk_search_index_prune (dirname, filename);
+    }
+
+  g_free (dirname);
+  g_free (filename);
+}
+
+static IndexBuilder *
+index_builder_new (void)
+{
+  IndexBuilder *builder;
+
+  builder = g_slice_new0 (IndexBuilder);
+  builder->dirs = g_array_new (FALSE, FALSE, sizeof (BuilderDir));
+  builder->entries = g_ptr_array_new_with_free_func (g_free);
+  builder->start_time = g_get_real_time () / G_USEC_PER_SEC;
+
+  return builder;
+}
+
+static void
+index_builder_free (IndexBuilder *builder)
+{
+  guint i;
+
+  for (i = 0; i < builder->dirs->len; i++)
+    g_free (g_array_index (builder->dirs, BuilderDir, i).path);
+
+  g_array_unref (builder->dirs);
+  g_ptr_array_unref (builder->entries);
+  if (builder->known_dirs)
+    g_hash_table_unref (builder->known_dirs);
+
+  g_slice_free (IndexBuilder, builder);
+}
+
+/* Adds the entries of a directory at once, so searches waiting
+ * for the job only need to take the lock once per directory.
+ * Returns %FALSE if the builder was stopped. */
+static gboolean
+index_builder_add_entries (IndexBuilder *builder,
+                           GPtrArray    *children)
+{
+  gboolean stopped;
+  guint i;
+
+  g_mutex_lock (&index_lock);
+  for (i = 0; i < children->len; i++)
+    g_ptr_array_add (builder->entries, g_ptr_array_index (children, i));
+  stopped = builder->stopped;
+  g_mutex_unlock (&index_lock);
+
+  return !stopped;
+}
+
+/* Returns %FALSE if the builder was stopped */
+static gboolean
+index_builder_scan (IndexBuilder *builder,
+                    const gchar  *path)
+{
+  BuilderDir dir;
+  GStatBuf st;
+  GDir *handle;
+  GPtrArray *children, *subdirs;
+  const gchar *name;
+  gboolean keep_going;
+  guint i;
+
+  if (g_stat (path, &st) != 0 || !S_ISDIR (st.st_mode))
+    return TRUE;
+
+  handle = g_dir_open (path, 0, NULL);
+  if (handle == NULL)
+    return TRUE;
+
+  dir.path = g_strdup (path);
+  /* A directory can change again within the same second without
+   * its mtime changing, so make sure it is read again next time */
+  dir.mtime = st.st_mtime < builder->start_time ? st.st_mtime : -1;
+  dir.first_entry = builder->entries->len;
+
+  children = g_ptr_array_new ();
+  subdirs = g_ptr_array_new_with_free_func (g_free);
+
+  while ((name = g_dir_read_name (handle)) != NULL)
+    {
+      gchar *child;
+
+      /* Hidden files and everything below hidden directories
+       * are not searched */
+      if (name[0] == '.')
+        continue;
+
+      child = g_build_filename (path, name, NULL);
+      g_ptr_array_add (children, child);
+
+      if (g_lstat (child, &st) == 0 && S_ISDIR (st.st_mode) &&
+          (builder->known_dirs == NULL ||
+           !g_hash_table_contains (builder->known_dirs, child)))
+        g_ptr_array_add (subdirs, g_strdup (child));
+    }
+
+  g_dir_close (handle);
+
+  keep_going = index_builder_add_entries (builder, children);
+  g_ptr_array_unref (children);
+
+  dir.n_entries = builder->entries->len - dir.first_entry;
+  g_array_append_val (builder->dirs, dir);
+
+  for (i = 0; keep_going && i < subdirs->len; i++)
+    keep_going = index_builder_scan (builder, g_ptr_array_index (subdirs, i));
+
+  g_ptr_array_unref (subdirs);
+
+  return keep_going;
+}
+
+/* Returns %FALSE if the builder was stopped */
+static gboolean
+index_builder_copy_dir (IndexBuilder   *builder,
+                        GtkSearchIndex *index,
+                        const IndexDir *old_dir)
+{
+  BuilderDir dir;
+  GPtrArray *children;
+  gboolean keep_going;
+  guint i;
+
+  dir.path = g_strdup (index_string (index, old_dir->path));
+  dir.mtime = old_dir->mtime;
+  dir.first_entry = builder->entries->len;
+  dir.n_entries = old_dir->n_entries;
+
+  children = g_ptr_array_sized_new (old_dir->n_entries);
+  for (i = 0; i < old_dir->n_entries; i++)
+    {
+      const IndexEntry *entry = &index->entries[old_dir->first_entry + i];
+
+      g_ptr_array_add (children, g_strdup (index_string (index, entry->path)));
+    }
+
+  keep_going = index_builder_add_entries (builder, children);
+  g_ptr_array_unref (children);
+
+  g_array_append_val (builder->dirs, dir);
+
+  return keep_going;
+}
+
+static guint32
+add_string (GString     *strings,
+            const gchar *s)
+{
+  guint32 offset = strings->len;
+
+  g_string_append_len (strings, s, strlen (s) + 1);
+
+  return offset;
+}
+
+static gint
+compare_pairs (gconstpointer a,
+               gconstpointer b)
+{
+  guint64 pa = *(const guint64 *) a;
+  guint64 pb = *(const guint64 *) b;
+
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+static GtkSearchIndex *
+index_builder_finish (IndexBuilder *builder,
+                      const gchar  *root)
+{
+  GtkSearchIndex *index;
+  IndexHeader header;
+  GArray *dirs, *entries, *trigrams, *postings, *pairs;
+  GString *strings;
+  GByteArray *data;
+  GBytes *bytes;
+  guint64 last_pair;
+  guint i, j;
+
+  dirs = g_array_sized_new (FALSE, FALSE, sizeof (IndexDir), builder->dirs->len);
+  entries = g_array_sized_new (FALSE, FALSE, sizeof (IndexEntry), builder->entries->len);
+  trigrams = g_array_new (FALSE, FALSE, sizeof (IndexTrigram));
+  postings = g_array_new (FALSE, FALSE, sizeof (guint32));
+  pairs = g_array_new (FALSE, FALSE, sizeof (guint64));
+  strings = g_string_new (NULL);
+
+  /* offset 0 is the empty string */
+  g_string_append_c (strings, '\0');
+
+  for (i = 0; i < builder->dirs->len; i++)
+    {
+      BuilderDir *bdir = &g_array_index (builder->dirs, BuilderDir, i);
+      IndexDir dir;
+
+      dir.mtime = bdir->mtime;
+      dir.path = add_string (strings, bdir->path);
+      dir.first_entry = bdir->first_entry;
+      dir.n_entries = bdir->n_entries;
+      dir.padding = 0;
+
+      g_array_append_val (dirs, dir);
+    }
+
+  for (i = 0; i < builder->entries->len; i++)
+    {
+      const gchar *path = g_ptr_array_index (builder->entries, i);
+      const gchar *name;
+      gchar *lower;
+      IndexEntry entry;
+
+      name = strrchr (path, G_DIR_SEPARATOR);
+      name = name ? name + 1 : path;
+      lower = g_ascii_strdown (name, -1);
+
+      entry.path = add_string (strings, path);
+      entry.name = add_string (strings, lower);
+      g_array_append_val (entries, entry);
+
+      for (j = 0; lower[j] && lower[j + 1] && lower[j + 2]; j++)
+        {
+          guint64 pair = ((guint64) make_trigram (lower + j) << 32) | i;
+
+          g_array_append_val (pairs, pair);
+        }
+
+      g_free (lower);
+    }
+
+  /* Sorting groups the entries by trigram and orders each posting
+   * list, duplicates from names repeating a trigram end up adjacent */
+  g_array_sort (pairs, compare_pairs);
+
+  last_pair = G_MAXUINT64;
+  for (i = 0; i < pairs->len; i++)
+    {
+      guint64 pair = g_array_index (pairs, guint64, i);
+      guint32 trigram = pair >> 32;
+      guint32 id = pair & G_MAXUINT32;
+
+      if (pair == last_pair)
+        continue;
+
+      if (trigrams->len == 0 ||
+          g_array_index (trigrams, IndexTrigram, trigrams->len - 1).trigram != trigram)
+        {
+          IndexTrigram t;
+
+          t.trigram = trigram;
+          t.first_posting = postings->len;
+          t.n_postings = 0;
+          g_array_append_val (trigrams, t);
+        }
+
+      g_array_index (trigrams, IndexTrigram, trigrams->len - 1).n_postings++;
+      g_array_append_val (postings, id);
+      last_pair = pair;
+    }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, INDEX_MAGIC, sizeof (header.magic));
+  header.byte_order = INDEX_BYTE_ORDER;
+  header.n_dirs = dirs->len;
+  header.n_entries = entries->len;
+  header.n_trigrams = trigrams->len;
+  header.n_postings = postings->len;
+  header.strings_size = strings->len;
+
+  data = g_byte_array_sized_new (sizeof (header)
+                                 + dirs->len * sizeof (IndexDir)
+                                 + entries->len * sizeof (IndexEntry)
+                                 + trigrams->len * sizeof (IndexTrigram)
+                                 + postings->len * sizeof (guint32)
+                                 + strings->len);
+  g_byte_array_append (data, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (data, (const guint8 *) dirs->data, dirs->len * sizeof (IndexDir));
+  g_byte_array_append (data, (const guint8 *) entries->data, entries->len * sizeof (IndexEntry));
+  g_byte_array_append (data, (const guint8 *) trigrams->data, trigrams->len * sizeof (IndexTrigram));
+  g_byte_array_append (data, (const guint8 *) postings->data, postings->len * sizeof (guint32));
+  g_byte_array_append (data, (const guint8 *) strings->str, strings->len);
+
+  g_array_unref (dirs);
+  g_array_unref (entries);
+  g_array_unref (trigrams);
+  g_array_unref (postings);
+  g_array_unref (pairs);
+  g_string_free (strings, TRUE);
+
+  bytes = g_byte_array_free_to_bytes (data);
+  index = gtk_search_index_new_from_bytes (root, bytes);
+  g_bytes_unref (bytes);
+
+  return index;
+}
+
+/* Returns a new reference to @index if nothing changed,
+ * or %NULL if the builder was stopped */
+static GtkSearchIndex *
+gtk_search_index_refresh (GtkSearchIndex *index,
+                          IndexBuilder   *builder)
+{
+  gboolean changed, keep_going;
+  guint i;
+
+  builder->known_dirs = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (i = 0; i < index->header->n_dirs; i++)
+    g_hash_table_add (builder->known_dirs,
+                      (gpointer) index_string (index, index->dirs[i].path));
+
+  changed = FALSE;
+  keep_going = TRUE;
+
+  for (i = 0; keep_going && i < index->header->n_dirs; i++)
+    {
+      const IndexDir *dir = &index->dirs[i];
+      const gchar *path = index_string (index, dir->path);
+      GStatBuf st;
+
+      /* Removed directories are simply dropped; their parent changed
+       * as well, so its list of entries is updated below */
+      if (g_stat (path, &st) != 0 || !S_ISDIR (st.st_mode))
+        changed = TRUE;
+      else if (st.st_mtime != dir->mtime)
+        {
+          changed = TRUE;
+          keep_going = index_builder_scan (builder, path);
+        }
+      else
+        keep_going = index_builder_copy_dir (builder, index, dir);
+    }
+
+  if (!keep_going)
+    return NULL;
+  else if (changed)
+    return index_builder_finish (builder, index->root);
+  else
+    return _gtk_search_index_ref (index);
+}
+
+static IndexJob *
+index_job_ref (IndexJob *job)
+{
+  g_atomic_int_inc (&job->ref_count);
+
+  return job;
+}
+
+static void
+index_job_unref (IndexJob *job)
+{
+  if (!g_atomic_int_dec_and_test (&job->ref_count))
+    return;
+
+  if (job->old_index)
+    _gtk_search_index_unref (job->old_index);
+  if (job->result)
+    _gtk_search_index_unref (job->result);
+  index_builder_free (job->builder);
+  g_free (job->root);
+  g_slice_free (IndexJob, job);
+}
+
+static gpointer
+index_job_run (gpointer data)
+{
+  IndexJob *job = data;
+  GtkSearchIndex *index, *result;
+
+  index = job->old_index;
+  if (index == NULL)
+    index = job->old_index = gtk_search_index_load (job->root);
+
+  if (index == NULL)
+    {
+      g_mutex_lock (&index_lock);
+      job->from_scratch = TRUE;
+      g_mutex_unlock (&index_lock);
+
+      if (index_builder_scan (job->builder, job->root))
+        result = index_builder_finish (job->builder, job->root);
+      else
+        result = NULL;
+    }
+  else
+    result = gtk_search_index_refresh (index, job->builder);
+
+  if (result != NULL && result != index)
+    gtk_search_index_save (result);
+
+  g_mutex_lock (&index_lock);
+
+  job->result = result;
+  job->done = TRUE;
+
+  if (result != NULL)
+    {
+      result->checked_time = g_get_monotonic_time ();
+
+      if (current_job == job && cached_index != result)
+        {
+          if (cached_index != NULL)
+            _gtk_search_index_unref (cached_index);
+          cached_index = _gtk_search_index_ref (result);
+        }
+    }
+
+  if (current_job == job)
+    current_job = NULL;
+
+  g_cond_broadcast (&index_cond);
+  g_mutex_unlock (&index_lock);
+
+  index_job_unref (job);
+
+  return NULL;
+}
+
+/* Stops @job if it is useless. The index of a job that nobody
+ * waits for is only worth finishing if the next search for the
+ * same directory can pick it up, that is while it is the current
+ * job. Must be called with index_lock held. */
+static void
+index_job_check_waiters (IndexJob *job)
+{
+  if (job->n_waiters == 0 && job != current_job)
+    job->builder->stopped = TRUE;
+}
+
+/* Must be called with index_lock held */
+static IndexJob *
+index_job_start (const gchar    *root,
+                 GtkSearchIndex *old_index)
+{
+  IndexJob *job, *replaced;
+
+  job = g_slice_new0 (IndexJob);
+  job->ref_count = 2;
+  job->root = g_strdup (root);
+  job->old_index = old_index ? _gtk_search_index_ref (old_index) : NULL;
+  job->builder = index_builder_new ();
+
+  replaced = current_job;
+  current_job = job;
+  if (replaced != NULL)
+    index_job_check_waiters (replaced);
+
+  g_thread_unref (g_thread_new ("search-index", index_job_run, job));
+
+  return job;
+}
+
+/* Calls @visit_func for the entries that were found since the last
+ * call. Must be called with index_lock held, which is released while
+ * calling @visit_func. */
+static void
+index_job_visit (IndexJob                *job,
+                 guint                   *n_visited,
+                 GtkSearchIndexVisitFunc  visit_func,
+                 gpointer                 user_data)
+{
+  GPtrArray *entries = job->builder->entries;
+  gchar **paths;
+  guint i, n;
+
+  if (!job->from_scratch || *n_visited >= entries->len)
+    return;
+
+  /* The paths stay around as long as the job does */
+  n = entries->len - *n_visited;
+  paths = g_new (gchar *, n);
+  memcpy (paths, entries->pdata + *n_visited, n * sizeof (gchar *));
+  *n_visited = entries->len;
+
+  g_mutex_unlock (&index_lock);
+
+  for (i = 0; i < n; i++)
+    visit_func (paths[i], user_data);
+
+  g_free (paths);
+
+  g_mutex_lock (&index_lock);
+}
+
+/*
+ * _gtk_search_index_get:
+ * @root: the directory to search
+ * @visit_func: (allow-none): function to call for the files found
+ *     while the index is built
+ * @user_data: user data for @visit_func
+ * @cancelled: a flag that is set when the caller is no longer interested
+ *
+ * Returns an up to date index of the file names below @root. This is
+ * meant to be called from the search thread, since it may have to wait
+ * until the whole directory tree is walked.
+ *
+ * If the index has to be built from scratch, @visit_func is called
+ * from the calling thread for every file found so far and while the
+ * build continues, so the caller can show results before the index is
+ * done. In that case it was called for every entry of the returned
+ * index; otherwise it isn't called at all.
+ *
+ * Setting @cancelled only stops waiting; the index is still built,
+ * so that the next search for @root can use it, unless a search for
+ * another directory starts before it is done.
+ *
+ * Returns: a new reference to the index, or %NULL if @cancelled was set
+ */
+GtkSearchIndex *
+_gtk_search_index_get (const gchar             *root,
+                       GtkSearchIndexVisitFunc  visit_func,
+                       gpointer                 user_data,
+                       volatile gboolean       *cancelled)
+{
+  GtkSearchIndex *result;
+  IndexJob *job;
+  guint n_visited;
+
+  g_return_val_if_fail (root != NULL, NULL);
+
+  g_mutex_lock (&index_lock);
+
+  if (cached_index != NULL && strcmp (cached_index->root, root) == 0 &&
+      g_get_monotonic_time () - cached_index->checked_time <= REFRESH_INTERVAL)
+    {
+      result = _gtk_search_index_ref (cached_index);
+      g_mutex_unlock (&index_lock);
+      return result;
+    }
+
+  if (current_job != NULL && strcmp (current_job->root, root) == 0)
+    job = index_job_ref (current_job);
+  else if (cached_index != NULL && strcmp (cached_index->root, root) == 0)
+    job = index_job_start (root, cached_index);
+  else
+    job = index_job_start (root, NULL);
+
+  n_visited = 0;
+  job->n_waiters++;
+
+  while (!job->done && !*cancelled)
+    {
+      gint64 end_time;
+
+      if (visit_func)
+        index_job_visit (job, &n_visited, visit_func, user_data);
+
+      /* Wake up now and then to check @cancelled */
+      end_time = g_get_monotonic_time () + G_TIME_SPAN_SECOND / 10;
+      if (!job->done)
+        g_cond_wait_until (&index_cond, &index_lock, end_time);
+    }
+
+  if (job->done && job->result != NULL)
+    {
+      if (visit_func)
+        index_job_visit (job, &n_visited, visit_func, user_data);
+
+      result = _gtk_search_index_ref (job->result);
+    }
+  else
+    result = NULL;
+
+  job->n_waiters--;
+  if (!job->done)
+    index_job_check_waiters (job);
+
+  g_mutex_unlock (&index_lock);
+
+  index_job_unref (job);
+
+  return result;
+}
+
+guint
+_gtk_search_index_get_n_entries (GtkSearchIndex *index)
+{
+  return index->header->n_entries;
+}
+
+const gchar *
+_gtk_search_index_get_path (GtkSearchIndex *index,
+                            guint           id)
+{
+  g_return_val_if_fail (id < index->header->n_entries, NULL);
+
+  return index_string (index, index->entries[id].path);
+}
+
+/* The lowercased basename */
+const gchar *
+_gtk_search_index_get_name (GtkSearchIndex *index,
+                            guint           id)
+{
+  g_return_val_if_fail (id < index->header->n_entries, NULL);
+
+  return index_string (index, index->entries[id].name);
+}
+
+static const IndexTrigram *
+find_trigram (GtkSearchIndex *index,
+              guint32         trigram)
+{
+  guint lo, hi, mid;
+
+  lo = 0;
+  hi = index->header->n_trigrams;
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+
+      if (index->trigrams[mid].trigram == trigram)
+        return &index->trigrams[mid];
+      else if (index->trigrams[mid].trigram < trigram)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return NULL;
+}
+
+/*
+ * _gtk_search_index_lookup:
+ * @index: a #GtkSearchIndex
+ * @words: the lowercased words that must all be part of a name
+ *
+ * Narrows down the entries whose names can contain all of @words.
+ * The candidates still need to be checked by the caller.
+ *
+ * Returns: an array of entry ids, or %NULL if none of the words is
+ *   long enough to narrow down the search and every entry is a candidate
+ */
+GArray *
+_gtk_search_index_lookup (GtkSearchIndex  *index,
+                          gchar          **words)
+{
+  const IndexTrigram *best, *found;
+  GArray *result;
+  guint i, j;
+
+  best = NULL;
+
+  for (i = 0; words[i] != NULL; i++)
+    {
+      for (j = 0; words[i][j] && words[i][j + 1] && words[i][j + 2]; j++)
+        {
+          found = find_trigram (index, make_trigram (words[i] + j));
+
+          /* No name contains this trigram, so nothing matches */
+          if (found == NULL)
+            return g_array_new (FALSE, FALSE, sizeof (guint));
+
+          if (best == NULL || found->n_postings < best->n_postings)
+            best = found;
+        }
+    }
+
+  if (best == NULL)
+    return NULL;
+
+  result = g_array_sized_new (FALSE, FALSE, sizeof (guint), best->n_postings);
+
+  for (i = 0; i < best->n_postings; i++)
+    {
+      guint id = index->postings[best->first_posting + i];
+
+      if (id < index->header->n_entries)
+        g_array_append_val (result, id);
+    }
+
+  return result;
+}
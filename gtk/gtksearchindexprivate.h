@@ -0,0 +1,54 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_SEARCH_INDEX_PRIVATE_H__
+#define __GTK_SEARCH_INDEX_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Limits for the indexes kept in the user cache directory */
+#define GTK_SEARCH_INDEX_MAX_FILES 16
+#define GTK_SEARCH_INDEX_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct _GtkSearchIndex GtkSearchIndex;
+
+typedef void (* GtkSearchIndexVisitFunc) (const gchar *path,
+                                          gpointer     user_data);
+
+GtkSearchIndex *        _gtk_search_index_get                   (const gchar            *root,
+                                                                 GtkSearchIndexVisitFunc visit_func,
+                                                                 gpointer                user_data,
+                                                                 volatile gboolean      *cancelled);
+GtkSearchIndex *        _gtk_search_index_ref                   (GtkSearchIndex         *index);
+void                    _gtk_search_index_unref                 (GtkSearchIndex         *index);
+
+gchar *                 _gtk_search_index_get_filename          (const gchar            *root);
+
+guint                   _gtk_search_index_get_n_entries         (GtkSearchIndex         *index);
+const gchar *           _gtk_search_index_get_path              (GtkSearchIndex         *index,
+                                                                 guint                   id);
+const gchar *           _gtk_search_index_get_name              (GtkSearchIndex         *index,
+                                                                 guint                   id);
+
+GArray *                _gtk_search_index_lookup                (GtkSearchIndex         *index,
+                                                                 gchar                 **words);
+
+G_END_DECLS
+
+#endif /* __GTK_SEARCH_INDEX_PRIVATE_H__ */
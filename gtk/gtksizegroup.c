@@ -212,22 +212,16 @@ static void
 real_queue_resize (GtkWidget          *widget,
 		   GtkQueueResizeFlags flags)
 {
-  GtkWidget *container;
-
-  _gtk_widget_set_alloc_needed (widget, TRUE);
-  _gtk_size_request_cache_clear (_gtk_widget_peek_request_cache (widget));
-
-  container = gtk_widget_get_parent (widget);
-  if (!container &&
-      gtk_widget_is_toplevel (widget) && GTK_IS_CONTAINER (widget))
-    container = widget;
-
-  if (container)
+  if (gtk_widget_get_parent (widget) ||
+      (gtk_widget_is_toplevel (widget) && GTK_IS_CONTAINER (widget)))
+    {
+      _gtk_container_queue_resize_widget (widget,
+                                          (flags & GTK_QUEUE_RESIZE_INVALIDATE_ONLY) != 0);
+    }
+  else
     {
-      if (flags & GTK_QUEUE_RESIZE_INVALIDATE_ONLY)
-	_gtk_container_resize_invalidate (GTK_CONTAINER (container));
-      else
-	_gtk_container_queue_resize (GTK_CONTAINER (container));
+      _gtk_widget_set_alloc_needed (widget, TRUE);
+      _gtk_size_request_cache_clear (_gtk_widget_peek_request_cache (widget));
     }
 }
 
@@ -23,6 +23,7 @@
 
 #include "gtksizerequest.h"
 
+#include "gtkcontainerprivate.h"
 #include "gtkdebug.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
@@ -31,6 +32,8 @@
 #include "gtkwidgetprivate.h"
 #include "deprecated/gtkstyle.h"
 
+#include <stdlib.h>
+
 
 #ifndef G_DISABLE_CHECKS
 static GQuark recursion_check_quark = 0;
@@ -168,6 +171,8 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
     {
       gint adjusted_min, adjusted_natural, adjusted_for_size = for_size;
 
+      _gtk_container_count_measure ();
+
       G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
       gtk_widget_ensure_style (widget);
       G_GNUC_END_IGNORE_DEPRECATIONS;
@@ -353,6 +358,286 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 	    );
 }
 
+static gboolean
+request_matches (GtkWidget      *widget,
+                 GtkOrientation  orientation,
+                 gint            for_size,
+                 gint            minimum_size,
+                 gint            natural_size,
+                 gint            minimum_baseline,
+                 gint            natural_baseline)
+{
+  gint min_size, nat_size, min_baseline, nat_baseline;
+
+  gtk_widget_query_size_for_orientation (widget, orientation, for_size,
+                                         &min_size, &nat_size,
+                                         &min_baseline, &nat_baseline);
+
+  return min_size == minimum_size &&
+         nat_size == natural_size &&
+         min_baseline == minimum_baseline &&
+         nat_baseline == natural_baseline;
+}
+
+/* Measures @widget again for every size that was cached in @request,
+ * a cache that has since been taken away from the widget, and checks
+ * that the results did not change. Cached ranges are only checked at
+ * their bounds.
+ *
+ * Size group and visibility handling happens on top of the cache, so
+ * callers need to rule those out themselves.
+ */
+gboolean
+_gtk_widget_request_matches (GtkWidget *widget,
+                             gpointer   request)
+{
+  SizeRequestCache *cache = request;
+  GtkOrientation orientation;
+  guint i;
+
+  if (!cache->request_mode_valid ||
+      cache->request_mode != gtk_widget_get_request_mode (widget))
+    return FALSE;
+
+  for (orientation = GTK_ORIENTATION_HORIZONTAL; orientation <= GTK_ORIENTATION_VERTICAL; orientation++)
+    {
+      /* An evicting cache may have dropped sizes the parent relied on */
+      if (!cache->flags[orientation].cached_size_valid ||
+          cache->flags[orientation].evicted)
+        return FALSE;
+    }
+
+  if (!request_matches (widget, GTK_ORIENTATION_HORIZONTAL, -1,
+                        cache->cached_size_x.minimum_size,
+                        cache->cached_size_x.natural_size,
+                        -1, -1) ||
+      !request_matches (widget, GTK_ORIENTATION_VERTICAL, -1,
+                        cache->cached_size_y.minimum_size,
+                        cache->cached_size_y.natural_size,
+                        cache->cached_size_y.minimum_baseline,
+                        cache->cached_size_y.natural_baseline))
+    return FALSE;
+
+  for (i = 0; i < cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i++)
+    {
+      SizeRequestX *size = &cache->requests_x[i];
+
+      if (!request_matches (widget, GTK_ORIENTATION_HORIZONTAL, size->lower_for_size,
+                            size->cached_size.minimum_size,
+                            size->cached_size.natural_size,
+                            -1, -1) ||
+          !request_matches (widget, GTK_ORIENTATION_HORIZONTAL, size->upper_for_size,
+                            size->cached_size.minimum_size,
+                            size->cached_size.natural_size,
+                            -1, -1))
+        return FALSE;
+    }
+
+  for (i = 0; i < cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i++)
+    {
+      SizeRequestY *size = &cache->requests_y[i];
+
+      if (!request_matches (widget, GTK_ORIENTATION_VERTICAL, size->lower_for_size,
+                            size->cached_size.minimum_size,
+                            size->cached_size.natural_size,
+                            size->cached_size.minimum_baseline,
+                            size->cached_size.natural_baseline) ||
+          !request_matches (widget, GTK_ORIENTATION_VERTICAL, size->upper_for_size,
+                            size->cached_size.minimum_size,
+                            size->cached_size.natural_size,
+                            size->cached_size.minimum_baseline,
+                            size->cached_size.natural_baseline))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Widgets opt in to having their measurement prefetched by setting
+ * GtkWidgetMeasureFuncs on their class. Containers call
+ * _gtk_widget_prefetch_child_sizes() before requesting their children
+ * and the part of the measurement that the widget declared thread-safe
+ * runs in a thread pool. Everything else, like styling, size groups
+ * and the request cache, stays on the main thread.
+ *
+ * This is only enabled when GTK_MEASURE_THREADS is set to the number
+ * of threads to use, and only with a text stack that can shape in
+ * several threads at once, as long as no Pango object is shared
+ * between them:
+ *  - Pango 1.32.6, which gives each thread its own default cairo
+ *    font map; this is checked at runtime
+ *  - cairo 1.12, which GTK+ requires anyway
+ *  - fontconfig 2.10.91, the first thread-safe release; GTK+ doesn't
+ *    link to it on every backend, so it can't be checked here and
+ *    distributors enabling this must make sure of it
+ */
+typedef struct {
+  GMutex mutex;
+  GCond  cond;
+  guint  n_pending;
+} MeasureBatch;
+
+typedef struct {
+  MeasureBatch                *batch;
+  GtkWidget                   *widget;
+  const GtkWidgetMeasureFuncs *funcs;
+  gpointer                     data;
+} MeasureJob;
+
+typedef struct {
+  GtkOrientation  orientation;
+  GArray         *jobs;
+} MeasureCollect;
+
+static void
+measure_job_run (gpointer data,
+                 gpointer user_data)
+{
+  MeasureJob *job = data;
+  MeasureBatch *batch = job->batch;
+
+  job->funcs->run (job->data);
+
+  g_mutex_lock (&batch->mutex);
+  if (--batch->n_pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+}
+
+static GThreadPool *
+get_measure_pool (void)
+{
+  static GThreadPool *pool = NULL;
+  static gboolean initialized = FALSE;
+
+  if (!initialized)
+    {
+      const gchar *env;
+      gint n_threads;
+
+      initialized = TRUE;
+
+      env = g_getenv ("GTK_MEASURE_THREADS");
+      n_threads = env ? atoi (env) : 0;
+
+      if (n_threads > 1 && pango_version_check (1, 32, 6) == NULL)
+        pool = g_thread_pool_new (measure_job_run, NULL, n_threads, FALSE, NULL);
+    }
+
+  return pool;
+}
+
+static void
+collect_measure_job (GtkWidget *widget,
+                     gpointer   user_data)
+{
+  MeasureCollect *collect = user_data;
+  const GtkWidgetMeasureFuncs *funcs;
+  SizeRequestCache *cache;
+  MeasureJob job;
+
+  funcs = _gtk_widget_class_get_measure_funcs (GTK_WIDGET_GET_CLASS (widget));
+  if (funcs == NULL)
+    return;
+
+  if (!gtk_widget_get_visible (widget) ||
+      _gtk_widget_get_sizegroups (widget) != NULL)
+    return;
+
+  cache = _gtk_widget_peek_request_cache (widget);
+  if (cache->flags[collect->orientation].cached_size_valid)
+    return;
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
+  gtk_widget_ensure_style (widget);
+  G_GNUC_END_IGNORE_DEPRECATIONS;
+
+  job.batch = NULL;
+  job.widget = widget;
+  job.funcs = funcs;
+  job.data = funcs->prepare (widget, collect->orientation);
+
+  if (job.data != NULL)
+    g_array_append_val (collect->jobs, job);
+}
+
+/* Measures the children of @container that opted in to it in parallel,
+ * filling their request caches for @orientation. Results are applied
+ * on the main thread in child order, so the outcome is the same as
+ * measuring one child after the other.
+ */
+void
+_gtk_widget_prefetch_child_sizes (GtkWidget      *container,
+                                  GtkOrientation  orientation)
+{
+  GThreadPool *pool;
+  MeasureCollect collect;
+  MeasureBatch batch;
+  guint i;
+
+  pool = get_measure_pool ();
+  if (pool == NULL)
+    return;
+
+  collect.orientation = orientation;
+  collect.jobs = g_array_new (FALSE, FALSE, sizeof (MeasureJob));
+
+  gtk_container_forall (GTK_CONTAINER (container), collect_measure_job, &collect);
+
+  if (collect.jobs->len > 1)
+    {
+      g_mutex_init (&batch.mutex);
+      g_cond_init (&batch.cond);
+      batch.n_pending = collect.jobs->len;
+
+      for (i = 0; i < collect.jobs->len; i++)
+        {
+          MeasureJob *job = &g_array_index (collect.jobs, MeasureJob, i);
+
+          job->batch = &batch;
+          g_thread_pool_push (pool, job, NULL);
+        }
+
+      g_mutex_lock (&batch.mutex);
+      while (batch.n_pending > 0)
+        g_cond_wait (&batch.cond, &batch.mutex);
+      g_mutex_unlock (&batch.mutex);
+
+      g_mutex_clear (&batch.mutex);
+      g_cond_clear (&batch.cond);
+    }
+  else
+    {
+      /* Not worth the synchronization for a single child */
+      for (i = 0; i < collect.jobs->len; i++)
+        {
+          MeasureJob *job = &g_array_index (collect.jobs, MeasureJob, i);
+
+          job->funcs->run (job->data);
+        }
+    }
+
+  for (i = 0; i < collect.jobs->len; i++)
+    {
+      MeasureJob *job = &g_array_index (collect.jobs, MeasureJob, i);
+      gint minimum, natural, minimum_baseline, natural_baseline;
+
+      job->funcs->apply (job->widget, job->data);
+
+      if (orientation == GTK_ORIENTATION_HORIZONTAL)
+        gtk_widget_get_preferred_width (job->widget, &minimum, &natural);
+      else
+        gtk_widget_get_preferred_height_and_baseline_for_width (job->widget, -1,
+                                                                &minimum, &natural,
+                                                                &minimum_baseline,
+                                                                &natural_baseline);
+
+      job->funcs->clear (job->widget);
+    }
+
+  g_array_free (collect.jobs, TRUE);
+}
+
 /* This is the main function that checks for a cached size and
  * possibly queries the widget class to compute the size if it's
  * not cached. If the for_size here is -1, then get_preferred_width()
@@ -25,48 +25,90 @@
 
 #include <string.h>
 
+/* Global statistics of for_size lookups, see GTK_DEBUG=layout */
+static guint64 n_hits = 0;
+static guint64 n_misses = 0;
+static guint64 n_evictions = 0;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
   memset (cache, 0, sizeof (SizeRequestCache));
 }
 
-static void
-free_sizes_x (SizeRequestX **sizes)
+void
+_gtk_size_request_cache_free (SizeRequestCache *cache)
 {
-  gint i;
-
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestX, sizes[i]);
-
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_free (cache->requests_x);
+  g_free (cache->requests_y);
 }
 
-static void
-free_sizes_y (SizeRequestY **sizes)
+/* Drops the cached sizes, but keeps the room that was allocated
+ * for them, so widgets that needed a bigger cache keep it
+ */
+void
+_gtk_size_request_cache_clear (SizeRequestCache *cache)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestY, sizes[i]);
+  cache->request_mode_valid = FALSE;
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  for (i = 0; i < 2; i++)
+    {
+      cache->flags[i].n_cached_requests = 0;
+      cache->flags[i].last_cached_request = 0;
+      cache->flags[i].cached_size_valid = FALSE;
+      cache->flags[i].evicted = FALSE;
+    }
 }
 
-void
-_gtk_size_request_cache_free (SizeRequestCache *cache)
+/* Picks the slot for a new range, growing the cache if it is
+ * full and has been missing a lot lately
+ */
+static guint
+cache_take_slot (SizeRequestCache *cache,
+                 GtkOrientation    orientation,
+                 gsize             element_size,
+                 gpointer         *requests)
 {
-  if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
-  if (cache->requests_y)
-    free_sizes_y (cache->requests_y);
-}
+  guint n_sizes = cache->flags[orientation].n_cached_requests;
+  guint n_allocated = cache->flags[orientation].n_allocated_requests;
 
-void
-_gtk_size_request_cache_clear (SizeRequestCache *cache)
-{
-  _gtk_size_request_cache_free (cache);
-  _gtk_size_request_cache_init (cache);
+  if (n_sizes == n_allocated)
+    {
+      if (n_allocated == 0)
+        n_allocated = GTK_SIZE_REQUEST_CACHED_SIZES;
+      else if (n_allocated < GTK_SIZE_REQUEST_MAX_CACHED_SIZES &&
+               cache->flags[orientation].n_misses * 4 > cache->flags[orientation].n_lookups)
+        {
+          n_allocated = MIN (n_allocated * 2, GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+          cache->flags[orientation].n_lookups = 0;
+          cache->flags[orientation].n_misses = 0;
+        }
+
+      if (n_allocated != cache->flags[orientation].n_allocated_requests)
+        {
+          *requests = g_realloc (*requests, element_size * n_allocated);
+          cache->flags[orientation].n_allocated_requests = n_allocated;
+        }
+    }
+
+  /* If there is room, use a new slot, otherwise evict round-robin */
+  if (n_sizes < n_allocated)
+    {
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else
+    {
+      if (++cache->flags[orientation].last_cached_request == n_allocated)
+        cache->flags[orientation].last_cached_request = 0;
+
+      cache->flags[orientation].evicted = TRUE;
+      n_evictions++;
+    }
+
+  return cache->flags[orientation].last_cached_request;
 }
 
 void
@@ -115,42 +157,26 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
-      SizeRequestX **cached_sizes;
-      SizeRequestX  *cached_size;
-      cached_sizes = cache->requests_x;
+      SizeRequestX *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size)
+	  cached_size = &cache->requests_x[i];
+
+	  if (cached_size->cached_size.minimum_size == minimum_size &&
+	      cached_size->cached_size.natural_size == natural_size)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_size->lower_for_size = MIN (cached_size->lower_for_size, for_size);
+	      cached_size->upper_for_size = MAX (cached_size->upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
+      /* If not found, pull a new size from the cache */
+      i = cache_take_slot (cache, orientation, sizeof (SizeRequestX),
+                           (gpointer *) &cache->requests_x);
 
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
-
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_x[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -158,44 +184,28 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
     }
   else
     {
-      SizeRequestY **cached_sizes;
-      SizeRequestY  *cached_size;
-      cached_sizes = cache->requests_y;
+      SizeRequestY *cached_size;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size &&
-	      cached_sizes[i]->cached_size.minimum_baseline == minimum_baseline &&
-	      cached_sizes[i]->cached_size.natural_baseline == natural_baseline)
+	  cached_size = &cache->requests_y[i];
+
+	  if (cached_size->cached_size.minimum_size == minimum_size &&
+	      cached_size->cached_size.natural_size == natural_size &&
+	      cached_size->cached_size.minimum_baseline == minimum_baseline &&
+	      cached_size->cached_size.natural_baseline == natural_baseline)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_size->lower_for_size = MIN (cached_size->lower_for_size, for_size);
+	      cached_size->upper_for_size = MAX (cached_size->upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
+      /* If not found, pull a new size from the cache */
+      i = cache_take_slot (cache, orientation, sizeof (SizeRequestY),
+                           (gpointer *) &cache->requests_y);
 
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
-
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_y[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -205,6 +215,29 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
     }
 }
 
+static void
+count_lookup (SizeRequestCache *cache,
+              GtkOrientation    orientation,
+              gboolean          hit)
+{
+  /* Keep the ratio when the counters would overflow */
+  if (cache->flags[orientation].n_lookups == G_MAXUINT16)
+    {
+      cache->flags[orientation].n_lookups /= 2;
+      cache->flags[orientation].n_misses /= 2;
+    }
+
+  cache->flags[orientation].n_lookups++;
+
+  if (hit)
+    n_hits++;
+  else
+    {
+      cache->flags[orientation].n_misses++;
+      n_misses++;
+    }
+}
+
 /* looks for a cached size request for this for_size.
  *
  * Note that this caching code was originally derived from
@@ -235,7 +268,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  /* Search for an already cached size */
 	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
 	    {
-	      SizeRequestX *cur = cache->requests_x[i];
+	      SizeRequestX *cur = &cache->requests_x[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -244,6 +277,8 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 		  break;
 		}
 	    }
+
+	  count_lookup (cache, orientation, result != NULL);
 	}
 
       if (result)
@@ -273,7 +308,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  /* Search for an already cached size */
 	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
 	    {
-	      SizeRequestY *cur = cache->requests_y[i];
+	      SizeRequestY *cur = &cache->requests_y[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -282,6 +317,8 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 		  break;
 		}
 	    }
+
+	  count_lookup (cache, orientation, result != NULL);
 	}
 
       if (result)
@@ -297,3 +334,12 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
     }
 }
 
+void
+_gtk_size_request_cache_get_stats (guint64 *hits,
+                                   guint64 *misses,
+                                   guint64 *evictions)
+{
+  *hits = n_hits;
+  *misses = n_misses;
+  *evictions = n_evictions;
+}
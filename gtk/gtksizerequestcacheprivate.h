@@ -35,8 +35,15 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * Widgets start out with room for a few ranges.
+ * When more than a quarter of the lookups miss
+ * while the cache is full, like for wrapping
+ * text during window resizes, the cache grows
+ * instead of evicting, up to a limit.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
+#define GTK_SIZE_REQUEST_CACHED_SIZES     (5)
+#define GTK_SIZE_REQUEST_MAX_CACHED_SIZES (40)
 
 typedef struct {
   gint minimum_size;
@@ -65,8 +72,8 @@ typedef struct
 } SizeRequestY;
 
 typedef struct {
-  SizeRequestX **requests_x;
-  SizeRequestY **requests_y;
+  SizeRequestX *requests_x;
+  SizeRequestY *requests_y;
 
   CachedSizeX  cached_size_x;
   CachedSizeY  cached_size_y;
@@ -74,9 +81,15 @@ typedef struct {
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
+    guint8      n_cached_requests;
+    guint8      last_cached_request;
+    guint8      n_allocated_requests;
     guint       cached_size_valid   : 1;
+    guint       evicted             : 1; /* Ranges were dropped since the last clear */
+    /* Lookups of a for_size since the cache last grew,
+     * kept across clears */
+    guint16     n_lookups;
+    guint16     n_misses;
   }           flags[2];
 } SizeRequestCache;
 
@@ -99,6 +112,10 @@ gboolean        _gtk_size_request_cache_lookup                  (SizeRequestCach
                                                                  gint                   *minimum_baseline,
                                                                  gint                   *natural_baseline);
 
+void            _gtk_size_request_cache_get_stats               (guint64                *hits,
+                                                                 guint64                *misses,
+                                                                 guint64                *evictions);
+
 G_END_DECLS
 
 #endif /* __GTK_SIZE_REQUEST_CACHE_PRIVATE_H__ */
@@ -37,7 +37,7 @@
 #include "gtkwidget.h"
 #include "gtkwindow.h"
 #include "gtkprivate.h"
-#include "gtkwidgetpath.h"
+#include "gtkwidgetpathprivate.h"
 #include "gtkwidgetprivate.h"
 #include "gtkstylecascadeprivate.h"
 #include "gtkstyleproviderprivate.h"
@@ -319,6 +319,7 @@ typedef struct GtkStyleInfo GtkStyleInfo;
 typedef struct GtkRegion GtkRegion;
 typedef struct PropertyValue PropertyValue;
 typedef struct StyleData StyleData;
+typedef struct SharedStyle SharedStyle;
 
 struct GtkRegion
 {
@@ -351,6 +352,26 @@ struct StyleData
   guint ref_count;
 };
 
+/* All inputs that determine the result of build_properties(). Contexts
+ * with equal inputs share one GtkCssComputedValues. The cascade is
+ * referenced so its address can't be reused. The parent values are
+ * not referenced, their serial makes sure we never match freed or
+ * modified parent values.
+ */
+struct SharedStyle
+{
+  GtkWidgetPath *path;
+  GtkStateFlags state_flags;
+  gint scale;
+  GtkStyleCascade *cascade;
+  GtkCssComputedValues *parent;
+  guint parent_serial;
+  guint hash;
+
+  GtkCssComputedValues *store; /* weak */
+  guint n_users;               /* style data using the store */
+};
+
 struct _GtkStyleContextPrivate
 {
   GdkScreen *screen;
@@ -391,6 +412,14 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+static GHashTable *shared_styles = NULL;
+static GQuark shared_style_quark = 0;
+static GQuark shared_cascade_quark = 0;
+static guint shared_styles_hits = 0;
+static guint shared_styles_misses = 0;
+static guint restyle_n_updated = 0;
+static guint restyle_n_computed = 0;
+
 static void gtk_style_context_finalize (GObject *object);
 
 static void gtk_style_context_impl_set_property (GObject      *object,
@@ -477,6 +506,254 @@ gtk_style_context_class_init (GtkStyleContextClass *klass)
                                                         GTK_PARAM_READWRITE));
 }
 
+static guint
+shared_style_hash (gconstpointer elem)
+{
+  const SharedStyle *shared = elem;
+
+  return shared->hash;
+}
+
+static gboolean
+shared_style_equal (gconstpointer elem1,
+                    gconstpointer elem2)
+{
+  const SharedStyle *shared1 = elem1;
+  const SharedStyle *shared2 = elem2;
+
+  return shared1->hash == shared2->hash &&
+         shared1->state_flags == shared2->state_flags &&
+         shared1->scale == shared2->scale &&
+         shared1->cascade == shared2->cascade &&
+         shared1->parent == shared2->parent &&
+         shared1->parent_serial == shared2->parent_serial &&
+         _gtk_widget_path_equal (shared1->path, shared2->path);
+}
+
+static void
+shared_style_store_finalized (gpointer  data,
+                              GObject  *where_the_object_was)
+{
+  SharedStyle *shared = data;
+
+  shared->store = NULL;
+  g_hash_table_remove (shared_styles, shared);
+}
+
+static gboolean
+shared_style_uses_cascade (gpointer key,
+                           gpointer value,
+                           gpointer cascade)
+{
+  SharedStyle *shared = key;
+
+  return shared->cascade == cascade;
+}
+
+static void
+shared_styles_cascade_changed (GtkStyleCascade *cascade,
+                               gpointer         data)
+{
+  /* Values shared through @cascade might have been computed from
+   * the old style information, so drop them. This runs once per
+   * change, not once per style context using the cascade. */
+  g_hash_table_foreach_remove (shared_styles, shared_style_uses_cascade, cascade);
+}
+
+/* Cascades are watched for changes as long as shared styles use them.
+ * The number of those is kept in the cascade's qdata. */
+typedef struct {
+  gulong changed_id;
+  guint n_styles;
+} SharedCascade;
+
+static void
+shared_cascade_ref (GtkStyleCascade *cascade)
+{
+  SharedCascade *shared_cascade;
+
+  shared_cascade = g_object_get_qdata (G_OBJECT (cascade), shared_cascade_quark);
+  if (shared_cascade == NULL)
+    {
+      shared_cascade = g_slice_new0 (SharedCascade);
+      shared_cascade->changed_id = g_signal_connect (cascade,
+                                                     "-gtk-private-changed",
+                                                     G_CALLBACK (shared_styles_cascade_changed),
+                                                     NULL);
+      g_object_set_qdata (G_OBJECT (cascade), shared_cascade_quark, shared_cascade);
+    }
+
+  shared_cascade->n_styles++;
+}
+
+static void
+shared_cascade_unref (GtkStyleCascade *cascade)
+{
+  SharedCascade *shared_cascade;
+
+  shared_cascade = g_object_get_qdata (G_OBJECT (cascade), shared_cascade_quark);
+  if (--shared_cascade->n_styles > 0)
+    return;
+
+  g_signal_handler_disconnect (cascade, shared_cascade->changed_id);
+  g_object_set_qdata (G_OBJECT (cascade), shared_cascade_quark, NULL);
+  g_slice_free (SharedCascade, shared_cascade);
+}
+
+static void
+shared_style_free (SharedStyle *shared)
+{
+  if (shared->store)
+    {
+      g_object_weak_unref (G_OBJECT (shared->store), shared_style_store_finalized, shared);
+      g_object_set_qdata (G_OBJECT (shared->store), shared_style_quark, NULL);
+    }
+
+  gtk_widget_path_unref (shared->path);
+  shared_cascade_unref (shared->cascade);
+  g_object_unref (shared->cascade);
+  g_slice_free (SharedStyle, shared);
+}
+
+/* Returns the store of the matching shared style and
+ * counts the caller as a user of it. */
+static GtkCssComputedValues *
+shared_style_lookup (const SharedStyle *key)
+{
+  SharedStyle *shared;
+
+  if (shared_styles == NULL)
+    return NULL;
+
+  shared = g_hash_table_lookup (shared_styles, key);
+  if (shared == NULL)
+    return NULL;
+
+  shared->n_users++;
+
+  return shared->store;
+}
+
+static void
+shared_style_add (const SharedStyle    *key,
+                  GtkCssComputedValues *store)
+{
+  SharedStyle *shared;
+
+  if (shared_styles == NULL)
+    {
+      shared_styles = g_hash_table_new_full (shared_style_hash,
+                                             shared_style_equal,
+                                             (GDestroyNotify) shared_style_free,
+                                             NULL);
+      shared_style_quark = g_quark_from_static_string ("gtk-style-context-shared-style");
+      shared_cascade_quark = g_quark_from_static_string ("gtk-style-context-shared-cascade");
+    }
+
+  shared = g_slice_dup (SharedStyle, key);
+  gtk_widget_path_ref (shared->path);
+  g_object_ref (shared->cascade);
+  shared_cascade_ref (shared->cascade);
+  shared->store = store;
+  shared->n_users = 1;
+
+  g_object_weak_ref (G_OBJECT (store), shared_style_store_finalized, shared);
+  g_object_set_qdata (G_OBJECT (store), shared_style_quark, shared);
+
+  g_hash_table_add (shared_styles, shared);
+}
+
+/* Returns the shared style @store is registered with, if any */
+static SharedStyle *
+shared_style_for_store (GtkCssComputedValues *store)
+{
+  if (shared_style_quark == 0)
+    return NULL;
+
+  return g_object_get_qdata (G_OBJECT (store), shared_style_quark);
+}
+
+/* Stops counting a style data as a user of @store */
+static void
+shared_style_release (GtkCssComputedValues *store)
+{
+  SharedStyle *shared;
+
+  shared = shared_style_for_store (store);
+  if (shared)
+    shared->n_users--;
+}
+
+static void
+shared_styles_clear (void)
+{
+  if (shared_styles)
+    g_hash_table_remove_all (shared_styles);
+}
+
+/*
+ * _gtk_style_context_get_sharing_stats:
+ * @hits: (out) (allow-none): number of computed values that were reused
+ * @misses: (out) (allow-none): number of computed values that had to be built
+ * @n_shared: (out) (allow-none): number of computed values that can be shared
+ * @n_saved: (out) (allow-none): number of computed values that didn't need
+ *     to be allocated because an existing one is used instead
+ *
+ * Queries statistics about computed values shared between style contexts.
+ */
+void
+_gtk_style_context_get_sharing_stats (guint *hits,
+                                      guint *misses,
+                                      guint *n_shared,
+                                      guint *n_saved)
+{
+  if (hits)
+    *hits = shared_styles_hits;
+  if (misses)
+    *misses = shared_styles_misses;
+  if (n_shared)
+    *n_shared = shared_styles ? g_hash_table_size (shared_styles) : 0;
+  if (n_saved)
+    {
+      GHashTableIter iter;
+      gpointer key;
+
+      *n_saved = 0;
+
+      if (shared_styles)
+        {
+          g_hash_table_iter_init (&iter, shared_styles);
+          while (g_hash_table_iter_next (&iter, &key, NULL))
+            {
+              SharedStyle *shared = key;
+
+              if (shared->n_users > 1)
+                *n_saved += shared->n_users - 1;
+            }
+        }
+    }
+}
+
+/*
+ * _gtk_style_context_get_restyle_stats:
+ * @n_updated: (out) (allow-none): number of times computed values were
+ *     built or updated
+ * @n_computed: (out) (allow-none): number of property values that were
+ *     computed while doing so
+ *
+ * Queries how much work restyling did. Values that were taken from
+ * shared or previous computed values are not counted.
+ */
+void
+_gtk_style_context_get_restyle_stats (guint *n_updated,
+                                      guint *n_computed)
+{
+  if (n_updated)
+    *n_updated = restyle_n_updated;
+  if (n_computed)
+    *n_computed = restyle_n_computed;
+}
+
 static StyleData *
 style_data_new (void)
 {
@@ -524,12 +801,39 @@ style_data_unref (StyleData *data)
   if (data->ref_count > 0)
     return;
 
+  shared_style_release (data->store);
   g_object_unref (data->store);
   clear_property_cache (data);
 
   g_slice_free (StyleData, data);
 }
 
+/* Makes sure the store of @data can be modified without
+ * affecting other style contexts sharing it.
+ */
+static void
+style_data_make_writable (StyleData *data)
+{
+  GtkCssComputedValues *copy;
+  SharedStyle *shared;
+
+  shared = shared_style_for_store (data->store);
+  if (shared == NULL)
+    return;
+
+  if (shared->n_users <= 1)
+    {
+      /* No other style data uses it, so just stop sharing */
+      g_hash_table_remove (shared_styles, shared);
+      return;
+    }
+
+  shared->n_users--;
+  copy = _gtk_css_computed_values_copy (data->store);
+  g_object_unref (data->store);
+  data->store = copy;
+}
+
 static gboolean
 style_data_is_animating (StyleData *style_data)
 {
@@ -704,7 +1008,7 @@ gtk_style_context_set_cascade (GtkStyleContext *context,
   priv->cascade = cascade;
 
   if (cascade)
-    gtk_style_context_cascade_changed (cascade, context);
+    _gtk_style_context_queue_invalidate (context, GTK_CSS_CHANGE_SOURCE);
 }
 
 static void
@@ -972,38 +1276,112 @@ create_query_path (GtkStyleContext *context,
 }
 
 static void
-build_properties (GtkStyleContext      *context,
-                  GtkCssComputedValues *values,
-                  GtkStyleInfo         *info,
-                  const GtkBitmask     *relevant_changes)
+build_properties_for_path (GtkStyleContext      *context,
+                           GtkCssComputedValues *values,
+                           const GtkWidgetPath  *path,
+                           GtkStateFlags         state_flags,
+                           const GtkBitmask     *relevant_changes,
+                           GtkCssComputedValues *previous)
 {
   GtkStyleContextPrivate *priv;
   GtkCssMatcher matcher;
-  GtkWidgetPath *path;
   GtkCssLookup *lookup;
 
   priv = context->priv;
 
-  path = create_query_path (context, info);
   lookup = _gtk_css_lookup_new (relevant_changes);
 
-  if (_gtk_css_matcher_init (&matcher, path, info->state_flags))
+  if (_gtk_css_matcher_init (&matcher, path, state_flags))
     _gtk_style_provider_private_lookup (GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
                                         &matcher,
                                         lookup);
 
-  _gtk_css_lookup_resolve (lookup, 
-                           GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
-			   priv->scale,
-                           values,
-                           priv->parent ? style_data_lookup (priv->parent)->store : NULL);
+  restyle_n_updated++;
+  restyle_n_computed += _gtk_css_lookup_resolve (lookup,
+                                                 GTK_STYLE_PROVIDER_PRIVATE (priv->cascade),
+                                                 priv->scale,
+                                                 values,
+                                                 priv->parent ? style_data_lookup (priv->parent)->store : NULL,
+                                                 previous);
 
   _gtk_css_lookup_free (lookup);
+}
+
+static void
+build_properties (GtkStyleContext      *context,
+                  GtkCssComputedValues *values,
+                  GtkStyleInfo         *info,
+                  const GtkBitmask     *relevant_changes)
+{
+  GtkWidgetPath *path;
+
+  path = create_query_path (context, info);
+  build_properties_for_path (context, values, path, info->state_flags, relevant_changes, NULL);
   gtk_widget_path_free (path);
 }
 
+/* Returns new computed values for @info, reusing the values of
+ * another context with identical inputs if possible. Otherwise
+ * values that didn't change are taken from @previous.
+ */
+static GtkCssComputedValues *
+build_shared_properties (GtkStyleContext      *context,
+                         GtkStyleInfo         *info,
+                         GtkCssComputedValues *previous)
+{
+  GtkStyleContextPrivate *priv;
+  GtkCssComputedValues *values;
+  GtkWidgetPath *path;
+  SharedStyle key;
+
+  priv = context->priv;
+
+  path = create_query_path (context, info);
+
+  /* GTK_DEBUG=no-css-cache disables sharing, too */
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_CSS_CACHE))
+    {
+      values = _gtk_css_computed_values_new ();
+      build_properties_for_path (context, values, path, info->state_flags, NULL, NULL);
+      gtk_widget_path_free (path);
+      return values;
+    }
+
+  key.path = path;
+  key.state_flags = info->state_flags;
+  key.scale = priv->scale;
+  key.cascade = priv->cascade;
+  key.parent = priv->parent ? style_data_lookup (priv->parent)->store : NULL;
+  key.parent_serial = key.parent ? _gtk_css_computed_values_get_serial (key.parent) : 0;
+  key.hash = _gtk_widget_path_hash (path) ^ key.state_flags ^ key.parent_serial;
+  key.store = NULL;
+
+  values = shared_style_lookup (&key);
+  if (values)
+    {
+      g_object_ref (values);
+      shared_styles_hits++;
+    }
+  else
+    {
+      values = _gtk_css_computed_values_new ();
+      build_properties_for_path (context, values, path, info->state_flags, NULL, previous);
+      shared_style_add (&key, values);
+      shared_styles_misses++;
+    }
+
+  gtk_widget_path_free (path);
+
+  return values;
+}
+
+/* Like style_data_lookup(), but if new style data needs to be created,
+ * unchanged values are taken from @previous. @previous must have been
+ * computed with the same style provider and scale.
+ */
 static StyleData *
-style_data_lookup (GtkStyleContext *context)
+style_data_lookup_full (GtkStyleContext      *context,
+                        GtkCssComputedValues *previous)
 {
   GtkStyleContextPrivate *priv;
   GtkStyleInfo *info;
@@ -1026,17 +1404,21 @@ style_data_lookup (GtkStyleContext *context)
     }
 
   data = style_data_new ();
-  data->store = _gtk_css_computed_values_new ();
+  data->store = build_shared_properties (context, info, previous);
   style_info_set_data (info, data);
   g_hash_table_insert (priv->style_data,
                        style_info_copy (info),
                        data);
 
-  build_properties (context, data->store, info, NULL);
-
   return data;
 }
 
+static StyleData *
+style_data_lookup (GtkStyleContext *context)
+{
+  return style_data_lookup_full (context, NULL);
+}
+
 static StyleData *
 style_data_lookup_for_state (GtkStyleContext *context,
                              GtkStateFlags    state)
@@ -1237,6 +1619,9 @@ gtk_style_context_reset_widgets (GdkScreen *screen)
 
   _gtk_icon_set_invalidate_caches ();
 
+  /* Shared values might depend on the global parameter that changed */
+  shared_styles_clear ();
+
   toplevels = gtk_window_list_toplevels ();
   g_list_foreach (toplevels, (GFunc) g_object_ref, NULL);
 
@@ -2283,6 +2668,16 @@ _gtk_style_context_peek_property (GtkStyleContext *context,
   return _gtk_css_computed_values_get_value (data->store, property_id);
 }
 
+/* The returned values are only valid until @context changes. They may
+ * be shared with other contexts and must not be modified. */
+GtkCssComputedValues *
+_gtk_style_context_peek_computed_values (GtkStyleContext *context)
+{
+  StyleData *data = style_data_lookup (context);
+
+  return data->store;
+}
+
 const GValue *
 _gtk_style_context_peek_style_property (GtkStyleContext *context,
                                         GType            widget_type,
@@ -3118,7 +3513,10 @@ gtk_style_context_update_cache (GtkStyleContext  *context,
       changes = _gtk_css_computed_values_compute_dependencies (data->store, parent_changes);
 
       if (!_gtk_bitmask_is_empty (changes))
-	build_properties (context, data->store, info, changes);
+        {
+          style_data_make_writable (data);
+	  build_properties (context, data->store, info, changes);
+        }
 
       _gtk_bitmask_free (changes);
     }
@@ -3153,6 +3551,7 @@ gtk_style_context_update_animations (GtkStyleContext *context,
   StyleData *style_data;
   
   style_data = style_data_lookup (context);
+  style_data_make_writable (style_data);
 
   differences = _gtk_css_computed_values_advance (style_data->store,
                                                   timestamp);
@@ -3285,7 +3684,15 @@ _gtk_style_context_validate (GtkStyleContext  *context,
           style_info_set_data (info, NULL);
         }
 
-      data = style_data_lookup (context);
+      /* Matching rules changed, but most values usually don't. Only
+       * recompute the ones whose declarations or dependencies changed. */
+      if (current && !(change & GTK_CSS_CHANGE_SOURCE))
+        data = style_data_lookup_full (context, current->store);
+      else
+        data = style_data_lookup (context);
+
+      if (_gtk_css_computed_values_may_animate (data->store))
+        style_data_make_writable (data);
 
       _gtk_css_computed_values_create_animations (data->store,
                                                   priv->parent ? style_data_lookup (priv->parent)->store : NULL,
@@ -32,6 +32,8 @@ const GtkBitmask *
 
 GtkCssValue   * _gtk_style_context_peek_property             (GtkStyleContext *context,
                                                               guint            property_id);
+GtkCssComputedValues *
+                _gtk_style_context_peek_computed_values      (GtkStyleContext *context);
 const GValue * _gtk_style_context_peek_style_property        (GtkStyleContext *context,
                                                               GType            widget_type,
                                                               GtkStateFlags    state,
@@ -54,6 +56,13 @@ void           _gtk_style_context_get_cursor_color           (GtkStyleContext
 
 void           _gtk_style_context_update_animating           (GtkStyleContext    *context);
 
+void           _gtk_style_context_get_sharing_stats          (guint              *hits,
+                                                              guint              *misses,
+                                                              guint              *n_shared,
+                                                              guint              *n_saved);
+void           _gtk_style_context_get_restyle_stats          (guint              *n_updated,
+                                                              guint              *n_computed);
+
 G_END_DECLS
 
 #endif /* __GTK_STYLE_CONTEXT_PRIVATE_H__ */
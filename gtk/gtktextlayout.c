@@ -97,8 +97,33 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* Recently used line displays, most recent first. The hash table
+   * maps each GtkTextLine to its link in the queue.
+   */
+  GQueue display_cache;
+  GHashTable *display_cache_lines;
+  guint display_cache_size;
+  gsize display_cache_max_bytes;
+  gsize display_cache_bytes;
+  guint display_cache_hits;
+  guint display_cache_misses;
 };
 
+/* Enough to cover all visible lines of a tall view with a small font,
+ * so scrolling and expose only rebuild the lines that came into view.
+ */
+#define DEFAULT_DISPLAY_CACHE_SIZE 128
+
+/* Line displays are also evicted when their estimated memory use
+ * exceeds this, so a few long paragraphs can't fill the memory.
+ * The estimate counts the glyphs, clusters and attributes Pango
+ * keeps per character.
+ */
+#define DEFAULT_DISPLAY_CACHE_MAX_BYTES (4 * 1024 * 1024)
+#define DISPLAY_BYTES_PER_CHAR          40
+#define DISPLAY_BYTES_OVERHEAD          1024
+
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
                                                    GtkTextLine *line,
                                                    /* may be NULL */
@@ -127,6 +152,8 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
 
+static void display_cache_clear (GtkTextLayout *layout);
+
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
 static void gtk_text_layout_mark_set_handler    (GtkTextBuffer     *buffer,
@@ -193,12 +220,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  display_cache_clear (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -213,9 +235,14 @@ static void
 gtk_text_layout_finalize (GObject *object)
 {
   GtkTextLayout *layout;
+  GtkTextLayoutPrivate *priv;
 
   layout = GTK_TEXT_LAYOUT (object);
 
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  if (priv->display_cache_lines)
+    g_hash_table_unref (priv->display_cache_lines);
+
   g_free (layout->preedit_string);
 
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
@@ -276,7 +303,13 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  g_queue_init (&priv->display_cache);
+  priv->display_cache_size = DEFAULT_DISPLAY_CACHE_SIZE;
+  priv->display_cache_max_bytes = DEFAULT_DISPLAY_CACHE_MAX_BYTES;
 }
 
 GtkTextLayout*
@@ -311,6 +344,9 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
 
   free_style_cache (layout);
 
+  /* The cached displays belong to lines of the old buffer */
+  display_cache_clear (layout);
+
   if (layout->buffer)
     {
       _gtk_text_btree_remove_view (_gtk_text_buffer_get_btree (layout->buffer),
@@ -628,6 +664,33 @@ gtk_text_layout_emit_changed (GtkTextLayout *layout,
   g_signal_emit (layout, signals[CHANGED], 0, y, old_height, new_height);
 }
 
+/* Invalidates the cached line displays intersecting the range by
+ * finding the position of each of them */
+static void
+invalidate_cached_lines_in_range (GtkTextLayout *layout,
+                                  gint           y,
+                                  gint           height,
+                                  gboolean       cursors_only)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  for (l = priv->display_cache.head; l != NULL; l = next)
+    {
+      GtkTextLineDisplay *display = l->data;
+      gint cache_y, cache_height;
+
+      next = l->next;
+
+      cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
+                                               display->line, layout);
+      cache_height = display->height;
+
+      if (cache_y + cache_height > y && cache_y < y + height)
+	gtk_text_layout_invalidate_cache (layout, display->line, cursors_only);
+    }
+}
+
 static void
 text_layout_changed (GtkTextLayout *layout,
                      gint           y,
@@ -635,18 +698,41 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLine *line;
+  gint line_top;
+  guint n_lines, max_lines;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so. Changes usually cover
+   * a few lines, so walk those and look them up in the cache.
+   * Finding the position of every cached line instead is only
+   * cheaper when the range has more lines than the cache.
    */
-  if (layout->one_display_cache)
+  max_lines = priv->display_cache.length;
+  if (max_lines > 0)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
-      gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
-						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      line = _gtk_text_btree_find_line_by_y (_gtk_text_buffer_get_btree (layout->buffer),
+                                             layout, y, &line_top);
+
+      for (n_lines = 0;
+           line != NULL && n_lines < max_lines &&
+           (n_lines == 0 || line_top < y + old_height);
+           n_lines++)
+        {
+          GtkTextLineData *line_data;
 
-      if (cache_y + cache_height > y && cache_y < y + old_height)
-	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+          gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+
+          line_data = _gtk_text_line_get_data (line, layout);
+          if (line_data)
+            line_top += line_data->height;
+
+          line = _gtk_text_line_next_excluding_last (line);
+        }
+
+      if (line != NULL && line_top < y + old_height)
+        invalidate_cached_lines_in_range (layout, y, old_height, cursors_only);
     }
 
   gtk_text_layout_emit_changed (layout, y, old_height, new_height);
@@ -813,29 +899,252 @@ gtk_text_layout_invalidate_all (GtkTextLayout *layout)
   gtk_text_layout_invalidate (layout, &start, &end);
 }
 
+static GtkTextLineDisplay *
+display_cache_lookup (GtkTextLayout *layout,
+                      GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  if (priv->display_cache_lines == NULL)
+    return NULL;
+
+  link = g_hash_table_lookup (priv->display_cache_lines, line);
+  if (link == NULL)
+    return NULL;
+
+  return link->data;
+}
+
+/* Estimates the memory used by @display, see DEFAULT_DISPLAY_CACHE_MAX_BYTES */
+static gsize
+display_get_size (GtkTextLineDisplay *display)
+{
+  gsize size = DISPLAY_BYTES_OVERHEAD;
+
+  if (display->layout)
+    size += (gsize) pango_layout_get_character_count (display->layout) * DISPLAY_BYTES_PER_CHAR;
+
+  return size;
+}
+
+static void
+display_cache_remove (GtkTextLayout      *layout,
+                      GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache_lines, display->line);
+  g_assert (link != NULL && link->data == display);
+
+  g_hash_table_remove (priv->display_cache_lines, display->line);
+  g_queue_delete_link (&priv->display_cache, link);
+  priv->display_cache_bytes -= display_get_size (display);
+  layout->one_display_cache = g_queue_peek_head (&priv->display_cache);
+
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+/* Evicts the least recently used displays until at most @n_displays
+ * remain and they use at most @max_bytes */
+static void
+display_cache_trim (GtkTextLayout *layout,
+                    guint          n_displays,
+                    gsize          max_bytes)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_cache.length > n_displays ||
+         (priv->display_cache.length > 0 && priv->display_cache_bytes > max_bytes))
+    display_cache_remove (layout, g_queue_peek_tail (&priv->display_cache));
+}
+
+static void
+display_cache_clear (GtkTextLayout *layout)
+{
+  display_cache_trim (layout, 0, 0);
+}
+
+/* Makes @display the most recently used line display */
+static void
+display_cache_insert (GtkTextLayout      *layout,
+                      GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  if (priv->display_cache_lines == NULL)
+    priv->display_cache_lines = g_hash_table_new (NULL, NULL);
+
+  link = g_hash_table_lookup (priv->display_cache_lines, display->line);
+  if (link != NULL)
+    {
+      g_assert (link->data == display);
+      g_queue_unlink (&priv->display_cache, link);
+      g_queue_push_head_link (&priv->display_cache, link);
+    }
+  else
+    {
+      gsize size = display_get_size (display);
+      gsize max_bytes = priv->display_cache_max_bytes;
+
+      /* Make room first, so we never evict the new display */
+      display_cache_trim (layout,
+                          priv->display_cache_size - 1,
+                          size < max_bytes ? max_bytes - size : 0);
+
+      g_queue_push_head (&priv->display_cache, display);
+      priv->display_cache_bytes += size;
+      g_hash_table_insert (priv->display_cache_lines,
+                           display->line, priv->display_cache.head);
+    }
+
+  layout->one_display_cache = display;
+}
+
 static void
 gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
-    {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+  GtkTextLineDisplay *display;
 
-      if (cursors_only)
-	{
-          if (display->cursors)
-            g_array_free (display->cursors, TRUE);
-	  display->cursors = NULL;
-	  display->cursors_invalid = TRUE;
-	  display->has_block_cursor = FALSE;
-	}
-      else
-	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
-	}
+  display = display_cache_lookup (layout, line);
+  if (display == NULL)
+    return;
+
+  if (cursors_only)
+    {
+      if (display->cursors)
+        g_array_free (display->cursors, TRUE);
+      display->cursors = NULL;
+      display->cursors_invalid = TRUE;
+      display->has_block_cursor = FALSE;
     }
+  else
+    display_cache_remove (layout, display);
+}
+
+/**
+ * gtk_text_layout_set_display_cache_size:
+ * @layout: a #GtkTextLayout
+ * @n_lines: the maximum number of line displays to keep, at least 1
+ *
+ * Sets how many line displays @layout keeps around. Views showing
+ * many lines at once benefit from a cache at least as large as the
+ * number of visible lines.
+ *
+ * Each line display holds a #PangoLayout of its whole paragraph, so
+ * the number of lines alone doesn't bound the memory used. Line
+ * displays are also evicted when they use more than
+ * gtk_text_layout_set_display_cache_max_bytes() in total, so fewer
+ * than @n_lines can be kept when paragraphs are long.
+ */
+void
+gtk_text_layout_set_display_cache_size (GtkTextLayout *layout,
+                                        guint          n_lines)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+  g_return_if_fail (n_lines > 0);
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  priv->display_cache_size = n_lines;
+  display_cache_trim (layout, n_lines, priv->display_cache_max_bytes);
+}
+
+/**
+ * gtk_text_layout_get_display_cache_size:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns the maximum number of line displays kept by @layout.
+ *
+ * Return value: the size of the line display cache
+ */
+guint
+gtk_text_layout_get_display_cache_size (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), 0);
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  return priv->display_cache_size;
+}
+
+/**
+ * gtk_text_layout_set_display_cache_max_bytes:
+ * @layout: a #GtkTextLayout
+ * @max_bytes: the estimated memory the line displays may use
+ *
+ * Sets how much memory the line displays kept by @layout may use,
+ * as estimated from the number of characters they lay out. A line
+ * display which alone uses more than @max_bytes is still kept until
+ * the next one is created. The default is 4 megabytes.
+ */
+void
+gtk_text_layout_set_display_cache_max_bytes (GtkTextLayout *layout,
+                                             gsize          max_bytes)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  priv->display_cache_max_bytes = max_bytes;
+  display_cache_trim (layout, priv->display_cache_size, max_bytes);
+}
+
+/**
+ * gtk_text_layout_get_display_cache_max_bytes:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns the estimated memory the line displays kept by @layout
+ * may use, see gtk_text_layout_set_display_cache_max_bytes().
+ *
+ * Return value: the memory limit of the line display cache
+ */
+gsize
+gtk_text_layout_get_display_cache_max_bytes (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), 0);
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  return priv->display_cache_max_bytes;
+}
+
+/**
+ * gtk_text_layout_get_display_cache_stats:
+ * @layout: a #GtkTextLayout
+ * @hits: (out) (allow-none): return location for the number of cache hits
+ * @misses: (out) (allow-none): return location for the number of cache misses
+ *
+ * Queries how often gtk_text_layout_get_line_display() could reuse a
+ * cached line display and how often it had to create a new one.
+ */
+void
+gtk_text_layout_get_display_cache_stats (GtkTextLayout *layout,
+                                         guint         *hits,
+                                         guint         *misses)
+{
+  GtkTextLayoutPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (hits)
+    *hits = priv->display_cache_hits;
+  if (misses)
+    *misses = priv->display_cache_misses;
 }
 
 /* Now invalidate the paragraph containing the cursor
@@ -926,31 +1235,34 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l;
+
+  if (gtk_text_iter_compare (start, end) > 0)
+    {
+      const GtkTextIter *tmp = start;
+      start = end;
+      end = tmp;
+    }
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_cache.head; l != NULL; l = l->next)
     {
       GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLineDisplay *display = l->data;
 
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+      gtk_text_layout_get_iter_at_line (layout, &line_start, display->line, 0);
 
       line_end = line_start;
       if (!gtk_text_iter_ends_line (&line_end))
 	gtk_text_iter_forward_to_line_end (&line_end);
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
-
       if (gtk_text_iter_compare (&line_start, end) <= 0 &&
 	  gtk_text_iter_compare (start, &line_end) <= 0)
 	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
+	  gtk_text_layout_invalidate_cache (layout, display->line, TRUE);
 	}
     }
 
@@ -2141,24 +2453,24 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  display = display_cache_lookup (layout, line);
+  if (display)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      if (size_only || !display->size_only)
 	{
+          priv->display_cache_hits++;
+          display_cache_insert (layout, display);
 	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
+            update_text_display_cursors (layout, line, display);
+	  return display;
 	}
       else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
+        display_cache_remove (layout, display);
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  priv->display_cache_misses++;
+
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2477,7 +2789,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  display_cache_insert (layout, display);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2489,7 +2801,7 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
+  if (display_cache_lookup (layout, display->line) != display)
     {
       if (display->layout)
         g_object_unref (display->layout);
@@ -144,8 +144,9 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
+  /* The most recently used line display. Getting the same line
+   * many times in a row is the most common case. More line
+   * displays are cached, see gtk_text_layout_set_display_cache_size().
    */
   GtkTextLineDisplay *one_display_cache;
 
@@ -335,6 +336,20 @@ GtkTextLineDisplay* gtk_text_layout_get_line_display  (GtkTextLayout      *layou
 GDK_AVAILABLE_IN_ALL
 void                gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                                        GtkTextLineDisplay *display);
+GDK_AVAILABLE_IN_3_10
+void                gtk_text_layout_set_display_cache_size  (GtkTextLayout *layout,
+                                                             guint          n_lines);
+GDK_AVAILABLE_IN_3_10
+guint               gtk_text_layout_get_display_cache_size  (GtkTextLayout *layout);
+GDK_AVAILABLE_IN_3_10
+void                gtk_text_layout_set_display_cache_max_bytes (GtkTextLayout *layout,
+                                                                 gsize          max_bytes);
+GDK_AVAILABLE_IN_3_10
+gsize               gtk_text_layout_get_display_cache_max_bytes (GtkTextLayout *layout);
+GDK_AVAILABLE_IN_3_10
+void                gtk_text_layout_get_display_cache_stats (GtkTextLayout *layout,
+                                                             guint         *hits,
+                                                             guint         *misses);
 
 GDK_AVAILABLE_IN_ALL
 void gtk_text_layout_get_line_at_y     (GtkTextLayout     *layout,
@@ -25,12 +25,15 @@
 
 #include "gtkcssarrayvalueprivate.h"
 #include "gtkcssbgsizevalueprivate.h"
+#include "gtkcsscomputedvaluesprivate.h"
 #include "gtkcssenumvalueprivate.h"
 #include "gtkcssimagevalueprivate.h"
 #include "gtkcssshadowsvalueprivate.h"
 #include "gtkcsspositionvalueprivate.h"
 #include "gtkcssrepeatvalueprivate.h"
 #include "gtkcsstypesprivate.h"
+#include "gtkdebug.h"
+#include "gtkrendercacheprivate.h"
 #include "gtkthemingengineprivate.h"
 
 #include <math.h>
@@ -348,18 +351,15 @@ _gtk_theming_background_init_from_context (GtkThemingBackground *bg,
   _gtk_theming_background_init_context (bg);
 }
 
-void
-_gtk_theming_background_render (GtkThemingBackground *bg,
-                                cairo_t              *cr)
+static void
+gtk_theming_background_paint (GtkThemingBackground *bg,
+                              cairo_t              *cr)
 {
   gint idx;
   GtkCssValue *background_image;
 
   background_image = _gtk_style_context_peek_property (bg->context, GTK_CSS_PROPERTY_BACKGROUND_IMAGE);
 
-  cairo_save (cr);
-  cairo_translate (cr, bg->paint_area.x, bg->paint_area.y);
-
   _gtk_theming_background_apply_shadow (bg, cr, FALSE); /* Outset shadow */
 
   _gtk_theming_background_paint_color (bg, cr, background_image);
@@ -370,6 +370,213 @@ _gtk_theming_background_render (GtkThemingBackground *bg,
     }
 
   _gtk_theming_background_apply_shadow (bg, cr, TRUE);  /* Inset shadow */
+}
+
+/* RENDER CACHE */
+
+/* Backgrounds of widgets that didn't change are rendered again on every
+ * redraw, and gradients, images and shadows are expensive. So we keep the
+ * rendered backgrounds of each screen in a render cache, keyed by
+ * everything rendering depends on: The computed values (which include the
+ * state), the size, the junction and the device scale.
+ * Entries are dropped when their computed values change or go away and
+ * when the cache exceeds its size.
+ */
+#define GTK_THEMING_BACKGROUND_CACHE_SIZE (8 * 1024 * 1024)
+
+static GQuark background_cache_quark = 0;
+
+static GtkRenderCache *
+gtk_theming_background_cache_get (GdkScreen *screen)
+{
+  GtkRenderCache *cache;
+
+  if (G_UNLIKELY (background_cache_quark == 0))
+    background_cache_quark = g_quark_from_static_string ("gtk-theming-background-cache");
+
+  cache = g_object_get_qdata (G_OBJECT (screen), background_cache_quark);
+  if (cache == NULL)
+    {
+      cache = _gtk_render_cache_new (GTK_THEMING_BACKGROUND_CACHE_SIZE);
+      g_object_set_qdata_full (G_OBJECT (screen), background_cache_quark,
+                               cache, (GDestroyNotify) _gtk_render_cache_free);
+    }
+
+  return cache;
+}
+
+/* Renders the background into a new image surface. Returns %NULL if
+ * it would be too large for @cache. */
+static cairo_surface_t *
+gtk_theming_background_render_surface (GtkThemingBackground *bg,
+                                       GtkRenderCache       *cache,
+                                       cairo_surface_t      *target,
+                                       double                scale,
+                                       int                  *x_offset,
+                                       int                  *y_offset)
+{
+  GtkBorder extents = { 0, };
+  cairo_surface_t *surface;
+  int width, height, pixel_width, pixel_height;
+  cairo_t *cr;
+
+  /* Outset shadows are drawn outside the paint area. Blurring may
+   * reach a few pixels further, see CLIP_RADIUS_EXTRA in
+   * gtkcssshadowvalue.c */
+  _gtk_css_shadows_value_get_extents (_gtk_style_context_peek_property (bg->context, GTK_CSS_PROPERTY_BOX_SHADOW),
+                                      &extents);
+  if (extents.left || extents.right || extents.top || extents.bottom)
+    {
+      extents.left += 5;
+      extents.right += 5;
+      extents.top += 5;
+      extents.bottom += 5;
+    }
+
+  width = ceil (bg->paint_area.width) + extents.left + extents.right;
+  height = ceil (bg->paint_area.height) + extents.top + extents.bottom;
+  pixel_width = ceil (width * scale);
+  pixel_height = ceil (height * scale);
+
+  if ((gsize) cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, pixel_width) * pixel_height >
+      _gtk_render_cache_get_max_entry_size (cache))
+    return NULL;
+
+  /* An image surface, so the cache knows the memory it uses, and it can
+   * be painted to any target. Image surfaces similar to the target are
+   * cheaper to upload. */
+  surface = cairo_surface_create_similar_image (target, CAIRO_FORMAT_ARGB32,
+                                                pixel_width, pixel_height);
+  if (cairo_surface_status (surface) != CAIRO_STATUS_SUCCESS ||
+      cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE)
+    {
+      cairo_surface_destroy (surface);
+      return NULL;
+    }
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  cairo_surface_set_device_scale (surface, scale, scale);
+#endif
+
+  *x_offset = extents.left;
+  *y_offset = extents.top;
+
+  cr = cairo_create (surface);
+  cairo_translate (cr, *x_offset, *y_offset);
+  gtk_theming_background_paint (bg, cr);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+static gboolean
+gtk_theming_background_target_is_raster (cairo_surface_t *target)
+{
+  switch ((guint) cairo_surface_get_type (target))
+    {
+    case CAIRO_SURFACE_TYPE_PDF:
+    case CAIRO_SURFACE_TYPE_PS:
+    case CAIRO_SURFACE_TYPE_SVG:
+    case CAIRO_SURFACE_TYPE_RECORDING:
+    case CAIRO_SURFACE_TYPE_SCRIPT:
+      return FALSE;
+    default:
+      return TRUE;
+    }
+}
+
+/* Renders the background from the cache, creating a cache entry
+ * if necessary. Returns %FALSE if the background can't be cached,
+ * it needs to be painted then.
+ */
+static gboolean
+gtk_theming_background_render_cached (GtkThemingBackground *bg,
+                                      cairo_t              *cr)
+{
+  GtkRenderCacheKey key;
+  GtkRenderCache *cache;
+  GtkCssComputedValues *values;
+  cairo_surface_t *target, *surface;
+  cairo_matrix_t matrix;
+  GdkScreen *screen;
+  double x, y, sx, sy;
+  int x_offset, y_offset;
+
+  if (G_UNLIKELY (gtk_get_debug_flags () & GTK_DEBUG_NO_PIXEL_CACHE))
+    return FALSE;
+
+  /* Blitting the cached surface must produce the same pixels as
+   * painting, so only allow unscaled, pixel aligned drawing. */
+  if (cairo_get_operator (cr) != CAIRO_OPERATOR_OVER)
+    return FALSE;
+
+  cairo_get_matrix (cr, &matrix);
+  if (matrix.xx != 1.0 || matrix.yy != 1.0 ||
+      matrix.xy != 0.0 || matrix.yx != 0.0)
+    return FALSE;
+
+  x = y = 0;
+  cairo_user_to_device (cr, &x, &y);
+  if (x != floor (x) || y != floor (y))
+    return FALSE;
+
+  target = cairo_get_target (cr);
+  if (!gtk_theming_background_target_is_raster (target))
+    return FALSE;
+
+  sx = sy = 1;
+#ifdef HAVE_CAIRO_SURFACE_SET_DEVICE_SCALE
+  cairo_surface_get_device_scale (target, &sx, &sy);
+#endif
+  if (sx != sy)
+    return FALSE;
+
+  screen = gtk_style_context_get_screen (bg->context);
+  if (screen == NULL)
+    return FALSE;
+
+  /* Animated values change on every frame */
+  values = _gtk_style_context_peek_computed_values (bg->context);
+  if (!_gtk_css_computed_values_is_static (values))
+    return FALSE;
+
+  cache = gtk_theming_background_cache_get (screen);
+
+  key.owner = G_OBJECT (values);
+  key.serial = _gtk_css_computed_values_get_serial (values);
+  key.width = bg->paint_area.width;
+  key.height = bg->paint_area.height;
+  key.flags = bg->junction;
+  key.scale = sx;
+
+  surface = _gtk_render_cache_lookup (cache, &key, &x_offset, &y_offset);
+  if (surface)
+    cairo_surface_reference (surface);
+  else
+    {
+      surface = gtk_theming_background_render_surface (bg, cache, target, sx,
+                                                       &x_offset, &y_offset);
+      if (surface == NULL)
+        return FALSE;
+
+      _gtk_render_cache_add (cache, &key, surface, x_offset, y_offset);
+    }
+
+  cairo_set_source_surface (cr, surface, - x_offset, - y_offset);
+  cairo_paint (cr);
+  cairo_surface_destroy (surface);
+
+  return TRUE;
+}
+
+void
+_gtk_theming_background_render (GtkThemingBackground *bg,
+                                cairo_t              *cr)
+{
+  cairo_save (cr);
+  cairo_translate (cr, bg->paint_area.x, bg->paint_area.y);
+
+  if (!gtk_theming_background_render_cached (bg, cr))
+    gtk_theming_background_paint (bg, cr);
 
   cairo_restore (cr);
 }
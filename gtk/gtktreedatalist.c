@@ -46,15 +46,7 @@ _gtk_tree_data_list_free (GtkTreeDataList *list,
   while (tmp)
     {
       next = tmp->next;
-      if (g_type_is_a (column_headers [i], G_TYPE_STRING))
-	g_free ((gchar *) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_OBJECT) && tmp->data.v_pointer != NULL)
-	g_object_unref (tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_BOXED) && tmp->data.v_pointer != NULL)
-	g_boxed_free (column_headers [i], (gpointer) tmp->data.v_pointer);
-      else if (g_type_is_a (column_headers [i], G_TYPE_VARIANT) && tmp->data.v_pointer != NULL)
-	g_variant_unref ((gpointer) tmp->data.v_pointer);
-
+      _gtk_tree_data_value_clear (&tmp->data, column_headers [i]);
       g_slice_free (GtkTreeDataList, tmp);
       i++;
       tmp = next;
@@ -116,68 +108,86 @@ get_fundamental_type (GType type)
 
   return result;
 }
+/* single cells
+ */
 void
-_gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
-				   GType            type,
-				   GValue          *value)
+_gtk_tree_data_value_clear (GtkTreeDataValue *data,
+                            GType             type)
+{
+  if (g_type_is_a (type, G_TYPE_STRING))
+    g_free ((gchar *) data->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_OBJECT) && data->v_pointer != NULL)
+    g_object_unref (data->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_BOXED) && data->v_pointer != NULL)
+    g_boxed_free (type, (gpointer) data->v_pointer);
+  else if (g_type_is_a (type, G_TYPE_VARIANT) && data->v_pointer != NULL)
+    g_variant_unref ((gpointer) data->v_pointer);
+
+  memset (data, 0, sizeof (GtkTreeDataValue));
+}
+
+void
+_gtk_tree_data_value_get (const GtkTreeDataValue *data,
+                          GType                   type,
+                          GValue                 *value)
 {
   g_value_init (value, type);
 
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
-      g_value_set_boolean (value, (gboolean) list->data.v_int);
+      g_value_set_boolean (value, (gboolean) data->v_int);
       break;
     case G_TYPE_CHAR:
-      g_value_set_schar (value, (gchar) list->data.v_char);
+      g_value_set_schar (value, (gchar) data->v_char);
       break;
     case G_TYPE_UCHAR:
-      g_value_set_uchar (value, (guchar) list->data.v_uchar);
+      g_value_set_uchar (value, (guchar) data->v_uchar);
       break;
     case G_TYPE_INT:
-      g_value_set_int (value, (gint) list->data.v_int);
+      g_value_set_int (value, (gint) data->v_int);
       break;
     case G_TYPE_UINT:
-      g_value_set_uint (value, (guint) list->data.v_uint);
+      g_value_set_uint (value, (guint) data->v_uint);
       break;
     case G_TYPE_LONG:
-      g_value_set_long (value, list->data.v_long);
+      g_value_set_long (value, data->v_long);
       break;
     case G_TYPE_ULONG:
-      g_value_set_ulong (value, list->data.v_ulong);
+      g_value_set_ulong (value, data->v_ulong);
       break;
     case G_TYPE_INT64:
-      g_value_set_int64 (value, list->data.v_int64);
+      g_value_set_int64 (value, data->v_int64);
       break;
     case G_TYPE_UINT64:
-      g_value_set_uint64 (value, list->data.v_uint64);
+      g_value_set_uint64 (value, data->v_uint64);
       break;
     case G_TYPE_ENUM:
-      g_value_set_enum (value, list->data.v_int);
+      g_value_set_enum (value, data->v_int);
       break;
     case G_TYPE_FLAGS:
-      g_value_set_flags (value, list->data.v_uint);
+      g_value_set_flags (value, data->v_uint);
       break;
     case G_TYPE_FLOAT:
-      g_value_set_float (value, (gfloat) list->data.v_float);
+      g_value_set_float (value, (gfloat) data->v_float);
       break;
     case G_TYPE_DOUBLE:
-      g_value_set_double (value, (gdouble) list->data.v_double);
+      g_value_set_double (value, (gdouble) data->v_double);
       break;
     case G_TYPE_STRING:
-      g_value_set_string (value, (gchar *) list->data.v_pointer);
+      g_value_set_string (value, (gchar *) data->v_pointer);
       break;
     case G_TYPE_POINTER:
-      g_value_set_pointer (value, (gpointer) list->data.v_pointer);
+      g_value_set_pointer (value, (gpointer) data->v_pointer);
       break;
     case G_TYPE_BOXED:
-      g_value_set_boxed (value, (gpointer) list->data.v_pointer);
+      g_value_set_boxed (value, (gpointer) data->v_pointer);
       break;
     case G_TYPE_VARIANT:
-      g_value_set_variant (value, (gpointer) list->data.v_pointer);
+      g_value_set_variant (value, (gpointer) data->v_pointer);
       break;
     case G_TYPE_OBJECT:
-      g_value_set_object (value, (GObject *) list->data.v_pointer);
+      g_value_set_object (value, (GObject *) data->v_pointer);
       break;
     default:
       g_warning ("%s: Unsupported type (%s) retrieved.", G_STRLOC, g_type_name (value->g_type));
@@ -186,71 +196,71 @@ _gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
 }
 
 void
-_gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
-				   GValue          *value)
+_gtk_tree_data_value_set (GtkTreeDataValue *data,
+                          GValue           *value)
 {
   switch (get_fundamental_type (G_VALUE_TYPE (value)))
     {
     case G_TYPE_BOOLEAN:
-      list->data.v_int = g_value_get_boolean (value);
+      data->v_int = g_value_get_boolean (value);
       break;
     case G_TYPE_CHAR:
-      list->data.v_char = g_value_get_schar (value);
+      data->v_char = g_value_get_schar (value);
       break;
     case G_TYPE_UCHAR:
-      list->data.v_uchar = g_value_get_uchar (value);
+      data->v_uchar = g_value_get_uchar (value);
       break;
     case G_TYPE_INT:
-      list->data.v_int = g_value_get_int (value);
+      data->v_int = g_value_get_int (value);
       break;
     case G_TYPE_UINT:
-      list->data.v_uint = g_value_get_uint (value);
+      data->v_uint = g_value_get_uint (value);
       break;
     case G_TYPE_LONG:
-      list->data.v_long = g_value_get_long (value);
+      data->v_long = g_value_get_long (value);
       break;
     case G_TYPE_ULONG:
-      list->data.v_ulong = g_value_get_ulong (value);
+      data->v_ulong = g_value_get_ulong (value);
       break;
     case G_TYPE_INT64:
-      list->data.v_int64 = g_value_get_int64 (value);
+      data->v_int64 = g_value_get_int64 (value);
       break;
     case G_TYPE_UINT64:
-      list->data.v_uint64 = g_value_get_uint64 (value);
+      data->v_uint64 = g_value_get_uint64 (value);
       break;
     case G_TYPE_ENUM:
-      list->data.v_int = g_value_get_enum (value);
+      data->v_int = g_value_get_enum (value);
       break;
     case G_TYPE_FLAGS:
-      list->data.v_uint = g_value_get_flags (value);
+      data->v_uint = g_value_get_flags (value);
       break;
     case G_TYPE_POINTER:
-      list->data.v_pointer = g_value_get_pointer (value);
+      data->v_pointer = g_value_get_pointer (value);
       break;
     case G_TYPE_FLOAT:
-      list->data.v_float = g_value_get_float (value);
+      data->v_float = g_value_get_float (value);
       break;
     case G_TYPE_DOUBLE:
-      list->data.v_double = g_value_get_double (value);
+      data->v_double = g_value_get_double (value);
       break;
     case G_TYPE_STRING:
-      g_free (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_string (value);
+      g_free (data->v_pointer);
+      data->v_pointer = g_value_dup_string (value);
       break;
     case G_TYPE_OBJECT:
-      if (list->data.v_pointer)
-	g_object_unref (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_object (value);
+      if (data->v_pointer)
+	g_object_unref (data->v_pointer);
+      data->v_pointer = g_value_dup_object (value);
       break;
     case G_TYPE_BOXED:
-      if (list->data.v_pointer)
-	g_boxed_free (G_VALUE_TYPE (value), list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_boxed (value);
+      if (data->v_pointer)
+	g_boxed_free (G_VALUE_TYPE (value), data->v_pointer);
+      data->v_pointer = g_value_dup_boxed (value);
       break;
     case G_TYPE_VARIANT:
-      if (list->data.v_pointer)
-	g_variant_unref (list->data.v_pointer);
-      list->data.v_pointer = g_value_dup_variant (value);
+      if (data->v_pointer)
+	g_variant_unref (data->v_pointer);
+      data->v_pointer = g_value_dup_variant (value);
       break;
     default:
       g_warning ("%s: Unsupported type (%s) stored.", G_STRLOC, g_type_name (G_VALUE_TYPE (value)));
@@ -258,17 +268,11 @@ _gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
     }
 }
 
-GtkTreeDataList *
-_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
-                               GType            type)
+void
+_gtk_tree_data_value_copy (const GtkTreeDataValue *src,
+                           GtkTreeDataValue       *dest,
+                           GType                   type)
 {
-  GtkTreeDataList *new_list;
-
-  g_return_val_if_fail (list != NULL, NULL);
-  
-  new_list = _gtk_tree_data_list_alloc ();
-  new_list->next = NULL;
-
   switch (get_fundamental_type (type))
     {
     case G_TYPE_BOOLEAN:
@@ -285,33 +289,62 @@ _gtk_tree_data_list_node_copy (GtkTreeDataList *list,
     case G_TYPE_POINTER:
     case G_TYPE_FLOAT:
     case G_TYPE_DOUBLE:
-      new_list->data = list->data;
+      *dest = *src;
       break;
     case G_TYPE_STRING:
-      new_list->data.v_pointer = g_strdup (list->data.v_pointer);
+      dest->v_pointer = g_strdup (src->v_pointer);
       break;
     case G_TYPE_OBJECT:
     case G_TYPE_INTERFACE:
-      new_list->data.v_pointer = list->data.v_pointer;
-      if (new_list->data.v_pointer)
-	g_object_ref (new_list->data.v_pointer);
+      dest->v_pointer = src->v_pointer;
+      if (dest->v_pointer)
+	g_object_ref (dest->v_pointer);
       break;
     case G_TYPE_BOXED:
-      if (list->data.v_pointer)
-	new_list->data.v_pointer = g_boxed_copy (type, list->data.v_pointer);
+      if (src->v_pointer)
+	dest->v_pointer = g_boxed_copy (type, src->v_pointer);
       else
-	new_list->data.v_pointer = NULL;
+	dest->v_pointer = NULL;
       break;
     case G_TYPE_VARIANT:
-      if (list->data.v_pointer)
-	new_list->data.v_pointer = g_variant_ref (list->data.v_pointer);
+      if (src->v_pointer)
+	dest->v_pointer = g_variant_ref (src->v_pointer);
       else
-	new_list->data.v_pointer = NULL;
+	dest->v_pointer = NULL;
       break;
     default:
       g_warning ("Unsupported node type (%s) copied.", g_type_name (type));
       break;
     }
+}
+
+void
+_gtk_tree_data_list_node_to_value (GtkTreeDataList *list,
+				   GType            type,
+				   GValue          *value)
+{
+  _gtk_tree_data_value_get (&list->data, type, value);
+}
+
+void
+_gtk_tree_data_list_value_to_node (GtkTreeDataList *list,
+				   GValue          *value)
+{
+  _gtk_tree_data_value_set (&list->data, value);
+}
+
+GtkTreeDataList *
+_gtk_tree_data_list_node_copy (GtkTreeDataList *list,
+                               GType            type)
+{
+  GtkTreeDataList *new_list;
+
+  g_return_val_if_fail (list != NULL, NULL);
+  
+  new_list = _gtk_tree_data_list_alloc ();
+  new_list->next = NULL;
+
+  _gtk_tree_data_value_copy (&list->data, &new_list->data, type);
 
   return new_list;
 }
@@ -464,6 +497,127 @@ _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 }
 
 
+/* The key types mirror the comparisons done by
+ * _gtk_tree_data_list_compare_func(), so sorting by keys
+ * gives the same order as sorting with it.
+ */
+GtkTreeDataSortKeyType
+_gtk_tree_data_sort_key_type (GType type)
+{
+  switch (get_fundamental_type (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+      return GTK_TREE_DATA_SORT_KEY_INT;
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLAGS:
+      return GTK_TREE_DATA_SORT_KEY_UINT;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      return GTK_TREE_DATA_SORT_KEY_DOUBLE;
+    case G_TYPE_STRING:
+      return GTK_TREE_DATA_SORT_KEY_STRING;
+    default:
+      return GTK_TREE_DATA_SORT_KEY_NONE;
+    }
+}
+
+void
+_gtk_tree_data_sort_key_init (GtkTreeDataSortKey *key,
+                              const GValue       *value)
+{
+  const gchar *str;
+
+  switch (get_fundamental_type (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_BOOLEAN:
+      key->v_int = g_value_get_boolean (value);
+      break;
+    case G_TYPE_CHAR:
+      key->v_int = g_value_get_schar (value);
+      break;
+    case G_TYPE_INT:
+      key->v_int = g_value_get_int (value);
+      break;
+    case G_TYPE_LONG:
+      key->v_int = g_value_get_long (value);
+      break;
+    case G_TYPE_INT64:
+      key->v_int = g_value_get_int64 (value);
+      break;
+    case G_TYPE_ENUM:
+      key->v_int = g_value_get_enum (value);
+      break;
+    case G_TYPE_UCHAR:
+      key->v_uint = g_value_get_uchar (value);
+      break;
+    case G_TYPE_UINT:
+      key->v_uint = g_value_get_uint (value);
+      break;
+    case G_TYPE_ULONG:
+      key->v_uint = g_value_get_ulong (value);
+      break;
+    case G_TYPE_UINT64:
+      key->v_uint = g_value_get_uint64 (value);
+      break;
+    case G_TYPE_FLAGS:
+      key->v_uint = g_value_get_flags (value);
+      break;
+    case G_TYPE_FLOAT:
+      key->v_double = g_value_get_float (value);
+      break;
+    case G_TYPE_DOUBLE:
+      key->v_double = g_value_get_double (value);
+      break;
+    case G_TYPE_STRING:
+      str = g_value_get_string (value);
+      key->v_string = g_utf8_collate_key (str ? str : "", -1);
+      break;
+    default:
+      g_warning ("%s: Unsupported type (%s) sorted.", G_STRLOC, g_type_name (G_VALUE_TYPE (value)));
+      memset (key, 0, sizeof (GtkTreeDataSortKey));
+      break;
+    }
+}
+
+void
+_gtk_tree_data_sort_key_clear (GtkTreeDataSortKey     *key,
+                               GtkTreeDataSortKeyType  key_type)
+{
+  if (key_type == GTK_TREE_DATA_SORT_KEY_STRING)
+    g_free (key->v_string);
+}
+
+/* Only uses the keys, so it is safe to call from any thread */
+gint
+_gtk_tree_data_sort_key_compare (const GtkTreeDataSortKey *a,
+                                 const GtkTreeDataSortKey *b,
+                                 GtkTreeDataSortKeyType    key_type)
+{
+  switch (key_type)
+    {
+    case GTK_TREE_DATA_SORT_KEY_INT:
+      return a->v_int < b->v_int ? -1 : (a->v_int == b->v_int ? 0 : 1);
+    case GTK_TREE_DATA_SORT_KEY_UINT:
+      return a->v_uint < b->v_uint ? -1 : (a->v_uint == b->v_uint ? 0 : 1);
+    case GTK_TREE_DATA_SORT_KEY_DOUBLE:
+      return a->v_double < b->v_double ? -1 : (a->v_double == b->v_double ? 0 : 1);
+    case GTK_TREE_DATA_SORT_KEY_STRING:
+      return strcmp (a->v_string, b->v_string);
+    case GTK_TREE_DATA_SORT_KEY_NONE:
+    default:
+      g_assert_not_reached ();
+      return 0;
+    }
+}
+
 GList *
 _gtk_tree_data_list_header_new (gint   n_columns,
 				GType *types)
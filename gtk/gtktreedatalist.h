@@ -21,24 +21,28 @@
 #include <gtk/gtktreemodel.h>
 #include <gtk/gtktreesortable.h>
 
+typedef union _GtkTreeDataValue GtkTreeDataValue;
+union _GtkTreeDataValue
+{
+  gint	   v_int;
+  gint8          v_char;
+  guint8         v_uchar;
+  guint	   v_uint;
+  glong	   v_long;
+  gulong	   v_ulong;
+  gint64	   v_int64;
+  guint64        v_uint64;
+  gfloat	   v_float;
+  gdouble        v_double;
+  gpointer	   v_pointer;
+};
+
 typedef struct _GtkTreeDataList GtkTreeDataList;
 struct _GtkTreeDataList
 {
   GtkTreeDataList *next;
 
-  union {
-    gint	   v_int;
-    gint8          v_char;
-    guint8         v_uchar;
-    guint	   v_uint;
-    glong	   v_long;
-    gulong	   v_ulong;
-    gint64	   v_int64;
-    guint64        v_uint64;
-    gfloat	   v_float;
-    gdouble        v_double;
-    gpointer	   v_pointer;
-  } data;
+  GtkTreeDataValue data;
 };
 
 typedef struct _GtkTreeDataSortHeader
@@ -62,11 +66,53 @@ void             _gtk_tree_data_list_value_to_node  (GtkTreeDataList *list,
 GtkTreeDataList *_gtk_tree_data_list_node_copy      (GtkTreeDataList *list,
                                                      GType            type);
 
+/* Single cell code */
+void             _gtk_tree_data_value_clear         (GtkTreeDataValue *data,
+                                                     GType             type);
+void             _gtk_tree_data_value_get           (const GtkTreeDataValue *data,
+                                                     GType             type,
+                                                     GValue           *value);
+void             _gtk_tree_data_value_set           (GtkTreeDataValue *data,
+                                                     GValue           *value);
+void             _gtk_tree_data_value_copy          (const GtkTreeDataValue *src,
+                                                     GtkTreeDataValue *dest,
+                                                     GType             type);
+
 /* Header code */
 gint                   _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 							 GtkTreeIter  *a,
 							 GtkTreeIter  *b,
 							 gpointer      user_data);
+
+/* Sort keys, precomputed values that sort like
+ * _gtk_tree_data_list_compare_func() does
+ */
+typedef enum
+{
+  GTK_TREE_DATA_SORT_KEY_NONE,
+  GTK_TREE_DATA_SORT_KEY_INT,
+  GTK_TREE_DATA_SORT_KEY_UINT,
+  GTK_TREE_DATA_SORT_KEY_DOUBLE,
+  GTK_TREE_DATA_SORT_KEY_STRING
+} GtkTreeDataSortKeyType;
+
+typedef union _GtkTreeDataSortKey GtkTreeDataSortKey;
+union _GtkTreeDataSortKey
+{
+  gint64   v_int;
+  guint64  v_uint;
+  gdouble  v_double;
+  gchar   *v_string;
+};
+
+GtkTreeDataSortKeyType _gtk_tree_data_sort_key_type    (GType                   type);
+void                   _gtk_tree_data_sort_key_init    (GtkTreeDataSortKey     *key,
+                                                        const GValue           *value);
+void                   _gtk_tree_data_sort_key_clear   (GtkTreeDataSortKey     *key,
+                                                        GtkTreeDataSortKeyType  key_type);
+gint                   _gtk_tree_data_sort_key_compare (const GtkTreeDataSortKey *a,
+                                                        const GtkTreeDataSortKey *b,
+                                                        GtkTreeDataSortKeyType    key_type);
 GList *                _gtk_tree_data_list_header_new  (gint          n_columns,
 							GType        *types);
 void                   _gtk_tree_data_list_header_free (GList        *header_list);
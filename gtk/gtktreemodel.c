@@ -1780,6 +1780,27 @@ gtk_tree_model_get_valist (GtkTreeModel *tree_model,
     }
 }
 
+/* Whether anything observes the row signals of @tree_model,
+ * either through signal handlers or through row references.
+ * Models may skip emitting row signals while this is %FALSE.
+ */
+gboolean
+_gtk_tree_model_is_observed (GtkTreeModel *tree_model)
+{
+  guint i;
+
+  if (g_object_get_data (G_OBJECT (tree_model), ROW_REF_DATA_STRING) != NULL)
+    return TRUE;
+
+  for (i = 0; i < LAST_SIGNAL; i++)
+    {
+      if (g_signal_has_handler_pending (tree_model, tree_model_signals[i], 0, FALSE))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 /**
  * gtk_tree_model_row_changed:
  * @tree_model: a #GtkTreeModel
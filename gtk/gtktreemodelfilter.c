@@ -262,6 +262,8 @@ struct _FilterLevel
 
   FilterElt *parent_elt;
   FilterLevel *parent_level;
+
+  guint refilter_queued : 1; /* in priv->refilter_queue */
 };
 
 
@@ -292,12 +294,21 @@ struct _GtkTreeModelFilterPrivate
   guint in_row_deleted       : 1;
   guint virtual_root_deleted : 1;
 
+  guint refilter_restart       : 1;
+  guint refilter_level_changed : 1;
+
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
   gulong has_child_toggled_id;
   gulong deleted_id;
   gulong reordered_id;
+
+  /* level-wise refiltering, see gtk_tree_model_filter_update_visible() */
+  GQueue refilter_queue;
+  FilterLevel *refilter_level;
+  gint refilter_offset;
+  guint refilter_idle_id;
 };
 
 /* properties */
@@ -325,6 +336,12 @@ enum
  */
 #undef MODEL_FILTER_DEBUG
 
+/* A queued refilter works for this long per idle callback, checking
+ * the clock after every REFILTER_ROWS_PER_CHECK rows.
+ */
+#define REFILTER_SLICE_USEC 5000
+#define REFILTER_ROWS_PER_CHECK 64
+
 #define FILTER_ELT(filter_elt) ((FilterElt *)filter_elt)
 #define FILTER_LEVEL(filter_level) ((FilterLevel *)filter_level)
 #define GET_ELT(siter) ((FilterElt*) (siter ? g_sequence_get (siter) : NULL))
@@ -490,6 +507,9 @@ static void         gtk_tree_model_filter_remove_elt_from_level           (GtkTr
 static void         gtk_tree_model_filter_update_children                 (GtkTreeModelFilter     *filter,
                                                                            FilterLevel            *level,
                                                                            FilterElt              *elt);
+static void         gtk_tree_model_filter_refilter_cancel                 (GtkTreeModelFilter     *filter);
+static void         gtk_tree_model_filter_refilter_child_changed          (GtkTreeModelFilter     *filter,
+                                                                           gboolean                offsets_changed);
 static void         gtk_tree_model_filter_emit_row_inserted_for_path      (GtkTreeModelFilter     *filter,
                                                                            GtkTreeModel           *c_model,
                                                                            GtkTreePath            *c_path,
@@ -584,6 +604,8 @@ gtk_tree_model_filter_finalize (GObject *object)
 {
   GtkTreeModelFilter *filter = (GtkTreeModelFilter *) object;
 
+  gtk_tree_model_filter_refilter_cancel (filter);
+
   if (filter->priv->virtual_root && !filter->priv->virtual_root_deleted)
     {
       gtk_tree_model_filter_unref_path (filter, filter->priv->virtual_root,
@@ -805,6 +827,7 @@ gtk_tree_model_filter_build_level (GtkTreeModelFilter *filter,
   new_level->ext_ref_count = 0;
   new_level->parent_elt = parent_elt;
   new_level->parent_level = parent_level;
+  new_level->refilter_queued = FALSE;
 
   if (parent_elt)
     parent_elt->children = new_level;
@@ -935,6 +958,12 @@ gtk_tree_model_filter_free_level (GtkTreeModelFilter *filter,
 
   g_assert (filter_level);
 
+  /* Forget the level if it is waiting to be refiltered */
+  if (filter->priv->refilter_level == filter_level)
+    filter->priv->refilter_level = NULL;
+  if (filter_level->refilter_queued)
+    g_queue_remove_all (&filter->priv->refilter_queue, filter_level);
+
   end_siter = g_sequence_get_end_iter (filter_level->seq);
   for (siter = g_sequence_get_begin_iter (filter_level->seq);
        siter != end_siter;
@@ -2008,6 +2037,8 @@ gtk_tree_model_filter_row_changed (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL || c_iter != NULL);
 
+  gtk_tree_model_filter_refilter_child_changed (filter, FALSE);
+
   if (!c_path)
     {
       c_path = gtk_tree_model_get_path (c_model, c_iter);
@@ -2138,6 +2169,8 @@ gtk_tree_model_filter_row_inserted (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL || c_iter != NULL);
 
+  gtk_tree_model_filter_refilter_child_changed (filter, TRUE);
+
   if (!c_path)
     {
       c_path = gtk_tree_model_get_path (c_model, c_iter);
@@ -2314,6 +2347,8 @@ gtk_tree_model_filter_row_has_child_toggled (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL && c_iter != NULL);
 
+  gtk_tree_model_filter_refilter_child_changed (filter, FALSE);
+
   /* If we get row-has-child-toggled on the virtual root, and there is
    * no root level; try to build it now.
    */
@@ -2549,6 +2584,8 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL);
 
+  gtk_tree_model_filter_refilter_child_changed (filter, TRUE);
+
   /* special case the deletion of an ancestor of the virtual root */
   if (filter->priv->virtual_root &&
       (gtk_tree_path_is_ancestor (c_path, filter->priv->virtual_root) ||
@@ -2733,6 +2770,8 @@ gtk_tree_model_filter_rows_reordered (GtkTreeModel *c_model,
 
   g_return_if_fail (new_order != NULL);
 
+  gtk_tree_model_filter_refilter_child_changed (filter, TRUE);
+
   if (c_path == NULL || gtk_tree_path_get_depth (c_path) == 0)
     {
       length = gtk_tree_model_iter_n_children (c_model, NULL);
@@ -3659,6 +3698,7 @@ gtk_tree_model_filter_set_model (GtkTreeModelFilter *filter,
                                    filter->priv->reordered_id);
 
       /* reset our state */
+      gtk_tree_model_filter_refilter_cancel (filter);
       if (filter->priv->root)
         gtk_tree_model_filter_free_level (filter, filter->priv->root,
                                           TRUE, TRUE, FALSE);
@@ -4262,6 +4302,9 @@ gtk_tree_model_filter_refilter_helper (GtkTreeModel *model,
  * Emits ::row_changed for each row in the child model, which causes
  * the filter to re-evaluate whether a row is visible or not.
  *
+ * For large models, gtk_tree_model_filter_update_visible() is usually
+ * much faster.
+ *
  * Since: 2.4
  */
 void
@@ -4269,12 +4312,319 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
 {
   g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
 
+  gtk_tree_model_filter_refilter_cancel (filter);
+
   /* S L O W */
   gtk_tree_model_foreach (filter->priv->child_model,
                           gtk_tree_model_filter_refilter_helper,
                           filter);
 }
 
+/* Level-wise refiltering
+ *
+ * Instead of pretending that every child row changed, the rows of a
+ * cached level are walked together with the level's sequence, so each
+ * row costs one call of the visible function and signals are only
+ * emitted for rows that appear or disappear. Levels are processed
+ * breadth-first, parents before their children; uncached levels are
+ * skipped, their visibility is evaluated when they are built.
+ *
+ * The state lives in the private struct so the walk can be suspended
+ * between idle callbacks. Freeing a level drops it from the queue, and
+ * child model signals make the current level start over, as they may
+ * have shifted the offsets.
+ */
+static void
+gtk_tree_model_filter_refilter_child_changed (GtkTreeModelFilter *filter,
+                                              gboolean            offsets_changed)
+{
+  if (filter->priv->refilter_level == NULL)
+    return;
+
+  filter->priv->refilter_restart = TRUE;
+  if (offsets_changed)
+    filter->priv->refilter_offset = 0;
+}
+
+static void
+gtk_tree_model_filter_refilter_queue_clear (GtkTreeModelFilter *filter)
+{
+  FilterLevel *level;
+
+  while ((level = g_queue_pop_head (&filter->priv->refilter_queue)))
+    level->refilter_queued = FALSE;
+}
+
+/* Queues the child level of a row that stays visible. A level can be
+ * walked more than once when the child model changes under it, so
+ * this makes sure every level is queued only once.
+ */
+static void
+gtk_tree_model_filter_refilter_queue_push (GtkTreeModelFilter *filter,
+                                           FilterLevel        *level)
+{
+  if (level->refilter_queued)
+    return;
+
+  level->refilter_queued = TRUE;
+  g_queue_push_tail (&filter->priv->refilter_queue, level);
+}
+
+static void
+gtk_tree_model_filter_refilter_begin (GtkTreeModelFilter *filter)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+
+  gtk_tree_model_filter_refilter_queue_clear (filter);
+  priv->refilter_level = priv->root;
+  priv->refilter_offset = 0;
+  priv->refilter_restart = FALSE;
+  priv->refilter_level_changed = FALSE;
+}
+
+static void
+gtk_tree_model_filter_refilter_cancel (GtkTreeModelFilter *filter)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+
+  if (priv->refilter_idle_id != 0)
+    {
+      g_source_remove (priv->refilter_idle_id);
+      priv->refilter_idle_id = 0;
+    }
+
+  gtk_tree_model_filter_refilter_queue_clear (filter);
+  priv->refilter_level = NULL;
+}
+
+/* Refilters priv->refilter_level from priv->refilter_offset on.
+ * Returns FALSE if @end_time passed before the end of the level
+ * was reached.
+ */
+static gboolean
+gtk_tree_model_filter_refilter_level (GtkTreeModelFilter *filter,
+                                      gint64              end_time)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+  FilterLevel *level = priv->refilter_level;
+  GtkTreeIter c_parent_iter;
+  GtkTreeIter c_iter;
+  GSequenceIter *siter;
+  FilterElt dummy;
+  guint n_rows = 0;
+
+restart:
+  priv->refilter_restart = FALSE;
+
+  if (level->parent_elt)
+    {
+      GtkTreeIter f_iter;
+
+      f_iter.stamp = priv->stamp;
+      f_iter.user_data = level->parent_level;
+      f_iter.user_data2 = level->parent_elt;
+
+      gtk_tree_model_filter_convert_iter_to_child_iter (filter,
+                                                        &c_parent_iter,
+                                                        &f_iter);
+    }
+  else if (priv->virtual_root)
+    {
+      if (!gtk_tree_model_get_iter (priv->child_model, &c_parent_iter,
+                                    priv->virtual_root))
+        return TRUE;
+    }
+
+  if (!gtk_tree_model_iter_nth_child (priv->child_model, &c_iter,
+                                      level->parent_elt || priv->virtual_root ? &c_parent_iter : NULL,
+                                      priv->refilter_offset))
+    goto done;
+
+  /* The first elt with an offset of at least refilter_offset */
+  dummy.offset = priv->refilter_offset - 1;
+  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, NULL);
+
+  do
+    {
+      FilterElt *elt = NULL;
+      GSequenceIter *next_siter = siter;
+      gboolean current_state, requested_state;
+
+      if (!g_sequence_iter_is_end (siter) &&
+          GET_ELT (siter)->offset == priv->refilter_offset)
+        {
+          elt = GET_ELT (siter);
+          next_siter = g_sequence_iter_next (siter);
+        }
+
+      current_state = elt && elt->visible_siter;
+      requested_state = gtk_tree_model_filter_visible (filter, &c_iter);
+
+      if (current_state && !requested_state)
+        {
+          gtk_tree_model_filter_remove_elt_from_level (filter, level, elt);
+          priv->refilter_level_changed = TRUE;
+        }
+      else if (!current_state && requested_state)
+        {
+          GtkTreePath *c_path;
+
+          c_path = gtk_tree_model_get_path (priv->child_model, &c_iter);
+          gtk_tree_model_filter_emit_row_inserted_for_path (filter,
+                                                            priv->child_model,
+                                                            c_path, &c_iter);
+          gtk_tree_path_free (c_path);
+          priv->refilter_level_changed = TRUE;
+        }
+      else if (elt && elt->children)
+        gtk_tree_model_filter_refilter_queue_push (filter, elt->children);
+
+      /* Signal handlers may have freed the level or changed the
+       * child model.
+       */
+      if (priv->refilter_level != level)
+        return TRUE;
+      if (priv->refilter_restart)
+        goto restart;
+
+      siter = next_siter;
+      priv->refilter_offset++;
+
+      if (end_time != 0 &&
+          ++n_rows % REFILTER_ROWS_PER_CHECK == 0 &&
+          g_get_monotonic_time () >= end_time)
+        return FALSE;
+    }
+  while (gtk_tree_model_iter_next (priv->child_model, &c_iter));
+
+done:
+  /* The visibility of the ancestors may depend on this level */
+  if (priv->refilter_level_changed && level->parent_elt)
+    {
+      GtkTreePath *path;
+
+      path = gtk_tree_model_filter_elt_get_path (level->parent_level,
+                                                 level->parent_elt,
+                                                 NULL);
+      gtk_tree_path_append_index (path, 0);
+      gtk_tree_model_filter_check_ancestors (filter, path);
+      gtk_tree_path_free (path);
+    }
+
+  return TRUE;
+}
+
+/* Returns TRUE if there is work left after @end_time, or 0 to
+ * run to completion.
+ */
+static gboolean
+gtk_tree_model_filter_refilter_run (GtkTreeModelFilter *filter,
+                                    gint64              end_time)
+{
+  GtkTreeModelFilterPrivate *priv = filter->priv;
+
+  while (TRUE)
+    {
+      if (priv->refilter_level == NULL)
+        {
+          priv->refilter_level = g_queue_pop_head (&priv->refilter_queue);
+          priv->refilter_offset = 0;
+          priv->refilter_level_changed = FALSE;
+
+          if (priv->refilter_level == NULL)
+            return FALSE;
+
+          priv->refilter_level->refilter_queued = FALSE;
+        }
+
+      if (!gtk_tree_model_filter_refilter_level (filter, end_time))
+        return TRUE;
+
+      priv->refilter_level = NULL;
+    }
+}
+
+static gboolean
+gtk_tree_model_filter_refilter_idle (gpointer data)
+{
+  GtkTreeModelFilter *filter = data;
+
+  if (gtk_tree_model_filter_refilter_run (filter,
+                                          g_get_monotonic_time () + REFILTER_SLICE_USEC))
+    return G_SOURCE_CONTINUE;
+
+  filter->priv->refilter_idle_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * gtk_tree_model_filter_update_visible:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Re-evaluates whether each row is visible, like
+ * gtk_tree_model_filter_refilter(). Unlike that function, it only
+ * emits signals for rows whose visibility changes: ::row-deleted for
+ * rows that are hidden, ::row-inserted for rows that appear and
+ * ::row-has-child-toggled where needed. Rows that stay visible do not
+ * get ::row-changed, so use gtk_tree_model_filter_refilter() if the
+ * values computed by the modify function have changed as well.
+ *
+ * Rows in levels of the child model that were never accessed through
+ * @filter are not looked at; their visibility is determined when
+ * they are first accessed.
+ *
+ * A pending update queued with gtk_tree_model_filter_queue_update_visible()
+ * is finished by this function.
+ *
+ * Since: 3.10
+ */
+void
+gtk_tree_model_filter_update_visible (GtkTreeModelFilter *filter)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  gtk_tree_model_filter_refilter_cancel (filter);
+
+  if (filter->priv->root == NULL)
+    return;
+
+  gtk_tree_model_filter_refilter_begin (filter);
+  gtk_tree_model_filter_refilter_run (filter, 0);
+}
+
+/**
+ * gtk_tree_model_filter_queue_update_visible:
+ * @filter: A #GtkTreeModelFilter.
+ *
+ * Like gtk_tree_model_filter_update_visible(), but the rows are
+ * re-evaluated in short slices from an idle handler, so the user
+ * interface stays responsive while a large model is filtered.
+ * Rows change their visibility as the update progresses.
+ *
+ * Calling this function again while an update is pending starts
+ * the update over. This makes it suitable for filtering by the
+ * contents of a search entry on every keystroke.
+ *
+ * Since: 3.10
+ */
+void
+gtk_tree_model_filter_queue_update_visible (GtkTreeModelFilter *filter)
+{
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+
+  if (filter->priv->root == NULL)
+    return;
+
+  gtk_tree_model_filter_refilter_begin (filter);
+
+  if (filter->priv->refilter_idle_id == 0)
+    filter->priv->refilter_idle_id =
+      gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE,
+                                 gtk_tree_model_filter_refilter_idle,
+                                 filter, NULL);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -150,6 +150,10 @@ GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_refilter                   (GtkTreeModelFilter           *filter);
 GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_clear_cache                (GtkTreeModelFilter           *filter);
+GDK_AVAILABLE_IN_3_10
+void          gtk_tree_model_filter_update_visible             (GtkTreeModelFilter           *filter);
+GDK_AVAILABLE_IN_3_10
+void          gtk_tree_model_filter_queue_update_visible       (GtkTreeModelFilter           *filter);
 
 G_END_DECLS
 
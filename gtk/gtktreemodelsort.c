@@ -1895,6 +1895,178 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+/* Sorting by keys
+ *
+ * When a level is sorted with the default compare function of a column,
+ * the value of every row is fetched only once and turned into a sort
+ * key, instead of fetching two values for each comparison. The keys are
+ * merge sorted, which keeps rows that compare equal in their current
+ * order. Large levels are split and sorted in several threads; nothing
+ * but the keys is touched there.
+ */
+#define SORT_KEYS_INSERTION_LENGTH 16
+#define SORT_KEYS_THREAD_MIN_LENGTH 32768
+
+typedef struct
+{
+  GtkTreeDataSortKey key;
+  SortElt *elt;
+} SortKeyItem;
+
+typedef struct
+{
+  SortKeyItem *items;
+  SortKeyItem *tmp;
+  gint n_items;
+  gint n_threads;
+  GtkTreeDataSortKeyType key_type;
+  gboolean descending;
+} SortKeyJob;
+
+static inline gint
+sort_key_item_compare (const SortKeyJob  *job,
+                       const SortKeyItem *a,
+                       const SortKeyItem *b)
+{
+  gint retval;
+
+  retval = _gtk_tree_data_sort_key_compare (&a->key, &b->key, job->key_type);
+
+  return job->descending ? -retval : retval;
+}
+
+static gpointer
+sort_keys (gpointer user_data)
+{
+  SortKeyJob *job = user_data;
+  SortKeyJob left, right;
+  GThread *thread = NULL;
+  gint i, j, k;
+
+  if (job->n_items <= SORT_KEYS_INSERTION_LENGTH)
+    {
+      for (i = 1; i < job->n_items; i++)
+        {
+          SortKeyItem item = job->items[i];
+
+          for (j = i; j > 0 && sort_key_item_compare (job, &job->items[j - 1], &item) > 0; j--)
+            job->items[j] = job->items[j - 1];
+          job->items[j] = item;
+        }
+
+      return NULL;
+    }
+
+  left = right = *job;
+  left.n_items = job->n_items / 2;
+  left.n_threads = job->n_threads / 2;
+  right.items += left.n_items;
+  right.tmp += left.n_items;
+  right.n_items -= left.n_items;
+  right.n_threads -= left.n_threads;
+
+  if (left.n_threads > 0 && job->n_items >= SORT_KEYS_THREAD_MIN_LENGTH)
+    thread = g_thread_try_new ("gtk-sort", sort_keys, &left, NULL);
+  if (thread == NULL)
+    sort_keys (&left);
+  sort_keys (&right);
+  if (thread != NULL)
+    g_thread_join (thread);
+
+  /* merge, preferring the left side for equal keys */
+  i = 0;
+  j = left.n_items;
+  k = 0;
+  while (i < left.n_items && j < job->n_items)
+    {
+      if (sort_key_item_compare (job, &job->items[j], &job->items[i]) < 0)
+        job->tmp[k++] = job->items[j++];
+      else
+        job->tmp[k++] = job->items[i++];
+    }
+  while (i < left.n_items)
+    job->tmp[k++] = job->items[i++];
+  while (j < job->n_items)
+    job->tmp[k++] = job->items[j++];
+
+  memcpy (job->items, job->tmp, job->n_items * sizeof (SortKeyItem));
+
+  return NULL;
+}
+
+/* Returns %FALSE if the level can't be sorted by keys */
+static gboolean
+gtk_tree_model_sort_sort_level_by_keys (GtkTreeModelSort *tree_model_sort,
+                                        SortLevel        *level,
+                                        SortData         *data)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GSequenceIter *siter, *end_siter;
+  SortKeyJob job;
+  gint column, i;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  column = GPOINTER_TO_INT (data->sort_data);
+  job.key_type = _gtk_tree_data_sort_key_type (gtk_tree_model_get_column_type (priv->child_model, column));
+  if (job.key_type == GTK_TREE_DATA_SORT_KEY_NONE)
+    return FALSE;
+
+  job.n_items = g_sequence_get_length (level->seq);
+  job.items = g_new (SortKeyItem, job.n_items);
+  job.tmp = g_new (SortKeyItem, job.n_items);
+  job.n_threads = g_get_num_processors ();
+  job.descending = priv->order == GTK_SORT_DESCENDING;
+
+  i = 0;
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    {
+      SortElt *elt = g_sequence_get (siter);
+      GtkTreeIter child_iter;
+      GValue value = G_VALUE_INIT;
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+        child_iter = elt->iter;
+      else
+        {
+          data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+          gtk_tree_model_get_iter (priv->child_model, &child_iter, data->parent_path);
+        }
+
+      gtk_tree_model_get_value (priv->child_model, &child_iter, column, &value);
+      if (_gtk_tree_data_sort_key_type (G_VALUE_TYPE (&value)) != job.key_type)
+        {
+          /* the child model is broken, sort the row like an empty one */
+          if (G_IS_VALUE (&value))
+            g_value_unset (&value);
+          g_value_init (&value, gtk_tree_model_get_column_type (priv->child_model, column));
+        }
+      _gtk_tree_data_sort_key_init (&job.items[i].key, &value);
+      g_value_unset (&value);
+
+      job.items[i].elt = elt;
+      i++;
+    }
+
+  sort_keys (&job);
+
+  /* moving every row to the end leaves them in sorted order */
+  for (i = 0; i < job.n_items; i++)
+    {
+      g_sequence_move (job.items[i].elt->siter, end_siter);
+      _gtk_tree_data_sort_key_clear (&job.items[i].key, job.key_type);
+    }
+
+  g_free (job.items);
+  g_free (job.tmp);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1943,7 +2115,7 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   if (data.sort_func == NO_SORT_FUNC)
     g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
                      &data);
-  else
+  else if (!gtk_tree_model_sort_sort_level_by_keys (tree_model_sort, level, &data))
     g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
 
   free_sort_data (&data);
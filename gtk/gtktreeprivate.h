@@ -147,6 +147,7 @@ gint              _gtk_tree_view_column_get_drag_x            (GtkTreeViewColumn
 GtkCellAreaContext *_gtk_tree_view_column_get_context         (GtkTreeViewColumn  *column);
 void              _gtk_tree_view_reset_header_styles       (GtkTreeView        *tree_view);
 
+gboolean          _gtk_tree_model_is_observed              (GtkTreeModel       *tree_model);
 
 G_END_DECLS
 
@@ -240,6 +240,7 @@ typedef enum {
 #define GTK_TREE_VIEW_PRIORITY_VALIDATE (GDK_PRIORITY_REDRAW + 5)
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
 #define GTK_TREE_VIEW_TIME_MS_PER_IDLE 30
+#define GTK_TREE_VIEW_ESTIMATE_SAMPLE_ROWS 100
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
 #define AUTO_EXPAND_TIMEOUT 500
@@ -420,6 +421,9 @@ struct _GtkTreeViewPrivate
   /* fixed height */
   gint fixed_height;
 
+  /* estimated height, -1 until rows were sampled */
+  gint estimated_height;
+
   /* Scroll-to functionality when unrealized */
   GtkTreeRowReference *scroll_to_path;
   GtkTreeViewColumn *scroll_to_column;
@@ -462,6 +466,7 @@ struct _GtkTreeViewPrivate
 
   guint fixed_height_mode : 1;
   guint fixed_height_check : 1;
+  guint estimated_height_mode : 1;
 
   guint activate_on_single_click : 1;
   guint reorderable : 1;
@@ -561,7 +566,8 @@ enum {
   PROP_ENABLE_GRID_LINES,
   PROP_ENABLE_TREE_LINES,
   PROP_TOOLTIP_COLUMN,
-  PROP_ACTIVATE_ON_SINGLE_CLICK
+  PROP_ACTIVATE_ON_SINGLE_CLICK,
+  PROP_ESTIMATED_HEIGHT_MODE
 };
 
 /* object signals */
@@ -1196,6 +1202,24 @@ gtk_tree_view_class_init (GtkTreeViewClass *class)
 							 FALSE,
 							 GTK_PARAM_READWRITE));
 
+  /**
+   * GtkTreeView:estimated-height-mode:
+   *
+   * Setting the ::estimated-height-mode property to %TRUE speeds up
+   * #GtkTreeView with many rows by only measuring a sample of the rows
+   * up front and estimating the height of the others. Please see
+   * gtk_tree_view_set_estimated_height_mode() for more information.
+   *
+   * Since: 3.10
+   */
+  g_object_class_install_property (o_class,
+                                   PROP_ESTIMATED_HEIGHT_MODE,
+                                   g_param_spec_boolean ("estimated-height-mode",
+							 P_("Estimated Height Mode"),
+							 P_("Speeds up GtkTreeView by only measuring rows when they are shown"),
+							 FALSE,
+							 GTK_PARAM_READWRITE));
+
   /* Style properties */
 #define _TREE_VIEW_EXPANDER_SIZE 14
 #define _TREE_VIEW_VERTICAL_SEPARATOR 2
@@ -1753,6 +1777,8 @@ gtk_tree_view_init (GtkTreeView *tree_view)
   tree_view->priv->scroll_sync_timer = 0;
   tree_view->priv->fixed_height = -1;
   tree_view->priv->fixed_height_mode = FALSE;
+  tree_view->priv->estimated_height = -1;
+  tree_view->priv->estimated_height_mode = FALSE;
   tree_view->priv->fixed_height_check = 0;
   tree_view->priv->selection = _gtk_tree_selection_new_with_tree_view (tree_view);
   tree_view->priv->enable_search = TRUE;
@@ -1874,6 +1900,9 @@ gtk_tree_view_set_property (GObject         *object,
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       gtk_tree_view_set_activate_on_single_click (tree_view, g_value_get_boolean (value));
       break;
+    case PROP_ESTIMATED_HEIGHT_MODE:
+      gtk_tree_view_set_estimated_height_mode (tree_view, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1958,6 +1987,9 @@ gtk_tree_view_get_property (GObject    *object,
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       g_value_set_boolean (value, tree_view->priv->activate_on_single_click);
       break;
+    case PROP_ESTIMATED_HEIGHT_MODE:
+      g_value_set_boolean (value, tree_view->priv->estimated_height_mode);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -6642,6 +6674,9 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   gint y = -1;
   gint prev_height = -1;
   gboolean fixed_height = TRUE;
+  gboolean estimating = FALSE;
+  gint sample_height = 0;
+  gint n_samples = 0;
 
   g_assert (tree_view);
 
@@ -6660,6 +6695,15 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
+  if (tree_view->priv->estimated_height_mode)
+    {
+      /* the remaining rows are validated when they become visible */
+      if (tree_view->priv->estimated_height >= 0)
+        return FALSE;
+
+      estimating = TRUE;
+    }
+
   timer = g_timer_new ();
   g_timer_start (timer);
 
@@ -6748,11 +6792,18 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 	    fixed_height = FALSE;
 	}
 
+      if (estimating)
+        {
+          sample_height += gtk_tree_view_get_row_height (tree_view, node);
+          n_samples++;
+        }
+
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000. &&
+         !(estimating && n_samples >= GTK_TREE_VIEW_ESTIMATE_SAMPLE_ROWS));
 
-  if (!tree_view->priv->fixed_height_check)
+  if (!tree_view->priv->fixed_height_check && !estimating)
    {
      if (fixed_height)
        _gtk_rbtree_set_fixed_height (tree_view->priv->tree, prev_height, FALSE);
@@ -6761,6 +6812,16 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
    }
   
  done:
+  if (estimating && n_samples > 0)
+    {
+      /* give all rows that were not sampled the average height */
+      tree_view->priv->estimated_height = (sample_height + n_samples / 2) / n_samples;
+      _gtk_rbtree_set_fixed_height (tree_view->priv->tree,
+                                    tree_view->priv->estimated_height, FALSE);
+      validated_area = TRUE;
+      retval = FALSE;
+    }
+
   if (validated_area)
     {
       GtkRequisition requisition;
@@ -8244,6 +8305,63 @@ gtk_tree_view_get_fixed_height_mode (GtkTreeView *tree_view)
   return tree_view->priv->fixed_height_mode;
 }
 
+/**
+ * gtk_tree_view_set_estimated_height_mode:
+ * @tree_view: a #GtkTreeView
+ * @enable: %TRUE to enable estimated height mode
+ *
+ * Enables or disables the estimated height mode of @tree_view.
+ *
+ * Normally, #GtkTreeView measures all rows in the background after a
+ * model is set, which takes a long time for big models. In estimated
+ * height mode, only a sample of the rows is measured, and the other
+ * rows are assumed to have the average height of the sample until they
+ * are scrolled into view. Unlike fixed height mode, rows may have
+ * different heights and all column sizing modes can be used. Autosized
+ * columns only take the rows into account that have been measured.
+ *
+ * Fixed height mode takes precedence if both modes are enabled.
+ *
+ * Since: 3.10
+ **/
+void
+gtk_tree_view_set_estimated_height_mode (GtkTreeView *tree_view,
+                                         gboolean     enable)
+{
+  g_return_if_fail (GTK_IS_TREE_VIEW (tree_view));
+
+  enable = enable != FALSE;
+
+  if (enable == tree_view->priv->estimated_height_mode)
+    return;
+
+  tree_view->priv->estimated_height_mode = enable;
+  tree_view->priv->estimated_height = -1;
+
+  /* force a revalidation */
+  install_presize_handler (tree_view);
+
+  g_object_notify (G_OBJECT (tree_view), "estimated-height-mode");
+}
+
+/**
+ * gtk_tree_view_get_estimated_height_mode:
+ * @tree_view: a #GtkTreeView
+ *
+ * Returns whether estimated height mode is turned on for @tree_view.
+ *
+ * Return value: %TRUE if @tree_view is in estimated height mode
+ *
+ * Since: 3.10
+ **/
+gboolean
+gtk_tree_view_get_estimated_height_mode (GtkTreeView *tree_view)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW (tree_view), FALSE);
+
+  return tree_view->priv->estimated_height_mode;
+}
+
 /* Returns TRUE if the focus is within the headers, after the focus operation is
  * done
  */
@@ -8549,6 +8667,7 @@ gtk_tree_view_style_updated (GtkWidget *widget)
 	}
 
       tree_view->priv->fixed_height = -1;
+      tree_view->priv->estimated_height = -1;
       _gtk_rbtree_mark_invalid (tree_view->priv->tree);
     }
 }
@@ -8832,6 +8951,9 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
   if (tree_view->priv->fixed_height_mode
       && tree_view->priv->fixed_height >= 0)
     height = tree_view->priv->fixed_height;
+  else if (tree_view->priv->estimated_height_mode
+           && tree_view->priv->estimated_height >= 0)
+    height = tree_view->priv->estimated_height;
   else
     height = 0;
 
@@ -9344,11 +9466,16 @@ gtk_tree_view_build_tree (GtkTreeView *tree_view,
 {
   GtkRBNode *temp = NULL;
   GtkTreePath *path = NULL;
+  gint height = 0;
+
+  /* rows of expanded nodes start out with the estimate, like inserted rows */
+  if (tree_view->priv->estimated_height_mode && tree_view->priv->estimated_height > 0)
+    height = tree_view->priv->estimated_height;
 
   do
     {
       gtk_tree_model_ref_node (tree_view->priv->model, iter);
-      temp = _gtk_rbtree_insert_after (tree, temp, 0, FALSE);
+      temp = _gtk_rbtree_insert_after (tree, temp, height, FALSE);
 
       if (tree_view->priv->fixed_height > 0)
         {
@@ -11185,6 +11312,10 @@ gtk_tree_view_adjustment_changed (GtkAdjustment *adjustment,
 
           if (!tree_view->priv->in_top_row_to_dy)
             gtk_tree_view_dy_to_top_row (tree_view);
+
+          /* measure the rows that scrolled into view before they are drawn */
+          if (tree_view->priv->estimated_height_mode)
+            install_presize_handler (tree_view);
 	}
     }
 }
@@ -11315,6 +11446,7 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
       tree_view->priv->search_column = -1;
       tree_view->priv->fixed_height_check = 0;
       tree_view->priv->fixed_height = -1;
+      tree_view->priv->estimated_height = -1;
       tree_view->priv->dy = tree_view->priv->top_row_dy = 0;
       tree_view->priv->last_button_x = -1;
       tree_view->priv->last_button_y = -1;
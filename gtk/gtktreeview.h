@@ -521,6 +521,11 @@ void     gtk_tree_view_set_fixed_height_mode (GtkTreeView          *tree_view,
 					      gboolean              enable);
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_tree_view_get_fixed_height_mode (GtkTreeView          *tree_view);
+GDK_AVAILABLE_IN_3_10
+void     gtk_tree_view_set_estimated_height_mode (GtkTreeView      *tree_view,
+                                                  gboolean          enable);
+GDK_AVAILABLE_IN_3_10
+gboolean gtk_tree_view_get_estimated_height_mode (GtkTreeView      *tree_view);
 GDK_AVAILABLE_IN_ALL
 void     gtk_tree_view_set_hover_selection   (GtkTreeView          *tree_view,
 					      gboolean              hover);
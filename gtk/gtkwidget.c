@@ -403,6 +403,7 @@ typedef struct {
 
 typedef struct {
   GBytes               *data;
+  GtkBuilderTemplate   *compiled;       /* Parsed lazily by the first instance */
   GSList               *children;
   GSList               *callbacks;
   GtkBuilderConnectFunc connect_func;
@@ -493,6 +494,10 @@ struct _GtkWidgetPrivate
   GtkAllocation allocation;
   gint allocated_baseline;
 
+  /* The allocation the parent gave, before adjust_size_allocation() */
+  GtkAllocation parent_allocation;
+  gint parent_baseline;
+
   /* The widget's requested sizes */
   SizeRequestCache requests;
 
@@ -527,6 +532,7 @@ struct _GtkWidgetClassPrivate
   GType accessible_type;
   AtkRole accessible_role;
   GtkWidgetTemplate *template;
+  const GtkWidgetMeasureFuncs *measure_funcs;
 };
 
 enum {
@@ -5419,6 +5425,9 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
 
   gtk_widget_push_verify_invariants (widget);
 
+  priv->parent_allocation = *allocation;
+  priv->parent_baseline = baseline;
+
 #ifdef G_ENABLE_DEBUG
   if (gtk_get_debug_flags () & GTK_DEBUG_GEOMETRY)
     {
@@ -5549,6 +5558,7 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
     goto out;
 
   priv->allocated_baseline = baseline;
+  _gtk_container_count_allocate ();
   g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0, &real_allocation);
 
   /* Size allocation is god... after consulting god, no further requests or allocations are needed */
@@ -11684,6 +11694,29 @@ _gtk_widget_peek_request_cache (GtkWidget *widget)
   return &widget->priv->requests;
 }
 
+/*
+ * _gtk_widget_class_set_measure_funcs:
+ * @widget_class: a #GtkWidgetClass
+ * @funcs: (allow-none): static functions to measure widgets of
+ *     @widget_class off the main thread, or %NULL
+ *
+ * Lets containers measure widgets of @widget_class and its subclasses
+ * in parallel, see _gtk_widget_prefetch_child_sizes(). This should
+ * only be called from class init functions.
+ */
+void
+_gtk_widget_class_set_measure_funcs (GtkWidgetClass              *widget_class,
+                                     const GtkWidgetMeasureFuncs *funcs)
+{
+  widget_class->priv->measure_funcs = funcs;
+}
+
+const GtkWidgetMeasureFuncs *
+_gtk_widget_class_get_measure_funcs (GtkWidgetClass *widget_class)
+{
+  return widget_class->priv->measure_funcs;
+}
+
 /*
  * _gtk_widget_set_device_window:
  * @widget: a #GtkWidget
@@ -15196,6 +15229,19 @@ _gtk_widget_set_alloc_needed (GtkWidget *widget,
   widget->priv->alloc_needed = alloc_needed;
 }
 
+/* Allocates @widget again with the allocation its parent gave it last
+ * time, for relayouts that don't need to involve the parent.
+ */
+void
+_gtk_widget_reallocate (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  GtkAllocation allocation;
+
+  allocation = priv->parent_allocation;
+  gtk_widget_size_allocate_with_baseline (widget, &allocation, priv->parent_baseline);
+}
+
 void
 _gtk_widget_add_sizegroup (GtkWidget    *widget,
 			   gpointer      group)
@@ -15583,6 +15629,8 @@ template_data_free (GtkWidgetTemplate *template_data)
   if (template_data)
     {
       g_bytes_unref (template_data->data);
+      if (template_data->compiled)
+        _gtk_builder_template_free (template_data->compiled);
       g_slist_free_full (template_data->children, (GDestroyNotify)template_child_class_free);
       g_slist_free_full (template_data->callbacks, (GDestroyNotify)callback_symbol_free);
 
@@ -15709,6 +15757,24 @@ gtk_widget_init_template (GtkWidget *widget)
   template = GTK_WIDGET_GET_CLASS (widget)->priv->template;
   g_return_if_fail (template != NULL);
 
+  /* The template XML is only tokenized once per class, every instance
+   * replays the compiled template.
+   */
+  if (template->compiled == NULL)
+    {
+      template->compiled =
+        _gtk_builder_template_compile ((const gchar *)g_bytes_get_data (template->data, NULL),
+                                       g_bytes_get_size (template->data),
+                                       &error);
+      if (template->compiled == NULL)
+        {
+          g_critical ("Error parsing template class '%s' for an instance of type '%s': %s",
+                      g_type_name (class_type), G_OBJECT_TYPE_NAME (object), error->message);
+          g_error_free (error);
+          return;
+        }
+    }
+
   builder = gtk_builder_new ();
 
   /* Add any callback symbols declared for this GType to the GtkBuilder namespace */
@@ -15724,8 +15790,7 @@ gtk_widget_init_template (GtkWidget *widget)
    * there is no infinate recursion.
    */
   if (!_gtk_builder_extend_with_template (builder, widget, class_type,
-					  (const gchar *)g_bytes_get_data (template->data, NULL),
-					  g_bytes_get_size (template->data),
+					  template->compiled,
 					  &error))
     {
       g_critical ("Error building template class '%s' for an instance of type '%s': %s",
@@ -20,7 +20,7 @@
 #include <string.h>
 
 #include "gtkwidget.h"
-#include "gtkwidgetpath.h"
+#include "gtkwidgetpathprivate.h"
 #include "gtkstylecontextprivate.h"
 
 /**
@@ -1293,3 +1293,216 @@ gtk_widget_path_has_parent (const GtkWidgetPath *path,
 
   return FALSE;
 }
+
+static guint
+gtk_path_element_hash (const GtkPathElement *elem)
+{
+  guint i, hash;
+
+  hash = elem->type;
+  hash = (hash << 5) - hash + elem->name;
+  hash = (hash << 5) - hash + elem->sibling_index;
+
+  if (elem->classes)
+    {
+      for (i = 0; i < elem->classes->len; i++)
+        hash = (hash << 5) - hash + g_array_index (elem->classes, GQuark, i);
+    }
+
+  /* Regions live in a hash table, so only use an order
+   * independent property of them */
+  if (elem->regions)
+    hash ^= g_hash_table_size (elem->regions);
+
+  return hash;
+}
+
+static gboolean
+gtk_path_element_equal (const GtkPathElement *elem1,
+                        const GtkPathElement *elem2)
+{
+  guint n_classes1, n_classes2;
+
+  if (elem1->type != elem2->type ||
+      elem1->name != elem2->name ||
+      elem1->sibling_index != elem2->sibling_index)
+    return FALSE;
+
+  /* classes are kept sorted, see gtk_widget_path_iter_add_class() */
+  n_classes1 = elem1->classes ? elem1->classes->len : 0;
+  n_classes2 = elem2->classes ? elem2->classes->len : 0;
+  if (n_classes1 != n_classes2)
+    return FALSE;
+  if (n_classes1 > 0 &&
+      memcmp (elem1->classes->data, elem2->classes->data, n_classes1 * sizeof (GQuark)) != 0)
+    return FALSE;
+
+  if ((elem1->regions ? g_hash_table_size (elem1->regions) : 0) !=
+      (elem2->regions ? g_hash_table_size (elem2->regions) : 0))
+    return FALSE;
+  if (elem1->regions)
+    {
+      GHashTableIter iter;
+      gpointer key, value, other;
+
+      g_hash_table_iter_init (&iter, elem1->regions);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+          if (!g_hash_table_lookup_extended (elem2->regions, key, NULL, &other) ||
+              value != other)
+            return FALSE;
+        }
+    }
+
+  if (elem1->siblings != elem2->siblings)
+    {
+      if (elem1->siblings == NULL || elem2->siblings == NULL)
+        return FALSE;
+      if (!_gtk_widget_path_equal (elem1->siblings, elem2->siblings))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _gtk_widget_path_hash:
+ * @path: a #GtkWidgetPath
+ *
+ * Computes a hash value for @path, suitable for use in a #GHashTable
+ * together with _gtk_widget_path_equal(). The siblings of the path
+ * elements are not taken into account, only their position.
+ *
+ * Returns: a hash value for @path
+ */
+guint
+_gtk_widget_path_hash (const GtkWidgetPath *path)
+{
+  guint i, hash;
+
+  hash = path->elems->len;
+
+  for (i = 0; i < path->elems->len; i++)
+    {
+      GtkPathElement *elem = &g_array_index (path->elems, GtkPathElement, i);
+
+      hash = (hash << 5) - hash + gtk_path_element_hash (elem);
+    }
+
+  return hash;
+}
+
+/*
+ * _gtk_widget_path_equal:
+ * @path1: a #GtkWidgetPath
+ * @path2: another #GtkWidgetPath
+ *
+ * Checks if @path1 and @path2 describe the same widget hierarchy,
+ * including names, classes, regions and siblings of all elements.
+ * Two equal paths match the same CSS selectors.
+ *
+ * Returns: %TRUE if the paths are equal
+ */
+gboolean
+_gtk_widget_path_equal (const GtkWidgetPath *path1,
+                        const GtkWidgetPath *path2)
+{
+  guint i;
+
+  if (path1 == path2)
+    return TRUE;
+
+  if (path1->elems->len != path2->elems->len)
+    return FALSE;
+
+  /* Compare from the end, that's where paths usually differ */
+  for (i = path1->elems->len; i-- > 0; )
+    {
+      if (!gtk_path_element_equal (&g_array_index (path1->elems, GtkPathElement, i),
+                                   &g_array_index (path2->elems, GtkPathElement, i)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * _gtk_widget_path_iter_get_qname:
+ * @path: a #GtkWidgetPath
+ * @pos: position to query, -1 for the path head
+ *
+ * Returns the name of the object at @pos as a quark, or 0 if
+ * it has no name.
+ *
+ * Returns: the name quark
+ */
+GQuark
+_gtk_widget_path_iter_get_qname (const GtkWidgetPath *path,
+                                 gint                 pos)
+{
+  GtkPathElement *elem;
+
+  if (pos < 0 || pos >= path->elems->len)
+    pos = path->elems->len - 1;
+
+  elem = &g_array_index (path->elems, GtkPathElement, pos);
+
+  return elem->name;
+}
+
+/*
+ * _gtk_widget_path_iter_get_qclasses:
+ * @path: a #GtkWidgetPath
+ * @pos: position to query, -1 for the path head
+ * @n_classes: (out): return location for the number of classes
+ *
+ * Returns the sorted class quarks of the object at @pos without
+ * copying them, for callers that scan paths in hot loops.
+ *
+ * Returns: (array length=n_classes) (transfer none): the classes
+ */
+const GQuark *
+_gtk_widget_path_iter_get_qclasses (const GtkWidgetPath *path,
+                                    gint                 pos,
+                                    guint               *n_classes)
+{
+  GtkPathElement *elem;
+
+  if (pos < 0 || pos >= path->elems->len)
+    pos = path->elems->len - 1;
+
+  elem = &g_array_index (path->elems, GtkPathElement, pos);
+
+  if (!elem->classes)
+    {
+      *n_classes = 0;
+      return NULL;
+    }
+
+  *n_classes = elem->classes->len;
+  return (const GQuark *) elem->classes->data;
+}
+
+/*
+ * _gtk_widget_path_iter_get_qregions:
+ * @path: a #GtkWidgetPath
+ * @pos: position to query, -1 for the path head
+ *
+ * Returns the regions of the object at @pos. The keys of the
+ * table are region name quarks, the values #GtkRegionFlags.
+ *
+ * Returns: (transfer none) (allow-none): the regions, or %NULL
+ */
+GHashTable *
+_gtk_widget_path_iter_get_qregions (const GtkWidgetPath *path,
+                                    gint                 pos)
+{
+  GtkPathElement *elem;
+
+  if (pos < 0 || pos >= path->elems->len)
+    pos = path->elems->len - 1;
+
+  elem = &g_array_index (path->elems, GtkPathElement, pos);
+
+  return elem->regions;
+}
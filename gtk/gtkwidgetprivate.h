@@ -45,6 +45,7 @@ void         _gtk_widget_set_shadowed       (GtkWidget *widget,
 gboolean     _gtk_widget_get_alloc_needed   (GtkWidget *widget);
 void         _gtk_widget_set_alloc_needed   (GtkWidget *widget,
                                              gboolean   alloc_needed);
+void         _gtk_widget_reallocate         (GtkWidget *widget);
 void         _gtk_widget_draw               (GtkWidget *widget,
 					     cairo_t   *cr);
 void          _gtk_widget_scale_changed     (GtkWidget *widget);
@@ -125,6 +126,28 @@ void              _gtk_widget_synthesize_crossing          (GtkWidget       *fro
                                                             GdkCrossingMode  mode);
 
 gpointer          _gtk_widget_peek_request_cache           (GtkWidget *widget);
+gboolean          _gtk_widget_request_matches              (GtkWidget *widget,
+                                                            gpointer   request);
+
+/* Measurement that may run off the main thread, see gtksizerequest.c.
+ * Only run() is called from a worker thread, and it must not touch
+ * the widget.
+ */
+typedef struct {
+  gpointer (* prepare) (GtkWidget      *widget,
+                        GtkOrientation  orientation);
+  void     (* run)     (gpointer        data);
+  void     (* apply)   (GtkWidget      *widget,
+                        gpointer        data);
+  void     (* clear)   (GtkWidget      *widget);
+} GtkWidgetMeasureFuncs;
+
+void              _gtk_widget_class_set_measure_funcs      (GtkWidgetClass              *widget_class,
+                                                            const GtkWidgetMeasureFuncs *funcs);
+const GtkWidgetMeasureFuncs *
+                  _gtk_widget_class_get_measure_funcs      (GtkWidgetClass              *widget_class);
+void              _gtk_widget_prefetch_child_sizes         (GtkWidget                   *container,
+                                                            GtkOrientation               orientation);
 
 void              _gtk_widget_buildable_finish_accelerator (GtkWidget *widget,
                                                             GtkWidget *toplevel,
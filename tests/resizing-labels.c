@@ -0,0 +1,176 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+/* Live-resizes a window full of wrapping labels and counts how often
+ * the labels get measured, to see how well height-for-width requests
+ * are cached.
+ */
+
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "frame-stats.h"
+
+#define WIDTH 600
+#define HEIGHT 600
+#define WINDOW_SIZE_JITTER 300
+#define CYCLE_TIME 5.
+
+static const char text[] =
+  "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod "
+  "tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, "
+  "quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo "
+  "consequat.";
+
+static GtkWidget *window;
+static gint64 start_frame_time;
+
+static int n_labels = 200;
+static gboolean cb_no_resize = FALSE;
+
+static guint64 n_height_for_width = 0;
+static guint64 n_frames = 0;
+
+typedef GtkLabel CountingLabel;
+typedef GtkLabelClass CountingLabelClass;
+
+static GType counting_label_get_type (void);
+
+G_DEFINE_TYPE (CountingLabel, counting_label, GTK_TYPE_LABEL)
+
+static void
+counting_label_get_preferred_height_for_width (GtkWidget *widget,
+                                               gint       width,
+                                               gint      *minimum_height,
+                                               gint      *natural_height)
+{
+  n_height_for_width++;
+
+  GTK_WIDGET_CLASS (counting_label_parent_class)->get_preferred_height_for_width (widget, width,
+                                                                                  minimum_height,
+                                                                                  natural_height);
+}
+
+static void
+counting_label_class_init (CountingLabelClass *class)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (class);
+
+  widget_class->get_preferred_height_for_width = counting_label_get_preferred_height_for_width;
+}
+
+static void
+counting_label_init (CountingLabel *label)
+{
+}
+
+static void
+on_frame (double progress)
+{
+  int jitter;
+
+  n_frames++;
+
+  if (cb_no_resize)
+    return;
+
+  jitter = WINDOW_SIZE_JITTER * sin (2 * M_PI * progress);
+
+  gtk_window_resize (GTK_WINDOW (window),
+                     WIDTH + jitter, HEIGHT);
+}
+
+static gboolean
+tick_callback (GtkWidget     *widget,
+               GdkFrameClock *frame_clock,
+               gpointer       user_data)
+{
+  gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  double scaled_time;
+
+  if (start_frame_time == 0)
+    start_frame_time = frame_time;
+
+  scaled_time = (frame_time - start_frame_time) / (CYCLE_TIME * 1000000);
+  on_frame (scaled_time - floor (scaled_time));
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+on_map_event (GtkWidget   *widget,
+              GdkEventAny *event)
+{
+  gtk_widget_add_tick_callback (window, tick_callback, NULL, NULL);
+
+  return FALSE;
+}
+
+static GOptionEntry options[] = {
+  { "labels", 'l', 0, G_OPTION_ARG_INT, &n_labels, "Number of labels", "COUNT" },
+  { "no-resize", 'n', 0, G_OPTION_ARG_NONE, &cb_no_resize, "No Resize", NULL },
+  { NULL }
+};
+
+int
+main (int argc, char **argv)
+{
+  GError *error = NULL;
+  GtkWidget *scrolled_window;
+  GtkWidget *box;
+  GtkWidget *label;
+  int i;
+
+  GOptionContext *context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  frame_stats_add_options (g_option_context_get_main_group (context));
+  g_option_context_add_group (context,
+                              gtk_get_option_group (TRUE));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  g_print ("# Labels: %d\n", n_labels);
+  g_print ("# Resizing?: %s\n",
+           cb_no_resize ? "no" : "yes");
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  frame_stats_ensure (GTK_WINDOW (window));
+  gtk_window_set_default_size (GTK_WINDOW (window), WIDTH, HEIGHT);
+
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window),
+                                  GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_container_add (GTK_CONTAINER (window), scrolled_window);
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  gtk_container_add (GTK_CONTAINER (scrolled_window), box);
+
+  for (i = 0; i < n_labels; i++)
+    {
+      /* Vary the length, so the labels wrap at different widths */
+      label = g_object_new (counting_label_get_type (), NULL);
+      gtk_label_set_text (GTK_LABEL (label), text + (i * 7) % 64);
+      gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+      gtk_misc_set_alignment (GTK_MISC (label), 0.0, 0.5);
+      gtk_box_pack_start (GTK_BOX (box), label, FALSE, FALSE, 0);
+    }
+
+  g_signal_connect (window, "destroy",
+                    G_CALLBACK (gtk_main_quit), NULL);
+  g_signal_connect (window, "map-event",
+                    G_CALLBACK (on_map_event), NULL);
+
+  gtk_widget_show_all (window);
+
+  gtk_main ();
+
+  g_print ("# Frames: %" G_GUINT64_FORMAT "\n", n_frames);
+  g_print ("# get_preferred_height_for_width() calls: %" G_GUINT64_FORMAT " (%.1f per frame)\n",
+           n_height_for_width,
+           n_frames > 0 ? (double) n_height_for_width / n_frames : 0.);
+
+  return 0;
+}
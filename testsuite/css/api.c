@@ -18,8 +18,17 @@
  * License along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+#include <utime.h>
+
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
+#include "../gtk/testutils.h"
+
+/* Compiled themes are looked up in here */
+static char *theme_prefix;
+
 static void
 gtk_css_provider_load_data_not_null_terminated (void)
 {
@@ -33,15 +42,210 @@ gtk_css_provider_load_data_not_null_terminated (void)
   g_object_unref (p);
 }
 
+/* Only the size and modification time of the CSS are checked, so
+ * keep them the same when changing it */
+#define THEME_MTIME 1000000000
+
+static void
+write_theme_file (const char *path,
+                  const char *contents)
+{
+  struct utimbuf buf;
+
+  g_assert (g_file_set_contents (path, contents, -1, NULL));
+
+  buf.actime = THEME_MTIME;
+  buf.modtime = THEME_MTIME;
+  g_assert_cmpint (g_utime (path, &buf), ==, 0);
+}
+
+/* Creates the theme @name with a cache for red text, and then makes
+ * the CSS say tan, so we can tell whether the cache was used */
+static char *
+create_cached_theme (const char *name)
+{
+  GtkCssProvider *provider;
+  GError *error = NULL;
+  char *dir, *path, *cache_path;
+
+  dir = g_build_filename (theme_prefix, "share", "themes", name, "gtk-3.0", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+  path = g_build_filename (dir, "gtk.css", NULL);
+  cache_path = g_strconcat (path, ".cache", NULL);
+
+  write_theme_file (path, "* { color: red; }");
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_path (provider, path, &error);
+  g_assert_no_error (error);
+  gtk_css_provider_save_cache (provider, cache_path, &error);
+  g_assert_no_error (error);
+  g_object_unref (provider);
+
+  write_theme_file (path, "* { color: tan; }");
+
+  g_free (path);
+  g_free (dir);
+
+  return cache_path;
+}
+
+static void
+assert_theme_color (const char *name,
+                    const char *expected_color)
+{
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+  GdkRGBA color, expected;
+
+  context = gtk_style_context_new ();
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_free (path);
+  gtk_style_context_add_provider (context,
+                                  GTK_STYLE_PROVIDER (gtk_css_provider_get_named (name, NULL)),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, &color);
+  g_assert (gdk_rgba_parse (&expected, expected_color));
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  g_object_unref (context);
+}
+
+static void
+test_cache_fresh (void)
+{
+  g_free (create_cached_theme ("fresh"));
+
+  assert_theme_color ("fresh", "red");
+}
+
+static gboolean
+count_parsing_errors (GSignalInvocationHint *ihint,
+                      guint                  n_param_values,
+                      const GValue          *param_values,
+                      gpointer               data)
+{
+  guint *n_errors = data;
+
+  (*n_errors)++;
+
+  return TRUE;
+}
+
+/* With a fresh cache, the CSS of the theme is not parsed at all */
+static void
+test_cache_used (void)
+{
+  char *cache_path, *path;
+  guint n_errors = 0;
+  guint signal_id;
+  gulong hook_id;
+
+  cache_path = create_cached_theme ("used");
+  path = g_strndup (cache_path, strlen (cache_path) - strlen (".cache"));
+  /* same size as the cached CSS, so the cache is still fresh */
+  write_theme_file (path, "* { colour: re; }");
+
+  signal_id = g_signal_lookup ("parsing-error", GTK_TYPE_CSS_PROVIDER);
+  hook_id = g_signal_add_emission_hook (signal_id, 0, count_parsing_errors, &n_errors, NULL);
+
+  assert_theme_color ("used", "red");
+  g_assert_cmpuint (n_errors, ==, 0);
+
+  g_signal_remove_emission_hook (signal_id, hook_id);
+
+  g_free (path);
+  g_free (cache_path);
+}
+
+static void
+test_cache_changed (void)
+{
+  char *cache_path, *path;
+
+  cache_path = create_cached_theme ("changed");
+  path = g_strndup (cache_path, strlen (cache_path) - strlen (".cache"));
+  write_theme_file (path, "* { color: blue; }");
+
+  assert_theme_color ("changed", "blue");
+
+  g_free (path);
+  g_free (cache_path);
+}
+
+static void
+test_cache_truncated (void)
+{
+  char *cache_path, *contents;
+  gsize length;
+
+  cache_path = create_cached_theme ("truncated");
+  g_assert (g_file_get_contents (cache_path, &contents, &length, NULL));
+  g_assert (g_file_set_contents (cache_path, contents, length / 2, NULL));
+
+  assert_theme_color ("truncated", "tan");
+
+  g_free (contents);
+  g_free (cache_path);
+}
+
+static void
+test_cache_old_version (void)
+{
+  char *cache_path, *contents;
+  gsize length, offset;
+  guint32 version;
+
+  cache_path = create_cached_theme ("old-version");
+  g_assert (g_file_get_contents (cache_path, &contents, &length, NULL));
+
+  /* The format version follows the magic, which is stored as
+   * its length and the string including the terminating 0 */
+  offset = sizeof (guint32) + strlen ("GTK CSS cache") + 1;
+  g_assert_cmpuint (length, >, offset + sizeof (guint32));
+  memcpy (&version, contents + offset, sizeof (guint32));
+  version--;
+  memcpy (contents + offset, &version, sizeof (guint32));
+  g_assert (g_file_set_contents (cache_path, contents, length, NULL));
+
+  assert_theme_color ("old-version", "tan");
+
+  g_free (contents);
+  g_free (cache_path);
+}
 
 int
 main (int argc, char *argv[])
 {
+  int result;
+
+  theme_prefix = g_dir_make_tmp ("gtk-css-api-XXXXXX", NULL);
+  g_assert (theme_prefix != NULL);
+  g_setenv ("GTK_DATA_PREFIX", theme_prefix, TRUE);
+
   gtk_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/gtk_css_provider_load_data/not_null_terminated",
       gtk_css_provider_load_data_not_null_terminated);
+  g_test_add_func ("/gtk_css_provider_save_cache/fresh",
+      test_cache_fresh);
+  g_test_add_func ("/gtk_css_provider_save_cache/used",
+      test_cache_used);
+  g_test_add_func ("/gtk_css_provider_save_cache/changed",
+      test_cache_changed);
+  g_test_add_func ("/gtk_css_provider_save_cache/truncated",
+      test_cache_truncated);
+  g_test_add_func ("/gtk_css_provider_save_cache/old-version",
+      test_cache_old_version);
+
+  result = g_test_run ();
+
+  remove_tree (theme_prefix);
+  g_free (theme_prefix);
 
-  return g_test_run ();
+  return result;
 }
 
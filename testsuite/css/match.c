@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2013 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+/* Roughly the number of rules in a full theme like Adwaita */
+#define N_THEME_RULES 2000
+#define PATH_DEPTH 24
+
+static GtkCssProvider *
+create_theme (void)
+{
+  GtkCssProvider *provider;
+  GString *css;
+  GError *error = NULL;
+  guint i;
+
+  css = g_string_new (NULL);
+
+  /* Most rules in a theme are descendant selectors that
+   * don't match the ancestors of any given widget */
+  for (i = 0; i < N_THEME_RULES; i++)
+    {
+      switch (i % 5)
+        {
+        case 0:
+          g_string_append_printf (css, ".theme-class-%u GtkLabel { color: blue; }\n", i);
+          break;
+        case 1:
+          g_string_append_printf (css, "GtkNotebook .theme-class-%u { color: blue; }\n", i);
+          break;
+        case 2:
+          g_string_append_printf (css, "#theme-name-%u .button { color: blue; }\n", i);
+          break;
+        case 3:
+          g_string_append_printf (css, "GtkTreeView row .theme-class-%u { color: blue; }\n", i);
+          break;
+        default:
+          g_string_append_printf (css, ".theme-class-%u:hover .theme-class-%u { color: blue; }\n", i, i + 1);
+          break;
+        }
+    }
+
+  g_string_append (css,
+                   "GtkNotebook .suggested-action GtkLabel { color: blue; }\n"
+                   "GtkWindow.background GtkButton.suggested-action GtkLabel { color: red; }\n");
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider, css->str, css->len, &error);
+  g_assert_no_error (error);
+
+  g_string_free (css, TRUE);
+
+  return provider;
+}
+
+static GtkWidgetPath *
+create_deep_path (void)
+{
+  GtkWidgetPath *path;
+  guint i;
+  gint pos;
+
+  path = gtk_widget_path_new ();
+
+  pos = gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+  gtk_widget_path_iter_add_class (path, pos, "background");
+
+  for (i = 0; i < PATH_DEPTH; i++)
+    {
+      pos = gtk_widget_path_append_type (path, i % 3 ? GTK_TYPE_BOX : GTK_TYPE_GRID);
+      gtk_widget_path_iter_add_class (path, pos, i % 2 ? "vertical" : "horizontal");
+    }
+
+  pos = gtk_widget_path_append_type (path, GTK_TYPE_BUTTON);
+  gtk_widget_path_iter_add_class (path, pos, "button");
+  gtk_widget_path_iter_add_class (path, pos, "suggested-action");
+
+  gtk_widget_path_append_type (path, GTK_TYPE_LABEL);
+
+  return path;
+}
+
+static void
+lookup_color (GtkCssProvider *provider,
+              GtkWidgetPath  *path,
+              GdkRGBA        *color)
+{
+  GtkStyleContext *context;
+
+  /* a new context each time, so nothing is reused between lookups */
+  context = gtk_style_context_new ();
+  gtk_style_context_add_provider (context,
+                                  GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+  gtk_style_context_set_path (context, path);
+  gtk_style_context_get_color (context, GTK_STATE_FLAG_NORMAL, color);
+  g_object_unref (context);
+}
+
+static void
+test_match_deep_path (void)
+{
+  GtkCssProvider *provider;
+  GtkWidgetPath *path;
+  GdkRGBA color, red = { 1, 0, 0, 1 };
+  guint i, n_iterations;
+  gdouble elapsed;
+
+  provider = create_theme ();
+  path = create_deep_path ();
+
+  /* Check that the only matching descendant rule is found */
+  lookup_color (provider, path, &color);
+  g_assert (gdk_rgba_equal (&color, &red));
+
+  n_iterations = g_test_perf () ? 10000 : 10;
+
+  g_test_timer_start ();
+  for (i = 0; i < n_iterations; i++)
+    lookup_color (provider, path, &color);
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_minimized_result (elapsed * 1000000 / n_iterations,
+                           "%u rules, path depth %u: %.2f µs per lookup",
+                           N_THEME_RULES, gtk_widget_path_length (path),
+                           elapsed * 1000000 / n_iterations);
+
+  gtk_widget_path_unref (path);
+  g_object_unref (provider);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/css/match/deep-path", test_match_deep_path);
+
+  return g_test_run ();
+}
@@ -0,0 +1,205 @@
+#include <gdk/gdk.h>
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
+/* More than the motion history keeps */
+#define N_MOTIONS 1100
+#define MAX_MOTION_HISTORY 1024
+
+#ifdef GDK_WINDOWING_X11
+/* Sends a run of motion events that are all queued before any of them
+ * is handled, so they get compressed. The time of each event is its
+ * position in the run, starting at 1. */
+static void
+send_motions (GdkWindow *window,
+              guint      n_motions)
+{
+  Display *xdisplay;
+  XMotionEvent xev = { 0, };
+  guint i;
+
+  xdisplay = GDK_WINDOW_XDISPLAY (window);
+
+  xev.type = MotionNotify;
+  xev.display = xdisplay;
+  xev.window = GDK_WINDOW_XID (window);
+  xev.root = GDK_WINDOW_XID (gdk_screen_get_root_window (gdk_window_get_screen (window)));
+  xev.subwindow = None;
+  xev.same_screen = True;
+
+  for (i = 1; i <= n_motions; i++)
+    {
+      xev.time = i;
+      xev.x = i % 100;
+      xev.y = 50;
+      XSendEvent (xdisplay, xev.window, False, PointerMotionMask, (XEvent *) &xev);
+    }
+
+  XSync (xdisplay, False);
+}
+
+static void
+motion_handler (GdkEvent *event,
+                gpointer  data)
+{
+  GdkEvent **motion = data;
+
+  if (event->type == GDK_MOTION_NOTIFY && *motion == NULL)
+    *motion = gdk_event_copy (event);
+}
+
+static gboolean
+motion_timeout (gpointer data)
+{
+  g_assert_not_reached ();
+
+  return G_SOURCE_REMOVE;
+}
+
+/* A run of motion events at the end of the queue is held back until
+ * the frame clock flushes the events, so let the main loop deliver
+ * them instead of taking them from the queue */
+static GdkEvent *
+get_motion_event (void)
+{
+  GdkEvent *motion = NULL;
+  guint id;
+
+  gdk_event_handler_set (motion_handler, &motion, NULL);
+  id = g_timeout_add_seconds (5, motion_timeout, NULL);
+
+  while (motion == NULL)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_source_remove (id);
+  gdk_event_handler_set (NULL, NULL, NULL);
+
+  return motion;
+}
+
+static void
+check_history (GdkEvent *event,
+               guint     n_motions)
+{
+  GList *history, *l;
+  guint n_history, time;
+
+  g_assert_cmpuint (gdk_event_get_time (event), ==, n_motions);
+
+  history = gdk_event_get_motion_history (event);
+  n_history = g_list_length (history);
+  g_assert_cmpuint (n_history, ==, MIN (n_motions - 1, MAX_MOTION_HISTORY));
+
+  /* oldest first, and only the oldest ones are dropped */
+  time = n_motions - n_history;
+  for (l = history; l; l = l->next)
+    {
+      GdkEvent *motion = l->data;
+
+      g_assert (motion != event);
+      g_assert_cmpint (motion->type, ==, GDK_MOTION_NOTIFY);
+      g_assert_cmpuint (gdk_event_get_time (motion), ==, time);
+      time++;
+    }
+  g_assert_cmpuint (time, ==, n_motions);
+
+  g_list_free (history);
+}
+
+static GdkWindow *
+create_window (void)
+{
+  GdkWindowAttr attributes = { 0, };
+
+  attributes.window_type = GDK_WINDOW_TOPLEVEL;
+  attributes.wclass = GDK_INPUT_OUTPUT;
+  attributes.width = 100;
+  attributes.height = 100;
+  attributes.event_mask = GDK_POINTER_MOTION_MASK;
+
+  return gdk_window_new (NULL, &attributes, 0);
+}
+#endif
+
+static void
+test_motion_history (void)
+{
+#ifdef GDK_WINDOWING_X11
+  GdkDisplay *display;
+  GdkWindow *window;
+  GdkEvent *event, *copy;
+  GList *history, *copied_history, *l, *m;
+
+  display = gdk_display_get_default ();
+  if (!GDK_IS_X11_DISPLAY (display))
+    return;
+
+  window = create_window ();
+  gdk_window_show (window);
+  gdk_display_sync (display);
+
+  /* a few motions keep all of the others */
+  send_motions (window, 5);
+  event = get_motion_event ();
+  check_history (event, 5);
+  gdk_event_free (event);
+
+  /* many motions only keep the most recent ones */
+  send_motions (window, N_MOTIONS);
+  event = get_motion_event ();
+  check_history (event, N_MOTIONS);
+
+  /* copies get their own history */
+  copy = gdk_event_copy (event);
+  history = gdk_event_get_motion_history (event);
+  copied_history = gdk_event_get_motion_history (copy);
+  g_assert_cmpuint (g_list_length (copied_history), ==, g_list_length (history));
+  for (l = history, m = copied_history; l; l = l->next, m = m->next)
+    {
+      g_assert (l->data != m->data);
+      g_assert_cmpuint (gdk_event_get_time (l->data), ==, gdk_event_get_time (m->data));
+    }
+  g_list_free (history);
+  g_list_free (copied_history);
+
+  /* and keep it when the original goes away */
+  gdk_event_free (event);
+  check_history (copy, N_MOTIONS);
+  gdk_event_free (copy);
+
+  gdk_window_destroy (window);
+#endif
+}
+
+static void
+test_no_motion_history (void)
+{
+  GdkEvent *event, *copy;
+
+  /* events that were never queued have no history */
+  event = gdk_event_new (GDK_MOTION_NOTIFY);
+  g_assert (gdk_event_get_motion_history (event) == NULL);
+
+  copy = gdk_event_copy (event);
+  g_assert (gdk_event_get_motion_history (copy) == NULL);
+
+  gdk_event_free (copy);
+  gdk_event_free (event);
+
+  event = gdk_event_new (GDK_BUTTON_PRESS);
+  g_assert (gdk_event_get_motion_history (event) == NULL);
+  gdk_event_free (event);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  gdk_init (&argc, &argv);
+
+  g_test_add_func ("/events/motion-history", test_motion_history);
+  g_test_add_func ("/events/no-motion-history", test_no_motion_history);
+
+  return g_test_run ();
+}
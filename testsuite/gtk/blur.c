@@ -0,0 +1,198 @@
+/* Blur tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "../../gtk/gtkcairoblurprivate.h"
+
+#define APREC 16
+#define ZPREC 7
+
+/* The blur as it was before the column pass handled all columns
+ * at once, one channel and one pixel at a time. */
+static void
+reference_blur_pixel (guchar *pixel,
+                      gint   *z,
+                      gint    alpha)
+{
+  *z += (alpha * ((*pixel << ZPREC) - *z)) >> APREC;
+  *pixel = *z >> ZPREC;
+}
+
+static void
+reference_blur (guchar *pixels,
+                gint    width,
+                gint    height,
+                gint    rowstride,
+                gint    channels,
+                double  radius)
+{
+  gint alpha, x, y, c, z;
+
+  alpha = (gint) ((1 << APREC) * (1.0f - expf (-2.3f / (radius + 1.f))));
+
+  for (y = 0; y < height; y++)
+    for (c = 0; c < channels; c++)
+      {
+        guchar *row = pixels + y * rowstride + c;
+
+        z = row[0] << ZPREC;
+        for (x = 0; x < width; x++)
+          reference_blur_pixel (&row[x * channels], &z, alpha);
+        for (x = width - 2; x >= 0; x--)
+          reference_blur_pixel (&row[x * channels], &z, alpha);
+      }
+
+  for (x = 0; x < width; x++)
+    for (c = 0; c < channels; c++)
+      {
+        guchar *column = pixels + x * channels + c;
+
+        z = column[0] << ZPREC;
+        for (y = 0; y < height; y++)
+          reference_blur_pixel (&column[y * rowstride], &z, alpha);
+        for (y = height - 2; y >= 0; y--)
+          reference_blur_pixel (&column[y * rowstride], &z, alpha);
+      }
+}
+
+static cairo_surface_t *
+create_random_surface (cairo_format_t format,
+                       gint           width,
+                       gint           height)
+{
+  cairo_surface_t *surface;
+  guchar *data;
+  gint stride, i;
+
+  surface = cairo_image_surface_create (format, width, height);
+  cairo_surface_flush (surface);
+
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  for (i = 0; i < stride * height; i++)
+    data[i] = g_test_rand_int_range (0, 256);
+
+  cairo_surface_mark_dirty (surface);
+
+  return surface;
+}
+
+static void
+check_blur (cairo_format_t format,
+            gint           width,
+            gint           height,
+            double         radius)
+{
+  cairo_surface_t *surface;
+  guchar *expected;
+  gint stride, y;
+
+  surface = create_random_surface (format, width, height);
+  stride = cairo_image_surface_get_stride (surface);
+  expected = g_memdup (cairo_image_surface_get_data (surface), stride * height);
+
+  reference_blur (expected, width, height, stride,
+                  format == CAIRO_FORMAT_A8 ? 1 : 4,
+                  radius);
+  _gtk_cairo_blur_surface (surface, radius);
+
+  /* the padding at the end of the rows is undefined */
+  for (y = 0; y < height; y++)
+    g_assert (memcmp (cairo_image_surface_get_data (surface) + y * stride,
+                      expected + y * stride,
+                      width * (format == CAIRO_FORMAT_A8 ? 1 : 4)) == 0);
+
+  g_free (expected);
+  cairo_surface_destroy (surface);
+}
+
+static void
+test_argb32 (void)
+{
+  check_blur (CAIRO_FORMAT_ARGB32, 1, 1, 3);
+  check_blur (CAIRO_FORMAT_ARGB32, 37, 23, 1);
+  check_blur (CAIRO_FORMAT_ARGB32, 64, 64, 10);
+}
+
+static void
+test_a8 (void)
+{
+  check_blur (CAIRO_FORMAT_A8, 1, 1, 3);
+  check_blur (CAIRO_FORMAT_A8, 37, 23, 1);
+  check_blur (CAIRO_FORMAT_A8, 64, 64, 10);
+}
+
+/* Shadows are blurred in A8 masks. That must give the same coverage
+ * as blurring the alpha channel of an ARGB32 surface. */
+static void
+test_a8_matches_argb32 (void)
+{
+  cairo_surface_t *a8, *argb32;
+  guchar *a8_data, *argb32_data;
+  gint x, y;
+  cairo_t *cr;
+
+  a8 = cairo_image_surface_create (CAIRO_FORMAT_A8, 40, 30);
+  argb32 = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 40, 30);
+
+  cr = cairo_create (a8);
+  cairo_rectangle (cr, 10, 8, 17, 11);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  cr = cairo_create (argb32);
+  cairo_rectangle (cr, 10, 8, 17, 11);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  _gtk_cairo_blur_surface (a8, 5);
+  _gtk_cairo_blur_surface (argb32, 5);
+
+  cairo_surface_flush (a8);
+  cairo_surface_flush (argb32);
+  a8_data = cairo_image_surface_get_data (a8);
+  argb32_data = cairo_image_surface_get_data (argb32);
+
+  for (y = 0; y < 30; y++)
+    for (x = 0; x < 40; x++)
+      {
+        guint32 pixel = ((guint32 *) (argb32_data + y * cairo_image_surface_get_stride (argb32)))[x];
+
+        g_assert_cmpuint (a8_data[y * cairo_image_surface_get_stride (a8) + x], ==, pixel >> 24);
+      }
+
+  /* the blur spreads outside of the rectangle */
+  g_assert_cmpuint (a8_data[12 * cairo_image_surface_get_stride (a8) + 8], >, 0);
+
+  cairo_surface_destroy (a8);
+  cairo_surface_destroy (argb32);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/blur/argb32", test_argb32);
+  g_test_add_func ("/blur/a8", test_a8);
+  g_test_add_func ("/blur/a8-matches-argb32", test_a8_matches_argb32);
+
+  return g_test_run ();
+}
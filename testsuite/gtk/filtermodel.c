@@ -2424,6 +2424,168 @@ insert_before (void)
   gtk_widget_destroy (tree_view);
 }
 
+static gboolean
+update_visible_func (GtkTreeModel *model,
+                     GtkTreeIter  *iter,
+                     gpointer      data)
+{
+  gint *threshold = data;
+  gint value;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value < *threshold;
+}
+
+static void
+update_visible_test (gboolean queue)
+{
+  GtkTreeStore *store;
+  GtkTreeModel *filter;
+  GtkWidget *tree_view;
+  SignalMonitor *monitor;
+  gint threshold = 5;
+  gint i;
+
+  store = gtk_tree_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 10; i++)
+    gtk_tree_store_insert_with_values (store, NULL, NULL, i, 0, i, -1);
+
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          update_visible_func,
+                                          &threshold, NULL);
+
+  tree_view = gtk_tree_view_new_with_model (filter);
+  monitor = signal_monitor_new (filter);
+
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), NULL, 5);
+
+  /* Rows that stay visible get no signals */
+  threshold = 3;
+  signal_monitor_append_signal (monitor, ROW_DELETED, "3");
+  signal_monitor_append_signal (monitor, ROW_DELETED, "3");
+
+  if (queue)
+    {
+      gtk_tree_model_filter_queue_update_visible (GTK_TREE_MODEL_FILTER (filter));
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+    }
+  else
+    gtk_tree_model_filter_update_visible (GTK_TREE_MODEL_FILTER (filter));
+
+  signal_monitor_assert_is_empty (monitor);
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), NULL, 3);
+
+  threshold = 7;
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "3");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "4");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "5");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "6");
+
+  if (queue)
+    {
+      gtk_tree_model_filter_queue_update_visible (GTK_TREE_MODEL_FILTER (filter));
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+    }
+  else
+    gtk_tree_model_filter_update_visible (GTK_TREE_MODEL_FILTER (filter));
+
+  signal_monitor_assert_is_empty (monitor);
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), NULL, 7);
+
+  signal_monitor_free (monitor);
+  gtk_widget_destroy (tree_view);
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
+static void
+update_visible (void)
+{
+  update_visible_test (FALSE);
+}
+
+static void
+queue_update_visible (void)
+{
+  update_visible_test (TRUE);
+}
+
+static gboolean
+slow_visible_func (GtkTreeModel *model,
+                   GtkTreeIter  *iter,
+                   gpointer      data)
+{
+  /* Make every idle slice end after its first check of the time */
+  g_usleep (100);
+
+  return update_visible_func (model, iter, data);
+}
+
+static void
+queue_update_visible_levels (void)
+{
+  GtkTreeStore *store;
+  GtkTreeModel *filter;
+  GtkWidget *tree_view;
+  GtkTreeIter parent, iter;
+  gint threshold = 10;
+  gint i, j;
+
+  store = gtk_tree_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 200; i++)
+    {
+      gtk_tree_store_insert_with_values (store, &parent, NULL, i, 0, 0, -1);
+      for (j = 0; j < 4; j++)
+        gtk_tree_store_insert_with_values (store, NULL, &parent, j, 0, j * 3, -1);
+    }
+
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          slow_visible_func,
+                                          &threshold, NULL);
+
+  tree_view = gtk_tree_view_new_with_model (filter);
+  gtk_tree_view_expand_all (GTK_TREE_VIEW (tree_view));
+
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), NULL, 200);
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), "1", 4);
+
+  threshold = 5;
+  gtk_tree_model_filter_queue_update_visible (GTK_TREE_MODEL_FILTER (filter));
+
+  /* The root level is only partially walked after the first slice.
+   * Inserting a row makes it start over, walking rows whose child
+   * levels were already queued.
+   */
+  g_main_context_iteration (NULL, FALSE);
+  gtk_tree_store_insert_with_values (store, &iter, NULL, 0, 0, 0, -1);
+  g_main_context_iteration (NULL, FALSE);
+
+  /* Free one of those queued child levels */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1);
+  gtk_tree_store_remove (store, &iter);
+
+  while (g_main_context_pending (NULL))
+    g_main_context_iteration (NULL, FALSE);
+
+  check_level_length (GTK_TREE_MODEL_FILTER (filter), NULL, 200);
+  for (i = 1; i < 200; i++)
+    {
+      gchar *level = g_strdup_printf ("%d", i);
+
+      check_level_length (GTK_TREE_MODEL_FILTER (filter), level, 2);
+      g_free (level);
+    }
+
+  gtk_widget_destroy (tree_view);
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 static void
 insert_child (void)
 {
@@ -7022,6 +7184,13 @@ register_filter_model_tests (void)
   g_test_add_func ("/TreeModelFilter/insert/child",
                    insert_child);
 
+  g_test_add_func ("/TreeModelFilter/update-visible/sync",
+                   update_visible);
+  g_test_add_func ("/TreeModelFilter/update-visible/queued",
+                   queue_update_visible);
+  g_test_add_func ("/TreeModelFilter/update-visible/queued-levels",
+                   queue_update_visible_levels);
+
   /* Removals from child model after creating of filter model */
   g_test_add_func ("/TreeModelFilter/remove/node",
                    remove_node);
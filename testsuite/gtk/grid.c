@@ -223,6 +223,88 @@ test_add (void)
   g_assert_cmpint (height, ==, 1);
 }
 
+static GtkWidget *
+create_measure_label (gint i)
+{
+  static const gchar *texts[] = {
+    "Short",
+    "A somewhat longer label that will wrap when it gets narrow",
+    "Two\nlines",
+    "Label with <b>markup</b> and a few more words to wrap"
+  };
+  GtkWidget *label;
+
+  label = gtk_label_new (NULL);
+  gtk_label_set_markup (GTK_LABEL (label), texts[i % G_N_ELEMENTS (texts)]);
+  gtk_label_set_line_wrap (GTK_LABEL (label), i % 2 == 1);
+  if (i % 3 == 0)
+    gtk_label_set_width_chars (GTK_LABEL (label), 10);
+  if (i % 5 == 0)
+    gtk_label_set_max_width_chars (GTK_LABEL (label), 20);
+  gtk_widget_show (label);
+
+  return label;
+}
+
+/* test that measuring labels in parallel gives the
+ * same sizes as measuring them one after the other
+ */
+static void
+test_parallel_measure_subprocess (void)
+{
+  GtkWidget *grid, *sequential_grid, *label;
+  GtkSizeGroup *group;
+  gint min, nat, expected_min, expected_nat;
+  gint i;
+
+  grid = gtk_grid_new ();
+  g_object_ref_sink (grid);
+  sequential_grid = gtk_grid_new ();
+  g_object_ref_sink (sequential_grid);
+
+  for (i = 0; i < 40; i++)
+    {
+      gtk_grid_attach (GTK_GRID (grid), create_measure_label (i), 0, i, 1, 1);
+
+      /* Widgets in size groups are never measured in parallel */
+      label = create_measure_label (i);
+      group = gtk_size_group_new (GTK_SIZE_GROUP_BOTH);
+      gtk_size_group_add_widget (group, label);
+      g_object_unref (group);
+      gtk_grid_attach (GTK_GRID (sequential_grid), label, 0, i, 1, 1);
+    }
+
+  gtk_widget_get_preferred_width (grid, &min, &nat);
+  gtk_widget_get_preferred_width (sequential_grid, &expected_min, &expected_nat);
+  g_assert_cmpint (min, ==, expected_min);
+  g_assert_cmpint (nat, ==, expected_nat);
+
+  gtk_widget_get_preferred_height (grid, &min, &nat);
+  gtk_widget_get_preferred_height (sequential_grid, &expected_min, &expected_nat);
+  g_assert_cmpint (min, ==, expected_min);
+  g_assert_cmpint (nat, ==, expected_nat);
+
+  gtk_widget_get_preferred_height_for_width (grid, 100, &min, &nat);
+  gtk_widget_get_preferred_height_for_width (sequential_grid, 100, &expected_min, &expected_nat);
+  g_assert_cmpint (min, ==, expected_min);
+  g_assert_cmpint (nat, ==, expected_nat);
+
+  g_object_unref (grid);
+  g_object_unref (sequential_grid);
+}
+
+/* The thread pool is set up once per process, so only enable it
+ * for a process of its own */
+static void
+test_parallel_measure (void)
+{
+  g_setenv ("GTK_MEASURE_THREADS", "4", TRUE);
+  g_test_trap_subprocess ("/grid/parallel-measure/subprocess", 0, 0);
+  g_unsetenv ("GTK_MEASURE_THREADS");
+
+  g_test_trap_assert_passed ();
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -231,6 +313,8 @@ main (int   argc,
 
   g_test_add_func ("/grid/attach", test_attach);
   g_test_add_func ("/grid/add", test_add);
+  g_test_add_func ("/grid/parallel-measure", test_parallel_measure);
+  g_test_add_func ("/grid/parallel-measure/subprocess", test_parallel_measure_subprocess);
 
   return g_test_run();
 }
@@ -472,6 +472,119 @@ list_store_set_gvalue_to_transform (void)
   gtk_list_store_set_value (store, &iter, 0, &value);
 }
 
+static void
+fill_row_values (GValue *values,
+                 gint    i)
+{
+  gchar *text;
+
+  g_value_init (&values[0], G_TYPE_INT);
+  g_value_set_int (&values[0], i);
+  text = g_strdup_printf ("row %d", i % 3);
+  g_value_init (&values[1], G_TYPE_STRING);
+  g_value_take_string (&values[1], text);
+}
+
+static void
+check_row (GtkListStore *store,
+           gint          position,
+           gint          i)
+{
+  GtkTreeIter iter;
+  gint number;
+  gchar *text, *expected;
+
+  g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, position));
+  gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &number, 1, &text, -1);
+  expected = g_strdup_printf ("row %d", i % 3);
+  g_assert_cmpint (number, ==, i);
+  g_assert_cmpstr (text, ==, expected);
+  g_free (expected);
+  g_free (text);
+}
+
+static void
+row_inserted_count (GtkTreeModel *model,
+                    GtkTreePath  *path,
+                    GtkTreeIter  *iter,
+                    gint         *count)
+{
+  (*count)++;
+}
+
+static void
+list_store_test_insert_rows (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GValue values[20] = { G_VALUE_INIT, };
+  gint columns[] = { 0, 1 };
+  gint i, count = 0;
+
+  store = gtk_list_store_new (2, G_TYPE_INT, G_TYPE_STRING);
+
+  for (i = 0; i < 10; i++)
+    fill_row_values (&values[i * 2], i);
+
+  /* nothing is connected, no signals needed */
+  gtk_list_store_insert_rows (store, -1, 5, columns, values, 2);
+
+  g_signal_connect (store, "row-inserted", G_CALLBACK (row_inserted_count), &count);
+  gtk_list_store_insert_rows (store, 0, 5, columns, values + 10, 2);
+  g_assert_cmpint (count, ==, 5);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 10);
+  for (i = 0; i < 5; i++)
+    {
+      check_row (store, i, i + 5);
+      check_row (store, i + 5, i);
+    }
+
+  /* slots of removed rows are reused */
+  g_assert (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter));
+  gtk_list_store_remove (store, &iter);
+  gtk_list_store_insert_rows (store, -1, 1, columns, values + 10, 2);
+  check_row (store, 9, 5);
+
+  for (i = 0; i < 20; i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
+static void
+list_store_test_set_rows (void)
+{
+  GtkListStore *store;
+  GValue values[20] = { G_VALUE_INIT, };
+  gint columns[] = { 0, 1 };
+  gint i;
+
+  store = gtk_list_store_new (2, G_TYPE_INT, G_TYPE_STRING);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store),
+                                        0, GTK_SORT_DESCENDING);
+
+  for (i = 0; i < 10; i++)
+    fill_row_values (&values[i * 2], i);
+
+  gtk_list_store_insert_rows (store, -1, 5, columns, values, 2);
+  for (i = 0; i < 5; i++)
+    check_row (store, i, 4 - i);
+
+  /* replace rows 1-3, resorting once afterwards */
+  gtk_list_store_set_rows (store, 1, 3, columns, values + 10, 2);
+  check_row (store, 0, 7);
+  check_row (store, 1, 6);
+  check_row (store, 2, 5);
+  check_row (store, 3, 4);
+  check_row (store, 4, 0);
+
+  for (i = 0; i < 20; i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
 /* removal */
 static void
 list_store_test_remove_begin (ListStore     *fixture,
@@ -1037,6 +1150,10 @@ register_list_store_tests (void)
   /* setting values (FIXME) */
   g_test_add_func ("/ListStore/set-gvalue-to-transform",
                    list_store_set_gvalue_to_transform);
+  g_test_add_func ("/ListStore/insert-rows",
+                   list_store_test_insert_rows);
+  g_test_add_func ("/ListStore/set-rows",
+                   list_store_test_set_rows);
 
   /* removal */
   g_test_add ("/ListStore/remove-begin", ListStore, NULL,
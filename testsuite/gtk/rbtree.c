@@ -507,6 +507,88 @@ test_reorder (void)
   _gtk_rbtree_free (tree);
 }
 
+static void
+test_large (void)
+{
+  guint n = g_test_perf () ? 10000000 : 1000;
+  GtkRBTree *tree, *found_tree;
+  GtkRBNode *node, *found_node;
+  guint i, index;
+  double elapsed;
+
+  tree = _gtk_rbtree_new ();
+
+  g_test_timer_start ();
+
+  node = NULL;
+  for (i = 0; i < n; i++)
+    node = _gtk_rbtree_insert_after (tree, node, 1, TRUE);
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "appending %u items to rbtree: %gsec", n, elapsed);
+
+  if (!g_test_perf ())
+    _gtk_rbtree_test (tree);
+
+  /* Stride through the rows so lookups don't share a path */
+  g_test_timer_start ();
+
+  for (i = 0, index = 0; i < n; i++, index = (index + 7919) % n)
+    {
+      g_assert (_gtk_rbtree_find_offset (tree, index, &found_tree, &found_node) == 0);
+      g_assert (found_tree == tree);
+      g_assert (_gtk_rbtree_node_get_index (tree, found_node) == index);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "looking up %u offsets in rbtree: %gsec", n, elapsed);
+
+  g_test_timer_start ();
+
+  for (i = 0, index = 0; i < n; i++, index = (index + 7919) % n)
+    {
+      g_assert (_gtk_rbtree_find_index (tree, index, &found_tree, &found_node));
+      g_assert (_gtk_rbtree_node_find_offset (tree, found_node) == index);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "looking up %u indexes in rbtree: %gsec", n, elapsed);
+
+  g_test_timer_start ();
+
+  for (node = _gtk_rbtree_first (tree), i = 0;
+       node != NULL;
+       node = _gtk_rbtree_next (tree, node), i++)
+    ;
+  g_assert (i == n);
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "walking %u items in rbtree: %gsec", n, elapsed);
+
+  /* Remove every other row, then reuse the freed nodes */
+  for (node = _gtk_rbtree_first (tree); node != NULL; )
+    {
+      GtkRBNode *next = _gtk_rbtree_next (tree, node);
+
+      _gtk_rbtree_remove_node (tree, node);
+      node = next ? _gtk_rbtree_next (tree, next) : NULL;
+    }
+  g_assert (tree->root->count == n / 2);
+
+  for (i = 0; i < n - n / 2; i++)
+    _gtk_rbtree_insert_before (tree, _gtk_rbtree_first (tree), 1, TRUE);
+  g_assert (tree->root->count == n);
+
+  if (!g_test_perf ())
+    _gtk_rbtree_test (tree);
+
+  _gtk_rbtree_free (tree);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -520,6 +602,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/rbtree/remove_node", test_remove_node);
   g_test_add_func ("/rbtree/remove_root", test_remove_root);
   g_test_add_func ("/rbtree/reorder", test_reorder);
+  g_test_add_func ("/rbtree/large", test_large);
 
   return g_test_run ();
 }
@@ -17,6 +17,7 @@
  * License along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
@@ -159,6 +160,70 @@ recent_manager_add_many (void)
   g_object_unref (manager);
 
   g_assert_cmpint (g_unlink ("recently-used.xbel"), ==, 0);
+  g_assert_cmpint (g_unlink ("recently-used.xbel.journal"), ==, 0);
+}
+
+static void
+quit_loop (GtkRecentManager *manager,
+           gpointer          data)
+{
+  g_main_loop_quit (data);
+}
+
+static void
+recent_manager_journal (void)
+{
+  GtkRecentManager *manager, *manager2;
+  GtkRecentData data = { NULL, NULL, "text/plain", "testrecentchooser", "testrecentchooser %u", NULL, FALSE };
+  GMainLoop *loop;
+  gchar *contents;
+  gsize length;
+  gulong id;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                          "filename", "recently-used-journal.xbel",
+                          NULL);
+  id = g_signal_connect (manager, "changed", G_CALLBACK (quit_loop), loop);
+
+  /* the first change writes the file, the next one goes to
+   * the journal */
+  gtk_recent_manager_add_full (manager, uri, &data);
+  g_main_loop_run (loop);
+  gtk_recent_manager_add_full (manager, uri2, &data);
+  g_main_loop_run (loop);
+
+  g_assert (g_file_get_contents ("recently-used-journal.xbel.journal", &contents, &length, NULL));
+  g_assert (g_strstr_len (contents, length, uri2) != NULL);
+  g_free (contents);
+
+  /* and the file is not written again for it */
+  g_assert (g_file_get_contents ("recently-used-journal.xbel", &contents, NULL, NULL));
+  g_assert (strstr (contents, uri) != NULL);
+  g_assert (strstr (contents, uri2) == NULL);
+  g_free (contents);
+
+  /* other instances see both */
+  manager2 = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                           "filename", "recently-used-journal.xbel",
+                           NULL);
+  g_assert (gtk_recent_manager_has_item (manager2, uri));
+  g_assert (gtk_recent_manager_has_item (manager2, uri2));
+  g_object_unref (manager2);
+
+  g_signal_handler_disconnect (manager, id);
+  g_object_unref (manager);
+  g_main_loop_unref (loop);
+
+  /* going away writes the journalled changes to the file, for
+   * readers that don't know about the journal */
+  g_assert (g_file_get_contents ("recently-used-journal.xbel", &contents, NULL, NULL));
+  g_assert (strstr (contents, uri) != NULL);
+  g_assert (strstr (contents, uri2) != NULL);
+  g_free (contents);
+
+  g_assert_cmpint (g_unlink ("recently-used-journal.xbel"), ==, 0);
+  g_assert_cmpint (g_unlink ("recently-used-journal.xbel.journal"), ==, 0);
 }
 
 static void
@@ -303,6 +368,7 @@ main (int    argc,
   g_test_add_func ("/recent-manager/get-default", recent_manager_get_default);
   g_test_add_func ("/recent-manager/add", recent_manager_add);
   g_test_add_func ("/recent-manager/add-many", recent_manager_add_many);
+  g_test_add_func ("/recent-manager/journal", recent_manager_journal);
   g_test_add_func ("/recent-manager/has-item", recent_manager_has_item);
   g_test_add_func ("/recent-manager/move-item", recent_manager_move_item);
   g_test_add_func ("/recent-manager/lookup-item", recent_manager_lookup_item);
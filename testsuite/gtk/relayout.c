@@ -0,0 +1,220 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2013 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+/* These tests change how a container lays out a child whose own
+ * request stays the same, after the first layout, and check that
+ * the change is applied.
+ */
+
+static gboolean
+stop_main (gpointer data)
+{
+  gtk_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+wait_for_layout (void)
+{
+  g_timeout_add (200, stop_main, NULL);
+  gtk_main ();
+}
+
+static GtkWidget *
+create_window (GtkWidget *child)
+{
+  GtkWidget *window;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 300);
+  gtk_container_add (GTK_CONTAINER (window), child);
+  gtk_widget_show_all (window);
+
+  wait_for_layout ();
+
+  return window;
+}
+
+static void
+test_box_reorder (void)
+{
+  GtkWidget *window, *box, *a, *b;
+  GtkAllocation alloc_a, alloc_b;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  a = gtk_label_new ("Same");
+  b = gtk_label_new ("Same");
+  gtk_box_pack_start (GTK_BOX (box), a, FALSE, FALSE, 0);
+  gtk_box_pack_start (GTK_BOX (box), b, FALSE, FALSE, 0);
+  window = create_window (box);
+
+  gtk_widget_get_allocation (a, &alloc_a);
+  gtk_widget_get_allocation (b, &alloc_b);
+  g_assert_cmpint (alloc_a.x, <, alloc_b.x);
+
+  gtk_box_reorder_child (GTK_BOX (box), b, 0);
+  wait_for_layout ();
+
+  gtk_widget_get_allocation (a, &alloc_a);
+  gtk_widget_get_allocation (b, &alloc_b);
+  g_assert_cmpint (alloc_b.x, <, alloc_a.x);
+
+  gtk_widget_destroy (window);
+}
+
+static void
+test_box_packing (void)
+{
+  GtkWidget *window, *box, *a, *b;
+  gint width;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  a = gtk_label_new ("A");
+  b = gtk_label_new ("B");
+  gtk_box_pack_start (GTK_BOX (box), a, FALSE, FALSE, 0);
+  gtk_box_pack_start (GTK_BOX (box), b, FALSE, FALSE, 0);
+  window = create_window (box);
+
+  width = gtk_widget_get_allocated_width (a);
+
+  gtk_box_set_child_packing (GTK_BOX (box), a, TRUE, TRUE, 0, GTK_PACK_START);
+  wait_for_layout ();
+
+  g_assert_cmpint (gtk_widget_get_allocated_width (a), >, width);
+
+  gtk_widget_destroy (window);
+}
+
+static void
+test_grid_attach (void)
+{
+  GtkWidget *window, *grid, *a, *b;
+  GtkAllocation alloc_a, alloc_b;
+
+  grid = gtk_grid_new ();
+  a = gtk_label_new ("Same");
+  b = gtk_label_new ("Same");
+  gtk_grid_attach (GTK_GRID (grid), a, 0, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (grid), b, 1, 0, 1, 1);
+  window = create_window (grid);
+
+  gtk_widget_get_allocation (a, &alloc_a);
+  gtk_widget_get_allocation (b, &alloc_b);
+  g_assert_cmpint (alloc_a.y, ==, alloc_b.y);
+
+  gtk_container_child_set (GTK_CONTAINER (grid), b,
+                           "left-attach", 0,
+                           "top-attach", 1,
+                           NULL);
+  wait_for_layout ();
+
+  gtk_widget_get_allocation (a, &alloc_a);
+  gtk_widget_get_allocation (b, &alloc_b);
+  g_assert_cmpint (alloc_a.x, ==, alloc_b.x);
+  g_assert_cmpint (alloc_a.y, <, alloc_b.y);
+
+  gtk_widget_destroy (window);
+}
+
+static void
+test_hexpand (void)
+{
+  GtkWidget *window, *box, *a, *b;
+  gint width;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  a = gtk_label_new ("A");
+  b = gtk_label_new ("B");
+  gtk_container_add (GTK_CONTAINER (box), a);
+  gtk_container_add (GTK_CONTAINER (box), b);
+  window = create_window (box);
+
+  width = gtk_widget_get_allocated_width (a);
+
+  gtk_widget_set_hexpand (a, TRUE);
+  wait_for_layout ();
+
+  g_assert_cmpint (gtk_widget_get_allocated_width (a), >, width);
+
+  gtk_widget_destroy (window);
+}
+
+static void
+count_allocations (GtkWidget     *widget,
+                   GtkAllocation *allocation,
+                   gpointer       data)
+{
+  guint *n_allocations = data;
+
+  (*n_allocations)++;
+}
+
+/* A scrolled window requests the same size whatever its content is,
+ * so changing a label inside it must not lay out anything outside
+ */
+static void
+test_scrolled_boundary (void)
+{
+  GtkWidget *window, *box, *scrolled, *label, *sibling;
+  GtkAllocation alloc_sibling, alloc;
+  guint n_allocations = 0;
+  gint width;
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  scrolled = gtk_scrolled_window_new (NULL, NULL);
+  label = gtk_label_new ("Short");
+  gtk_scrolled_window_add_with_viewport (GTK_SCROLLED_WINDOW (scrolled), label);
+  sibling = gtk_label_new ("Sibling");
+  gtk_box_pack_start (GTK_BOX (box), scrolled, TRUE, TRUE, 0);
+  gtk_box_pack_start (GTK_BOX (box), sibling, FALSE, FALSE, 0);
+  window = create_window (box);
+
+  width = gtk_widget_get_allocated_width (label);
+  gtk_widget_get_allocation (sibling, &alloc_sibling);
+  g_signal_connect (sibling, "size-allocate",
+                    G_CALLBACK (count_allocations), &n_allocations);
+
+  gtk_label_set_text (GTK_LABEL (label),
+                      "A much longer text that does not fit into the scrolled window");
+  wait_for_layout ();
+
+  g_assert_cmpint (gtk_widget_get_allocated_width (label), >, width);
+  g_assert_cmpuint (n_allocations, ==, 0);
+  gtk_widget_get_allocation (sibling, &alloc);
+  g_assert_cmpint (alloc.x, ==, alloc_sibling.x);
+  g_assert_cmpint (alloc.width, ==, alloc_sibling.width);
+
+  gtk_widget_destroy (window);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/relayout/box-reorder", test_box_reorder);
+  g_test_add_func ("/relayout/box-packing", test_box_packing);
+  g_test_add_func ("/relayout/grid-attach", test_grid_attach);
+  g_test_add_func ("/relayout/hexpand", test_hexpand);
+  g_test_add_func ("/relayout/scrolled-boundary", test_scrolled_boundary);
+
+  return g_test_run();
+}
@@ -0,0 +1,204 @@
+/* GtkRenderCache tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../../gtk/gtkrendercacheprivate.h"
+
+/* 10x10 ARGB32 surfaces use 400 bytes, so 8 of them fit and
+ * each of them is small enough to be added */
+#define SURFACE_SIZE 10
+#define SURFACE_BYTES (SURFACE_SIZE * SURFACE_SIZE * 4)
+#define CACHE_SIZE (8 * SURFACE_BYTES)
+
+static cairo_surface_t *
+create_surface (int width,
+                int height)
+{
+  return cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+}
+
+static void
+init_key (GtkRenderCacheKey *key,
+          GObject           *owner,
+          double             width)
+{
+  key->owner = owner;
+  key->serial = 1;
+  key->width = width;
+  key->height = SURFACE_SIZE;
+  key->flags = 0;
+  key->scale = 1;
+}
+
+static gboolean
+add (GtkRenderCache *cache,
+     GObject        *owner,
+     double          width)
+{
+  GtkRenderCacheKey key;
+  cairo_surface_t *surface;
+  gboolean added;
+
+  init_key (&key, owner, width);
+  surface = create_surface (SURFACE_SIZE, SURFACE_SIZE);
+  added = _gtk_render_cache_add (cache, &key, surface, 1, 2);
+  cairo_surface_destroy (surface);
+
+  return added;
+}
+
+static gboolean
+lookup (GtkRenderCache *cache,
+        GObject        *owner,
+        double          width)
+{
+  GtkRenderCacheKey key;
+  int x_offset, y_offset;
+
+  init_key (&key, owner, width);
+  return _gtk_render_cache_lookup (cache, &key, &x_offset, &y_offset) != NULL;
+}
+
+static void
+test_hits (void)
+{
+  GtkRenderCache *cache;
+  GtkRenderCacheKey key;
+  GObject *owner;
+  guint hits, misses, n_entries;
+  int x_offset, y_offset;
+  gsize size;
+
+  cache = _gtk_render_cache_new (CACHE_SIZE);
+  owner = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_assert (!lookup (cache, owner, 1));
+  g_assert (add (cache, owner, 1));
+  g_assert (add (cache, owner, 2));
+
+  init_key (&key, owner, 1);
+  g_assert (_gtk_render_cache_lookup (cache, &key, &x_offset, &y_offset) != NULL);
+  g_assert_cmpint (x_offset, ==, 1);
+  g_assert_cmpint (y_offset, ==, 2);
+
+  /* other parameters don't match */
+  key.scale = 2;
+  g_assert (_gtk_render_cache_lookup (cache, &key, &x_offset, &y_offset) == NULL);
+
+  _gtk_render_cache_get_stats (cache, &hits, &misses, &n_entries, &size);
+  g_assert_cmpuint (hits, ==, 1);
+  g_assert_cmpuint (misses, ==, 2);
+  g_assert_cmpuint (n_entries, ==, 2);
+  g_assert_cmpuint (size, ==, 2 * SURFACE_BYTES);
+
+  g_object_unref (owner);
+  _gtk_render_cache_free (cache);
+}
+
+static void
+test_outdated (void)
+{
+  GtkRenderCache *cache;
+  GtkRenderCacheKey key;
+  GObject *owner;
+  guint n_entries;
+  int x_offset, y_offset;
+  gsize size;
+
+  cache = _gtk_render_cache_new (CACHE_SIZE);
+  owner = g_object_new (G_TYPE_OBJECT, NULL);
+
+  g_assert (add (cache, owner, 1));
+  g_assert (add (cache, owner, 2));
+
+  /* a changed owner doesn't get the old rendering */
+  init_key (&key, owner, 1);
+  key.serial = 2;
+  g_assert (_gtk_render_cache_lookup (cache, &key, &x_offset, &y_offset) == NULL);
+  _gtk_render_cache_get_stats (cache, NULL, NULL, &n_entries, NULL);
+  g_assert_cmpuint (n_entries, ==, 1);
+
+  /* and entries go away with their owner */
+  g_object_unref (owner);
+  _gtk_render_cache_get_stats (cache, NULL, NULL, &n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 0);
+  g_assert_cmpuint (size, ==, 0);
+
+  _gtk_render_cache_free (cache);
+}
+
+static void
+test_eviction (void)
+{
+  GtkRenderCache *cache;
+  cairo_surface_t *surface;
+  GtkRenderCacheKey key;
+  GObject *owner;
+  guint n_entries;
+  gsize size;
+  int i;
+
+  cache = _gtk_render_cache_new (CACHE_SIZE);
+  owner = g_object_new (G_TYPE_OBJECT, NULL);
+
+  for (i = 0; i < 8; i++)
+    g_assert (add (cache, owner, i));
+
+  /* entry 0 becomes the most recently used one, so adding
+   * another entry evicts entry 1 */
+  g_assert (lookup (cache, owner, 0));
+  g_assert (add (cache, owner, 8));
+
+  _gtk_render_cache_get_stats (cache, NULL, NULL, &n_entries, &size);
+  g_assert_cmpuint (n_entries, ==, 8);
+  g_assert_cmpuint (size, ==, CACHE_SIZE);
+  g_assert (lookup (cache, owner, 0));
+  g_assert (!lookup (cache, owner, 1));
+  g_assert (lookup (cache, owner, 2));
+
+  /* the size is computed from the pixels, including the stride,
+   * and entry 3 is evicted to make room */
+  init_key (&key, owner, 9);
+  surface = create_surface (1, 2);
+  g_assert (_gtk_render_cache_add (cache, &key, surface, 0, 0));
+  _gtk_render_cache_get_stats (cache, NULL, NULL, NULL, &size);
+  g_assert_cmpuint (size, ==, 7 * SURFACE_BYTES +
+                    2 * cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, 1));
+  cairo_surface_destroy (surface);
+
+  /* surfaces that would evict too much are not added */
+  init_key (&key, owner, 10);
+  surface = create_surface (SURFACE_SIZE, 2 * SURFACE_SIZE);
+  g_assert (!_gtk_render_cache_add (cache, &key, surface, 0, 0));
+  g_assert (!lookup (cache, owner, 10));
+  cairo_surface_destroy (surface);
+
+  g_object_unref (owner);
+  _gtk_render_cache_free (cache);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rendercache/hits", test_hits);
+  g_test_add_func ("/rendercache/outdated", test_outdated);
+  g_test_add_func ("/rendercache/eviction", test_eviction);
+
+  return g_test_run ();
+}
@@ -0,0 +1,378 @@
+/* GtkSearchIndex tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <utime.h>
+
+#include <glib/gstdio.h>
+
+#include "../../gtk/gtksearchindexprivate.h"
+#include "testutils.h"
+
+/* Directories that changed within the last second are always read
+ * again, so the trees get modification times in the past. If the
+ * time doesn't change, the index can't know the directory did.
+ */
+#define OLD_TIME 1000000000
+#define NEWER_TIME 1000000100
+
+static gchar *tmp_dir;
+
+static void
+set_mtime (const gchar *path,
+           time_t       mtime)
+{
+  struct utimbuf buf;
+
+  buf.actime = mtime;
+  buf.modtime = mtime;
+  g_assert_cmpint (g_utime (path, &buf), ==, 0);
+}
+
+static void
+create_file (const gchar *dir,
+             const gchar *name)
+{
+  gchar *path;
+
+  path = g_build_filename (dir, name, NULL);
+  g_assert (g_file_set_contents (path, "", 0, NULL));
+  g_free (path);
+}
+
+static void
+remove_file (const gchar *dir,
+             const gchar *name)
+{
+  gchar *path;
+
+  path = g_build_filename (dir, name, NULL);
+  g_assert_cmpint (g_remove (path), ==, 0);
+  g_free (path);
+}
+
+/* Creates a tree with the entries one.txt, two.txt, sub and
+ * sub/three.txt */
+static gchar *
+create_tree (const gchar *name)
+{
+  gchar *root, *sub;
+
+  root = g_build_filename (tmp_dir, name, NULL);
+  sub = g_build_filename (root, "sub", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (sub, 0700), ==, 0);
+
+  create_file (root, "one.txt");
+  create_file (root, "two.txt");
+  create_file (sub, "three.txt");
+
+  set_mtime (sub, OLD_TIME);
+  set_mtime (root, OLD_TIME);
+  g_free (sub);
+
+  return root;
+}
+
+static GtkSearchIndex *
+get_index (const gchar *root)
+{
+  volatile gboolean cancelled = FALSE;
+  GtkSearchIndex *index;
+
+  index = _gtk_search_index_get (root, NULL, NULL, &cancelled);
+  g_assert (index != NULL);
+
+  return index;
+}
+
+/* Only the last index is kept in memory, so getting another one
+ * makes the next lookup load the index from disk */
+static void
+forget_index (void)
+{
+  gchar *other;
+
+  other = g_build_filename (tmp_dir, "other", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (other, 0700), ==, 0);
+  _gtk_search_index_unref (get_index (other));
+  g_free (other);
+}
+
+static gboolean
+index_has_name (GtkSearchIndex *index,
+                const gchar    *name)
+{
+  guint i;
+
+  for (i = 0; i < _gtk_search_index_get_n_entries (index); i++)
+    {
+      if (strcmp (_gtk_search_index_get_name (index, i), name) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+count_visits (const gchar *path,
+              gpointer     user_data)
+{
+  guint *n_visits = user_data;
+
+  (*n_visits)++;
+}
+
+static void
+test_build (void)
+{
+  volatile gboolean cancelled = FALSE;
+  GtkSearchIndex *index;
+  gchar *root, *filename;
+  guint n_visits;
+
+  root = create_tree ("build");
+
+  n_visits = 0;
+  index = _gtk_search_index_get (root, count_visits, &n_visits, &cancelled);
+  g_assert (index != NULL);
+
+  g_assert_cmpuint (_gtk_search_index_get_n_entries (index), ==, 4);
+  g_assert_cmpuint (n_visits, ==, 4);
+  g_assert (index_has_name (index, "one.txt"));
+  g_assert (index_has_name (index, "three.txt"));
+
+  filename = _gtk_search_index_get_filename (root);
+  g_assert (g_file_test (filename, G_FILE_TEST_IS_REGULAR));
+
+  _gtk_search_index_unref (index);
+  g_free (filename);
+  g_free (root);
+}
+
+static void
+test_round_trip (void)
+{
+  GtkSearchIndex *index;
+  gchar *root;
+  guint n_visits;
+  volatile gboolean cancelled = FALSE;
+
+  root = create_tree ("round-trip");
+  _gtk_search_index_unref (get_index (root));
+  forget_index ();
+
+  /* Nothing looks changed, so a loaded index still has the file */
+  remove_file (root, "one.txt");
+  set_mtime (root, OLD_TIME);
+
+  n_visits = 0;
+  index = _gtk_search_index_get (root, count_visits, &n_visits, &cancelled);
+  g_assert (index != NULL);
+
+  g_assert_cmpuint (n_visits, ==, 0);
+  g_assert_cmpuint (_gtk_search_index_get_n_entries (index), ==, 4);
+  g_assert (index_has_name (index, "one.txt"));
+  g_assert (index_has_name (index, "three.txt"));
+
+  _gtk_search_index_unref (index);
+  g_free (root);
+}
+
+static void
+test_refresh (void)
+{
+  GtkSearchIndex *index;
+  gchar *root, *sub;
+
+  root = create_tree ("refresh");
+  sub = g_build_filename (root, "sub", NULL);
+  _gtk_search_index_unref (get_index (root));
+  forget_index ();
+
+  remove_file (root, "one.txt");
+  create_file (sub, "four.txt");
+  set_mtime (root, NEWER_TIME);
+  set_mtime (sub, NEWER_TIME);
+
+  index = get_index (root);
+
+  g_assert_cmpuint (_gtk_search_index_get_n_entries (index), ==, 4);
+  g_assert (!index_has_name (index, "one.txt"));
+  g_assert (index_has_name (index, "two.txt"));
+  g_assert (index_has_name (index, "four.txt"));
+
+  _gtk_search_index_unref (index);
+  g_free (sub);
+  g_free (root);
+}
+
+/* Replaces the index of @root with broken contents and makes sure it
+ * is built again instead of being loaded */
+static void
+check_rejected (const gchar *root,
+                const gchar *removed,
+                gboolean     truncate)
+{
+  GtkSearchIndex *index;
+  gchar *filename, *contents;
+  gsize length;
+
+  _gtk_search_index_unref (get_index (root));
+  forget_index ();
+
+  remove_file (root, removed);
+  set_mtime (root, OLD_TIME);
+
+  filename = _gtk_search_index_get_filename (root);
+  g_assert (g_file_get_contents (filename, &contents, &length, NULL));
+  if (truncate)
+    length /= 2;
+  else
+    memset (contents + 8, 0xff, length - 8);
+  g_assert (g_file_set_contents (filename, contents, length, NULL));
+
+  index = get_index (root);
+  g_assert (!index_has_name (index, removed));
+
+  _gtk_search_index_unref (index);
+  g_free (contents);
+  g_free (filename);
+}
+
+static void
+test_corrupt (void)
+{
+  gchar *root;
+
+  root = create_tree ("corrupt");
+  check_rejected (root, "one.txt", FALSE);
+  g_free (root);
+}
+
+static void
+test_truncated (void)
+{
+  gchar *root;
+
+  root = create_tree ("truncated");
+  check_rejected (root, "one.txt", TRUE);
+  g_free (root);
+}
+
+/* Loading an index marks it as used, so it outlives indexes that
+ * were saved later but not used since */
+static void
+test_prune (void)
+{
+  gchar *roots[GTK_SEARCH_INDEX_MAX_FILES + 1];
+  gchar *filenames[GTK_SEARCH_INDEX_MAX_FILES + 1];
+  gchar *name, *filename, *dirname;
+  guint i;
+
+  /* Start with an empty cache */
+  filename = _gtk_search_index_get_filename (tmp_dir);
+  dirname = g_path_get_dirname (filename);
+  remove_tree (dirname);
+  g_free (filename);
+
+  for (i = 0; i < GTK_SEARCH_INDEX_MAX_FILES; i++)
+    {
+      name = g_strdup_printf ("prune-%u", i);
+      roots[i] = create_tree (name);
+      filenames[i] = _gtk_search_index_get_filename (roots[i]);
+      _gtk_search_index_unref (get_index (roots[i]));
+      set_mtime (filenames[i], OLD_TIME + i);
+      g_free (name);
+    }
+
+  /* Not the last index, so it is loaded from disk */
+  _gtk_search_index_unref (get_index (roots[0]));
+
+  roots[i] = create_tree ("prune-new");
+  filenames[i] = _gtk_search_index_get_filename (roots[i]);
+  _gtk_search_index_unref (get_index (roots[i]));
+
+  g_assert (g_file_test (filenames[GTK_SEARCH_INDEX_MAX_FILES], G_FILE_TEST_EXISTS));
+  g_assert (g_file_test (filenames[0], G_FILE_TEST_EXISTS));
+  g_assert (!g_file_test (filenames[1], G_FILE_TEST_EXISTS));
+  for (i = 2; i < GTK_SEARCH_INDEX_MAX_FILES; i++)
+    g_assert (g_file_test (filenames[i], G_FILE_TEST_EXISTS));
+
+  for (i = 0; i <= GTK_SEARCH_INDEX_MAX_FILES; i++)
+    {
+      g_free (roots[i]);
+      g_free (filenames[i]);
+    }
+  g_free (dirname);
+}
+
+/* A job that is left behind for another directory may stop early,
+ * but must not leave a broken index behind */
+static void
+test_switch_root (void)
+{
+  volatile gboolean cancelled = TRUE;
+  GtkSearchIndex *index;
+  gchar *root, *other;
+
+  root = create_tree ("switch-root");
+  other = create_tree ("switch-root-other");
+
+  g_assert (_gtk_search_index_get (root, NULL, NULL, &cancelled) == NULL);
+  _gtk_search_index_unref (get_index (other));
+
+  index = get_index (root);
+  g_assert_cmpuint (_gtk_search_index_get_n_entries (index), ==, 4);
+  g_assert (index_has_name (index, "three.txt"));
+
+  _gtk_search_index_unref (index);
+  g_free (other);
+  g_free (root);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gchar *cache_dir;
+  int result;
+
+  tmp_dir = g_dir_make_tmp ("gtk-searchindex-XXXXXX", NULL);
+  g_assert (tmp_dir != NULL);
+
+  /* Keep the indexes away from the real cache */
+  cache_dir = g_build_filename (tmp_dir, "cache", NULL);
+  g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+  g_free (cache_dir);
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/searchindex/build", test_build);
+  g_test_add_func ("/searchindex/round-trip", test_round_trip);
+  g_test_add_func ("/searchindex/refresh", test_refresh);
+  g_test_add_func ("/searchindex/corrupt", test_corrupt);
+  g_test_add_func ("/searchindex/truncated", test_truncated);
+  g_test_add_func ("/searchindex/prune", test_prune);
+  g_test_add_func ("/searchindex/switch-root", test_switch_root);
+
+  result = g_test_run ();
+
+  remove_tree (tmp_dir);
+  g_free (tmp_dir);
+
+  return result;
+}
@@ -1030,6 +1030,87 @@ sorted_insert (void)
 }
 
 
+/* Large enough to be sorted in several threads */
+#define N_SORT_KEY_ROWS 40000
+
+static void
+sort_by_keys (void)
+{
+  GtkListStore *store;
+  GtkTreeModel *sort_model;
+  GtkTreeIter iter, child_iter;
+  GtkTreePath *path;
+  gint i, prev_value, prev_offset;
+  gchar *prev_string;
+
+  store = gtk_list_store_new (2, G_TYPE_INT, G_TYPE_STRING);
+  for (i = 0; i < N_SORT_KEY_ROWS; i++)
+    {
+      gchar *string = g_strdup_printf ("row %d", (i * 7919) % 1000);
+
+      gtk_list_store_insert_with_values (store, NULL, -1,
+                                         0, (i * 7919) % 100,
+                                         1, string,
+                                         -1);
+      g_free (string);
+    }
+
+  sort_model = gtk_tree_model_sort_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_ASCENDING);
+
+  /* Rows with equal values keep the order of the child model */
+  prev_value = -1;
+  prev_offset = -1;
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  do
+    {
+      gint value, offset;
+
+      gtk_tree_model_get (sort_model, &iter, 0, &value, -1);
+      gtk_tree_model_sort_convert_iter_to_child_iter (GTK_TREE_MODEL_SORT (sort_model),
+                                                      &child_iter, &iter);
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), &child_iter);
+      offset = gtk_tree_path_get_indices (path)[0];
+      gtk_tree_path_free (path);
+
+      g_assert_cmpint (prev_value, <=, value);
+      if (prev_value == value)
+        g_assert_cmpint (prev_offset, <, offset);
+
+      prev_value = value;
+      prev_offset = offset;
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+
+  /* Strings sort like g_utf8_collate() */
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        1, GTK_SORT_DESCENDING);
+
+  prev_string = NULL;
+  g_assert (gtk_tree_model_get_iter_first (sort_model, &iter));
+  do
+    {
+      gchar *string;
+
+      gtk_tree_model_get (sort_model, &iter, 1, &string, -1);
+      if (prev_string)
+        g_assert_cmpint (g_utf8_collate (prev_string, string), >=, 0);
+
+      g_free (prev_string);
+      prev_string = string;
+    }
+  while (gtk_tree_model_iter_next (sort_model, &iter));
+  g_free (prev_string);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (sort_model),
+                                        0, GTK_SORT_DESCENDING);
+  check_sort_order (sort_model, GTK_SORT_DESCENDING, NULL);
+
+  g_object_unref (sort_model);
+  g_object_unref (store);
+}
+
 static void
 specific_bug_300089 (void)
 {
@@ -1230,6 +1311,8 @@ register_sort_model_tests (void)
                    rows_reordered_two_levels);
   g_test_add_func ("/TreeModelSort/sorted-insert",
                    sorted_insert);
+  g_test_add_func ("/TreeModelSort/sort-by-keys",
+                   sort_by_keys);
 
   g_test_add_func ("/TreeModelSort/specific/bug-300089",
                    specific_bug_300089);
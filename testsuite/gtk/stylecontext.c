@@ -343,6 +343,284 @@ test_basic_properties (void)
   g_object_unref (context);
 }
 
+/* A child computing the same padding as its parent shares the
+ * parent's value. Changing either one must not affect the other.
+ */
+static void
+test_parent_sharing (void)
+{
+  GtkCssProvider *provider;
+  GtkStyleContext *parent, *child;
+  GtkWidgetPath *path;
+  GtkBorder padding;
+  GdkRGBA color, expected;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "* { padding: 3px; color: #010; }\n"
+                                   ".big { padding: 7px; color: #020; }",
+                                   -1, NULL);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_BOX);
+
+  parent = gtk_style_context_new ();
+  gtk_style_context_add_provider (parent, GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+  gtk_style_context_set_path (parent, path);
+
+  gtk_widget_path_append_type (path, GTK_TYPE_LABEL);
+  child = gtk_style_context_new ();
+  gtk_style_context_add_provider (child, GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+  gtk_style_context_set_path (child, path);
+  gtk_style_context_set_parent (child, parent);
+  gtk_widget_path_free (path);
+
+  gtk_style_context_get_padding (child, 0, &padding);
+  g_assert_cmpint (padding.left, ==, 3);
+
+  gtk_style_context_add_class (parent, "big");
+  gtk_style_context_invalidate (parent);
+
+  gtk_style_context_get_padding (parent, 0, &padding);
+  g_assert_cmpint (padding.left, ==, 7);
+  gtk_style_context_get_padding (child, 0, &padding);
+  g_assert_cmpint (padding.left, ==, 3);
+
+  gtk_style_context_add_class (child, "big");
+  gtk_style_context_remove_class (parent, "big");
+  gtk_style_context_invalidate (parent);
+  gtk_style_context_invalidate (child);
+
+  gtk_style_context_get_padding (parent, 0, &padding);
+  g_assert_cmpint (padding.left, ==, 3);
+  gtk_style_context_get_padding (child, 0, &padding);
+  g_assert_cmpint (padding.left, ==, 7);
+  gtk_style_context_get_color (child, 0, &color);
+  gdk_rgba_parse (&expected, "#020");
+  g_assert (gdk_rgba_equal (&color, &expected));
+
+  g_object_unref (child);
+  g_object_unref (parent);
+  g_object_unref (provider);
+}
+
+static GtkStyleContext *
+create_label_context (void)
+{
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_LABEL);
+
+  context = gtk_style_context_new ();
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_free (path);
+
+  return context;
+}
+
+static void
+assert_color (GtkStyleContext *context,
+              const gchar     *spec)
+{
+  GdkRGBA color, expected;
+
+  gtk_style_context_get_color (context, gtk_style_context_get_state (context), &color);
+  gdk_rgba_parse (&expected, spec);
+  g_assert (gdk_rgba_equal (&color, &expected));
+}
+
+/* Contexts with equal paths share computed values. Changes to one
+ * of them or to the style information must never show up in stale
+ * values.
+ */
+static void
+test_shared_styles (void)
+{
+  GtkCssProvider *provider;
+  GtkStyleContext *context1, *context2, *context3;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkLabel { color: #010; }\n"
+                                   "GtkLabel:hover { color: #030; }",
+                                   -1, NULL);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  context1 = create_label_context ();
+  context2 = create_label_context ();
+  assert_color (context1, "#010");
+  assert_color (context2, "#010");
+
+  /* a context changing its state doesn't take the other one along */
+  gtk_style_context_set_state (context1, GTK_STATE_FLAG_PRELIGHT);
+  assert_color (context1, "#030");
+  assert_color (context2, "#010");
+
+  /* values shared before the style changed are not handed out again */
+  gtk_css_provider_load_from_data (provider,
+                                   "GtkLabel { color: #040; }",
+                                   -1, NULL);
+  context3 = create_label_context ();
+  assert_color (context3, "#040");
+
+  gtk_style_context_invalidate (context2);
+  assert_color (context2, "#040");
+
+  /* the last user of shared values can keep using them */
+  g_object_unref (context3);
+  assert_color (context2, "#040");
+
+  g_object_unref (context2);
+  g_object_unref (context1);
+
+  gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
+
+static guint32
+get_pixel (cairo_surface_t *surface,
+           int              x,
+           int              y)
+{
+  cairo_surface_flush (surface);
+
+  return ((guint32 *) (cairo_image_surface_get_data (surface) +
+                       y * cairo_image_surface_get_stride (surface)))[x];
+}
+
+/* Blurred shadows are drawn as a coverage mask that is filled with
+ * the shadow color, check that color and alpha come out right.
+ */
+static void
+test_blurred_shadow (void)
+{
+  GtkCssProvider *provider;
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint32 edge, outside;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "* { background: none;"
+                                   "    box-shadow: 0 0 4px rgba(255,0,0,0.5); }",
+                                   -1, NULL);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_BOX);
+
+  context = gtk_style_context_new ();
+  gtk_style_context_add_provider (context, GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_free (path);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 40, 40);
+  cr = cairo_create (surface);
+  gtk_render_background (context, cr, 10, 10, 20, 20);
+  cairo_destroy (cr);
+
+  /* next to the box, the shadow is red with about half of the
+   * color's alpha */
+  edge = get_pixel (surface, 9, 20);
+  g_assert_cmpuint (edge >> 24, >, 48);
+  g_assert_cmpuint (edge >> 24, <=, 128);
+  g_assert_cmpuint ((edge >> 16) & 0xff, ==, edge >> 24);
+  g_assert_cmpuint (edge & 0xffff, ==, 0);
+
+  /* it fades out further away */
+  outside = get_pixel (surface, 4, 20);
+  g_assert_cmpuint (outside >> 24, <, edge >> 24);
+  g_assert_cmpuint ((outside >> 16) & 0xff, ==, outside >> 24);
+
+  /* and outset shadows are not drawn below the box */
+  g_assert_cmpuint (get_pixel (surface, 20, 20), ==, 0);
+
+  cairo_surface_destroy (surface);
+  g_object_unref (context);
+  g_object_unref (provider);
+}
+
+static cairo_surface_t *
+render_background (GtkStyleContext *context,
+                   int              width,
+                   int              height)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width + 20, height + 20);
+  cr = cairo_create (surface);
+  gtk_render_background (context, cr, 10, 10, width, height);
+  cairo_destroy (cr);
+
+  return surface;
+}
+
+/* Blurred shadows of large boxes are put together from the slices of
+ * one mask, check that boxes of different sizes get the same corners
+ * and sides.
+ */
+static void
+test_blurred_shadow_sizes (void)
+{
+  GtkCssProvider *provider;
+  GtkStyleContext *context;
+  GtkWidgetPath *path;
+  cairo_surface_t *small, *large;
+  int x, y;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "* { background: none;"
+                                   "    border-radius: 5px;"
+                                   "    box-shadow: 0 0 4px red; }",
+                                   -1, NULL);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_BOX);
+
+  context = gtk_style_context_new ();
+  gtk_style_context_add_provider (context, GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+  gtk_style_context_set_path (context, path);
+  gtk_widget_path_free (path);
+
+  small = render_background (context, 40, 30);
+  large = render_background (context, 70, 50);
+
+  /* the top left corner */
+  for (y = 0; y < 23; y++)
+    for (x = 0; x < 23; x++)
+      g_assert_cmpuint (get_pixel (small, x, y), ==, get_pixel (large, x, y));
+
+  /* the bottom right corner */
+  for (y = -13; y < 10; y++)
+    for (x = -13; x < 10; x++)
+      g_assert_cmpuint (get_pixel (small, 50 + x, 40 + y), ==, get_pixel (large, 80 + x, 60 + y));
+
+  /* the top side, which is the same all along */
+  for (y = 0; y < 10; y++)
+    {
+      g_assert_cmpuint (get_pixel (small, 30, y), ==, get_pixel (large, 50, y));
+      g_assert_cmpuint (get_pixel (large, 30, y), ==, get_pixel (large, 50, y));
+    }
+  g_assert_cmpuint (get_pixel (large, 50, 9) >> 24, >, 0);
+
+  cairo_surface_destroy (small);
+  cairo_surface_destroy (large);
+  g_object_unref (context);
+  g_object_unref (provider);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -354,6 +632,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/style/match", test_match);
   g_test_add_func ("/style/style-property", test_style_property);
   g_test_add_func ("/style/basic", test_basic_properties);
+  g_test_add_func ("/style/parent-sharing", test_parent_sharing);
+  g_test_add_func ("/style/shared-styles", test_shared_styles);
+  g_test_add_func ("/style/blurred-shadow", test_blurred_shadow);
+  g_test_add_func ("/style/blurred-shadow-sizes", test_blurred_shadow_sizes);
 
   return g_test_run ();
 }
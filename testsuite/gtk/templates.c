@@ -70,6 +70,45 @@ test_message_dialog_basic (void)
   gtk_widget_destroy (dialog);
 }
 
+static void
+test_message_dialog_instances (void)
+{
+  GtkWidget *dialogs[2];
+  GtkWidget *content_area, *action_area;
+  GtkPackType pack_type;
+  gint i;
+
+  /* The second instance replays the template compiled by the first one */
+  for (i = 0; i < G_N_ELEMENTS (dialogs); i++)
+    {
+      dialogs[i] = gtk_message_dialog_new (NULL, 0,
+                                           GTK_MESSAGE_INFO,
+                                           GTK_BUTTONS_CLOSE,
+                                           "Do it hard !");
+      g_assert (GTK_IS_MESSAGE_DIALOG (dialogs[i]));
+      g_assert (gtk_message_dialog_get_message_area (GTK_MESSAGE_DIALOG (dialogs[i])) != NULL);
+      g_assert_cmpint (gtk_container_get_border_width (GTK_CONTAINER (dialogs[i])), ==, 5);
+
+      /* Values converted once by the first instance and shared */
+      g_assert (!gtk_window_get_resizable (GTK_WINDOW (dialogs[i])));
+      g_assert_cmpint (gtk_window_get_type_hint (GTK_WINDOW (dialogs[i])), ==, GDK_WINDOW_TYPE_HINT_DIALOG);
+      g_assert_cmpstr (gtk_window_get_title (GTK_WINDOW (dialogs[i])), ==, " ");
+
+      /* <packing> is a custom tag, replayed as its own fragment */
+      content_area = gtk_dialog_get_content_area (GTK_DIALOG (dialogs[i]));
+      action_area = gtk_dialog_get_action_area (GTK_DIALOG (dialogs[i]));
+      gtk_box_query_child_packing (GTK_BOX (content_area), action_area,
+                                   NULL, NULL, NULL, &pack_type);
+      g_assert_cmpint (pack_type, ==, GTK_PACK_END);
+    }
+
+  g_assert (gtk_message_dialog_get_message_area (GTK_MESSAGE_DIALOG (dialogs[0])) !=
+            gtk_message_dialog_get_message_area (GTK_MESSAGE_DIALOG (dialogs[1])));
+
+  for (i = 0; i < G_N_ELEMENTS (dialogs); i++)
+    gtk_widget_destroy (dialogs[i]);
+}
+
 static void
 test_about_dialog_basic (void)
 {
@@ -332,6 +371,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Template/GtkDialog/Basic", test_dialog_basic);
   g_test_add_func ("/Template/GtkDialog/OverrideProperty", test_dialog_override_property);
   g_test_add_func ("/Template/GtkMessageDialog/Basic", test_message_dialog_basic);
+  g_test_add_func ("/Template/GtkMessageDialog/Instances", test_message_dialog_instances);
   g_test_add_func ("/Template/GtkAboutDialog/Basic", test_about_dialog_basic);
   g_test_add_func ("/Template/GtkInfoBar/Basic", test_info_bar_basic);
   g_test_add_func ("/Template/GtkLockButton/Basic", test_lock_button_basic);
@@ -0,0 +1,44 @@
+/* Helpers shared by the tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "testutils.h"
+
+#include <glib/gstdio.h>
+
+/* Removes @path and, if it is a directory, everything below it */
+void
+remove_tree (const gchar *path)
+{
+  const gchar *name;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          gchar *child = g_build_filename (path, name, NULL);
+
+          remove_tree (child);
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_remove (path);
+}
@@ -0,0 +1,214 @@
+/* GtkTextLayout tests.
+ *
+ * Copyright (C) 2013, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define GTK_TEXT_USE_INTERNAL_UNSUPPORTED_API
+#include "gtk/gtktextlayout.h"
+
+static GtkTextBuffer *
+create_buffer (void)
+{
+  GtkTextBuffer *buffer;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer,
+                            "zero\none\ntwo\nthree\nfour\n"
+                            "five\nsix\nseven\neight\nnine",
+                            -1);
+
+  return buffer;
+}
+
+static GtkTextLayout *
+create_layout (GtkTextBuffer *buffer)
+{
+  GtkTextLayout *layout;
+  GtkTextAttributes *style;
+  PangoContext *ltr_context, *rtl_context;
+
+  layout = gtk_text_layout_new ();
+  gtk_text_layout_set_buffer (layout, buffer);
+
+  ltr_context = gdk_pango_context_get ();
+  pango_context_set_base_dir (ltr_context, PANGO_DIRECTION_LTR);
+  rtl_context = gdk_pango_context_get ();
+  pango_context_set_base_dir (rtl_context, PANGO_DIRECTION_RTL);
+  gtk_text_layout_set_contexts (layout, ltr_context, rtl_context);
+  g_object_unref (ltr_context);
+  g_object_unref (rtl_context);
+
+  style = gtk_text_attributes_new ();
+  style->font = pango_font_description_from_string ("Sans 10");
+  gtk_text_layout_set_default_style (layout, style);
+  gtk_text_attributes_unref (style);
+
+  gtk_text_layout_set_screen_width (layout, 200);
+
+  return layout;
+}
+
+/* Gets the display of @line and returns whether it was cached */
+static gboolean
+get_line (GtkTextLayout *layout,
+          gint           line)
+{
+  GtkTextIter iter;
+  GdkRectangle rect;
+  guint hits, misses, new_hits, new_misses;
+
+  gtk_text_layout_get_display_cache_stats (layout, &hits, &misses);
+
+  gtk_text_buffer_get_iter_at_line (layout->buffer, &iter, line);
+  gtk_text_layout_get_iter_location (layout, &iter, &rect);
+
+  gtk_text_layout_get_display_cache_stats (layout, &new_hits, &new_misses);
+  g_assert_cmpuint (new_hits + new_misses, ==, hits + misses + 1);
+
+  return new_hits > hits;
+}
+
+static void
+test_display_cache_hits (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextLayout *layout;
+  GtkTextIter iter;
+  gint i;
+
+  buffer = create_buffer ();
+  layout = create_layout (buffer);
+
+  for (i = 0; i < 10; i++)
+    g_assert (!get_line (layout, i));
+  for (i = 0; i < 10; i++)
+    g_assert (get_line (layout, i));
+
+  /* editing a line drops its display, but not the others */
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, 2);
+  gtk_text_buffer_insert (buffer, &iter, "x", -1);
+  g_assert (!get_line (layout, 2));
+  g_assert (get_line (layout, 7));
+
+  g_object_unref (layout);
+  g_object_unref (buffer);
+}
+
+static void
+test_display_cache_eviction (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextLayout *layout;
+  gint i;
+
+  buffer = create_buffer ();
+  layout = create_layout (buffer);
+
+  gtk_text_layout_set_display_cache_size (layout, 4);
+  g_assert_cmpuint (gtk_text_layout_get_display_cache_size (layout), ==, 4);
+
+  for (i = 0; i < 4; i++)
+    g_assert (!get_line (layout, i));
+
+  /* line 0 becomes the most recently used one, so line 1 is
+   * evicted to make room for line 4 */
+  g_assert (get_line (layout, 0));
+  g_assert (!get_line (layout, 4));
+  g_assert (get_line (layout, 0));
+  g_assert (get_line (layout, 2));
+  g_assert (!get_line (layout, 1));
+
+  /* shrinking the cache keeps the most recently used lines */
+  gtk_text_layout_set_display_cache_size (layout, 1);
+  g_assert (get_line (layout, 1));
+  g_assert (!get_line (layout, 2));
+
+  g_object_unref (layout);
+  g_object_unref (buffer);
+}
+
+static void
+test_display_cache_max_bytes (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextLayout *layout;
+
+  buffer = create_buffer ();
+  layout = create_layout (buffer);
+
+  g_assert_cmpuint (gtk_text_layout_get_display_cache_max_bytes (layout), ==, 4 * 1024 * 1024);
+
+  /* every display is estimated at more than 1k, so only one fits */
+  gtk_text_layout_set_display_cache_max_bytes (layout, 2048);
+  g_assert_cmpuint (gtk_text_layout_get_display_cache_max_bytes (layout), ==, 2048);
+
+  g_assert (!get_line (layout, 0));
+  g_assert (!get_line (layout, 1));
+  g_assert (!get_line (layout, 0));
+  g_assert (get_line (layout, 0));
+
+  /* a display that is too big on its own is kept until the next one */
+  gtk_text_layout_set_display_cache_max_bytes (layout, 0);
+  g_assert (!get_line (layout, 0));
+  g_assert (get_line (layout, 0));
+
+  gtk_text_layout_set_display_cache_max_bytes (layout, 1024 * 1024);
+  g_assert (!get_line (layout, 1));
+  g_assert (get_line (layout, 0));
+  g_assert (get_line (layout, 1));
+
+  g_object_unref (layout);
+  g_object_unref (buffer);
+}
+
+static void
+test_display_cache_buffer (void)
+{
+  GtkTextBuffer *buffer, *buffer2;
+  GtkTextLayout *layout;
+
+  buffer = create_buffer ();
+  layout = create_layout (buffer);
+
+  g_assert (!get_line (layout, 0));
+  g_assert (get_line (layout, 0));
+
+  /* nothing cached for the old buffer is used for the new one */
+  buffer2 = create_buffer ();
+  gtk_text_layout_set_buffer (layout, buffer2);
+  g_object_unref (buffer);
+
+  g_assert (!get_line (layout, 0));
+  g_assert (get_line (layout, 0));
+
+  g_object_unref (layout);
+  g_object_unref (buffer2);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/textlayout/display-cache/hits", test_display_cache_hits);
+  g_test_add_func ("/textlayout/display-cache/eviction", test_display_cache_eviction);
+  g_test_add_func ("/textlayout/display-cache/max-bytes", test_display_cache_max_bytes);
+  g_test_add_func ("/textlayout/display-cache/buffer", test_display_cache_buffer);
+
+  return g_test_run ();
+}
@@ -226,6 +226,71 @@ test_row_separator_height (void)
   gtk_widget_destroy (tree_view);
 }
 
+static gint
+get_row_height (GtkWidget *tree_view,
+                gint       row)
+{
+  GtkTreePath *path;
+  GdkRectangle area = { 0, };
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_view_get_background_area (GTK_TREE_VIEW (tree_view),
+                                     path, NULL, &area);
+  gtk_tree_path_free (path);
+
+  return area.height;
+}
+
+static void
+test_estimated_height (void)
+{
+  GtkListStore *store;
+  GtkWidget *window;
+  GtkWidget *tree_view;
+  gint even, odd;
+  gint i;
+
+  /* Rows alternate between two heights, so every sample big
+   * enough averages to the height in between */
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
+  for (i = 0; i < 1000; i++)
+    gtk_list_store_insert_with_values (store, NULL, i,
+                                       0, "Row content",
+                                       1, i % 2 ? 40 : 20,
+                                       -1);
+
+  window = gtk_offscreen_window_new ();
+
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_view_set_estimated_height_mode (GTK_TREE_VIEW (tree_view), TRUE);
+  g_assert (gtk_tree_view_get_estimated_height_mode (GTK_TREE_VIEW (tree_view)));
+
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view),
+                                               0,
+                                               "Test",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0,
+                                               "height", 1,
+                                               NULL);
+
+  gtk_widget_set_size_request (tree_view, -1, 200);
+  gtk_container_add (GTK_CONTAINER (window), tree_view);
+  gtk_widget_show_all (window);
+
+  /* The first rows are visible, so they were measured */
+  even = get_row_height (tree_view, 0);
+  odd = get_row_height (tree_view, 1);
+  g_assert_cmpint (even, >, 0);
+  g_assert_cmpint (odd, ==, even + 20);
+
+  /* The last row was not measured, but got the average height
+   * of the sampled rows */
+  g_assert_cmpint (get_row_height (tree_view, 999), ==, (even + odd) / 2);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -238,6 +303,8 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/estimated-height",
+                   test_estimated_height);
 
   return g_test_run ();
 }